@@ -0,0 +1,197 @@
+/*!
+\brief	Run loop that simulates at a fixed rate and renders at its own rate, interpolating between steps.
+*/
+
+#include "Application.h"
+
+#include <algorithm>	// std::min, std::max
+#include <cmath>		// std::floor
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <thread>		// std::this_thread::sleep_until
+
+namespace app
+{
+	namespace
+	{
+		/// \brief	Without a step per iteration the simulation would never advance.
+		Application::Settings Validate(Application::Settings settings)
+		{
+			settings.mMaxSteps = std::max(settings.mMaxSteps, 1u);
+			return settings;
+		}
+	}
+
+	class Application::Application_impl
+	{
+	public:
+		explicit Application_impl(const Settings & settings);
+
+		void setFrameFunction(FrameFunction frame) { mFrame = std::move(frame); }
+		void setSimulateFunction(SimulateFunction simulate) { mSimulate = std::move(simulate); }
+		void setRenderFunction(RenderFunction render) { mRender = std::move(render); }
+
+		void setSettings(const Settings & settings) { mSettings = Validate(settings); }
+		const Settings & getSettings() const { return mSettings; }
+
+		void Run();
+		bool RunFrame();
+		void Stop() { mbStopped = true; }
+
+		double getTime() const { return mTime; }
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		static Clock::duration ToDuration(double seconds);
+
+		Settings mSettings;
+		FrameFunction mFrame;
+		SimulateFunction mSimulate;
+		RenderFunction mRender;
+
+		Clock::time_point mLastTime;
+		Clock::time_point mNextRender;
+		double mAccumulator{ 0.0 };	// real seconds not simulated yet
+		double mTime{ 0.0 };
+		bool mbStopped{ false };
+
+		Stats mStats;
+	};
+
+	Application::Application_impl::Application_impl(const Settings & settings)
+		: mSettings(Validate(settings))
+		, mLastTime(Clock::now())
+		, mNextRender(mLastTime)
+	{}
+
+	void Application::Application_impl::Run()
+	{
+		// the time spent before running (loading...) is not simulated
+		mLastTime = mNextRender = Clock::now();
+		mbStopped = false;
+		while (RunFrame()) {}
+	}
+
+	bool Application::Application_impl::RunFrame()
+	{
+		if (mbStopped)
+			return false;
+		if (mFrame && !mFrame())
+		{
+			mbStopped = true;
+			return false;
+		}
+
+		const Clock::time_point now = Clock::now();
+		mAccumulator += std::chrono::duration<double>(now - mLastTime).count();
+		mLastTime = now;
+
+		// steps
+		const double dt = 1.0 / mSettings.mSimulateRate;
+		mStats.mSteps = 0;
+		while (mAccumulator >= dt)
+		{
+			// IMPORTANT(Borja): When the steps take longer than the time they simulate the loop would
+			// fall further behind every iteration, the time it can't catch up with is dropped.
+			if (mStats.mSteps == mSettings.mMaxSteps)
+			{
+				const double dropped = std::floor(mAccumulator / dt);
+				mStats.mDroppedSteps += static_cast<unsigned long long>(dropped);
+				mAccumulator -= dropped * dt;
+				break;
+			}
+
+			if (mSimulate)
+				mSimulate(dt);
+			mAccumulator -= dt;
+			mTime += dt;
+			++mStats.mSteps;
+		}
+		mStats.mTotalSteps += mStats.mSteps;
+		const Clock::time_point steps_end = Clock::now();
+		mStats.mSimulateMs = std::chrono::duration<double, std::milli>(steps_end - now).count();
+
+		// render
+		const bool render_every_iteration = mSettings.mRenderRate <= 0.0;
+		if (mRender && (render_every_iteration || steps_end >= mNextRender))
+		{
+			mStats.mAlpha = static_cast<float>(mAccumulator / dt);
+			mRender(mStats.mAlpha);
+			++mStats.mFrames;
+			mStats.mRenderMs = std::chrono::duration<double, std::milli>(Clock::now() - steps_end).count();
+
+			if (!render_every_iteration)
+			{
+				// a late frame doesn't make the next ones come sooner
+				const Clock::duration period = ToDuration(1.0 / mSettings.mRenderRate);
+				mNextRender += period;
+				if (mNextRender < steps_end)
+					mNextRender = steps_end + period;
+			}
+			return !mbStopped;
+		}
+
+		// nothing to render, wait for whatever comes first (the sleep can be late by the resolution
+		// of the system timer, the next iteration catches up)
+		Clock::time_point wake_up = mLastTime + ToDuration(dt - mAccumulator);
+		if (mRender)
+			wake_up = std::min(wake_up, mNextRender);
+		std::this_thread::sleep_until(wake_up);
+		return !mbStopped;
+	}
+
+	Application::Application_impl::Clock::duration Application::Application_impl::ToDuration(double seconds)
+	{
+		return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	}
+
+	Application::Application()
+		: mpImpl(std::make_unique<Application_impl>(Settings()))
+	{}
+	Application::Application(const Settings & settings)
+		: mpImpl(std::make_unique<Application_impl>(settings))
+	{}
+	Application::~Application() {}
+
+	void Application::setFrameFunction(FrameFunction frame)
+	{
+		mpImpl->setFrameFunction(std::move(frame));
+	}
+	void Application::setSimulateFunction(SimulateFunction simulate)
+	{
+		mpImpl->setSimulateFunction(std::move(simulate));
+	}
+	void Application::setRenderFunction(RenderFunction render)
+	{
+		mpImpl->setRenderFunction(std::move(render));
+	}
+	void Application::setSettings(const Settings & settings)
+	{
+		mpImpl->setSettings(settings);
+	}
+	const Application::Settings & Application::getSettings() const
+	{
+		return mpImpl->getSettings();
+	}
+	void Application::Run()
+	{
+		mpImpl->Run();
+	}
+	bool Application::RunFrame()
+	{
+		return mpImpl->RunFrame();
+	}
+	void Application::Stop()
+	{
+		mpImpl->Stop();
+	}
+	double Application::getTime() const
+	{
+		return mpImpl->getTime();
+	}
+	const Application::Stats & Application::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
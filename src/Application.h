@@ -0,0 +1,76 @@
+/*!
+\brief	Run loop that simulates at a fixed rate and renders at its own rate, interpolating between steps.
+*/
+
+#pragma once
+
+#include <memory>		// std::unique_ptr
+#include <functional>	// std::function
+
+namespace app
+{
+	/// \brief	Fixed timestep loop: the simulation always advances in steps of the same length whatever
+	/// the frame rate, running several steps in an iteration to catch up with the real time, and the
+	/// render gets the fraction of a step elapsed since the last one to interpolate the last two states.
+	/// It doesn't depend on Window, a headless instance only sets the simulate function.
+	class Application
+	{
+	public:
+		/// \brief	Called at the beginning of every iteration (to poll the input), the loop stops when it returns false.
+		typedef std::function<bool()> FrameFunction;
+		/// \brief	Advances the simulation dt seconds, it is the same every step.
+		typedef std::function<void(double dt)> SimulateFunction;
+		/// \param	alpha	Fraction [0, 1) of a step elapsed since the last step, to interpolate
+		/// between the state before it and after it.
+		typedef std::function<void(float alpha)> RenderFunction;
+
+		struct Settings
+		{
+			double		mSimulateRate{ 60.0 };	// steps per second
+			double		mRenderRate{ 0.0 };		// frames per second, 0 renders every iteration (limited by the vsync)
+			unsigned	mMaxSteps{ 5 };			// steps per iteration (at least 1), the time still behind is dropped
+		};
+
+		struct Stats
+		{
+			unsigned			mSteps{ 0 };		// steps of the last iteration
+			unsigned long long	mTotalSteps{ 0 };
+			unsigned long long	mDroppedSteps{ 0 };	// steps skipped because of Settings::mMaxSteps
+			unsigned long long	mFrames{ 0 };		// calls to the render function
+			float				mAlpha{ 0.f };		// of the last render
+			double				mSimulateMs{ 0.0 };	// of the steps of the last iteration
+			double				mRenderMs{ 0.0 };	// of the last render
+		};
+
+		Application();
+		explicit Application(const Settings & settings);
+		~Application();
+		Application(const Application &) = delete;
+		Application & operator=(const Application &) = delete;
+
+		void setFrameFunction(FrameFunction frame);
+		void setSimulateFunction(SimulateFunction simulate);
+		/// \brief	Without a render function the loop sleeps between the steps.
+		void setRenderFunction(RenderFunction render);
+
+		/// \brief	Can be changed while running, the time already accumulated is kept.
+		void setSettings(const Settings & settings);
+		const Settings & getSettings() const;
+
+		/// \brief	Runs iterations until Application::Stop is called or the frame function returns false.
+		void Run();
+		/// \brief	Runs one iteration: the frame function, the steps that are due and the render if it is due.
+		/// When nothing has been rendered it sleeps until the next step or render.
+		/// \return	False if the loop has been stopped.
+		bool RunFrame();
+		void Stop();
+
+		/// \brief	Simulated seconds, a multiple of the step.
+		double getTime() const;
+		const Stats & getStats() const;
+
+	private:
+		class Application_impl;
+		std::unique_ptr<Application_impl> mpImpl;
+	};
+}
@@ -0,0 +1,518 @@
+/*!
+\brief	Pack of assets read from a single memory mapped file, and the builder that writes it.
+*/
+
+#include "AssetPack.h"
+
+#include "my_gl_resources.h"	// my_gl_core::create_texture
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>	// CreateFileMappingA, MapViewOfFile
+#else
+#include <sys/mman.h>	// mmap
+#include <sys/stat.h>	// fstat
+#include <fcntl.h>		// open
+#include <unistd.h>		// close
+#endif
+
+#include <algorithm>	// std::sort, std::lower_bound, std::min
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <cstdint>		// std::uint32_t, std::uint64_t
+#include <cstring>		// std::memcpy, std::strcmp
+#include <fstream>		// std::ifstream, std::ofstream
+#include <iterator>		// std::istreambuf_iterator
+#include <stdexcept>	// std::runtime_error
+
+namespace app
+{
+	namespace
+	{
+		const char s_Magic[4] = { 'A', 'P', 'A', 'K' };
+		const std::uint32_t s_Version = 1;
+
+		struct FileHeader
+		{
+			char			mMagic[4];
+			std::uint32_t	mVersion;
+			std::uint32_t	mAssetCount;
+			std::uint32_t	mNamesSize;		// the names follow the index, null terminated
+		};
+		struct FileEntry
+		{
+			std::uint64_t	mOffset;		// from the beginning of the file, multiple of AssetPack::ALIGNMENT
+			std::uint64_t	mStoredSize;
+			std::uint64_t	mSize;
+			std::uint32_t	mNameOffset;	// in the names
+			std::uint32_t	mCompression;
+			std::uint32_t	mWidth;
+			std::uint32_t	mHeight;
+		};
+		static_assert(sizeof(FileHeader) == 16, "The layout of the header can't change");
+		static_assert(sizeof(FileEntry) == 40, "The layout of the index can't change");
+
+		std::size_t AlignUp(std::size_t offset)
+		{
+			return (offset + AssetPack::ALIGNMENT - 1) & ~(AssetPack::ALIGNMENT - 1);
+		}
+
+		// LZ4 block format: sequences of a token (4 bits of literal length, 4 bits of match length - 4),
+		// the literals, a 2 byte offset back in the output and the match, the lengths that don't fit
+		// in the token continue in bytes of 255. The last sequence only has literals.
+		const std::size_t s_Lz4MinMatch = 4;
+		const std::size_t s_Lz4LastLiterals = 5;	// the last bytes are always literals
+		const std::size_t s_Lz4MatchLimit = 12;		// no match starts in the last bytes
+		const unsigned s_Lz4HashBits = 12;
+
+		std::uint32_t Read32(const unsigned char * bytes)
+		{
+			std::uint32_t value;
+			std::memcpy(&value, bytes, sizeof(value));
+			return value;
+		}
+		void WriteLength(std::vector<unsigned char> & out, std::size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				out.push_back(255);
+			out.push_back(static_cast<unsigned char>(length));
+		}
+		void WriteSequence(std::vector<unsigned char> & out, const unsigned char * literals, std::size_t literal_length,
+						   std::size_t offset, std::size_t match_length)
+		{
+			const bool has_match = match_length >= s_Lz4MinMatch;
+			const std::size_t match_code = has_match ? match_length - s_Lz4MinMatch : 0;
+			out.push_back(static_cast<unsigned char>((std::min<std::size_t>(literal_length, 15) << 4) | std::min<std::size_t>(match_code, 15)));
+			if (literal_length >= 15)
+				WriteLength(out, literal_length - 15);
+			out.insert(out.end(), literals, literals + literal_length);
+			if (!has_match)
+				return;
+
+			out.push_back(static_cast<unsigned char>(offset & 0xFF));
+			out.push_back(static_cast<unsigned char>(offset >> 8));
+			if (match_code >= 15)
+				WriteLength(out, match_code - 15);
+		}
+
+		/// \brief	Greedy compressor, finds the matches with a hash table of the last position of every 4 bytes.
+		void Lz4Compress(const unsigned char * src, std::size_t size, std::vector<unsigned char> & out)
+		{
+			out.clear();
+			out.reserve(size + size / 255 + 16);
+
+			std::size_t anchor = 0;
+			if (size > s_Lz4MatchLimit)
+			{
+				std::vector<std::uint32_t> table(std::size_t{ 1 } << s_Lz4HashBits, 0);	// position + 1, 0 is empty
+				const std::size_t match_start_limit = size - s_Lz4MatchLimit;
+				const std::size_t match_end_limit = size - s_Lz4LastLiterals;
+
+				std::size_t pos = 0;
+				while (pos < match_start_limit)
+				{
+					const std::uint32_t sequence = Read32(src + pos);
+					const std::uint32_t hash = (sequence * 2654435761u) >> (32 - s_Lz4HashBits);
+					const std::size_t candidate = table[hash];
+					table[hash] = static_cast<std::uint32_t>(pos + 1);
+
+					if (candidate == 0 || pos - (candidate - 1) > 65535 || Read32(src + candidate - 1) != sequence)
+					{
+						++pos;
+						continue;
+					}
+
+					const std::size_t match = candidate - 1;
+					std::size_t length = s_Lz4MinMatch;
+					while (pos + length < match_end_limit && src[match + length] == src[pos + length])
+						++length;
+
+					WriteSequence(out, src + anchor, pos - anchor, pos - match, length);
+					pos += length;
+					anchor = pos;
+				}
+			}
+			WriteSequence(out, src + anchor, size - anchor, 0, 0);
+		}
+
+		/// \return	False if the data is not a valid block of exactly dst_size bytes.
+		bool Lz4Decompress(const unsigned char * src, std::size_t src_size, unsigned char * dst, std::size_t dst_size)
+		{
+			std::size_t in = 0, out = 0;
+			const auto read_length = [&](std::size_t & length)
+			{
+				unsigned char byte;
+				do
+				{
+					if (in >= src_size)
+						return false;
+					byte = src[in++];
+					length += byte;
+				} while (byte == 255);
+				return true;
+			};
+
+			while (in < src_size)
+			{
+				const unsigned char token = src[in++];
+				std::size_t literal_length = token >> 4;
+				if (literal_length == 15 && !read_length(literal_length))
+					return false;
+				if (literal_length > src_size - in || literal_length > dst_size - out)
+					return false;
+				std::memcpy(dst + out, src + in, literal_length);
+				in += literal_length;
+				out += literal_length;
+
+				if (in == src_size)
+					break;	// last sequence
+
+				if (src_size - in < 2)
+					return false;
+				const std::size_t offset = src[in] | (static_cast<std::size_t>(src[in + 1]) << 8);
+				in += 2;
+				if (offset == 0 || offset > out)
+					return false;
+
+				std::size_t match_length = token & 15;
+				if (match_length == 15 && !read_length(match_length))
+					return false;
+				match_length += s_Lz4MinMatch;
+				if (match_length > dst_size - out)
+					return false;
+
+				// the match can overlap the bytes it is writing
+				const unsigned char * match = dst + out - offset;
+				for (std::size_t i = 0; i < match_length; ++i)
+					dst[out + i] = match[i];
+				out += match_length;
+			}
+			return out == dst_size;
+		}
+
+		/// \brief	Read only mapping of a whole file.
+		class MappedFile
+		{
+		public:
+			explicit MappedFile(const char * filename)
+			{
+#ifdef _WIN32
+				const HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+												OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file == INVALID_HANDLE_VALUE)
+					return;
+
+				LARGE_INTEGER size;
+				if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+				{
+					const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					if (mapping)
+					{
+						// the view keeps the mapping alive
+						mpData = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+						mSize = mpData ? static_cast<std::size_t>(size.QuadPart) : 0;
+						CloseHandle(mapping);
+					}
+				}
+				CloseHandle(file);
+#else
+				const int file = open(filename, O_RDONLY);
+				if (file < 0)
+					return;
+
+				struct stat info;
+				if (fstat(file, &info) == 0 && info.st_size > 0)
+				{
+					void * data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+					if (data != MAP_FAILED)
+					{
+						mpData = static_cast<const unsigned char *>(data);
+						mSize = static_cast<std::size_t>(info.st_size);
+					}
+				}
+				close(file);
+#endif
+			}
+			~MappedFile()
+			{
+				if (mpData == nullptr)
+					return;
+#ifdef _WIN32
+				UnmapViewOfFile(mpData);
+#else
+				munmap(const_cast<unsigned char *>(mpData), mSize);
+#endif
+			}
+			MappedFile(const MappedFile &) = delete;
+			MappedFile & operator=(const MappedFile &) = delete;
+
+			const unsigned char * mpData{ nullptr };
+			std::size_t mSize{ 0 };
+		};
+	}
+
+	class AssetPack::AssetPack_impl
+	{
+	public:
+		explicit AssetPack_impl(const char * filename);
+
+		const Asset * Find(const char * name) const;
+		const std::vector<Asset> & getAssets() const { return mvAssets; }
+		Span getData(const Asset & asset);
+		GLuint CreateTexture(const Asset & asset, const char * owner);
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		MappedFile mFile;
+		std::vector<Asset> mvAssets;					// sorted by name
+		std::vector<std::size_t> mvOffsets;				// of the data of every asset in the file
+		std::vector<std::vector<unsigned char>> mvDecompressed;	// of the compressed assets already requested
+		Stats mStats;
+	};
+
+	AssetPack::AssetPack_impl::AssetPack_impl(const char * filename)
+		: mFile(filename)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		if (mFile.mpData == nullptr)
+			throw std::runtime_error{ std::string{ "AssetPack: Couldn't map the file " } + filename };
+
+		const auto invalid = [filename]()
+		{
+			return std::runtime_error{ std::string{ "AssetPack: The file is not a valid asset pack " } + filename };
+		};
+
+		FileHeader header;
+		if (mFile.mSize < sizeof(header))
+			throw invalid();
+		std::memcpy(&header, mFile.mpData, sizeof(header));
+		if (std::memcmp(header.mMagic, s_Magic, sizeof(s_Magic)) != 0 || header.mVersion != s_Version
+			|| header.mAssetCount > mFile.mSize / sizeof(FileEntry))
+			throw invalid();
+
+		const std::size_t names_offset = sizeof(FileHeader) + header.mAssetCount * sizeof(FileEntry);
+		if (names_offset + header.mNamesSize > mFile.mSize || (header.mNamesSize > 0 && mFile.mpData[names_offset + header.mNamesSize - 1] != '\0'))
+			throw invalid();
+		const char * names = reinterpret_cast<const char *>(mFile.mpData + names_offset);
+
+		mvAssets.reserve(header.mAssetCount);
+		mvOffsets.reserve(header.mAssetCount);
+		for (std::uint32_t i = 0; i < header.mAssetCount; ++i)
+		{
+			FileEntry entry;
+			std::memcpy(&entry, mFile.mpData + sizeof(FileHeader) + i * sizeof(FileEntry), sizeof(entry));
+			if (entry.mNameOffset >= header.mNamesSize || entry.mOffset > mFile.mSize || entry.mStoredSize > mFile.mSize - entry.mOffset
+				|| entry.mCompression > static_cast<std::uint32_t>(Compression::LZ4))
+				throw invalid();
+			// getData returns the stored bytes of the uncompressed assets as they are
+			if (entry.mCompression == static_cast<std::uint32_t>(Compression::None) && entry.mSize != entry.mStoredSize)
+				throw invalid();
+
+			Asset asset;
+			asset.mName = names + entry.mNameOffset;
+			asset.mSize = static_cast<std::size_t>(entry.mSize);
+			asset.mStoredSize = static_cast<std::size_t>(entry.mStoredSize);
+			asset.mCompression = static_cast<Compression>(entry.mCompression);
+			asset.mWidth = entry.mWidth;
+			asset.mHeight = entry.mHeight;
+			mvAssets.push_back(asset);
+			mvOffsets.push_back(static_cast<std::size_t>(entry.mOffset));
+		}
+		mvDecompressed.resize(mvAssets.size());
+
+		mStats.mMappedBytes = mFile.mSize;
+		mStats.mOpenMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	const AssetPack::Asset * AssetPack::AssetPack_impl::Find(const char * name) const
+	{
+		const auto it = std::lower_bound(mvAssets.begin(), mvAssets.end(), name, [](const Asset & asset, const char * key)
+		{
+			return std::strcmp(asset.mName, key) < 0;
+		});
+		return it != mvAssets.end() && std::strcmp(it->mName, name) == 0 ? &*it : nullptr;
+	}
+
+	AssetPack::Span AssetPack::AssetPack_impl::getData(const Asset & asset)
+	{
+		const std::size_t index = static_cast<std::size_t>(&asset - mvAssets.data());
+		const unsigned char * stored = mFile.mpData + mvOffsets[index];
+		if (asset.mCompression == Compression::None)
+			return Span{ stored, asset.mSize };
+
+		std::vector<unsigned char> & data = mvDecompressed[index];
+		if (data.empty() && asset.mSize > 0)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			data.resize(asset.mSize);
+			if (!Lz4Decompress(stored, asset.mStoredSize, data.data(), data.size()))
+			{
+				data.clear();
+				throw std::runtime_error{ std::string{ "AssetPack: The compressed data is corrupted " } + asset.mName };
+			}
+			mStats.mDecompressedBytes += data.size();
+			mStats.mDecompressMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		return Span{ data.data(), data.size() };
+	}
+
+	GLuint AssetPack::AssetPack_impl::CreateTexture(const Asset & asset, const char * owner)
+	{
+		const GLsizei width = static_cast<GLsizei>(asset.mWidth);
+		const GLsizei height = static_cast<GLsizei>(asset.mHeight);
+		if (width == 0 || height == 0 || asset.mSize != static_cast<std::size_t>(width) * height * 4)
+			return 0;
+
+		// IMPORTANT(Borja): The driver reads the pixels straight from the mapping, the pages are loaded
+		// from disk as it touches them.
+		const Span pixels = getData(asset);
+		GLuint texture = my_gl_core::create_texture(gl::TEXTURE_2D, owner);
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, texture, my_gl_core::get_texture_size(gl::RGBA8, width, height));
+		if (my_gl_core::get_caps().direct_state_access)
+		{
+			using namespace my_gl_core;
+			ext::TextureParameteri(texture, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			ext::TextureParameteri(texture, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			ext::TextureStorage2D(texture, 1, gl::RGBA8, width, height);
+			ext::TextureSubImage2D(texture, 0, 0, 0, width, height, gl::RGBA, gl::UNSIGNED_BYTE, pixels.mpData);
+		}
+		else
+		{
+			gl::BindTexture(gl::TEXTURE_2D, texture);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			gl::TexImage2D(gl::TEXTURE_2D, 0, gl::RGBA8, width, height, 0, gl::RGBA, gl::UNSIGNED_BYTE, pixels.mpData);
+		}
+		CheckOGLError();
+		return texture;
+	}
+
+	AssetPack::AssetPack(const char * filename)
+		: mpImpl(std::make_unique<AssetPack_impl>(filename))
+	{}
+	AssetPack::~AssetPack() {}
+
+	const AssetPack::Asset * AssetPack::Find(const char * name) const
+	{
+		return mpImpl->Find(name);
+	}
+	const std::vector<AssetPack::Asset> & AssetPack::getAssets() const
+	{
+		return mpImpl->getAssets();
+	}
+	AssetPack::Span AssetPack::getData(const Asset & asset)
+	{
+		return mpImpl->getData(asset);
+	}
+	GLuint AssetPack::CreateTexture(const Asset & asset, const char * owner)
+	{
+		return mpImpl->CreateTexture(asset, owner);
+	}
+	const AssetPack::Stats & AssetPack::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+
+	void AssetPackBuilder::Add(const char * name, const void * data, std::size_t size, AssetPack::Compression compression,
+							   unsigned width, unsigned height)
+	{
+		Entry entry;
+		entry.mName = name;
+		entry.mSize = size;
+		entry.mCompression = AssetPack::Compression::None;
+		entry.mWidth = width;
+		entry.mHeight = height;
+
+		const unsigned char * bytes = static_cast<const unsigned char *>(data);
+		if (compression == AssetPack::Compression::LZ4)
+		{
+			Lz4Compress(bytes, size, entry.mvData);
+			if (entry.mvData.size() < size)
+				entry.mCompression = AssetPack::Compression::LZ4;
+		}
+		if (entry.mCompression == AssetPack::Compression::None)
+			entry.mvData.assign(bytes, bytes + size);
+
+		// adding a name twice replaces the asset
+		for (Entry & old_entry : mvEntries)
+		{
+			if (old_entry.mName == entry.mName)
+			{
+				old_entry = std::move(entry);
+				return;
+			}
+		}
+		mvEntries.push_back(std::move(entry));
+	}
+	void AssetPackBuilder::AddFile(const char * name, const char * filename, AssetPack::Compression compression,
+								   unsigned width, unsigned height)
+	{
+		std::ifstream file{ filename, std::ios::binary };
+		if (!file)
+			throw std::runtime_error{ std::string{ "AssetPackBuilder: Couldn't open the file " } + filename };
+
+		const std::vector<char> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		Add(name, data.data(), data.size(), compression, width, height);
+	}
+
+	std::size_t AssetPackBuilder::Write(const char * filename) const
+	{
+		// the index is sorted so that AssetPack can search it
+		std::vector<const Entry *> entries;
+		for (const Entry & entry : mvEntries)
+			entries.push_back(&entry);
+		std::sort(entries.begin(), entries.end(), [](const Entry * a, const Entry * b) { return a->mName < b->mName; });
+
+		FileHeader header;
+		std::memcpy(header.mMagic, s_Magic, sizeof(s_Magic));
+		header.mVersion = s_Version;
+		header.mAssetCount = static_cast<std::uint32_t>(entries.size());
+
+		std::string names;
+		std::vector<FileEntry> index;
+		for (const Entry * entry : entries)
+		{
+			FileEntry file_entry;
+			file_entry.mNameOffset = static_cast<std::uint32_t>(names.size());
+			file_entry.mStoredSize = entry->mvData.size();
+			file_entry.mSize = entry->mSize;
+			file_entry.mCompression = static_cast<std::uint32_t>(entry->mCompression);
+			file_entry.mWidth = entry->mWidth;
+			file_entry.mHeight = entry->mHeight;
+			index.push_back(file_entry);
+
+			names += entry->mName;
+			names += '\0';
+		}
+		header.mNamesSize = static_cast<std::uint32_t>(names.size());
+
+		std::size_t offset = AlignUp(sizeof(FileHeader) + index.size() * sizeof(FileEntry) + names.size());
+		for (FileEntry & file_entry : index)
+		{
+			file_entry.mOffset = offset;
+			offset = AlignUp(offset + static_cast<std::size_t>(file_entry.mStoredSize));
+		}
+
+		std::ofstream file{ filename, std::ios::binary };
+		if (!file)
+			throw std::runtime_error{ std::string{ "AssetPackBuilder: Couldn't create the file " } + filename };
+
+		const char padding[AssetPack::ALIGNMENT] = {};
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(FileEntry)));
+		file.write(names.data(), static_cast<std::streamsize>(names.size()));
+		std::size_t written = sizeof(FileHeader) + index.size() * sizeof(FileEntry) + names.size();
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			file.write(padding, static_cast<std::streamsize>(index[i].mOffset - written));
+			file.write(reinterpret_cast<const char *>(entries[i]->mvData.data()), static_cast<std::streamsize>(entries[i]->mvData.size()));
+			written = static_cast<std::size_t>(index[i].mOffset) + entries[i]->mvData.size();
+		}
+		file.write(padding, static_cast<std::streamsize>(offset - written));
+
+		if (!file)
+			throw std::runtime_error{ std::string{ "AssetPackBuilder: Couldn't write the file " } + filename };
+		return offset;
+	}
+}
@@ -0,0 +1,108 @@
+/*!
+\brief	Pack of assets read from a single memory mapped file, and the builder that writes it.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"	// GLuint
+
+#include <memory>		// std::unique_ptr
+#include <vector>		// std::vector
+#include <string>		// std::string
+#include <cstddef>		// std::size_t
+
+namespace app
+{
+	/// \brief	Layout of the file: a header, the index sorted by name, the names and the data of every
+	/// asset aligned to AssetPack::ALIGNMENT. Each asset can be stored with LZ4 (block format).
+	/// The file is mapped when the pack is opened, the data of the assets stored uncompressed is used
+	/// straight from the mapping (it is only read from disk when it is touched), the compressed ones
+	/// are decompressed the first time they are requested.
+	/// IMPORTANT(Borja): The data returned lives as long as the pack, and it is not thread safe.
+	class AssetPack
+	{
+	public:
+		static const std::size_t ALIGNMENT = 64;
+
+		enum class Compression : unsigned
+		{
+			None,
+			LZ4,
+		};
+
+		struct Asset
+		{
+			const char *	mName;
+			std::size_t		mSize;			// uncompressed
+			std::size_t		mStoredSize;	// in the file
+			Compression		mCompression;
+			unsigned		mWidth;			// of an RGBA8 image, 0 for other assets
+			unsigned		mHeight;
+		};
+
+		struct Span
+		{
+			const void *	mpData;
+			std::size_t		mSize;
+		};
+
+		struct Stats
+		{
+			double		mOpenMs{ 0.0 };				// mapping the file and reading the index
+			std::size_t	mMappedBytes{ 0 };
+			std::size_t	mDecompressedBytes{ 0 };	// memory owned by the pack
+			double		mDecompressMs{ 0.0 };
+		};
+
+		/// \brief	Throws std::runtime_error if the file can't be mapped or is not a valid pack.
+		explicit AssetPack(const char * filename);
+		~AssetPack();
+		AssetPack(const AssetPack &) = delete;
+		AssetPack & operator=(const AssetPack &) = delete;
+
+		/// \return	Null if the pack doesn't have the asset.
+		const Asset * Find(const char * name) const;
+		const std::vector<Asset> & getAssets() const;
+
+		/// \brief	Uncompressed data of the asset, pointing to the mapping when it is stored uncompressed.
+		/// Throws std::runtime_error if the compressed data is corrupted.
+		Span getData(const Asset & asset);
+		/// \brief	Creates an RGBA8 texture with the data of an image asset, uploaded from the mapping.
+		/// \return	0 if the asset is not an image. Delete it with my_gl_core::delete_texture.
+		GLuint CreateTexture(const Asset & asset, const char * owner);
+
+		const Stats & getStats() const;
+
+	private:
+		class AssetPack_impl;
+		std::unique_ptr<AssetPack_impl> mpImpl;
+	};
+
+	/// \brief	Writes the files read by AssetPack.
+	class AssetPackBuilder
+	{
+	public:
+		/// \brief	Copies the data. LZ4 is only used if it makes the asset smaller.
+		/// \param	width, height	Of an RGBA8 image, so that AssetPack::CreateTexture can upload it.
+		void Add(const char * name, const void * data, std::size_t size, AssetPack::Compression compression,
+				 unsigned width = 0, unsigned height = 0);
+		/// \brief	Throws std::runtime_error if the file can't be read.
+		void AddFile(const char * name, const char * filename, AssetPack::Compression compression,
+					 unsigned width = 0, unsigned height = 0);
+
+		/// \brief	Throws std::runtime_error if the file can't be written.
+		/// \return	Size of the pack.
+		std::size_t Write(const char * filename) const;
+
+	private:
+		struct Entry
+		{
+			std::string					mName;
+			std::vector<unsigned char>	mvData;		// as stored
+			std::size_t					mSize;
+			AssetPack::Compression		mCompression;
+			unsigned					mWidth, mHeight;
+		};
+		std::vector<Entry> mvEntries;
+	};
+}
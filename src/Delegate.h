@@ -0,0 +1,107 @@
+/*!
+\brief	Callable wrapper that stores the callable inline and never allocates.
+*/
+
+#pragma once
+
+#include <cstddef>		// std::size_t, std::nullptr_t, std::max_align_t
+#include <new>			// placement new
+#include <type_traits>	// std::aligned_storage, std::decay_t, std::enable_if_t
+#include <utility>		// std::forward
+
+namespace app
+{
+	template <typename Signature, std::size_t SIZE = 4 * sizeof(void *)>
+	class Delegate;
+
+	/// \brief	Like std::function but the callable has to fit in SIZE bytes, which is checked when
+	/// compiling, so creating, copying and calling a Delegate never touch the heap. The default size
+	/// holds a function pointer or a lambda capturing up to four pointers.
+	template <typename R, typename ... Args, std::size_t SIZE>
+	class Delegate<R(Args...), SIZE>
+	{
+	public:
+		Delegate() = default;
+		Delegate(std::nullptr_t) {}
+
+		template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value>>
+		Delegate(F && f)
+		{
+			using Fn = std::decay_t<F>;
+			static_assert(sizeof(Fn) <= SIZE, "The callable doesn't fit in the Delegate, capture less or increase its size");
+			static_assert(alignof(Fn) <= alignof(Storage), "The callable needs a bigger alignment than the Delegate has");
+			new (&mStorage) Fn(std::forward<F>(f));
+			mpInvoke = &Invoke<Fn>;
+			mpManage = &Manage<Fn>;
+		}
+
+		Delegate(const Delegate & other)
+		{
+			CopyFrom(other);
+		}
+		Delegate & operator=(const Delegate & other)
+		{
+			if (this != &other)
+			{
+				Reset();
+				CopyFrom(other);
+			}
+			return *this;
+		}
+		~Delegate()
+		{
+			Reset();
+		}
+
+		R operator()(Args ... args) const
+		{
+			return mpInvoke(&mStorage, std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const { return mpInvoke != nullptr; }
+
+	private:
+		using Storage = typename std::aligned_storage<SIZE, alignof(std::max_align_t)>::type;
+		enum class Operation
+		{
+			Copy,
+			Destroy,
+		};
+
+		template <typename Fn>
+		static R Invoke(void * storage, Args ... args)
+		{
+			return (*static_cast<Fn *>(storage))(std::forward<Args>(args)...);
+		}
+		/// \param	src	Only used to copy.
+		template <typename Fn>
+		static void Manage(Operation operation, void * dst, const void * src)
+		{
+			switch (operation)
+			{
+			case Operation::Copy:		new (dst) Fn(*static_cast<const Fn *>(src)); break;
+			case Operation::Destroy:	static_cast<Fn *>(dst)->~Fn(); break;
+			}
+		}
+
+		void CopyFrom(const Delegate & other)
+		{
+			if (other.mpManage)
+				other.mpManage(Operation::Copy, &mStorage, &other.mStorage);
+			mpInvoke = other.mpInvoke;
+			mpManage = other.mpManage;
+		}
+		void Reset()
+		{
+			if (mpManage)
+				mpManage(Operation::Destroy, &mStorage, nullptr);
+			mpInvoke = nullptr;
+			mpManage = nullptr;
+		}
+
+		// mutable like the callable of std::function, calling it can change its captures
+		mutable Storage mStorage;
+		R(*mpInvoke)(void *, Args ...){ nullptr };
+		void(*mpManage)(Operation, void *, const void *){ nullptr };
+	};
+}
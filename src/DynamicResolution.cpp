@@ -0,0 +1,222 @@
+/*!
+\brief	Offscreen target the scene is drawn to at a fraction of the window resolution,
+and the controller that picks the fraction from the measured frame times.
+*/
+
+#include "DynamicResolution.h"
+
+#include "my_gl_resources.h"	// my_gl_core::create_texture, my_gl_core::delete_texture...
+#include "Log.h"
+
+#include <algorithm>	// std::min, std::max
+#include <cmath>		// std::sqrt, std::abs
+
+namespace app
+{
+	namespace
+	{
+		const char * s_ResourceOwner = "DynamicResolution";
+
+		// weight of a new frame time in the smoothed ones
+		const double TIME_SMOOTHING = 0.1;
+		// frames for the smoothed times to reflect a new scale before changing it again
+		const unsigned SETTLE_FRAMES = 10;
+		// the scale goes down when the GPU time is over HIGH_WATERMARK of the budget, up when it is
+		// under LOW_WATERMARK, and aims for the middle so that it doesn't oscillate
+		const double HIGH_WATERMARK = 0.95;
+		const double LOW_WATERMARK = 0.75;
+		const double AIM = 0.85;
+		// growing is limited per change, the times over the budget are the ones that hurt
+		const float MAX_SCALE_STEP_UP = 0.05f;
+		const float MIN_SCALE_CHANGE = 0.01f;
+	}
+
+	DynamicResolution::DynamicResolution(int window_width, int window_height)
+		: mWindowWidth(window_width)
+		, mWindowHeight(window_height)
+	{
+		gl::GenQueries(QUERY_NUM * 2, &mQueries[0][0]);
+		mStats.mWidth = mWindowWidth;
+		mStats.mHeight = mWindowHeight;
+		CheckOGLError();
+	}
+	DynamicResolution::~DynamicResolution()
+	{
+		DeleteTarget();
+		gl::DeleteQueries(QUERY_NUM * 2, &mQueries[0][0]);
+	}
+
+	void DynamicResolution::setSettings(const ResolutionSettings & settings)
+	{
+		mSettings = settings;
+		mSettings.mMaxScale = std::min(std::max(mSettings.mMaxScale, 0.1f), 1.0f);
+		mSettings.mMinScale = std::min(std::max(mSettings.mMinScale, 0.1f), mSettings.mMaxScale);
+
+		// the target is reallocated the next frame if the maximum changed
+		if (!mSettings.mbEnabled)
+			DeleteTarget();
+		mStats.mScale = mSettings.mbEnabled ? std::min(std::max(mStats.mScale, mSettings.mMinScale), mSettings.mMaxScale) : 1.0f;
+		mFramesSinceChange = 0;
+	}
+
+	const ResolutionSettings & DynamicResolution::getSettings() const
+	{
+		return mSettings;
+	}
+
+	void DynamicResolution::BeginScene()
+	{
+		gl::QueryCounter(mQueries[mQueryIndex][0], gl::TIMESTAMP);
+		mbSceneBegun = true;
+
+		mStats.mWidth = std::max(1, static_cast<int>(mWindowWidth * mStats.mScale + 0.5f));
+		mStats.mHeight = std::max(1, static_cast<int>(mWindowHeight * mStats.mScale + 0.5f));
+		if (!mSettings.mbEnabled)
+			return;
+
+		const int width = static_cast<int>(mWindowWidth * mSettings.mMaxScale + 0.5f);
+		const int height = static_cast<int>(mWindowHeight * mSettings.mMaxScale + 0.5f);
+		if (mFramebuffer == 0 || width != mTargetWidth || height != mTargetHeight)
+		{
+			DeleteTarget();
+			mTargetWidth = width;
+			mTargetHeight = height;
+			CreateTarget();
+			if (!mSettings.mbEnabled)
+			{
+				DeleteTarget();
+				mStats.mWidth = mWindowWidth;
+				mStats.mHeight = mWindowHeight;
+				return;
+			}
+		}
+
+		gl::BindFramebuffer(gl::FRAMEBUFFER, mFramebuffer);
+		gl::Viewport(0, 0, mStats.mWidth, mStats.mHeight);
+		gl::Clear(gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT);
+		CheckOGLError();
+	}
+
+	void DynamicResolution::EndScene()
+	{
+		if (!mSettings.mbEnabled || mFramebuffer == 0)
+			return;
+
+		gl::BindFramebuffer(gl::READ_FRAMEBUFFER, mFramebuffer);
+		gl::BindFramebuffer(gl::DRAW_FRAMEBUFFER, 0);
+		gl::BlitFramebuffer(0, 0, mStats.mWidth, mStats.mHeight, 0, 0, mWindowWidth, mWindowHeight,
+							gl::COLOR_BUFFER_BIT, gl::LINEAR);
+		gl::BindFramebuffer(gl::FRAMEBUFFER, 0);
+		gl::Viewport(0, 0, mWindowWidth, mWindowHeight);
+		CheckOGLError();
+	}
+
+	void DynamicResolution::EndFrame(double cpu_ms)
+	{
+		mStats.mCpuMs = mStats.mCpuMs > 0.0 ? mStats.mCpuMs + (cpu_ms - mStats.mCpuMs) * TIME_SMOOTHING : cpu_ms;
+
+		if (mbSceneBegun)
+		{
+			gl::QueryCounter(mQueries[mQueryIndex][1], gl::TIMESTAMP);
+			mbQueryPending[mQueryIndex] = true;
+			mQueryIndex = (mQueryIndex + 1) % QUERY_NUM;
+			mbSceneBegun = false;
+		}
+
+		// the oldest query is the next one we are going to reuse
+		if (mbQueryPending[mQueryIndex])
+		{
+			GLuint64 available = 0;
+			gl::GetQueryObjectui64v(mQueries[mQueryIndex][1], gl::QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 begin_ns = 0, end_ns = 0;
+				gl::GetQueryObjectui64v(mQueries[mQueryIndex][0], gl::QUERY_RESULT, &begin_ns);
+				gl::GetQueryObjectui64v(mQueries[mQueryIndex][1], gl::QUERY_RESULT, &end_ns);
+				mbQueryPending[mQueryIndex] = false;
+
+				const double gpu_ms = static_cast<double>(end_ns - begin_ns) / 1000000.0;
+				mStats.mGpuMs = mStats.mGpuMs > 0.0 ? mStats.mGpuMs + (gpu_ms - mStats.mGpuMs) * TIME_SMOOTHING : gpu_ms;
+				UpdateScale();
+			}
+		}
+		CheckOGLError();
+	}
+
+	const ResolutionStats & DynamicResolution::getStats() const
+	{
+		return mStats;
+	}
+
+	void DynamicResolution::UpdateScale()
+	{
+		if (!mSettings.mbEnabled || mStats.mGpuMs <= 0.0 || ++mFramesSinceChange < SETTLE_FRAMES)
+			return;
+
+		const double budget = mSettings.mTargetMs;
+		// the area (scale squared) that would take AIM of the budget
+		const float fit = mStats.mScale * static_cast<float>(std::sqrt(budget * AIM / mStats.mGpuMs));
+		float scale = mStats.mScale;
+		if (mStats.mGpuMs > budget * HIGH_WATERMARK && mStats.mCpuMs < budget * HIGH_WATERMARK)
+			scale = fit;
+		else if (mStats.mGpuMs < budget * LOW_WATERMARK)
+			scale = std::min(fit, mStats.mScale + MAX_SCALE_STEP_UP);
+		scale = std::min(std::max(scale, mSettings.mMinScale), mSettings.mMaxScale);
+
+		if (std::abs(scale - mStats.mScale) < MIN_SCALE_CHANGE)
+			return;
+		APP_LOG_DEBUG(log::Category::GL, "Resolution scale {} -> {} (GPU {} ms, CPU {} ms)", mStats.mScale, scale, mStats.mGpuMs, mStats.mCpuMs);
+		mStats.mScale = scale;
+		++mStats.mChanges;
+		mFramesSinceChange = 0;
+	}
+
+	void DynamicResolution::CreateTarget()
+	{
+		// IMPORTANT(Borja): Only the scene uses the depth, the UI is drawn after the upscale.
+		mColor = my_gl_core::create_texture(gl::TEXTURE_2D, s_ResourceOwner);
+		mDepth = my_gl_core::create_texture(gl::TEXTURE_2D, s_ResourceOwner);
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, mColor, my_gl_core::get_texture_size(gl::RGBA8, mTargetWidth, mTargetHeight));
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, mDepth, my_gl_core::get_texture_size(gl::DEPTH24_STENCIL8, mTargetWidth, mTargetHeight));
+		if (my_gl_core::get_caps().direct_state_access)
+		{
+			using namespace my_gl_core;
+			ext::TextureStorage2D(mColor, 1, gl::RGBA8, mTargetWidth, mTargetHeight);
+			ext::TextureStorage2D(mDepth, 1, gl::DEPTH24_STENCIL8, mTargetWidth, mTargetHeight);
+		}
+		else
+		{
+			GLint last_texture;
+			gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+			gl::BindTexture(gl::TEXTURE_2D, mColor);
+			gl::TexStorage2D(gl::TEXTURE_2D, 1, gl::RGBA8, mTargetWidth, mTargetHeight);
+			gl::BindTexture(gl::TEXTURE_2D, mDepth);
+			gl::TexStorage2D(gl::TEXTURE_2D, 1, gl::DEPTH24_STENCIL8, mTargetWidth, mTargetHeight);
+			gl::BindTexture(gl::TEXTURE_2D, last_texture);
+		}
+
+		gl::GenFramebuffers(1, &mFramebuffer);
+		gl::BindFramebuffer(gl::FRAMEBUFFER, mFramebuffer);
+		gl::FramebufferTexture2D(gl::FRAMEBUFFER, gl::COLOR_ATTACHMENT0, gl::TEXTURE_2D, mColor, 0);
+		gl::FramebufferTexture2D(gl::FRAMEBUFFER, gl::DEPTH_STENCIL_ATTACHMENT, gl::TEXTURE_2D, mDepth, 0);
+		if (gl::CheckFramebufferStatus(gl::FRAMEBUFFER) != gl::FRAMEBUFFER_COMPLETE)
+		{
+			APP_LOG_ERROR(log::Category::GL, "The dynamic resolution target is incomplete, it is disabled");
+			mSettings.mbEnabled = false;
+			mStats.mScale = 1.0f;
+		}
+		gl::BindFramebuffer(gl::FRAMEBUFFER, 0);
+		CheckOGLError();
+	}
+
+	void DynamicResolution::DeleteTarget()
+	{
+		if (mFramebuffer)
+		{
+			gl::DeleteFramebuffers(1, &mFramebuffer);
+			mFramebuffer = 0;
+		}
+		my_gl_core::delete_texture(mColor);
+		my_gl_core::delete_texture(mDepth);
+	}
+}
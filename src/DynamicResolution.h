@@ -0,0 +1,81 @@
+/*!
+\brief	Offscreen target the scene is drawn to at a fraction of the window resolution,
+and the controller that picks the fraction from the measured frame times.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"	// GLuint
+
+namespace app
+{
+	struct ResolutionSettings
+	{
+		bool	mbEnabled{ false };
+		double	mTargetMs{ 1000.0 / 60.0 };	// frame budget
+		float	mMinScale{ 0.5f };				// of the window width and height
+		float	mMaxScale{ 1.0f };
+	};
+
+	struct ResolutionStats
+	{
+		float				mScale{ 1.0f };		// active scale, 1 when disabled
+		int					mWidth{ 0 };		// of the scene
+		int					mHeight{ 0 };
+		double				mCpuMs{ 0.0 };		// smoothed, from the beginning of the frame to the swap
+		double				mGpuMs{ 0.0 };		// smoothed, from Window::BeginScene to the swap
+		unsigned long long	mChanges{ 0 };		// times the scale has changed
+	};
+
+	/// \brief	Used by app::Window. The target is allocated at the maximum scale and the scene is
+	/// drawn to the lower left corner at the active scale, then blitted with linear filtering to the
+	/// window, so changing the scale doesn't reallocate anything.
+	/// The cost of the scene is assumed to grow with its pixels: when the GPU time goes over the
+	/// budget the area is reduced to fit in it, when there is headroom it grows back slowly.
+	/// If the CPU time is over the budget the scale isn't reduced, it wouldn't help.
+	class DynamicResolution
+	{
+	public:
+		DynamicResolution(int window_width, int window_height);
+		~DynamicResolution();
+		DynamicResolution(const DynamicResolution &) = delete;
+		DynamicResolution & operator=(const DynamicResolution &) = delete;
+
+		void setSettings(const ResolutionSettings & settings);
+		const ResolutionSettings & getSettings() const;
+
+		/// \brief	Binds the target (cleared) and sets the viewport to the scene size.
+		/// When disabled the scene is drawn straight to the window.
+		void BeginScene();
+		/// \brief	Upscales the scene to the window and binds the default framebuffer.
+		void EndScene();
+		/// \brief	Reads the GPU times that are ready and updates the scale for the next frame.
+		/// \param	cpu_ms	Time the CPU spent in the frame.
+		void EndFrame(double cpu_ms);
+
+		const ResolutionStats & getStats() const;
+
+	private:
+		void CreateTarget();
+		void DeleteTarget();
+		void UpdateScale();
+
+		static const unsigned QUERY_NUM = 4;	// frames in flight
+		GLuint		mQueries[QUERY_NUM][2]{};	// timestamps at BeginScene and EndFrame
+		bool		mbQueryPending[QUERY_NUM]{};
+		unsigned	mQueryIndex{ 0 };
+		bool		mbSceneBegun{ false };
+
+		int			mWindowWidth;
+		int			mWindowHeight;
+		GLuint		mFramebuffer{ 0 };
+		GLuint		mColor{ 0 };
+		GLuint		mDepth{ 0 };
+		int			mTargetWidth{ 0 };
+		int			mTargetHeight{ 0 };
+		unsigned	mFramesSinceChange{ 0 };
+
+		ResolutionSettings	mSettings;
+		ResolutionStats		mStats;
+	};
+}
@@ -0,0 +1,359 @@
+/*!
+\brief	Gamepad state: hot-plugged slots, buttons updated once per frame and filtered axes with their history.
+*/
+
+#include "Gamepads.h"
+
+#include <algorithm>	// std::min, std::max
+#include <array>		// std::array
+#include <cmath>		// std::sqrt
+
+namespace app
+{
+	namespace
+	{
+		const float AXIS_RANGE = 32767.f;	// SDL axes go from -32768 to 32767, triggers from 0
+
+		// the history cursors keep the connection they were read from in the high bits
+		const unsigned CURSOR_CONNECTION_SHIFT = 48;
+		const unsigned long long CURSOR_SAMPLE_MASK = (1ull << CURSOR_CONNECTION_SHIFT) - 1;
+
+		float Normalize(int value)
+		{
+			return std::max(-1.f, std::min(static_cast<float>(value) / AXIS_RANGE, 1.f));
+		}
+
+		/// \brief	Radial deadzone, the direction of the stick is kept and its length rescaled.
+		void FilterStick(int raw_x, int raw_y, float deadzone, float & x, float & y)
+		{
+			x = Normalize(raw_x);
+			y = Normalize(raw_y);
+			const float length = std::sqrt(x * x + y * y);
+			const float scale = length > deadzone ? (std::min(length, 1.f) - deadzone) / ((1.f - deadzone) * length) : 0.f;
+			x *= scale;
+			y *= scale;
+		}
+
+		float FilterTrigger(int raw, float deadzone)
+		{
+			const float value = Normalize(raw);
+			return value > deadzone ? (value - deadzone) / (1.f - deadzone) : 0.f;
+		}
+	}
+
+	class Gamepads::Gamepads_impl
+	{
+	public:
+		int Connect(int id, const char * name);
+		int Disconnect(int id);
+		int FindGamepad(int id) const;
+		bool isConnected(unsigned pad) const { return pad < MAX_GAMEPADS && mvPads[pad].mbConnected; }
+		const std::string & getName(unsigned pad) const { return mvPads[pad].mName; }
+
+		unsigned getTriggered(unsigned pad) const { return pad < MAX_GAMEPADS ? mvPads[pad].mTriggered : 0; }
+		unsigned getPressed(unsigned pad) const { return pad < MAX_GAMEPADS ? mvPads[pad].mPressed : 0; }
+		unsigned getReleased(unsigned pad) const { return pad < MAX_GAMEPADS ? mvPads[pad].mReleased : 0; }
+		float getAxis(unsigned pad, unsigned axis) const { return pad < MAX_GAMEPADS && axis < AXIS_COUNT ? mvPads[pad].mvAxes[axis] : 0.f; }
+		std::size_t ReadAxisHistory(unsigned pad, unsigned axis, unsigned long long & cursor, AxisSample * samples, std::size_t max) const;
+
+		void setSettings(const Settings & settings) { mSettings = settings; }
+		const Settings & getSettings() const { return mSettings; }
+
+		void ProcessButton(int id, unsigned button, bool down);
+		void ProcessAxis(int id, unsigned axis, int value, unsigned timestamp);
+		void ReleaseAll(unsigned timestamp);
+		void Update();
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		/// \brief	Ring of the last HISTORY_SIZE samples, mWritten counts all of them.
+		struct History
+		{
+			std::array<AxisSample, HISTORY_SIZE>	mvSamples;
+			unsigned long long						mWritten{ 0 };
+		};
+
+		/// \brief	The button masks have a bit per Buttons value.
+		struct Pad
+		{
+			bool		mbConnected{ false };
+			int			mId{ -1 };
+			unsigned	mConnection{ 0 };	// of the slot, increased every time a gamepad takes it
+			std::string	mName;
+			unsigned	mDown{ 0 };			// as of the last event
+			unsigned	mPendingDown{ 0 };	// edges since the last Update
+			unsigned	mPendingUp{ 0 };
+			unsigned	mPressed{ 0 };		// of the current frame
+			unsigned	mTriggered{ 0 };
+			unsigned	mReleased{ 0 };
+			std::array<int, AXIS_COUNT>		mvRaw{};
+			std::array<float, AXIS_COUNT>	mvAxes{};
+			std::array<History, AXIS_COUNT>	mvHistory;
+		};
+
+		void SetAxis(Pad & pad, unsigned axis, float value, unsigned timestamp);
+		void Release(unsigned pad);
+
+		std::array<Pad, MAX_GAMEPADS> mvPads;
+		unsigned mDirty{ 0 };	// gamepads with button edges since the last Update
+		unsigned mEdges{ 0 };	// gamepads with edges this frame, to clear them the next one
+		unsigned mEvents{ 0 };
+		Settings mSettings;
+		Stats mStats;
+	};
+
+	int Gamepads::Gamepads_impl::Connect(int id, const char * name)
+	{
+		const int found = FindGamepad(id);
+		if (found >= 0)
+			return found;
+
+		for (unsigned pad = 0; pad < MAX_GAMEPADS; ++pad)
+		{
+			if (mvPads[pad].mbConnected)
+				continue;
+			const unsigned connection = mvPads[pad].mConnection + 1;
+			mvPads[pad] = Pad();
+			mvPads[pad].mConnection = connection;
+			mvPads[pad].mbConnected = true;
+			mvPads[pad].mId = id;
+			mvPads[pad].mName = name ? name : "";
+			++mStats.mConnected;
+			return static_cast<int>(pad);
+		}
+		return -1;
+	}
+
+	int Gamepads::Gamepads_impl::Disconnect(int id)
+	{
+		const int pad = FindGamepad(id);
+		if (pad < 0)
+			return -1;
+
+		Release(static_cast<unsigned>(pad));
+		mvPads[pad].mbConnected = false;
+		mvPads[pad].mId = -1;
+		mvPads[pad].mvRaw.fill(0);
+		mvPads[pad].mvAxes.fill(0.f);
+		--mStats.mConnected;
+		return pad;
+	}
+
+	int Gamepads::Gamepads_impl::FindGamepad(int id) const
+	{
+		for (unsigned pad = 0; pad < MAX_GAMEPADS; ++pad)
+		{
+			if (mvPads[pad].mbConnected && mvPads[pad].mId == id)
+				return static_cast<int>(pad);
+		}
+		return -1;
+	}
+
+	std::size_t Gamepads::Gamepads_impl::ReadAxisHistory(unsigned pad, unsigned axis, unsigned long long & cursor, AxisSample * samples, std::size_t max) const
+	{
+		if (!isConnected(pad) || axis >= AXIS_COUNT)
+			return 0;
+
+		// a cursor of another connection starts from the first sample of this one
+		const unsigned long long connection = static_cast<unsigned long long>(mvPads[pad].mConnection) << CURSOR_CONNECTION_SHIFT;
+		unsigned long long next = (cursor & ~CURSOR_SAMPLE_MASK) == connection ? cursor & CURSOR_SAMPLE_MASK : 0;
+
+		const History & history = mvPads[pad].mvHistory[axis];
+		const unsigned long long oldest = history.mWritten > HISTORY_SIZE ? history.mWritten - HISTORY_SIZE : 0;
+		next = std::max(std::min(next, history.mWritten), oldest);
+
+		std::size_t count = 0;
+		for (; next < history.mWritten && count < max; ++next, ++count)
+			samples[count] = history.mvSamples[static_cast<std::size_t>(next % HISTORY_SIZE)];
+		cursor = connection | next;
+		return count;
+	}
+
+	void Gamepads::Gamepads_impl::ProcessButton(int id, unsigned button, bool down)
+	{
+		const int pad = FindGamepad(id);
+		if (pad < 0 || button >= BUTTON_COUNT)
+			return;
+
+		Pad & state = mvPads[pad];
+		const unsigned bit = 1u << button;
+		if (down == ((state.mDown & bit) != 0))
+			return;
+
+		state.mDown ^= bit;
+		(down ? state.mPendingDown : state.mPendingUp) |= bit;
+		mDirty |= 1u << pad;
+		++mEvents;
+	}
+
+	void Gamepads::Gamepads_impl::ProcessAxis(int id, unsigned axis, int value, unsigned timestamp)
+	{
+		const int pad = FindGamepad(id);
+		if (pad < 0 || axis >= AXIS_COUNT)
+			return;
+
+		Pad & state = mvPads[pad];
+		state.mvRaw[axis] = value;
+		++mEvents;
+
+		if (axis >= AXIS_TRIGGER_LEFT)
+		{
+			SetAxis(state, axis, FilterTrigger(value, mSettings.mTriggerDeadzone), timestamp);
+			return;
+		}
+
+		// the deadzone of a stick depends on both of its axes, the other one can change too
+		const unsigned axis_x = axis & ~1u;
+		float x, y;
+		FilterStick(state.mvRaw[axis_x], state.mvRaw[axis_x + 1], mSettings.mStickDeadzone, x, y);
+		SetAxis(state, axis_x, x, timestamp);
+		SetAxis(state, axis_x + 1, y, timestamp);
+	}
+
+	void Gamepads::Gamepads_impl::SetAxis(Pad & pad, unsigned axis, float value, unsigned timestamp)
+	{
+		if (pad.mvAxes[axis] == value && pad.mvHistory[axis].mWritten != 0)
+			return;
+
+		pad.mvAxes[axis] = value;
+		History & history = pad.mvHistory[axis];
+		history.mvSamples[static_cast<std::size_t>(history.mWritten % HISTORY_SIZE)] = { value, timestamp };
+		++history.mWritten;
+	}
+
+	void Gamepads::Gamepads_impl::Release(unsigned pad)
+	{
+		Pad & state = mvPads[pad];
+		if (state.mDown != 0)
+		{
+			state.mPendingUp |= state.mDown;
+			state.mDown = 0;
+			mDirty |= 1u << pad;
+		}
+	}
+
+	void Gamepads::Gamepads_impl::ReleaseAll(unsigned timestamp)
+	{
+		for (unsigned pad = 0; pad < MAX_GAMEPADS; ++pad)
+		{
+			Pad & state = mvPads[pad];
+			if (!state.mbConnected)
+				continue;
+
+			Release(pad);
+			state.mvRaw.fill(0);
+			for (unsigned axis = 0; axis < AXIS_COUNT; ++axis)
+				SetAxis(state, axis, 0.f, timestamp);
+		}
+	}
+
+	void Gamepads::Gamepads_impl::Update()
+	{
+		// only the gamepads with edges from the last frame or events since then change
+		const unsigned visit = mDirty | mEdges;
+		mDirty = 0;
+		mEdges = 0;
+		mStats.mUpdated = 0;
+
+		for (unsigned pad = 0; pad < MAX_GAMEPADS; ++pad)
+		{
+			if ((visit & (1u << pad)) == 0)
+				continue;
+
+			Pad & state = mvPads[pad];
+			state.mTriggered = state.mPendingDown;
+			state.mReleased = state.mPendingUp;
+			// a press released within the frame still counts as pressed for it
+			state.mPressed = state.mDown | state.mPendingDown;
+			state.mPendingDown = 0;
+			state.mPendingUp = 0;
+
+			if ((state.mTriggered | state.mReleased) != 0)
+				mEdges |= 1u << pad;
+			++mStats.mUpdated;
+		}
+
+		mStats.mEvents = mEvents;
+		mEvents = 0;
+	}
+
+	Gamepads::Gamepads()
+		: mpImpl(std::make_unique<Gamepads_impl>())
+	{}
+	Gamepads::~Gamepads()
+	{}
+
+	int Gamepads::Connect(int id, const char * name)
+	{
+		return mpImpl->Connect(id, name);
+	}
+	int Gamepads::Disconnect(int id)
+	{
+		return mpImpl->Disconnect(id);
+	}
+	int Gamepads::FindGamepad(int id) const
+	{
+		return mpImpl->FindGamepad(id);
+	}
+	bool Gamepads::isConnected(unsigned pad) const
+	{
+		return mpImpl->isConnected(pad);
+	}
+	const std::string & Gamepads::getName(unsigned pad) const
+	{
+		return mpImpl->getName(pad);
+	}
+
+	bool Gamepads::ButtonTriggered(unsigned pad, unsigned button) const
+	{
+		return button < BUTTON_COUNT && (mpImpl->getTriggered(pad) & (1u << button)) != 0;
+	}
+	bool Gamepads::ButtonPressed(unsigned pad, unsigned button) const
+	{
+		return button < BUTTON_COUNT && (mpImpl->getPressed(pad) & (1u << button)) != 0;
+	}
+	bool Gamepads::ButtonReleased(unsigned pad, unsigned button) const
+	{
+		return button < BUTTON_COUNT && (mpImpl->getReleased(pad) & (1u << button)) != 0;
+	}
+	float Gamepads::getAxis(unsigned pad, unsigned axis) const
+	{
+		return mpImpl->getAxis(pad, axis);
+	}
+	std::size_t Gamepads::ReadAxisHistory(unsigned pad, unsigned axis, unsigned long long & cursor, AxisSample * samples, std::size_t max) const
+	{
+		return mpImpl->ReadAxisHistory(pad, axis, cursor, samples, max);
+	}
+
+	void Gamepads::setSettings(const Settings & settings)
+	{
+		mpImpl->setSettings(settings);
+	}
+	const Gamepads::Settings & Gamepads::getSettings() const
+	{
+		return mpImpl->getSettings();
+	}
+
+	void Gamepads::ProcessButton(int id, unsigned button, bool down)
+	{
+		mpImpl->ProcessButton(id, button, down);
+	}
+	void Gamepads::ProcessAxis(int id, unsigned axis, int value, unsigned timestamp)
+	{
+		mpImpl->ProcessAxis(id, axis, value, timestamp);
+	}
+	void Gamepads::ReleaseAll(unsigned timestamp)
+	{
+		mpImpl->ReleaseAll(timestamp);
+	}
+	void Gamepads::Update()
+	{
+		mpImpl->Update();
+	}
+
+	const Gamepads::Stats & Gamepads::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
@@ -0,0 +1,131 @@
+/*!
+\brief	Gamepad state: hot-plugged slots, buttons updated once per frame and filtered axes with their history.
+*/
+
+#pragma once
+
+#include <string>		// std::string
+#include <memory>		// std::unique_ptr
+#include <cstddef>		// std::size_t
+
+namespace app
+{
+	/// \brief	Up to MAX_GAMEPADS gamepads, a connected gamepad takes the first free slot and keeps it until
+	/// it is disconnected. The buttons of a gamepad are packed in a mask, so an Update only visits the
+	/// gamepads that had button events (idle gamepads don't add to the cost of a frame).
+	/// Every axis event is kept in order with its timestamp, so the consumers that read the history
+	/// (i.e. the steps of the simulation) see every value the axis went through, not only the last one.
+	/// IMPORTANT(Borja): SDL reads the controllers in SDL_PumpEvents and stamps the events with the time
+	/// of the pump, so the samples of a frame share its timestamp: the history keeps their order, not
+	/// when they happened within the frame.
+	/// Owned by app::Input, which feeds it the SDL game controller events.
+	class Gamepads
+	{
+	public:
+		static const unsigned MAX_GAMEPADS = 4;
+		/// \brief	Samples kept per axis.
+		static const unsigned HISTORY_SIZE = 64;
+
+		/// \brief	Same values as SDL_GameControllerButton.
+		enum Buttons
+		{
+			BUTTON_A,
+			BUTTON_B,
+			BUTTON_X,
+			BUTTON_Y,
+			BUTTON_BACK,
+			BUTTON_GUIDE,
+			BUTTON_START,
+			BUTTON_LEFT_STICK,
+			BUTTON_RIGHT_STICK,
+			BUTTON_LEFT_SHOULDER,
+			BUTTON_RIGHT_SHOULDER,
+			BUTTON_DPAD_UP,
+			BUTTON_DPAD_DOWN,
+			BUTTON_DPAD_LEFT,
+			BUTTON_DPAD_RIGHT,
+			BUTTON_COUNT
+		};
+
+		/// \brief	Same values as SDL_GameControllerAxis.
+		enum Axes
+		{
+			AXIS_LEFT_X,
+			AXIS_LEFT_Y,
+			AXIS_RIGHT_X,
+			AXIS_RIGHT_Y,
+			AXIS_TRIGGER_LEFT,
+			AXIS_TRIGGER_RIGHT,
+			AXIS_COUNT
+		};
+
+		struct AxisSample
+		{
+			float		mValue;
+			unsigned	mTimestamp;	// milliseconds, of the SDL event (the time of the pump that read it)
+		};
+
+		/// \brief	Fraction of the range ignored around the rest position, the rest of the range is
+		/// scaled so the values still go from 0 to 1. The sticks use a radial deadzone.
+		struct Settings
+		{
+			float mStickDeadzone{ 0.24f };
+			float mTriggerDeadzone{ 0.12f };
+		};
+
+		struct Stats
+		{
+			unsigned	mConnected{ 0 };
+			unsigned	mEvents{ 0 };	// of the last frame
+			unsigned	mUpdated{ 0 };	// gamepads visited by the last Update
+		};
+
+		Gamepads();
+		~Gamepads();
+		Gamepads(const Gamepads &) = delete;
+		Gamepads & operator=(const Gamepads &) = delete;
+
+		/// \param	id	Identifies the device in the events (the SDL joystick instance id).
+		/// \return	The slot of the gamepad, -1 if all of them are in use.
+		int Connect(int id, const char * name);
+		/// \brief	The buttons it had pressed are released the next frame.
+		/// \return	The slot it had, -1 if it wasn't connected.
+		int Disconnect(int id);
+		/// \return	The slot of the gamepad, -1 if it isn't connected.
+		int FindGamepad(int id) const;
+		bool isConnected(unsigned pad) const;
+		const std::string & getName(unsigned pad) const;
+
+		/// \return	True the first frame the button is pressed.
+		bool ButtonTriggered(unsigned pad, unsigned button) const;
+		/// \return	True while the button is pressed (and the frame of a press released within it).
+		bool ButtonPressed(unsigned pad, unsigned button) const;
+		/// \return	True the frame the button is released.
+		bool ButtonReleased(unsigned pad, unsigned button) const;
+		/// \return	The last value of the axis, in [-1, 1] for the sticks (Y grows down) and [0, 1] for the triggers.
+		float getAxis(unsigned pad, unsigned axis) const;
+		/// \brief	Copies the samples of the axis that came after the cursor, oldest first, and moves the cursor
+		/// past them. A new consumer starts with the cursor at 0, the samples older than HISTORY_SIZE are lost.
+		/// The cursor belongs to a connection of the gamepad, after a reconnection it starts again from the
+		/// first sample of the new gamepad.
+		/// \return	Number of samples copied.
+		std::size_t ReadAxisHistory(unsigned pad, unsigned axis, unsigned long long & cursor, AxisSample * samples, std::size_t max) const;
+
+		void setSettings(const Settings & settings);
+		const Settings & getSettings() const;
+
+		/// \brief	Events as app::Input receives them.
+		void ProcessButton(int id, unsigned button, bool down);
+		void ProcessAxis(int id, unsigned axis, int value, unsigned timestamp);
+		/// \brief	Releases the buttons and centers the axes, i.e. when the window loses the focus.
+		void ReleaseAll(unsigned timestamp);
+		/// \brief	Updates the state of the buttons of the gamepads that changed since the last call.
+		void Update();
+
+		const Stats & getStats() const;
+
+	private:
+		class Gamepads_impl;
+		std::unique_ptr<Gamepads_impl> mpImpl;
+	};
+}
@@ -0,0 +1,730 @@
+/*!
+\brief	Signed distance field glyph cache to render text at any scale from a single bake.
+*/
+
+#include "GlyphCache.h"
+
+#include "TextureAtlas.h"	// app::TextureAtlas
+#include "Window.h"
+#include "VectorMath.h"	// app::Mat4
+#include "GUI.h"		// namespace ImGui, ImDrawList
+#include "imgui\imgui_internal.h"	// ImTextCharFromUtf8
+
+#include "my_gl_core.h"
+#include "my_gl_stream_buffer.h"	// my_gl_core::StreamBuffer
+#include "my_gl_resources.h"	// my_gl_core::create_program, my_gl_core::delete_program...
+
+// IMPORTANT(Borja): imgui_draw.cpp compiles its own static copy for the font baker.
+#ifdef _MSC_VER
+#pragma warning (disable: 4505) // unreferenced local function has been removed (stb stuff)
+#pragma warning (push)
+#pragma warning (disable: 4456) // declaration of 'xx' hides previous local declaration
+#endif
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imgui\stb_truetype.h"
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
+
+#include <vector>			// std::vector
+#include <deque>			// std::deque
+#include <unordered_map>	// std::unordered_map
+#include <algorithm>		// std::min, std::max
+#include <chrono>			// std::chrono::high_resolution_clock
+#include <cmath>			// std::sqrt
+#include <cstddef>			// offsetof
+#include <cstdint>			// std::uint64_t
+#include <cstring>			// std::strlen, std::memcpy
+#include <string>			// std::string
+#include <fstream>			// std::ifstream
+#include <iterator>			// std::istreambuf_iterator
+#include <stdexcept>		// std::runtime_error
+
+namespace app
+{
+	namespace
+	{
+		/// \brief	Scratch buffers of the distance transform, kept between glyphs.
+		struct DistanceScratch
+		{
+			std::vector<float>	mvF, mvD, mvZ;
+			std::vector<int>	mvV;
+		};
+
+		/// \brief	1D squared Euclidean distance transform (Felzenszwalb & Huttenlocher).
+		void DistanceTransform1D(DistanceScratch & s, int n)
+		{
+			const float inf = 1e20f;
+			int k = 0;
+			s.mvV[0] = 0;
+			s.mvZ[0] = -inf;
+			s.mvZ[1] = inf;
+			for (int q = 1; q < n; ++q)
+			{
+				float p = (s.mvF[q] + q * q - (s.mvF[s.mvV[k]] + s.mvV[k] * s.mvV[k])) / (2.f * q - 2.f * s.mvV[k]);
+				while (p <= s.mvZ[k])
+				{
+					--k;
+					p = (s.mvF[q] + q * q - (s.mvF[s.mvV[k]] + s.mvV[k] * s.mvV[k])) / (2.f * q - 2.f * s.mvV[k]);
+				}
+				++k;
+				s.mvV[k] = q;
+				s.mvZ[k] = p;
+				s.mvZ[k + 1] = inf;
+			}
+
+			k = 0;
+			for (int q = 0; q < n; ++q)
+			{
+				while (s.mvZ[k + 1] < q)
+					++k;
+				const float d = static_cast<float>(q - s.mvV[k]);
+				s.mvD[q] = d * d + s.mvF[s.mvV[k]];
+			}
+		}
+
+		/// \brief	In place 2D squared distance to the closest cell that is 0.
+		void DistanceTransform2D(DistanceScratch & s, std::vector<float> & grid, int w, int h)
+		{
+			const std::size_t n = static_cast<std::size_t>(std::max(w, h));
+			s.mvF.resize(n);
+			s.mvD.resize(n);
+			s.mvV.resize(n);
+			s.mvZ.resize(n + 1);
+
+			for (int x = 0; x < w; ++x)
+			{
+				for (int y = 0; y < h; ++y)	s.mvF[y] = grid[y * w + x];
+				DistanceTransform1D(s, h);
+				for (int y = 0; y < h; ++y)	grid[y * w + x] = s.mvD[y];
+			}
+			for (int y = 0; y < h; ++y)
+			{
+				for (int x = 0; x < w; ++x)	s.mvF[x] = grid[y * w + x];
+				DistanceTransform1D(s, w);
+				for (int x = 0; x < w; ++x)	grid[y * w + x] = s.mvD[x];
+			}
+		}
+	}
+
+	class GlyphCache::GlyphCache_impl
+	{
+	public:
+		GlyphCache_impl(float bake_size, int spread, int page_size, unsigned max_pages);
+		~GlyphCache_impl();
+
+		FontId AddFontFromMemory(const void * data, std::size_t size, bool copy);
+
+		const Glyph * getGlyph(FontId font, unsigned codepoint);
+		float getLineHeight(FontId font, float size) const;
+		float getTextWidth(FontId font, float size, const char * text, const char * text_end);
+
+		void AddText(FontId font, float x, float y, float size, unsigned color, const char * text, const char * text_end);
+		void Render();
+		void AddImGuiText(ImDrawList * draw_list, FontId font, float x, float y, float size, unsigned color,
+						  const char * text, const char * text_end);
+
+		void NewFrame(Window & window);
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		struct Font
+		{
+			std::vector<unsigned char>	mvData;		// empty if the font data was not copied
+			stbtt_fontinfo				mInfo;
+			float						mScale;		// font units to bake pixels
+			float						mAscent, mLineHeight;	// in ems of the bake size
+		};
+
+		/// \brief	The texture and coordinates of mGlyph are looked up in the atlas every time
+		/// the glyph is used, they change when the atlas is defragmented.
+		struct CachedGlyph
+		{
+			Glyph					mGlyph;
+			TextureAtlas::Handle	mHandle;	// INVALID_HANDLE if the glyph has nothing to draw
+		};
+
+		/// \brief	Per-instance data as the vertex shader reads it.
+		struct Instance
+		{
+			float			mRect[4];	// x0, y0, x1, y1 in pixels
+			unsigned short	mUV[4];		// normalized u0, v0, u1, v1
+			unsigned		mColor;
+		};
+
+		/// \brief	Text of a draw list, the callback data points to it.
+		struct ImGuiBatch
+		{
+			GlyphCache_impl *	mpCache;
+			std::size_t			mFirst;
+			std::size_t			mCount;
+		};
+
+		void CreateDeviceObjects();
+		const Glyph * Rasterize(FontId font, unsigned codepoint, std::uint64_t key);
+		/// \return	False if the atlas evicted the glyph.
+		bool LookupGlyph(CachedGlyph & cached);
+		void UpdateAtlasStats();
+
+		void LayoutText(FontId font, float x, float y, float size, unsigned color, const char * text, const char * text_end,
+						std::vector<Instance> & instances, std::vector<GLuint> & textures);
+		/// \brief	Draws the quads with the SDF program, only changes the state it needs.
+		void DrawQuads(const Instance * instances, const GLuint * textures, std::size_t count, float width, float height);
+		void BindStreamBuffer(const my_gl_core::StreamBuffer::Range & range);
+
+		static void ImGuiCallback(const ImDrawList * parent_list, const ImDrawCmd * cmd);
+
+		const float		mBakeSize;
+		const int		mSpread;
+		bool			mbUseDSA{ false };
+
+		std::vector<std::unique_ptr<Font>>	mvFonts;	// stbtt_fontinfo points to the data
+		// one pixel of padding between glyphs, the fields already fade to 0 towards their borders
+		TextureAtlas	mAtlas;
+		std::unordered_map<std::uint64_t, CachedGlyph>	mGlyphs;
+
+		DistanceScratch				mScratch;
+		std::vector<unsigned char>	mvCoverage;
+		std::vector<float>			mvInside, mvOutside;
+		std::vector<unsigned char>	mvField;
+
+		std::vector<Instance>	mvInstances;		// queued by AddText
+		std::vector<GLuint>		mvTextures;
+		std::vector<Instance>	mvImGuiInstances;	// queued by AddImGuiText, alive until the next frame
+		std::vector<GLuint>		mvImGuiTextures;
+		std::deque<ImGuiBatch>	mImGuiBatches;		// deque so that the callback data doesn't move
+
+		Window * mpWindow{ nullptr };
+		my_gl_core::StreamBuffer * mpStreamBuffer{ nullptr };
+		GLuint mBoundStreamBuffer{ 0 };
+		unsigned mBoundStreamGeneration{ 0 };	// a retired buffer name can come back in a new buffer
+
+		GLuint	mProgram{ 0 }, mVertShader{ 0 }, mFragShader{ 0 };
+		GLuint	mVao{ 0 };
+		GLint	mLocationTex{ 0 }, mLocationProjMtx{ 0 };
+		GLint	mLocationRect{ 0 }, mLocationUV{ 0 }, mLocationColor{ 0 };
+
+		unsigned	mFrameQuads{ 0 };
+		Stats		mStats;
+	};
+
+	GlyphCache::GlyphCache_impl::GlyphCache_impl(float bake_size, int spread, int page_size, unsigned max_pages)
+		: mBakeSize(bake_size > 1.f ? bake_size : 1.f)
+		, mSpread(spread > 1 ? spread : 1)
+		, mAtlas(page_size, max_pages, 1, TextureAtlas::Format::R8)
+	{
+		CreateDeviceObjects();
+	}
+	GlyphCache::GlyphCache_impl::~GlyphCache_impl()
+	{
+		my_gl_core::delete_vertex_array(mVao);
+
+		gl::DetachShader(mProgram, mVertShader);
+		gl::DeleteShader(mVertShader);
+		gl::DetachShader(mProgram, mFragShader);
+		gl::DeleteShader(mFragShader);
+		my_gl_core::delete_program(mProgram);
+	}
+
+	void GlyphCache::GlyphCache_impl::CreateDeviceObjects()
+	{
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
+
+		const GLchar * vertex_shader =
+			"#version 330\n"
+			"uniform mat4 ProjMtx;\n"
+			"in vec4 Rect;\n"
+			"in vec4 UVRect;\n"
+			"in vec4 Color;\n"
+			"out vec2 Frag_UV;\n"
+			"out vec4 Frag_Color;\n"
+			"void main()\n"
+			"{\n"
+			"	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+			"	Frag_UV = mix(UVRect.xy, UVRect.zw, corner);\n"
+			"	Frag_Color = Color;\n"
+			"	gl_Position = ProjMtx * vec4(mix(Rect.xy, Rect.zw, corner), 0, 1);\n"
+			"}\n";
+
+		// the edge is at 0.5, the screen space derivative keeps it one pixel wide at any scale
+		const GLchar * fragment_shader =
+			"#version 330\n"
+			"uniform sampler2D Texture;\n"
+			"in vec2 Frag_UV;\n"
+			"in vec4 Frag_Color;\n"
+			"out vec4 Out_Color;\n"
+			"void main()\n"
+			"{\n"
+			"	float distance = texture(Texture, Frag_UV).r;\n"
+			"	float width = max(fwidth(distance) * 0.5, 0.0001);\n"
+			"	float alpha = smoothstep(0.5 - width, 0.5 + width, distance);\n"
+			"	Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * alpha);\n"
+			"}\n";
+
+		mProgram = my_gl_core::create_program("GlyphCache");
+		mVertShader = gl::CreateShader(gl::VERTEX_SHADER);
+		mFragShader = gl::CreateShader(gl::FRAGMENT_SHADER);
+		gl::ShaderSource(mVertShader, 1, &vertex_shader, 0);
+		gl::ShaderSource(mFragShader, 1, &fragment_shader, 0);
+		gl::CompileShader(mVertShader);
+		gl::CompileShader(mFragShader);
+		gl::AttachShader(mProgram, mVertShader);
+		gl::AttachShader(mProgram, mFragShader);
+		gl::LinkProgram(mProgram);
+
+		mLocationTex = gl::GetUniformLocation(mProgram, "Texture");
+		mLocationProjMtx = gl::GetUniformLocation(mProgram, "ProjMtx");
+		mLocationRect = gl::GetAttribLocation(mProgram, "Rect");
+		mLocationUV = gl::GetAttribLocation(mProgram, "UVRect");
+		mLocationColor = gl::GetAttribLocation(mProgram, "Color");
+
+		// the buffer is set in BindStreamBuffer
+		const GLuint locations[] = { (GLuint)mLocationRect, (GLuint)mLocationUV, (GLuint)mLocationColor };
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			mVao = create_vertex_array("GlyphCache");
+			for (const GLuint location : locations)
+			{
+				ext::EnableVertexArrayAttrib(mVao, location);
+				ext::VertexArrayAttribBinding(mVao, location, 0);
+			}
+			ext::VertexArrayAttribFormat(mVao, mLocationRect, 4, gl::FLOAT, gl::FALSE_, (GLuint)offsetof(Instance, mRect));
+			ext::VertexArrayAttribFormat(mVao, mLocationUV, 4, gl::UNSIGNED_SHORT, gl::TRUE_, (GLuint)offsetof(Instance, mUV));
+			ext::VertexArrayAttribFormat(mVao, mLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, (GLuint)offsetof(Instance, mColor));
+			ext::VertexArrayBindingDivisor(mVao, 0, 1);
+		}
+		else
+		{
+			GLint last_vertex_array;
+			gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+			mVao = my_gl_core::create_vertex_array("GlyphCache");
+			gl::BindVertexArray(mVao);
+			for (const GLuint location : locations)
+			{
+				gl::EnableVertexAttribArray(location);
+				gl::VertexAttribDivisor(location, 1);
+			}
+			gl::BindVertexArray(last_vertex_array);
+		}
+		CheckOGLError();
+	}
+
+	void GlyphCache::GlyphCache_impl::BindStreamBuffer(const my_gl_core::StreamBuffer::Range & range)
+	{
+		if (range.mBuffer == mBoundStreamBuffer && range.mGeneration == mBoundStreamGeneration)
+			return;
+		mBoundStreamBuffer = range.mBuffer;
+		mBoundStreamGeneration = range.mGeneration;
+		const GLuint buffer = range.mBuffer;
+
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::VertexArrayVertexBuffer(mVao, 0, buffer, 0, sizeof(Instance));
+			return;
+		}
+
+		// IMPORTANT(Borja): Our vertex array needs to be bound.
+		gl::BindBuffer(gl::ARRAY_BUFFER, buffer);
+		gl::VertexAttribPointer(mLocationRect, 4, gl::FLOAT, gl::FALSE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mRect));
+		gl::VertexAttribPointer(mLocationUV, 4, gl::UNSIGNED_SHORT, gl::TRUE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mUV));
+		gl::VertexAttribPointer(mLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mColor));
+	}
+
+	GlyphCache::FontId GlyphCache::GlyphCache_impl::AddFontFromMemory(const void * data, std::size_t size, bool copy)
+	{
+		std::unique_ptr<Font> font = std::make_unique<Font>();
+		const unsigned char * bytes = static_cast<const unsigned char *>(data);
+		if (copy)
+		{
+			font->mvData.assign(bytes, bytes + size);
+			bytes = font->mvData.data();
+		}
+
+		const int offset = stbtt_GetFontOffsetForIndex(bytes, 0);
+		if (offset < 0 || !stbtt_InitFont(&font->mInfo, bytes, offset))
+			throw std::runtime_error{ "GlyphCache: The data is not a valid TrueType font." };
+
+		int ascent, descent, line_gap;
+		stbtt_GetFontVMetrics(&font->mInfo, &ascent, &descent, &line_gap);
+		font->mScale = stbtt_ScaleForPixelHeight(&font->mInfo, mBakeSize);
+		font->mAscent = ascent * font->mScale / mBakeSize;
+		font->mLineHeight = (ascent - descent + line_gap) * font->mScale / mBakeSize;
+
+		mvFonts.push_back(std::move(font));
+		return static_cast<FontId>(mvFonts.size() - 1);
+	}
+
+	bool GlyphCache::GlyphCache_impl::LookupGlyph(CachedGlyph & cached)
+	{
+		if (cached.mHandle == TextureAtlas::INVALID_HANDLE)
+			return true;
+
+		const TextureAtlas::Region region = mAtlas.Lookup(cached.mHandle);
+		if (region.mTexture == 0)
+			return false;
+
+		Glyph & glyph = cached.mGlyph;
+		glyph.mTexture = region.mTexture;
+		glyph.mU0 = region.mU0;
+		glyph.mV0 = region.mV0;
+		glyph.mU1 = region.mU1;
+		glyph.mV1 = region.mV1;
+		return true;
+	}
+
+	void GlyphCache::GlyphCache_impl::UpdateAtlasStats()
+	{
+		const TextureAtlas::Stats & atlas_stats = mAtlas.getStats();
+		mStats.mGlyphs = atlas_stats.mImages;
+		mStats.mPages = atlas_stats.mPages;
+		mStats.mEvictions = atlas_stats.mEvictions;
+	}
+
+	const GlyphCache::Glyph * GlyphCache::GlyphCache_impl::Rasterize(FontId font_id, unsigned codepoint, std::uint64_t key)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		const Font & font = *mvFonts[font_id];
+		const int glyph_index = stbtt_FindGlyphIndex(&font.mInfo, static_cast<int>(codepoint));
+
+		int advance, left_side_bearing;
+		stbtt_GetGlyphHMetrics(&font.mInfo, glyph_index, &advance, &left_side_bearing);
+		int x0, y0, x1, y1;
+		stbtt_GetGlyphBitmapBox(&font.mInfo, glyph_index, font.mScale, font.mScale, &x0, &y0, &x1, &y1);
+
+		CachedGlyph cached;
+		cached.mHandle = TextureAtlas::INVALID_HANDLE;
+		cached.mGlyph.mAdvance = advance * font.mScale / mBakeSize;
+
+		const int w = x1 - x0;
+		const int h = y1 - y0;
+		if (w > 0 && h > 0)
+		{
+			// the field extends spread pixels around the outline
+			const int field_w = w + 2 * mSpread;
+			const int field_h = h + 2 * mSpread;
+			const std::size_t field_size = static_cast<std::size_t>(field_w) * field_h;
+			mvCoverage.assign(field_size, 0);
+			stbtt_MakeGlyphBitmap(&font.mInfo, mvCoverage.data() + mSpread * field_w + mSpread, w, h, field_w,
+								  font.mScale, font.mScale, glyph_index);
+
+			// squared distances to the closest pixel of the other side of the outline
+			const float inf = 1e20f;
+			mvInside.resize(field_size);
+			mvOutside.resize(field_size);
+			for (std::size_t i = 0; i < field_size; ++i)
+			{
+				const bool inside = mvCoverage[i] >= 128;
+				mvOutside[i] = inside ? 0.f : inf;
+				mvInside[i] = inside ? inf : 0.f;
+			}
+			DistanceTransform2D(mScratch, mvOutside, field_w, field_h);
+			DistanceTransform2D(mScratch, mvInside, field_w, field_h);
+
+			// the outline is half a pixel away from the centers of the pixels on both sides
+			mvField.resize(field_size);
+			const float spread = static_cast<float>(mSpread);
+			for (std::size_t i = 0; i < field_size; ++i)
+			{
+				const float distance = mvOutside[i] > 0.f ? std::sqrt(mvOutside[i]) - 0.5f : 0.5f - std::sqrt(mvInside[i]);
+				const float value = 0.5f - distance / (2.f * spread);
+				const float clamped = value < 0.f ? 0.f : value > 1.f ? 1.f : value;
+				mvField[i] = static_cast<unsigned char>(clamped * 255.f + 0.5f);
+			}
+
+			// the atlas evicts the glyphs that haven't been used this frame if it is full
+			cached.mHandle = mAtlas.Insert(field_w, field_h, mvField.data());
+			if (cached.mHandle == TextureAtlas::INVALID_HANDLE)
+				return nullptr;
+			LookupGlyph(cached);
+
+			Glyph & glyph = cached.mGlyph;
+			glyph.mX0 = (x0 - mSpread) / mBakeSize;
+			glyph.mY0 = (y0 - mSpread) / mBakeSize;
+			glyph.mX1 = (x1 + mSpread) / mBakeSize;
+			glyph.mY1 = (y1 + mSpread) / mBakeSize;
+		}
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		++mStats.mRasterized;
+		mStats.mRasterizeMs += elapsed.count();
+
+		const Glyph * glyph = &mGlyphs.emplace(key, cached).first->second.mGlyph;
+		UpdateAtlasStats();
+		return glyph;
+	}
+
+	const GlyphCache::Glyph * GlyphCache::GlyphCache_impl::getGlyph(FontId font, unsigned codepoint)
+	{
+		if (font >= mvFonts.size())
+			return nullptr;
+
+		const std::uint64_t key = (static_cast<std::uint64_t>(font) << 32) | codepoint;
+		auto it = mGlyphs.find(key);
+		if (it != mGlyphs.end())
+		{
+			if (LookupGlyph(it->second))
+				return &it->second.mGlyph;
+			mGlyphs.erase(it);
+		}
+		return Rasterize(font, codepoint, key);
+	}
+
+	float GlyphCache::GlyphCache_impl::getLineHeight(FontId font, float size) const
+	{
+		return font < mvFonts.size() ? mvFonts[font]->mLineHeight * size : 0.f;
+	}
+
+	float GlyphCache::GlyphCache_impl::getTextWidth(FontId font, float size, const char * text, const char * text_end)
+	{
+		if (!text_end)
+			text_end = text + std::strlen(text);
+
+		float width = 0.f, line_width = 0.f;
+		while (text < text_end)
+		{
+			unsigned codepoint;
+			const int bytes = ImTextCharFromUtf8(&codepoint, text, text_end);
+			if (bytes <= 0)
+				break;
+			text += bytes;
+
+			if (codepoint == '\n')
+			{
+				width = std::max(width, line_width);
+				line_width = 0.f;
+			}
+			else if (const Glyph * glyph = getGlyph(font, codepoint))
+			{
+				line_width += glyph->mAdvance * size;
+			}
+		}
+		return std::max(width, line_width);
+	}
+
+	void GlyphCache::GlyphCache_impl::LayoutText(FontId font, float x, float y, float size, unsigned color,
+												 const char * text, const char * text_end,
+												 std::vector<Instance> & instances, std::vector<GLuint> & textures)
+	{
+		if (font >= mvFonts.size() || !text)
+			return;
+		if (!text_end)
+			text_end = text + std::strlen(text);
+
+		auto to_unorm16 = [](float v) { return static_cast<unsigned short>(v * 65535.f + 0.5f); };
+
+		const float line_height = mvFonts[font]->mLineHeight * size;
+		float pen_x = x;
+		float baseline = y + mvFonts[font]->mAscent * size;
+		while (text < text_end)
+		{
+			unsigned codepoint;
+			const int bytes = ImTextCharFromUtf8(&codepoint, text, text_end);
+			if (bytes <= 0)
+				break;
+			text += bytes;
+
+			if (codepoint == '\n')
+			{
+				pen_x = x;
+				baseline += line_height;
+				continue;
+			}
+
+			const Glyph * glyph = getGlyph(font, codepoint);
+			if (!glyph)
+				continue;
+
+			if (glyph->mTexture)
+			{
+				Instance instance;
+				instance.mRect[0] = pen_x + glyph->mX0 * size;
+				instance.mRect[1] = baseline + glyph->mY0 * size;
+				instance.mRect[2] = pen_x + glyph->mX1 * size;
+				instance.mRect[3] = baseline + glyph->mY1 * size;
+				instance.mUV[0] = to_unorm16(glyph->mU0);
+				instance.mUV[1] = to_unorm16(glyph->mV0);
+				instance.mUV[2] = to_unorm16(glyph->mU1);
+				instance.mUV[3] = to_unorm16(glyph->mV1);
+				instance.mColor = color;
+				instances.push_back(instance);
+				textures.push_back(glyph->mTexture);
+			}
+			pen_x += glyph->mAdvance * size;
+		}
+	}
+
+	void GlyphCache::GlyphCache_impl::AddText(FontId font, float x, float y, float size, unsigned color,
+											  const char * text, const char * text_end)
+	{
+		LayoutText(font, x, y, size, color, text, text_end, mvInstances, mvTextures);
+	}
+
+	void GlyphCache::GlyphCache_impl::AddImGuiText(ImDrawList * draw_list, FontId font, float x, float y, float size, unsigned color,
+												   const char * text, const char * text_end)
+	{
+		const std::size_t first = mvImGuiInstances.size();
+		LayoutText(font, x, y, size, color, text, text_end, mvImGuiInstances, mvImGuiTextures);
+		if (mvImGuiInstances.size() == first)
+			return;
+
+		mImGuiBatches.push_back(ImGuiBatch{ this, first, mvImGuiInstances.size() - first });
+		draw_list->AddCallback(ImGuiCallback, &mImGuiBatches.back());
+	}
+
+	void GlyphCache::GlyphCache_impl::ImGuiCallback(const ImDrawList * /*parent_list*/, const ImDrawCmd * cmd)
+	{
+		// ImGuiSystem has already set the scissor and restores its own program afterwards
+		const ImGuiBatch & batch = *static_cast<const ImGuiBatch *>(cmd->UserCallbackData);
+		GlyphCache_impl & cache = *batch.mpCache;
+		const ImVec2 display_size = ImGui::GetIO().DisplaySize;
+		cache.DrawQuads(cache.mvImGuiInstances.data() + batch.mFirst, cache.mvImGuiTextures.data() + batch.mFirst,
+						batch.mCount, display_size.x, display_size.y);
+	}
+
+	void GlyphCache::GlyphCache_impl::DrawQuads(const Instance * instances, const GLuint * textures, std::size_t count,
+												float width, float height)
+	{
+		if (count == 0 || !mpStreamBuffer)
+			return;
+
+		const my_gl_core::StreamBuffer::Range range = mpStreamBuffer->Allocate(static_cast<GLsizeiptr>(count * sizeof(Instance)), sizeof(Instance));
+		std::memcpy(range.mpData, instances, count * sizeof(Instance));
+		mpStreamBuffer->Commit(range);
+
+		const Mat4 ortho_projection = Mat4::Ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
+		gl::Enable(gl::BLEND);
+		gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+		gl::UseProgram(mProgram);
+		gl::Uniform1i(mLocationTex, 0);
+		gl::UniformMatrix4fv(mLocationProjMtx, 1, gl::FALSE_, ortho_projection.data());
+		gl::ActiveTexture(gl::TEXTURE0);
+		gl::BindVertexArray(mVao);
+		BindStreamBuffer(range);
+
+		// one draw call per run of glyphs on the same page
+		const GLuint first_instance = static_cast<GLuint>(range.mOffset / sizeof(Instance));
+		std::size_t start = 0;
+		while (start < count)
+		{
+			std::size_t end = start + 1;
+			while (end < count && textures[end] == textures[start])
+				++end;
+
+			if (mbUseDSA)	my_gl_core::ext::BindTextureUnit(0, textures[start]);
+			else			gl::BindTexture(gl::TEXTURE_2D, textures[start]);
+			gl::DrawArraysInstancedBaseInstance(gl::TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(end - start),
+												first_instance + static_cast<GLuint>(start));
+			start = end;
+		}
+		mFrameQuads += static_cast<unsigned>(count);
+	}
+
+	void GlyphCache::GlyphCache_impl::Render()
+	{
+		if (mvInstances.empty() || !mpWindow)
+			return;
+
+		// Backup GL state
+		GLint last_program, last_texture, last_array_buffer, last_vertex_array;
+		GLint last_blend_src, last_blend_dst;
+		const GLboolean last_blend = gl::IsEnabled(gl::BLEND);
+		const GLboolean last_depth_test = gl::IsEnabled(gl::DEPTH_TEST);
+		gl::GetIntegerv(gl::CURRENT_PROGRAM, &last_program);
+		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
+		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+		gl::GetIntegerv(gl::BLEND_SRC_RGB, &last_blend_src);
+		gl::GetIntegerv(gl::BLEND_DST_RGB, &last_blend_dst);
+
+		gl::Disable(gl::DEPTH_TEST);
+		DrawQuads(mvInstances.data(), mvTextures.data(), mvInstances.size(),
+				  static_cast<float>(mpWindow->getWindowWidth()), static_cast<float>(mpWindow->getWindowHeight()));
+		mvInstances.clear();
+		mvTextures.clear();
+
+		// Restore modified GL state
+		gl::UseProgram(last_program);
+		gl::BindTexture(gl::TEXTURE_2D, last_texture);
+		gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
+		gl::BindVertexArray(last_vertex_array);
+		gl::BlendFunc(last_blend_src, last_blend_dst);
+		if (!last_blend)		gl::Disable(gl::BLEND);
+		if (last_depth_test)	gl::Enable(gl::DEPTH_TEST);
+		CheckOGLError();
+	}
+
+	void GlyphCache::GlyphCache_impl::NewFrame(Window & window)
+	{
+		mpWindow = &window;
+		mpStreamBuffer = &window.getStreamBuffer();
+
+		mStats.mLastRasterized = mStats.mRasterized;
+		mStats.mRasterized = 0;
+		mStats.mRasterizeMs = 0.0;
+		mStats.mQuads = mFrameQuads;
+		mFrameQuads = 0;
+		mAtlas.NewFrame();
+		UpdateAtlasStats();
+
+		// the draw lists that pointed to these have been rendered already
+		mvImGuiInstances.clear();
+		mvImGuiTextures.clear();
+		mImGuiBatches.clear();
+	}
+
+	GlyphCache::GlyphCache(float bake_size, int spread, int page_size, unsigned max_pages)
+		: mpImpl(std::make_unique<GlyphCache_impl>(bake_size, spread, page_size, max_pages))
+	{}
+	GlyphCache::~GlyphCache() {}
+
+	GlyphCache::FontId GlyphCache::AddFontFromFile(const char * filename)
+	{
+		std::ifstream file{ filename, std::ios::binary };
+		if (!file)
+			throw std::runtime_error{ std::string{ "GlyphCache: Couldn't open font file " } + filename };
+
+		const std::vector<char> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		return mpImpl->AddFontFromMemory(data.data(), data.size(), true);
+	}
+	GlyphCache::FontId GlyphCache::AddFontFromMemory(const void * data, std::size_t size, bool copy)
+	{
+		return mpImpl->AddFontFromMemory(data, size, copy);
+	}
+	const GlyphCache::Glyph * GlyphCache::getGlyph(FontId font, unsigned codepoint)
+	{
+		return mpImpl->getGlyph(font, codepoint);
+	}
+	float GlyphCache::getLineHeight(FontId font, float size) const
+	{
+		return mpImpl->getLineHeight(font, size);
+	}
+	float GlyphCache::getTextWidth(FontId font, float size, const char * text, const char * text_end)
+	{
+		return mpImpl->getTextWidth(font, size, text, text_end);
+	}
+	void GlyphCache::AddText(FontId font, float x, float y, float size, unsigned color, const char * text, const char * text_end)
+	{
+		mpImpl->AddText(font, x, y, size, color, text, text_end);
+	}
+	void GlyphCache::Render()
+	{
+		mpImpl->Render();
+	}
+	void GlyphCache::AddImGuiText(ImDrawList * draw_list, FontId font, float x, float y, float size, unsigned color,
+								  const char * text, const char * text_end)
+	{
+		mpImpl->AddImGuiText(draw_list, font, x, y, size, color, text, text_end);
+	}
+	void GlyphCache::NewFrame(Window & window)
+	{
+		mpImpl->NewFrame(window);
+	}
+	const GlyphCache::Stats & GlyphCache::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
@@ -0,0 +1,86 @@
+/*!
+\brief	Signed distance field glyph cache to render text at any scale from a single bake.
+*/
+
+#pragma once
+
+#include <memory>	// std::unique_ptr
+#include <cstddef>	// std::size_t
+
+struct ImDrawList;
+
+namespace app
+{
+	class Window;
+
+	/// \brief	Rasterizes the glyphs of TrueType fonts as signed distance fields the first time
+	/// they are used, into the R8 pages of an app::TextureAtlas. A glyph baked once can be drawn at any size.
+	/// When all the pages are full the least recently used glyphs are evicted.
+	/// Text can be drawn with its own pass (GlyphCache::AddText + GlyphCache::Render) or inside
+	/// an ImGui window (GlyphCache::AddImGuiText), which renders it from a draw list callback.
+	/// IMPORTANT(Borja): Needs a current OpenGL context during the whole lifetime of the object.
+	class GlyphCache
+	{
+	public:
+		typedef unsigned FontId;
+
+		/// \brief	Metrics are in ems of the bake size, multiply them by the size the text is drawn at.
+		struct Glyph
+		{
+			unsigned	mTexture{ 0 };		// 0 if the glyph has nothing to draw (i.e. space)
+			float		mU0{ 0.f }, mV0{ 0.f }, mU1{ 0.f }, mV1{ 0.f };
+			float		mX0{ 0.f }, mY0{ 0.f }, mX1{ 0.f }, mY1{ 0.f };	// quad relative to the pen on the baseline
+			float		mAdvance{ 0.f };
+		};
+
+		struct Stats
+		{
+			unsigned	mRasterized{ 0 };		// glyphs rasterized in the current frame
+			double		mRasterizeMs{ 0.0 };	// time spent rasterizing them
+			unsigned	mLastRasterized{ 0 };	// glyphs rasterized in the last completed frame
+			unsigned	mGlyphs{ 0 };			// glyphs in the atlas
+			unsigned	mPages{ 0 };
+			unsigned	mEvictions{ 0 };		// total glyphs evicted to make room
+			unsigned	mQuads{ 0 };			// glyph quads drawn in the last completed frame
+		};
+
+		/// \param	bake_size	Pixel height the glyphs are rasterized at, the text looks sharp well above it.
+		/// \param	spread		Pixels of distance stored around the outline.
+		GlyphCache(float bake_size = 48.f, int spread = 6, int page_size = 1024, unsigned max_pages = 4);
+		~GlyphCache();
+
+		/// \brief	Throws std::runtime_error if the file can't be read or is not a TrueType font.
+		FontId AddFontFromFile(const char * filename);
+		/// \param	copy	If false the font is read from data, which needs to outlive the cache
+		/// (i.e. an asset mapped by app::AssetPack).
+		FontId AddFontFromMemory(const void * data, std::size_t size, bool copy = true);
+
+		/// \brief	Rasterizes the glyph if it is not in the cache.
+		/// \return	Null if the glyph doesn't fit in the atlas without evicting glyphs used this frame.
+		const Glyph * getGlyph(FontId font, unsigned codepoint);
+		/// \brief	Distance between baselines for text drawn at size pixels.
+		float getLineHeight(FontId font, float size) const;
+		float getTextWidth(FontId font, float size, const char * text, const char * text_end = nullptr);
+
+		/// \brief	Queues UTF-8 text with its top left corner at x, y (pixels), drawn by GlyphCache::Render.
+		/// \param	color	RGBA packed as 0xAABBGGRR (same as ImGui).
+		void AddText(FontId font, float x, float y, float size, unsigned color, const char * text, const char * text_end = nullptr);
+		/// \brief	Draws the text queued with GlyphCache::AddText.
+		void Render();
+
+		/// \brief	Adds the text to an ImGui draw list (coordinates in screen space, like ImDrawList::AddText).
+		/// It is drawn with the SDF shader from a draw callback, so it keeps its order and clipping.
+		void AddImGuiText(ImDrawList * draw_list, FontId font, float x, float y, float size, unsigned color,
+						  const char * text, const char * text_end = nullptr);
+
+		/// \brief	Needs to be called every frame before adding any text, the text added to
+		/// ImGui stays alive until the next call.
+		void NewFrame(Window & window);
+
+		const Stats & getStats() const;
+
+	private:
+		class GlyphCache_impl;
+		std::unique_ptr<GlyphCache_impl> mpImpl;
+	};
+}
@@ -0,0 +1,616 @@
+/*!
+\brief	ImGui plot widget for time series of millions of points, drawn on the GPU.
+*/
+
+#include "GpuPlot.h"
+
+#include "Window.h"
+#include "VectorMath.h"	// app::Mat4
+#include "GUI.h"		// namespace ImGui, ImDrawList
+
+#include "my_gl_core.h"
+#include "my_gl_resources.h"	// my_gl_core::create_buffer, my_gl_core::delete_buffer...
+
+#include <vector>		// std::vector
+#include <deque>		// std::deque
+#include <algorithm>	// std::min, std::max
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <cmath>		// std::pow, std::floor, std::log2
+#include <cstring>		// std::memcpy
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define GPU_PLOT_SSE2
+#include <emmintrin.h>	// SSE2 intrinsics
+#endif
+
+namespace app
+{
+	namespace
+	{
+		/// \brief	out[2 * i] = min(in[2 * i], in[2 * i + 1]), out[2 * i + 1] = max(...)
+		/// Builds the first level of the pyramid from the samples.
+		void ReduceSamples(const float * in, std::size_t buckets, float * out)
+		{
+			std::size_t i = 0;
+#ifdef GPU_PLOT_SSE2
+			// 4 buckets per iteration
+			for (; i + 4 <= buckets; i += 4)
+			{
+				const __m128 a = _mm_loadu_ps(in + 2 * i);
+				const __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+				const __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+				const __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+				const __m128 mn = _mm_min_ps(even, odd);
+				const __m128 mx = _mm_max_ps(even, odd);
+				_mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(mn, mx));
+				_mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(mn, mx));
+			}
+#endif
+			for (; i < buckets; ++i)
+			{
+				out[2 * i] = std::min(in[2 * i], in[2 * i + 1]);
+				out[2 * i + 1] = std::max(in[2 * i], in[2 * i + 1]);
+			}
+		}
+
+		/// \brief	Builds level k + 1 of the pyramid from the min/max pairs of level k.
+		void ReduceMinMax(const float * in, std::size_t buckets, float * out)
+		{
+			std::size_t i = 0;
+#ifdef GPU_PLOT_SSE2
+			// 2 buckets (4 pairs) per iteration
+			for (; i + 2 <= buckets; i += 2)
+			{
+				const __m128 a = _mm_loadu_ps(in + 4 * i);
+				const __m128 b = _mm_loadu_ps(in + 4 * i + 4);
+				const __m128 mins = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));	// mn0 mn1 mn2 mn3
+				const __m128 maxs = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));	// mx0 mx1 mx2 mx3
+				const __m128 mn = _mm_min_ps(_mm_shuffle_ps(mins, mins, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(mins, mins, _MM_SHUFFLE(3, 1, 3, 1)));
+				const __m128 mx = _mm_max_ps(_mm_shuffle_ps(maxs, maxs, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(maxs, maxs, _MM_SHUFFLE(3, 1, 3, 1)));
+				const __m128 result = _mm_unpacklo_ps(mn, mx);		// mn01 mx01 mn23 mx23
+				_mm_storeu_ps(out + 2 * i, result);
+			}
+#endif
+			for (; i < buckets; ++i)
+			{
+				out[2 * i] = std::min(in[4 * i], in[4 * i + 2]);
+				out[2 * i + 1] = std::max(in[4 * i + 1], in[4 * i + 3]);
+			}
+		}
+
+		std::size_t DivideRoundUp(std::size_t value, std::size_t divisor)
+		{
+			return (value + divisor - 1) / divisor;
+		}
+	}
+
+	class GpuPlot::GpuPlot_impl
+	{
+	public:
+		GpuPlot_impl();
+		~GpuPlot_impl();
+
+		SeriesId AddSeries();
+		void Append(SeriesId series, const float * values, std::size_t count);
+		void Clear(SeriesId series);
+		std::size_t getSize(SeriesId series) const { return series < mvSeries.size() ? mvSeries[series].mSize : 0; }
+
+		void Plot(const char * label, SeriesId series, View & view, float width, float height, unsigned color);
+		void NewFrame(Window & window);
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		/// \brief	Samples and pyramid levels, laid out by capacity so that appending doesn't move them.
+		struct Series
+		{
+			std::vector<float>			mvData;			// CPU copy of the buffer
+			std::vector<std::size_t>	mvLevelOffset;	// first float of every level
+			std::size_t					mSize{ 0 };
+			std::size_t					mCapacity{ 0 };
+			GLuint						mBuffer{ 0 };
+		};
+
+		/// \brief	Everything the callback needs to draw a plot, the callback data points to it.
+		/// IMPORTANT(Borja): An append later in the frame can grow the series, which moves its levels
+		/// and (with DSA) replaces its buffer. The draw keeps the position inside the level and the
+		/// callback looks up the buffer and the offset of the level when it runs.
+		struct PlotDraw
+		{
+			GpuPlot_impl *	mpPlot;
+			SeriesId		mSeries;
+			unsigned		mLevel;
+			GLint			mFirst;		// first float inside the level
+			GLsizei			mCount;
+			float			mRect[4];
+			int				mBucket;
+			int				mViewFirst;
+			float			mViewFrac;
+			float			mPixelsPerSample;
+			float			mYMin, mYInvRange;
+			float			mColor[4];
+		};
+
+		void CreateDeviceObjects();
+		void Reserve(Series & series, std::size_t capacity);
+		/// \brief	Recomputes the buckets that depend on the samples [first, last) and uploads them.
+		void UpdatePyramid(Series & series, std::size_t first, std::size_t last);
+		void Upload(Series & series, std::size_t first_float, std::size_t float_count);
+		/// \return	Min and max of the samples [first, last) using the buckets of level.
+		void FindRange(const Series & series, unsigned level, std::size_t first, std::size_t last, float & y_min, float & y_max) const;
+
+		static void ImGuiCallback(const ImDrawList * parent_list, const ImDrawCmd * cmd);
+		void Draw(const PlotDraw & draw);
+
+		bool mbUseDSA{ false };
+
+		std::vector<Series>		mvSeries;
+		std::deque<PlotDraw>	mDraws;		// deque so that the callback data doesn't move
+
+		GLuint	mProgram{ 0 }, mVertShader{ 0 }, mFragShader{ 0 };
+		GLuint	mVao{ 0 };
+		GLint	mLocationProjMtx{ 0 }, mLocationRect{ 0 }, mLocationLevelFirst{ 0 }, mLocationBucket{ 0 };
+		GLint	mLocationViewFirst{ 0 }, mLocationViewFrac{ 0 }, mLocationPixelsPerSample{ 0 };
+		GLint	mLocationYRange{ 0 }, mLocationColor{ 0 }, mLocationValue{ 0 };
+
+		unsigned	mFramePlots{ 0 };
+		unsigned	mFrameVertices{ 0 };
+		Stats		mStats;
+	};
+
+	GpuPlot::GpuPlot_impl::GpuPlot_impl()
+	{
+		CreateDeviceObjects();
+	}
+	GpuPlot::GpuPlot_impl::~GpuPlot_impl()
+	{
+		for (Series & series : mvSeries)
+			my_gl_core::delete_buffer(series.mBuffer);
+		my_gl_core::delete_vertex_array(mVao);
+
+		gl::DetachShader(mProgram, mVertShader);
+		gl::DeleteShader(mVertShader);
+		gl::DetachShader(mProgram, mFragShader);
+		gl::DeleteShader(mFragShader);
+		my_gl_core::delete_program(mProgram);
+	}
+
+	void GpuPlot::GpuPlot_impl::CreateDeviceObjects()
+	{
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
+
+		// Every level is an array of floats: the samples, or min/max pairs that are drawn as a
+		// zig-zag line strip. The sample of a vertex comes from gl_VertexID, the positions are
+		// relative to the first visible sample so that they keep their precision with millions of samples.
+		const GLchar * vertex_shader =
+			"#version 330\n"
+			"uniform mat4 ProjMtx;\n"
+			"uniform vec4 Rect;\n"
+			"uniform int LevelFirst;\n"
+			"uniform int Bucket;\n"
+			"uniform int ViewFirst;\n"
+			"uniform float ViewFrac;\n"
+			"uniform float PixelsPerSample;\n"
+			"uniform vec2 YRange;\n"
+			"in float Value;\n"
+			"void main()\n"
+			"{\n"
+			"	int i = gl_VertexID - LevelFirst;\n"
+			"	float x = Bucket == 1 ? float(i - ViewFirst) - ViewFrac\n"
+			"						  : float((i >> 1) * Bucket - ViewFirst) + 0.5 * float(Bucket) - ViewFrac;\n"
+			"	float y = (Value - YRange.x) * YRange.y;\n"
+			"	gl_Position = ProjMtx * vec4(Rect.x + x * PixelsPerSample, Rect.y + Rect.w * (1.0 - y), 0, 1);\n"
+			"}\n";
+
+		const GLchar * fragment_shader =
+			"#version 330\n"
+			"uniform vec4 Color;\n"
+			"out vec4 Out_Color;\n"
+			"void main()\n"
+			"{\n"
+			"	Out_Color = Color;\n"
+			"}\n";
+
+		mProgram = my_gl_core::create_program("GpuPlot");
+		mVertShader = gl::CreateShader(gl::VERTEX_SHADER);
+		mFragShader = gl::CreateShader(gl::FRAGMENT_SHADER);
+		gl::ShaderSource(mVertShader, 1, &vertex_shader, 0);
+		gl::ShaderSource(mFragShader, 1, &fragment_shader, 0);
+		gl::CompileShader(mVertShader);
+		gl::CompileShader(mFragShader);
+		gl::AttachShader(mProgram, mVertShader);
+		gl::AttachShader(mProgram, mFragShader);
+		gl::LinkProgram(mProgram);
+
+		mLocationProjMtx = gl::GetUniformLocation(mProgram, "ProjMtx");
+		mLocationRect = gl::GetUniformLocation(mProgram, "Rect");
+		mLocationLevelFirst = gl::GetUniformLocation(mProgram, "LevelFirst");
+		mLocationBucket = gl::GetUniformLocation(mProgram, "Bucket");
+		mLocationViewFirst = gl::GetUniformLocation(mProgram, "ViewFirst");
+		mLocationViewFrac = gl::GetUniformLocation(mProgram, "ViewFrac");
+		mLocationPixelsPerSample = gl::GetUniformLocation(mProgram, "PixelsPerSample");
+		mLocationYRange = gl::GetUniformLocation(mProgram, "YRange");
+		mLocationColor = gl::GetUniformLocation(mProgram, "Color");
+		mLocationValue = gl::GetAttribLocation(mProgram, "Value");
+
+		// the buffer changes with every series, it is set in Draw
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			mVao = create_vertex_array("GpuPlot");
+			ext::EnableVertexArrayAttrib(mVao, mLocationValue);
+			ext::VertexArrayAttribBinding(mVao, mLocationValue, 0);
+			ext::VertexArrayAttribFormat(mVao, mLocationValue, 1, gl::FLOAT, gl::FALSE_, 0);
+		}
+		else
+		{
+			GLint last_vertex_array;
+			gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+			mVao = my_gl_core::create_vertex_array("GpuPlot");
+			gl::BindVertexArray(mVao);
+			gl::EnableVertexAttribArray(mLocationValue);
+			gl::BindVertexArray(last_vertex_array);
+		}
+		CheckOGLError();
+	}
+
+	GpuPlot::SeriesId GpuPlot::GpuPlot_impl::AddSeries()
+	{
+		mvSeries.emplace_back();
+		return static_cast<SeriesId>(mvSeries.size() - 1);
+	}
+
+	void GpuPlot::GpuPlot_impl::Reserve(Series & series, std::size_t capacity)
+	{
+		std::size_t new_capacity = std::max<std::size_t>(series.mCapacity, 4096);
+		while (new_capacity < capacity)
+			new_capacity *= 2;
+		if (new_capacity == series.mCapacity)
+			return;
+
+		// level 0 has the samples, level k one min/max pair per 2^k samples, up to a single pair
+		std::vector<std::size_t> offsets{ 0 };
+		std::size_t total = new_capacity;
+		for (std::size_t bucket = 2; bucket / 2 < new_capacity; bucket *= 2)
+		{
+			offsets.push_back(total);
+			total += 2 * DivideRoundUp(new_capacity, bucket);
+		}
+
+		std::vector<float> data(total);
+		std::memcpy(data.data(), series.mvData.data(), series.mSize * sizeof(float));
+		series.mvData.swap(data);
+		series.mvLevelOffset.swap(offsets);
+		series.mCapacity = new_capacity;
+
+		// the whole buffer is recreated, the levels are rebuilt and uploaded by UpdatePyramid
+		const GLsizeiptr size = static_cast<GLsizeiptr>(total * sizeof(float));
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			delete_buffer(series.mBuffer);
+			series.mBuffer = create_buffer("GpuPlot");
+			ext::NamedBufferData(series.mBuffer, size, nullptr, gl::DYNAMIC_DRAW);
+		}
+		else
+		{
+			if (!series.mBuffer)	series.mBuffer = my_gl_core::create_buffer("GpuPlot");
+			gl::BindBuffer(gl::COPY_WRITE_BUFFER, series.mBuffer);
+			gl::BufferData(gl::COPY_WRITE_BUFFER, size, nullptr, gl::DYNAMIC_DRAW);
+		}
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Buffer, series.mBuffer, size);
+		CheckOGLError();
+	}
+
+	void GpuPlot::GpuPlot_impl::Upload(Series & series, std::size_t first_float, std::size_t float_count)
+	{
+		if (float_count == 0)
+			return;
+
+		const GLintptr offset = static_cast<GLintptr>(first_float * sizeof(float));
+		const GLsizeiptr size = static_cast<GLsizeiptr>(float_count * sizeof(float));
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::NamedBufferSubData(series.mBuffer, offset, size, series.mvData.data() + first_float);
+		}
+		else
+		{
+			gl::BindBuffer(gl::COPY_WRITE_BUFFER, series.mBuffer);
+			gl::BufferSubData(gl::COPY_WRITE_BUFFER, offset, size, series.mvData.data() + first_float);
+		}
+		mStats.mUploadedBytes += static_cast<std::size_t>(size);
+	}
+
+	void GpuPlot::GpuPlot_impl::UpdatePyramid(Series & series, std::size_t first, std::size_t last)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		Upload(series, first, last - first);
+
+		// dirty range and size of the previous level
+		std::size_t dirty_first = first, dirty_last = last;
+		std::size_t previous_count = series.mSize;
+		for (std::size_t level = 1; level < series.mvLevelOffset.size(); ++level)
+		{
+			const float * in = series.mvData.data() + series.mvLevelOffset[level - 1];
+			float * out = series.mvData.data() + series.mvLevelOffset[level];
+
+			const std::size_t bucket_first = dirty_first / 2;
+			const std::size_t bucket_last = DivideRoundUp(dirty_last, 2);
+			const std::size_t full_last = std::min(bucket_last, previous_count / 2);
+
+			// the buckets with both halves go through the SIMD kernels, the last one may only have one
+			if (full_last > bucket_first)
+			{
+				if (level == 1)	ReduceSamples(in + 2 * bucket_first, full_last - bucket_first, out + 2 * bucket_first);
+				else			ReduceMinMax(in + 4 * bucket_first, full_last - bucket_first, out + 2 * bucket_first);
+			}
+			for (std::size_t bucket = std::max(full_last, bucket_first); bucket < bucket_last; ++bucket)
+			{
+				out[2 * bucket] = level == 1 ? in[2 * bucket] : in[4 * bucket];
+				out[2 * bucket + 1] = level == 1 ? in[2 * bucket] : in[4 * bucket + 1];
+			}
+
+			Upload(series, series.mvLevelOffset[level] + 2 * bucket_first, 2 * (bucket_last - bucket_first));
+
+			dirty_first = bucket_first;
+			dirty_last = bucket_last;
+			previous_count = DivideRoundUp(previous_count, 2);
+		}
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		mStats.mPyramidMs += elapsed.count();
+	}
+
+	void GpuPlot::GpuPlot_impl::Append(SeriesId series_id, const float * values, std::size_t count)
+	{
+		if (series_id >= mvSeries.size() || count == 0)
+			return;
+
+		Series & series = mvSeries[series_id];
+		const std::size_t old_capacity = series.mCapacity;
+		Reserve(series, series.mSize + count);
+
+		std::memcpy(series.mvData.data() + series.mSize, values, count * sizeof(float));
+		const std::size_t first = series.mCapacity != old_capacity ? 0 : series.mSize;
+		series.mSize += count;
+
+		// a new buffer needs all the levels
+		UpdatePyramid(series, first, series.mSize);
+		CheckOGLError();
+	}
+
+	void GpuPlot::GpuPlot_impl::Clear(SeriesId series_id)
+	{
+		if (series_id < mvSeries.size())
+			mvSeries[series_id].mSize = 0;
+	}
+
+	void GpuPlot::GpuPlot_impl::FindRange(const Series & series, unsigned level, std::size_t first, std::size_t last,
+										  float & y_min, float & y_max) const
+	{
+		const float * data = series.mvData.data() + series.mvLevelOffset[level];
+		if (level == 0)
+		{
+			y_min = y_max = data[first];
+			for (std::size_t i = first; i < last; ++i)
+			{
+				y_min = std::min(y_min, data[i]);
+				y_max = std::max(y_max, data[i]);
+			}
+			return;
+		}
+
+		const std::size_t bucket_first = first >> level;
+		const std::size_t bucket_last = DivideRoundUp(last, std::size_t{ 1 } << level);
+		y_min = data[2 * bucket_first];
+		y_max = data[2 * bucket_first + 1];
+		for (std::size_t bucket = bucket_first; bucket < bucket_last; ++bucket)
+		{
+			y_min = std::min(y_min, data[2 * bucket]);
+			y_max = std::max(y_max, data[2 * bucket + 1]);
+		}
+	}
+
+	void GpuPlot::GpuPlot_impl::Plot(const char * label, SeriesId series_id, View & view, float width, float height, unsigned color)
+	{
+		ImGui::InvisibleButton(label, ImVec2(width, height));
+		const ImVec2 rect_min = ImGui::GetItemRectMin();
+		const ImVec2 rect_max = ImGui::GetItemRectMax();
+		width = rect_max.x - rect_min.x;
+		height = rect_max.y - rect_min.y;
+
+		ImDrawList * draw_list = ImGui::GetWindowDrawList();
+		const ImGuiStyle & style = ImGui::GetStyle();
+		draw_list->AddRectFilled(rect_min, rect_max, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_FrameBg]), style.FrameRounding);
+
+		const std::size_t size = getSize(series_id);
+		if (size < 2 || width < 1.f || height < 1.f)
+		{
+			draw_list->AddText(rect_min, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_Text]), label);
+			return;
+		}
+		const Series & series = mvSeries[series_id];
+
+		// pan and zoom
+		const double samples = static_cast<double>(size);
+		double length = view.mLength > 0.0 ? std::min(view.mLength, samples) : samples;
+		double start = view.mStart;
+		const ImGuiIO & io = ImGui::GetIO();
+		if (ImGui::IsItemActive() && io.MouseDelta.x != 0.f)
+		{
+			start -= io.MouseDelta.x * length / width;
+			view.mbFollow = false;
+		}
+		if (ImGui::IsItemHovered() && io.MouseWheel != 0.f)
+		{
+			const double anchor = (io.MousePos.x - rect_min.x) / width;
+			const double zoomed = std::min(std::max(length * std::pow(0.8, io.MouseWheel), 8.0), samples);
+			start += (length - zoomed) * anchor;
+			length = zoomed;
+			view.mbFollow = false;
+		}
+		if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0))
+		{
+			length = samples;
+			view.mbFollow = true;
+		}
+		if (view.mbFollow)
+			start = samples - length;
+		start = std::min(std::max(start, 0.0), samples - length);
+		if (start + length >= samples)
+			view.mbFollow = true;
+		view.mStart = start;
+		view.mLength = length < samples ? length : 0.0;
+
+		// the level with buckets of at most one pixel, at most 2 vertices per pixel
+		const double samples_per_pixel = length / width;
+		const unsigned max_level = static_cast<unsigned>(series.mvLevelOffset.size() - 1);
+		const unsigned level = samples_per_pixel < 2.0 ? 0 : std::min(static_cast<unsigned>(std::floor(std::log2(samples_per_pixel))), max_level);
+		const std::size_t bucket = std::size_t{ 1 } << level;
+
+		// one extra sample on each side so that the line reaches the borders
+		const std::size_t first = static_cast<std::size_t>(start) > 0 ? static_cast<std::size_t>(start) - 1 : 0;
+		const std::size_t last = std::min(size, static_cast<std::size_t>(std::ceil(start + length)) + 1);
+
+		float y_min, y_max;
+		FindRange(series, level, first, last, y_min, y_max);
+		const float margin = (y_max - y_min) * 0.05f + 1e-6f;
+		y_min -= margin;
+		y_max += margin;
+
+		PlotDraw draw;
+		draw.mpPlot = this;
+		draw.mSeries = series_id;
+		draw.mLevel = level;
+		draw.mBucket = static_cast<int>(bucket);
+		if (level == 0)
+		{
+			draw.mFirst = static_cast<GLint>(first);
+			draw.mCount = static_cast<GLsizei>(last - first);
+		}
+		else
+		{
+			const std::size_t bucket_first = first / bucket;
+			const std::size_t bucket_last = DivideRoundUp(last, bucket);
+			draw.mFirst = static_cast<GLint>(2 * bucket_first);
+			draw.mCount = static_cast<GLsizei>(2 * (bucket_last - bucket_first));
+		}
+		draw.mRect[0] = rect_min.x;
+		draw.mRect[1] = rect_min.y;
+		draw.mRect[2] = width;
+		draw.mRect[3] = height;
+		draw.mViewFirst = static_cast<int>(start);
+		draw.mViewFrac = static_cast<float>(start - std::floor(start));
+		draw.mPixelsPerSample = static_cast<float>(width / length);
+		draw.mYMin = y_min;
+		draw.mYInvRange = 1.f / (y_max - y_min);
+		for (int i = 0; i < 4; ++i)
+			draw.mColor[i] = ((color >> (8 * i)) & 0xFF) / 255.f;
+		mDraws.push_back(draw);
+
+		// clipped to the plot and to the window
+		ImVec4 clip_rect{ rect_min.x, rect_min.y, rect_max.x, rect_max.y };
+		if (draw_list->_ClipRectStack.Size)
+		{
+			const ImVec4 & current = draw_list->_ClipRectStack.back();
+			clip_rect = ImVec4(std::max(clip_rect.x, current.x), std::max(clip_rect.y, current.y),
+							   std::min(clip_rect.z, current.z), std::min(clip_rect.w, current.w));
+		}
+		draw_list->PushClipRect(clip_rect);
+		draw_list->AddCallback(ImGuiCallback, &mDraws.back());
+		draw_list->PopClipRect();
+
+		draw_list->AddText(rect_min, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_Text]), label);
+
+		++mFramePlots;
+		mFrameVertices += static_cast<unsigned>(draw.mCount);
+		mStats.mLastLevel = level;
+	}
+
+	void GpuPlot::GpuPlot_impl::ImGuiCallback(const ImDrawList * /*parent_list*/, const ImDrawCmd * cmd)
+	{
+		// ImGuiSystem has already set the scissor and restores its own program afterwards
+		const PlotDraw & draw = *static_cast<const PlotDraw *>(cmd->UserCallbackData);
+		draw.mpPlot->Draw(draw);
+	}
+
+	void GpuPlot::GpuPlot_impl::Draw(const PlotDraw & draw)
+	{
+		const Series & series = mvSeries[draw.mSeries];
+		const GLint level_first = static_cast<GLint>(series.mvLevelOffset[draw.mLevel]);
+
+		const ImVec2 display_size = ImGui::GetIO().DisplaySize;
+		const Mat4 ortho_projection = Mat4::Ortho(0.0f, display_size.x, display_size.y, 0.0f, -1.0f, 1.0f);
+
+		gl::UseProgram(mProgram);
+		gl::UniformMatrix4fv(mLocationProjMtx, 1, gl::FALSE_, ortho_projection.data());
+		gl::Uniform4fv(mLocationRect, 1, draw.mRect);
+		gl::Uniform1i(mLocationLevelFirst, level_first);
+		gl::Uniform1i(mLocationBucket, draw.mBucket);
+		gl::Uniform1i(mLocationViewFirst, draw.mViewFirst);
+		gl::Uniform1f(mLocationViewFrac, draw.mViewFrac);
+		gl::Uniform1f(mLocationPixelsPerSample, draw.mPixelsPerSample);
+		gl::Uniform2f(mLocationYRange, draw.mYMin, draw.mYInvRange);
+		gl::Uniform4fv(mLocationColor, 1, draw.mColor);
+
+		gl::BindVertexArray(mVao);
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::VertexArrayVertexBuffer(mVao, 0, series.mBuffer, 0, sizeof(float));
+		}
+		else
+		{
+			gl::BindBuffer(gl::ARRAY_BUFFER, series.mBuffer);
+			gl::VertexAttribPointer(mLocationValue, 1, gl::FLOAT, gl::FALSE_, sizeof(float), 0);
+		}
+		gl::DrawArrays(gl::LINE_STRIP, level_first + draw.mFirst, draw.mCount);
+	}
+
+	void GpuPlot::GpuPlot_impl::NewFrame(Window & /*window*/)
+	{
+		mStats.mPlots = mFramePlots;
+		mStats.mVertices = mFrameVertices;
+		mStats.mUploadedBytes = 0;
+		mStats.mPyramidMs = 0.0;
+		mFramePlots = 0;
+		mFrameVertices = 0;
+
+		// the draw lists that pointed to these have been rendered already
+		mDraws.clear();
+	}
+
+	GpuPlot::GpuPlot()
+		: mpImpl(std::make_unique<GpuPlot_impl>())
+	{}
+	GpuPlot::~GpuPlot() {}
+
+	GpuPlot::SeriesId GpuPlot::AddSeries()
+	{
+		return mpImpl->AddSeries();
+	}
+	void GpuPlot::Append(SeriesId series, const float * values, std::size_t count)
+	{
+		mpImpl->Append(series, values, count);
+	}
+	void GpuPlot::Clear(SeriesId series)
+	{
+		mpImpl->Clear(series);
+	}
+	std::size_t GpuPlot::getSize(SeriesId series) const
+	{
+		return mpImpl->getSize(series);
+	}
+	void GpuPlot::Plot(const char * label, SeriesId series, View & view, float width, float height, unsigned color)
+	{
+		mpImpl->Plot(label, series, view, width, height, color);
+	}
+	void GpuPlot::NewFrame(Window & window)
+	{
+		mpImpl->NewFrame(window);
+	}
+	const GpuPlot::Stats & GpuPlot::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
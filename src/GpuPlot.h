@@ -0,0 +1,63 @@
+/*!
+\brief	ImGui plot widget for time series of millions of points, drawn on the GPU.
+*/
+
+#pragma once
+
+#include <memory>	// std::unique_ptr
+#include <cstddef>	// std::size_t
+
+namespace app
+{
+	class Window;
+
+	/// \brief	Keeps every series in a GL buffer together with a min/max decimation pyramid
+	/// (level k stores the min and max of every 2^k samples). A plot only draws the level
+	/// that matches its width in pixels, so the cost depends on the pixels, not on the samples.
+	/// The lines are drawn from an ImDrawCallback, they keep the order and clipping of the window.
+	/// IMPORTANT(Borja): Needs a current OpenGL context during the whole lifetime of the object.
+	class GpuPlot
+	{
+	public:
+		typedef unsigned SeriesId;
+
+		/// \brief	Visible part of a series, GpuPlot::Plot updates it when panning and zooming.
+		struct View
+		{
+			double	mStart{ 0.0 };		// first visible sample
+			double	mLength{ 0.0 };		// visible samples, 0 shows the whole series
+			bool	mbFollow{ true };	// keeps the end of the series visible while appending
+		};
+
+		struct Stats
+		{
+			unsigned	mPlots{ 0 };			// plots drawn in the last completed frame
+			unsigned	mVertices{ 0 };			// vertices of those plots
+			unsigned	mLastLevel{ 0 };		// level used by the last plot
+			std::size_t	mUploadedBytes{ 0 };	// bytes uploaded in the current frame
+			double		mPyramidMs{ 0.0 };		// time spent building the pyramids in the current frame
+		};
+
+		GpuPlot();
+		~GpuPlot();
+
+		SeriesId AddSeries();
+		/// \brief	Appends the samples and updates the part of the pyramid they change.
+		void Append(SeriesId series, const float * values, std::size_t count);
+		void Clear(SeriesId series);
+		std::size_t getSize(SeriesId series) const;
+
+		/// \brief	ImGui widget, drag to pan, mouse wheel to zoom and double click to show everything.
+		/// \param	color	RGBA packed as 0xAABBGGRR (same as ImGui).
+		void Plot(const char * label, SeriesId series, View & view, float width, float height, unsigned color);
+
+		/// \brief	Needs to be called every frame before GpuPlot::Plot.
+		void NewFrame(Window & window);
+
+		const Stats & getStats() const;
+
+	private:
+		class GpuPlot_impl;
+		std::unique_ptr<GpuPlot_impl> mpImpl;
+	};
+}
@@ -6,8 +6,10 @@
 
 #include "Window.h"
 #include "Input.h"
+#include "VectorMath.h"	// app::Mat4
 
 #include "GUI.h"		// namespace ImGui, GUI_ENABLED
+#include "ImGuiMemory.h"	// namespace imgui_memory
 
 // compile imgui here so that we don't need to include it in the project 
 // (this way we can keep it in the external folder, it would be better not to do this)
@@ -16,9 +18,98 @@
 #include "imgui\imgui_demo.cpp"
 
 #include "my_gl_core.h"
+#include "my_gl_stream_buffer.h"	// my_gl_core::StreamBuffer
+#include "my_gl_resources.h"	// my_gl_core::create_buffer, my_gl_core::get_resource_owners...
+
+#include "SDL\SDL_scancode.h"	// SDL_Scancode, the Input key events use them
+
+#include <cstddef>	// offsetof
+#include <cstdint>	// std::uint64_t
+#include <cstring>	// std::memcpy, std::strlen
+#include <bitset>	// std::bitset
+#include <vector>	// std::vector
+#include <algorithm>	// std::sort, std::max, std::remove
 
 namespace app
 {
+	namespace
+	{
+		/// \brief	io.KeysDown is indexed by SDL scancode, this is the scancode of every ImGuiKey.
+		constexpr int s_ImGuiKeyScancodes[] =
+		{
+			SDL_SCANCODE_TAB,		// ImGuiKey_Tab
+			SDL_SCANCODE_LEFT,		// ImGuiKey_LeftArrow
+			SDL_SCANCODE_RIGHT,		// ImGuiKey_RightArrow
+			SDL_SCANCODE_UP,		// ImGuiKey_UpArrow
+			SDL_SCANCODE_DOWN,		// ImGuiKey_DownArrow
+			SDL_SCANCODE_PAGEUP,	// ImGuiKey_PageUp
+			SDL_SCANCODE_PAGEDOWN,	// ImGuiKey_PageDown
+			SDL_SCANCODE_HOME,		// ImGuiKey_Home
+			SDL_SCANCODE_END,		// ImGuiKey_End
+			SDL_SCANCODE_DELETE,	// ImGuiKey_Delete
+			SDL_SCANCODE_BACKSPACE,	// ImGuiKey_Backspace
+			SDL_SCANCODE_RETURN,	// ImGuiKey_Enter
+			SDL_SCANCODE_ESCAPE,	// ImGuiKey_Escape
+			SDL_SCANCODE_A,			// ImGuiKey_A
+			SDL_SCANCODE_C,			// ImGuiKey_C
+			SDL_SCANCODE_V,			// ImGuiKey_V
+			SDL_SCANCODE_X,			// ImGuiKey_X
+			SDL_SCANCODE_Y,			// ImGuiKey_Y
+			SDL_SCANCODE_Z,			// ImGuiKey_Z
+		};
+		static_assert(sizeof(s_ImGuiKeyScancodes) / sizeof(s_ImGuiKeyScancodes[0]) == ImGuiKey_COUNT,
+			"Every ImGuiKey needs a scancode.");
+		static_assert(SDL_NUM_SCANCODES <= sizeof(ImGuiIO::KeysDown) / sizeof(bool),
+			"io.KeysDown can't be indexed by scancode.");
+
+		/// \brief	Keys that ImGui should treat as another one.
+		constexpr unsigned RemapScancode(unsigned scancode)
+		{
+			return scancode == SDL_SCANCODE_KP_ENTER ? static_cast<unsigned>(SDL_SCANCODE_RETURN) : scancode;
+		}
+
+		/// \brief	Frames a retained draw list is kept after its window stops being drawn.
+		constexpr unsigned s_RetainedListFrames = 120;
+		/// \brief	Owner of the GL objects of the ImGuiSystem in the resource registry.
+		constexpr const char * s_ResourceOwner = "ImGuiSystem";
+
+		inline std::uint64_t Rotl64(std::uint64_t x, int r)
+		{
+			return (x << r) | (x >> (64 - r));
+		}
+		/// \brief	64 bit fingerprint of a block of memory (MurmurHash3 mixing, 8 bytes at a time).
+		std::uint64_t HashBytes(const void * data, std::size_t size, std::uint64_t hash)
+		{
+			constexpr std::uint64_t c1 = 0x87c37b91114253d5ull;
+			constexpr std::uint64_t c2 = 0x4cf5ad432745937full;
+
+			const unsigned char * bytes = static_cast<const unsigned char *>(data);
+			const std::size_t total = size;
+			for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t), bytes += sizeof(std::uint64_t))
+			{
+				std::uint64_t k;
+				std::memcpy(&k, bytes, sizeof(k));
+				hash ^= Rotl64(k * c1, 31) * c2;
+				hash = Rotl64(hash, 27) * 5 + 0x52dce729;
+			}
+			if (size > 0)
+			{
+				std::uint64_t k = 0;
+				std::memcpy(&k, bytes, size);
+				hash ^= Rotl64(k * c1, 31) * c2;
+			}
+
+			// finalizer, so that every input bit affects every output bit
+			hash ^= total;
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash >> 33;
+			hash *= 0xc4ceb9fe1a85ec53ull;
+			hash ^= hash >> 33;
+			return hash;
+		}
+	}
+
 	class ImGuiSystem::ImGuiSystem_impl
 	{
 		/// \brief	Initialices ImGui and allocates all the needed resources.
@@ -31,6 +122,28 @@ namespace app
 		void CreateFontsTexture();
 		/// \brief	Creates the shaders that Imgui is going to be using.
 		void CreateDeviceObjects();
+		/// \brief	Points the vertex array to the buffer the draw lists are drawn from
+		/// (the stream buffer or the buffer of a retained list, which has generation 0).
+		void BindStreamBuffer(GLuint buffer, unsigned generation);
+
+		struct RetainedList;
+		/// \return	Index in mvRetainedLists of the list, adding it if it isn't there.
+		std::size_t FindRetainedList(const ImDrawList * cmd_list);
+		/// \brief	Copies the vertices and indices of the list to its own buffer.
+		void RetainList(RetainedList & retained, const ImDrawList * cmd_list);
+		/// \brief	Deletes the buffers of the lists whose window hasn't been drawn for a while.
+		void EvictRetainedLists();
+		/// \brief	Deletes the biggest retained buffers until bytes have been freed,
+		/// the eviction callback of the ImGuiSystem in the resource registry.
+		void EvictRetainedBuffers(GLsizeiptr bytes);
+		void DeleteRetainedBuffer(RetainedList & retained);
+
+		/// \brief	Connects to the input events of the window so that they reach ImGui as they arrive.
+		void ConnectInput(Input & input);
+		void OnKeyEvent(unsigned scancode, bool down, bool repeat, unsigned modifiers);
+		void OnTextInput(const char * utf8_text);
+		/// \brief	Moves the queued characters to io.InputCharacters while there is space.
+		void FlushPendingCharacters();
 	public:
 		ImGuiSystem_impl();
 		~ImGuiSystem_impl();
@@ -38,17 +151,66 @@ namespace app
 
 		/// \brief	Begins a new ImGui frame.
 		void NewFrame(Window & window);
+		void ShowStatsWindow(bool * opened);
+		void ShowGpuResourcesWindow(bool * opened);
 
 	private:
 		// variables needed by ImGui
 		double       g_Time = 0.0f;
-		float        g_MouseWheel = 0.0f;
 		GLuint       g_FontTexture = 0;
-		int          g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
+		GLuint       g_ShaderHandle = 0;
+		int          g_VertHandle = 0, g_FragHandle = 0;
 		int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
 		int          g_AttribLocationPosition = 0, g_AttribLocationUV = 0, g_AttribLocationColor = 0;
 
-		unsigned int g_VboHandle = 0, g_VaoHandle = 0, g_ElementsHandle = 0;
+		unsigned int g_VaoHandle = 0;
+
+		/// \brief	Buffer shared by all the renderers of the window to stream per-frame data.
+		my_gl_core::StreamBuffer * mpStreamBuffer{ nullptr };
+		/// \brief	Stream buffer the vertex array is currently pointing to, with its generation because
+		/// GL can give the name of a retired stream buffer to a new one.
+		GLuint mBoundStreamBuffer{ 0 };
+		unsigned mBoundStreamGeneration{ 0 };
+
+		/// \brief	Edit the GL objects with direct state access instead of binding them.
+		bool mbUseDSA{ false };
+
+		/// \brief	Geometry of the draw list of a window, kept in its own buffer while it doesn't change
+		/// so that static windows aren't uploaded every frame.
+		struct RetainedList
+		{
+			const ImDrawList *	mpList{ nullptr };	// windows keep their draw list while they live
+			std::uint64_t		mHash{ 0 };			// fingerprint of the vertices and indices of the last frame
+			GLuint				mBuffer{ 0 };		// vertices followed by the indices
+			GLsizeiptr			mSize{ 0 };			// bytes allocated in mBuffer
+			GLsizeiptr			mVtxSize{ 0 };		// offset of the indices in mBuffer
+			bool				mbResident{ false };	// mBuffer holds the current geometry of the list
+			unsigned			mLastFrame{ 0 };	// last frame the list was drawn
+		};
+		struct CacheStats
+		{
+			unsigned			mLists{ 0 };			// lists drawn in the last frame
+			unsigned			mHits{ 0 };				// lists of the last frame drawn from their retained buffer
+			std::size_t			mStreamedBytes{ 0 };	// bytes streamed in the last frame
+			std::size_t			mRetainedBytes{ 0 };	// bytes copied to retained buffers in the last frame
+			std::size_t			mSkippedBytes{ 0 };		// bytes that didn't need to be uploaded in the last frame
+			std::size_t			mResidentBytes{ 0 };	// bytes allocated by the retained buffers
+			unsigned long long	mTotalLists{ 0 };
+			unsigned long long	mTotalHits{ 0 };
+		};
+		std::vector<RetainedList> mvRetainedLists;
+		/// \brief	Index in mvRetainedLists of every list of the frame being rendered.
+		std::vector<std::size_t> mvFrameLists;
+		unsigned mFrame{ 0 };
+		CacheStats mCacheStats;
+
+		Input * mpInput{ nullptr };
+		/// \brief	Characters that didn't fit in io.InputCharacters (it only holds 16 per frame).
+		std::vector<ImWchar> mvPendingCharacters;
+		/// \brief	Keys pressed since the last ImGui::NewFrame, releasing them straight away
+		/// would make ImGui miss presses shorter than a frame.
+		std::bitset<SDL_NUM_SCANCODES> mKeysDownThisFrame;
+		std::vector<unsigned> mvDeferredReleases;
 
 		bool mbVisible{ true };
 	};
@@ -57,9 +219,23 @@ namespace app
 	{
 		Init();
 		CreateDeviceObjects();
+
+		// the retained draw lists are a cache, they can be dropped when the GPU memory is tight
+		my_gl_core::set_eviction_callback(s_ResourceOwner, [this](GLsizeiptr bytes_over)
+		{
+			EvictRetainedBuffers(bytes_over);
+		});
 	}
 	ImGuiSystem::ImGuiSystem_impl::~ImGuiSystem_impl()
 	{
+		my_gl_core::set_eviction_callback(s_ResourceOwner, nullptr);
+
+		// IMPORTANT(Borja): The window needs to outlive the ImGuiSystem.
+		if (mpInput)
+		{
+			mpInput->setKeyEventCallBack(nullptr);
+			mpInput->setTextInputCallBack(nullptr);
+		}
 		Shutdown();
 	}
 
@@ -73,27 +249,17 @@ namespace app
 			//g_Window = systemInfo.info.win.window;
 		}
 
+		// needs to be done before ImGui allocates anything
+		if (!imgui_memory::isInstalled())
+			imgui_memory::Install();
+
 		ImGuiIO& io = ImGui::GetIO();
-		// the OP magic numbers, better if we serialize this in the InputManager xD
-		io.KeyMap[ImGuiKey_Tab] = 9;                         // Keyboard mapping. ImGui will use those indices to peek into the io.KeyDown[] array.
-		io.KeyMap[ImGuiKey_LeftArrow] = VK_LEFT;
-		io.KeyMap[ImGuiKey_RightArrow] = VK_RIGHT;
-		io.KeyMap[ImGuiKey_UpArrow] = 38;
-		io.KeyMap[ImGuiKey_DownArrow] = 40;
-		io.KeyMap[ImGuiKey_PageUp] = 33;
-		io.KeyMap[ImGuiKey_PageDown] = 34;
-		io.KeyMap[ImGuiKey_Home] = 36;
-		io.KeyMap[ImGuiKey_End] = 35;
-		io.KeyMap[ImGuiKey_Delete] = 127;
-		io.KeyMap[ImGuiKey_Backspace] = 8;
-		io.KeyMap[ImGuiKey_Enter] = 13;
-		io.KeyMap[ImGuiKey_Escape] = 27;
-		io.KeyMap[ImGuiKey_A] = 'A';
-		io.KeyMap[ImGuiKey_C] = 'C';
-		io.KeyMap[ImGuiKey_V] = 'V';
-		io.KeyMap[ImGuiKey_X] = 'X';
-		io.KeyMap[ImGuiKey_Y] = 'Y';
-		io.KeyMap[ImGuiKey_Z] = 'Z';
+		// Keyboard mapping. ImGui will use those indices to peek into the io.KeyDown[] array.
+		for (int i = 0; i < ImGuiKey_COUNT; ++i)
+			io.KeyMap[i] = s_ImGuiKeyScancodes[i];
+
+		mvPendingCharacters.reserve(64);
+		mvDeferredReleases.reserve(16);
 
 		io.RenderDrawListsFn = nullptr;
 #ifdef _WIN32
@@ -103,11 +269,7 @@ namespace app
 
 	void ImGuiSystem::ImGuiSystem_impl::CreateDeviceObjects()
 	{
-		// Backup GL state
-		GLint last_texture, last_array_buffer, last_vertex_array;
-		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
-		gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
-		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
 
 		const GLchar *vertex_shader =
 			"#version 330\n"
@@ -135,7 +297,7 @@ namespace app
 			"	Out_Color = Frag_Color * texture( Texture, Frag_UV.st);\n"
 			"}\n";
 
-		g_ShaderHandle = gl::CreateProgram();
+		g_ShaderHandle = my_gl_core::create_program(s_ResourceOwner);
 		g_VertHandle = gl::CreateShader(gl::VERTEX_SHADER);
 		g_FragHandle = gl::CreateShader(gl::FRAGMENT_SHADER);
 		gl::ShaderSource(g_VertHandle, 1, &vertex_shader, 0);
@@ -152,29 +314,66 @@ namespace app
 		g_AttribLocationUV = gl::GetAttribLocation(g_ShaderHandle, "UV");
 		g_AttribLocationColor = gl::GetAttribLocation(g_ShaderHandle, "Color");
 
-		gl::GenBuffers(1, &g_VboHandle);
-		gl::GenBuffers(1, &g_ElementsHandle);
+		// the buffers come from the stream buffer, see BindStreamBuffer
+		if (mbUseDSA)
+		{
+			// no binding is touched, so there is no state to backup
+			using namespace my_gl_core;
+			g_VaoHandle = create_vertex_array(s_ResourceOwner);
+
+			ext::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationPosition);
+			ext::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationUV);
+			ext::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationColor);
+			ext::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationPosition, 2, gl::FLOAT, gl::FALSE_, (GLuint)offsetof(ImDrawVert, pos));
+			ext::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationUV, 2, gl::FLOAT, gl::FALSE_, (GLuint)offsetof(ImDrawVert, uv));
+			ext::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, (GLuint)offsetof(ImDrawVert, col));
+			ext::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationPosition, 0);
+			ext::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationUV, 0);
+			ext::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationColor, 0);
+
+			CreateFontsTexture();
+			return;
+		}
+
+		// Backup GL state
+		GLint last_texture, last_vertex_array;
+		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
 
-		gl::GenVertexArrays(1, &g_VaoHandle);
+		g_VaoHandle = my_gl_core::create_vertex_array(s_ResourceOwner);
 		gl::BindVertexArray(g_VaoHandle);
-		gl::BindBuffer(gl::ARRAY_BUFFER, g_VboHandle);
 		gl::EnableVertexAttribArray(g_AttribLocationPosition);
 		gl::EnableVertexAttribArray(g_AttribLocationUV);
 		gl::EnableVertexAttribArray(g_AttribLocationColor);
 
-#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
-		gl::VertexAttribPointer(g_AttribLocationPosition, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
-		gl::VertexAttribPointer(g_AttribLocationUV, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
-		gl::VertexAttribPointer(g_AttribLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
-#undef OFFSETOF
-
 		CreateFontsTexture();
 
 		// Restore modified GL state
 		gl::BindTexture(gl::TEXTURE_2D, last_texture);
-		gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
 		gl::BindVertexArray(last_vertex_array);
 	}
+	void ImGuiSystem::ImGuiSystem_impl::BindStreamBuffer(GLuint buffer, unsigned generation)
+	{
+		if (buffer == mBoundStreamBuffer && generation == mBoundStreamGeneration)
+			return;
+		mBoundStreamBuffer = buffer;
+		mBoundStreamGeneration = generation;
+
+		// vertices and indices share the buffer
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::VertexArrayVertexBuffer(g_VaoHandle, 0, buffer, 0, sizeof(ImDrawVert));
+			my_gl_core::ext::VertexArrayElementBuffer(g_VaoHandle, buffer);
+			return;
+		}
+
+		// IMPORTANT(Borja): Our vertex array needs to be bound.
+		gl::BindBuffer(gl::ARRAY_BUFFER, buffer);
+		gl::VertexAttribPointer(g_AttribLocationPosition, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, pos));
+		gl::VertexAttribPointer(g_AttribLocationUV, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, uv));
+		gl::VertexAttribPointer(g_AttribLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, col));
+		gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, buffer);
+	}
 	void ImGuiSystem::ImGuiSystem_impl::CreateFontsTexture()
 	{
 		ImGuiIO& io = ImGui::GetIO();
@@ -185,11 +384,23 @@ namespace app
 		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bits for OpenGL3 demo because it is more likely to be compatible with user's existing shader.
 
 		// Create OpenGL texture
-		gl::GenTextures(1, &g_FontTexture);
-		gl::BindTexture(gl::TEXTURE_2D, g_FontTexture);
-		gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
-		gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
-		gl::TexImage2D(gl::TEXTURE_2D, 0, gl::RGBA, width, height, 0, gl::RGBA, gl::UNSIGNED_BYTE, pixels);
+		g_FontTexture = my_gl_core::create_texture(gl::TEXTURE_2D, s_ResourceOwner);
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, g_FontTexture, my_gl_core::get_texture_size(gl::RGBA8, width, height));
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			ext::TextureParameteri(g_FontTexture, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			ext::TextureParameteri(g_FontTexture, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			ext::TextureStorage2D(g_FontTexture, 1, gl::RGBA8, width, height);
+			ext::TextureSubImage2D(g_FontTexture, 0, 0, 0, width, height, gl::RGBA, gl::UNSIGNED_BYTE, pixels);
+		}
+		else
+		{
+			gl::BindTexture(gl::TEXTURE_2D, g_FontTexture);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			gl::TexImage2D(gl::TEXTURE_2D, 0, gl::RGBA, width, height, 0, gl::RGBA, gl::UNSIGNED_BYTE, pixels);
+		}
 
 		// Store our identifier
 		io.Fonts->TexID = (void *)(intptr_t)g_FontTexture;
@@ -200,10 +411,12 @@ namespace app
 	}
 	void ImGuiSystem::ImGuiSystem_impl::Shutdown()
 	{
-		if (g_VaoHandle)		gl::DeleteVertexArrays(1, &g_VaoHandle);
-		if (g_VboHandle)		gl::DeleteBuffers(1, &g_VboHandle);
-		if (g_ElementsHandle)	gl::DeleteBuffers(1, &g_ElementsHandle);
-		g_VaoHandle = g_VboHandle = g_ElementsHandle = 0;
+		my_gl_core::delete_vertex_array(g_VaoHandle);
+		mBoundStreamBuffer = 0;
+
+		for (RetainedList & retained : mvRetainedLists)
+			DeleteRetainedBuffer(retained);
+		mvRetainedLists.clear();
 
 		gl::DetachShader(g_ShaderHandle, g_VertHandle);
 		gl::DeleteShader(g_VertHandle);
@@ -213,23 +426,25 @@ namespace app
 		gl::DeleteShader(g_FragHandle);
 		g_FragHandle = 0;
 
-		gl::DeleteProgram(g_ShaderHandle);
-		g_ShaderHandle = 0;
+		my_gl_core::delete_program(g_ShaderHandle);
 
 		if (g_FontTexture)
 		{
-			gl::DeleteTextures(1, &g_FontTexture);
+			my_gl_core::delete_texture(g_FontTexture);
 			ImGui::GetIO().Fonts->TexID = 0;
-			g_FontTexture = 0;
 		}
 		ImGui::Shutdown();
 	}
 
 	void ImGuiSystem::ImGuiSystem_impl::NewFrame(Window & window)
 	{
+		imgui_memory::NewFrame();
+
 		const float dt = window.getDt();
 		ImGuiIO& io = ImGui::GetIO();
 
+		mpStreamBuffer = &window.getStreamBuffer();
+
 		// Setup display size (every frame to accommodate for window resizing)
 
 		const int w = window.getWindowWidth();
@@ -246,17 +461,12 @@ namespace app
 		io.DeltaTime = g_Time > 0.0 ? (float)(current_time) : (float)(1.0f / 60.0f);
 		g_Time = current_time;
 
-		const Input & input = window.getInput();
+		Input & input = window.getInput();
 
-		// TODO(Borja): handle capital letters
-		// TODO(Borja): handle symbol input
-		// keyboard data
-		for (unsigned short i = 1; i < input.getKeyNum(); i++)
-		{
-			io.KeysDown[i] = input.KeyTriggered(i);
-			if (io.KeysDown[i])
-				io.AddInputCharacter(i);
-		}
+		// keyboard data arrives through the input events, only the characters of previous frames remain
+		if (mpInput != &input)
+			ConnectInput(input);
+		FlushPendingCharacters();
 
 		// mouse
 	{
@@ -272,8 +482,7 @@ namespace app
 			io.MousePos = ImVec2(-1, -1);
 		}
 
-		// TODO(Borja): Mouse wheel
-		//io.MouseWheel = static_cast<float>(input.getMouseWheel());
+		io.MouseWheel = input.getMouseWheelY();
 		for (unsigned short i = 1; i < input.getMouseButtonNum(); i++)
 		{
 			io.MouseDown[i - 1] = input.MousePressed(i);
@@ -286,26 +495,392 @@ namespace app
 
 		// Start the frame
 		ImGui::NewFrame();
+
+		// ImGui has seen the short presses, they can be released now
+		for (const unsigned scancode : mvDeferredReleases)
+			io.KeysDown[scancode] = false;
+		mvDeferredReleases.clear();
+		mKeysDownThisFrame.reset();
+	}
+	void ImGuiSystem::ImGuiSystem_impl::ConnectInput(Input & input)
+	{
+		if (mpInput)
+		{
+			mpInput->setKeyEventCallBack(nullptr);
+			mpInput->setTextInputCallBack(nullptr);
+		}
+
+		mpInput = &input;
+		mpInput->setKeyEventCallBack([this](unsigned scancode, bool down, bool repeat, unsigned modifiers)
+		{
+			OnKeyEvent(scancode, down, repeat, modifiers);
+		});
+		mpInput->setTextInputCallBack([this](const char * utf8_text)
+		{
+			OnTextInput(utf8_text);
+		});
+	}
+	void ImGuiSystem::ImGuiSystem_impl::OnKeyEvent(unsigned scancode, bool down, bool repeat, unsigned modifiers)
+	{
+		ImGuiIO& io = ImGui::GetIO();
+		io.KeyShift = (modifiers & Input::MOD_SHIFT) != 0;
+		io.KeyCtrl = (modifiers & Input::MOD_CTRL) != 0;
+		io.KeyAlt = (modifiers & Input::MOD_ALT) != 0;
+
+		scancode = RemapScancode(scancode);
+		if (scancode >= mKeysDownThisFrame.size() || repeat)	// ImGui handles the repeats by itself
+			return;
+
+		if (down)
+		{
+			io.KeysDown[scancode] = true;
+			mKeysDownThisFrame.set(scancode);
+			// pressed again after a short press, the key is held at the end of the frame
+			mvDeferredReleases.erase(std::remove(mvDeferredReleases.begin(), mvDeferredReleases.end(), scancode), mvDeferredReleases.end());
+		}
+		else if (mKeysDownThisFrame.test(scancode))
+		{
+			mvDeferredReleases.push_back(scancode);
+		}
+		else
+		{
+			io.KeysDown[scancode] = false;
+		}
+	}
+	void ImGuiSystem::ImGuiSystem_impl::OnTextInput(const char * utf8_text)
+	{
+		const char * text_end = utf8_text + std::strlen(utf8_text);
+		while (utf8_text < text_end)
+		{
+			unsigned int c = 0;
+			const int bytes = ImTextCharFromUtf8(&c, utf8_text, text_end);
+			if (bytes <= 0 || c == 0)
+				break;
+			utf8_text += bytes;
+
+			// ImWchar can only hold the basic multilingual plane
+			if (c < 0x10000)
+				mvPendingCharacters.push_back(static_cast<ImWchar>(c));
+		}
+		FlushPendingCharacters();
+	}
+	void ImGuiSystem::ImGuiSystem_impl::FlushPendingCharacters()
+	{
+		if (mvPendingCharacters.empty())
+			return;
+
+		ImGuiIO& io = ImGui::GetIO();
+		const int capacity = IM_ARRAYSIZE(io.InputCharacters) - 1;
+		int used = ImStrlenW(io.InputCharacters);
+
+		std::size_t flushed = 0;
+		while (flushed < mvPendingCharacters.size() && used < capacity)
+		{
+			io.InputCharacters[used++] = mvPendingCharacters[flushed++];
+		}
+		io.InputCharacters[used] = 0;
+
+		mvPendingCharacters.erase(mvPendingCharacters.begin(), mvPendingCharacters.begin() + flushed);
 	}
 	void ImGuiSystem::ImGuiSystem_impl::Render()
 	{
-		// render the GUI
+		// render the GUI, most of what is allocated here only lives until the next frame
+		imgui_memory::BeginTransient();
 		ImGui::Render();
 		if (ImDrawData * pImDrawData = ImGui::GetDrawData())
 			RenderDrawLists(pImDrawData);
+		imgui_memory::EndTransient();
+	}
+	void ImGuiSystem::ImGuiSystem_impl::ShowGpuResourcesWindow(bool * opened)
+	{
+		using namespace my_gl_core;
+		if (!ImGui::Begin("GPU resources", opened, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const float megabyte = 1024.f * 1024.f;
+		const unsigned type_count = static_cast<unsigned>(ResourceType::Count);
+		const ResourceUsage totals = get_resource_totals();
+		const GLsizeiptr budget = get_resource_budget();
+		if (budget > 0)
+			ImGui::Text("Total: %.2f MB (budget %.2f MB)", totals.getTotalBytes() / megabyte, budget / megabyte);
+		else
+			ImGui::Text("Total: %.2f MB (no budget)", totals.getTotalBytes() / megabyte);
+		for (unsigned t = 0; t < type_count; ++t)
+			ImGui::BulletText("%s: %u (%.2f MB)", get_resource_type_name(static_cast<ResourceType>(t)), totals.mCount[t], totals.mBytes[t] / megabyte);
+
+		// slow growth is easier to see in the graph than in the numbers
+		int offset = 0;
+		const std::vector<float> & history = get_resource_history(offset);
+		if (!history.empty())
+		{
+			const float oldest = history[offset];
+			const float newest = history[(offset + history.size() - 1) % history.size()];
+			char overlay[64];
+			ImFormatString(overlay, sizeof(overlay), "%+.3f MB in %u frames", newest - oldest, static_cast<unsigned>(history.size()));
+			ImGui::PlotLines("MB", history.data(), static_cast<int>(history.size()), offset, overlay, FLT_MAX, FLT_MAX, ImVec2(0, 60));
+		}
+
+		if (ImGui::CollapsingHeader("Owners", nullptr, true, true))
+		{
+			ImGui::Columns(type_count + 4, "owners");
+			ImGui::Text("Owner");		ImGui::NextColumn();
+			for (unsigned t = 0; t < type_count; ++t)
+			{
+				ImGui::Text("%s", get_resource_type_name(static_cast<ResourceType>(t)));
+				ImGui::NextColumn();
+			}
+			ImGui::Text("MB (peak)");	ImGui::NextColumn();
+			ImGui::Text("Budget MB");	ImGui::NextColumn();
+			ImGui::Text("Evictions");	ImGui::NextColumn();
+			ImGui::Separator();
+
+			for (const ResourceOwner & owner : get_resource_owners())
+			{
+				ImGui::Text("%s", owner.mName);		ImGui::NextColumn();
+				for (unsigned t = 0; t < type_count; ++t)
+				{
+					ImGui::Text("%u", owner.mUsage.mCount[t]);
+					ImGui::NextColumn();
+				}
+				ImGui::Text("%.2f (%.2f)", owner.mUsage.getTotalBytes() / megabyte, owner.mPeakBytes / megabyte);	ImGui::NextColumn();
+				if (owner.mBudget > 0)	ImGui::Text("%.2f", owner.mBudget / megabyte);
+				else					ImGui::Text("-");
+				ImGui::NextColumn();
+				ImGui::Text("%u", owner.mEvictions);	ImGui::NextColumn();
+			}
+			ImGui::Columns(1);
+		}
+
+		ImGui::End();
+	}
+	void ImGuiSystem::ImGuiSystem_impl::ShowStatsWindow(bool * opened)
+	{
+		if (!ImGui::Begin("ImGuiSystem stats", opened, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const imgui_memory::Stats & mem = imgui_memory::getLastFrameStats();
+		if (ImGui::CollapsingHeader("Memory (last frame)", nullptr, true, true))
+		{
+			ImGui::Text("Allocations: %u (%u from the heap, %u from the arena)", mem.mAllocs, mem.mHeapAllocs, mem.mArenaAllocs);
+			ImGui::Text("Frees: %u", mem.mFrees);
+			ImGui::Text("Bytes allocated: %u", static_cast<unsigned>(mem.mBytes));
+			ImGui::Text("Live bytes: %u (peak %u)", static_cast<unsigned>(mem.mLiveBytes), static_cast<unsigned>(mem.mPeakLiveBytes));
+		}
+
+		const CacheStats & cache = mCacheStats;
+		if (ImGui::CollapsingHeader("Draw list cache (last frame)", nullptr, true, true))
+		{
+			const float hit_rate = cache.mLists ? 100.f * cache.mHits / cache.mLists : 0.f;
+			const float total_hit_rate = cache.mTotalLists ? static_cast<float>(100.0 * cache.mTotalHits / cache.mTotalLists) : 0.f;
+			ImGui::Text("Lists: %u (%u retained)", cache.mLists, cache.mHits);
+			ImGui::Text("Hit rate: %.1f%% (%.1f%% since start)", hit_rate, total_hit_rate);
+			ImGui::Text("Bytes streamed: %u", static_cast<unsigned>(cache.mStreamedBytes));
+			ImGui::Text("Bytes copied to retained buffers: %u", static_cast<unsigned>(cache.mRetainedBytes));
+			ImGui::Text("Bytes skipped: %u", static_cast<unsigned>(cache.mSkippedBytes));
+			ImGui::Text("Resident bytes: %u (%u buffers)", static_cast<unsigned>(cache.mResidentBytes), static_cast<unsigned>(mvRetainedLists.size()));
+		}
+
+		ImGui::End();
+	}
+
+	std::size_t ImGuiSystem::ImGuiSystem_impl::FindRetainedList(const ImDrawList * cmd_list)
+	{
+		for (std::size_t i = 0; i < mvRetainedLists.size(); ++i)
+		{
+			if (mvRetainedLists[i].mpList == cmd_list)
+				return i;
+		}
+
+		RetainedList retained;
+		retained.mpList = cmd_list;
+		mvRetainedLists.push_back(retained);
+		return mvRetainedLists.size() - 1;
+	}
+	void ImGuiSystem::ImGuiSystem_impl::RetainList(RetainedList & retained, const ImDrawList * cmd_list)
+	{
+		const GLsizeiptr vtx_size = (GLsizeiptr)cmd_list->VtxBuffer.size() * sizeof(ImDrawVert);
+		const GLsizeiptr idx_size = (GLsizeiptr)cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+		const GLsizeiptr size = vtx_size + idx_size;
+
+		// IMPORTANT(Borja): BufferData orphans the old storage, the GPU may still be reading it.
+		if (!retained.mBuffer)
+			retained.mBuffer = my_gl_core::create_buffer(s_ResourceOwner);
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			ext::NamedBufferData(retained.mBuffer, size, nullptr, gl::STATIC_DRAW);
+			ext::NamedBufferSubData(retained.mBuffer, 0, vtx_size, cmd_list->VtxBuffer.Data);
+			ext::NamedBufferSubData(retained.mBuffer, vtx_size, idx_size, cmd_list->IdxBuffer.Data);
+		}
+		else
+		{
+			gl::BindBuffer(gl::COPY_WRITE_BUFFER, retained.mBuffer);
+			gl::BufferData(gl::COPY_WRITE_BUFFER, size, nullptr, gl::STATIC_DRAW);
+			gl::BufferSubData(gl::COPY_WRITE_BUFFER, 0, vtx_size, cmd_list->VtxBuffer.Data);
+			gl::BufferSubData(gl::COPY_WRITE_BUFFER, vtx_size, idx_size, cmd_list->IdxBuffer.Data);
+		}
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Buffer, retained.mBuffer, size);
+
+		mCacheStats.mResidentBytes += static_cast<std::size_t>(size);
+		mCacheStats.mResidentBytes -= static_cast<std::size_t>(retained.mSize);
+		mCacheStats.mRetainedBytes += static_cast<std::size_t>(size);
+		retained.mSize = size;
+		retained.mVtxSize = vtx_size;
+		retained.mbResident = true;
+	}
+	void ImGuiSystem::ImGuiSystem_impl::EvictRetainedLists()
+	{
+		for (std::size_t i = 0; i < mvRetainedLists.size();)
+		{
+			RetainedList & retained = mvRetainedLists[i];
+			if (mFrame - retained.mLastFrame < s_RetainedListFrames)
+			{
+				++i;
+				continue;
+			}
+
+			DeleteRetainedBuffer(retained);
+			retained = mvRetainedLists.back();
+			mvRetainedLists.pop_back();
+		}
+	}
+	void ImGuiSystem::ImGuiSystem_impl::EvictRetainedBuffers(GLsizeiptr bytes)
+	{
+		std::vector<RetainedList *> retained_lists;
+		for (RetainedList & retained : mvRetainedLists)
+		{
+			if (retained.mBuffer)
+				retained_lists.push_back(&retained);
+		}
+		std::sort(retained_lists.begin(), retained_lists.end(), [](const RetainedList * a, const RetainedList * b)
+		{
+			return a->mSize > b->mSize;
+		});
+
+		// the lists go back to the stream buffer, they can be retained again if they don't change
+		for (std::size_t i = 0; i < retained_lists.size() && bytes > 0; ++i)
+		{
+			bytes -= retained_lists[i]->mSize;
+			DeleteRetainedBuffer(*retained_lists[i]);
+		}
+	}
+	void ImGuiSystem::ImGuiSystem_impl::DeleteRetainedBuffer(RetainedList & retained)
+	{
+		if (!retained.mBuffer)
+			return;
+
+		// the vertex array may still point to it, and the name can be reused by a new buffer
+		if (retained.mBuffer == mBoundStreamBuffer)
+			mBoundStreamBuffer = 0;
+		my_gl_core::delete_buffer(retained.mBuffer);
+
+		mCacheStats.mResidentBytes -= static_cast<std::size_t>(retained.mSize);
+		retained.mSize = 0;
+		retained.mbResident = false;
 	}
 
 	void ImGuiSystem::ImGuiSystem_impl::RenderDrawLists(ImDrawData* draw_data)
 	{
-		if (draw_data == nullptr)
+		if (draw_data == nullptr || mpStreamBuffer == nullptr || draw_data->TotalVtxCount == 0)
 			return;
+		++mFrame;
+
+		// A list that is the same as in the last frame is copied to its own buffer and drawn from there
+		// until it changes, the rest of the lists are streamed every frame. Windows that change every
+		// frame never get a buffer, and static windows are only uploaded once.
+		CacheStats & stats = mCacheStats;
+		stats.mLists = static_cast<unsigned>(draw_data->CmdListsCount);
+		stats.mHits = 0;
+		stats.mStreamedBytes = stats.mRetainedBytes = stats.mSkippedBytes = 0;
+
+		// the lists stop being retained while the ImGuiSystem is over its GPU memory budget
+		GLsizeiptr retain_budget = -1;
+		for (const my_gl_core::ResourceOwner & owner : my_gl_core::get_resource_owners())
+		{
+			if (owner.mBudget > 0 && std::strcmp(owner.mName, s_ResourceOwner) == 0)
+				retain_budget = std::max(owner.mBudget - owner.mUsage.getTotalBytes(), GLsizeiptr(0));
+		}
 
-		// Backup GL state
-		GLint last_program, last_texture, last_array_buffer, last_element_array_buffer, last_vertex_array;
+		GLsizeiptr vtx_size = 0;
+		GLsizeiptr idx_size = 0;
+		mvFrameLists.resize(draw_data->CmdListsCount);
+		for (int n = 0; n < draw_data->CmdListsCount; n++)
+		{
+			const ImDrawList* cmd_list = draw_data->CmdLists[n];
+			const GLsizeiptr list_vtx_size = (GLsizeiptr)cmd_list->VtxBuffer.size() * sizeof(ImDrawVert);
+			const GLsizeiptr list_idx_size = (GLsizeiptr)cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+			std::uint64_t hash = HashBytes(cmd_list->VtxBuffer.Data, list_vtx_size, 0);
+			hash = HashBytes(cmd_list->IdxBuffer.Data, list_idx_size, hash);
+
+			// the commands aren't retained, the callbacks and textures can change without a new upload
+			const std::size_t index = FindRetainedList(cmd_list);
+			RetainedList & retained = mvRetainedLists[index];
+			retained.mLastFrame = mFrame;
+			mvFrameLists[n] = index;
+			if (retained.mHash != hash)
+			{
+				retained.mHash = hash;
+				retained.mbResident = false;
+			}
+			else if (!retained.mbResident && list_vtx_size > 0 && (retain_budget < 0 || list_vtx_size + list_idx_size <= retain_budget))
+			{
+				if (retain_budget >= 0)
+					retain_budget -= list_vtx_size + list_idx_size;
+				RetainList(retained, cmd_list);
+			}
+
+			if (retained.mbResident)
+			{
+				++stats.mHits;
+				stats.mSkippedBytes += static_cast<std::size_t>(list_vtx_size + list_idx_size);
+			}
+			else
+			{
+				vtx_size += list_vtx_size;
+				idx_size += list_idx_size;
+			}
+		}
+		stats.mTotalLists += stats.mLists;
+		stats.mTotalHits += stats.mHits;
+		stats.mSkippedBytes -= stats.mRetainedBytes;
+
+		// Upload the vertices and indices of the lists that aren't retained to a single range of the shared
+		// stream buffer, aligned to the vertex size so that the lists can be drawn with a base vertex.
+		my_gl_core::StreamBuffer::Range range;
+		if (vtx_size > 0)
+		{
+			range = mpStreamBuffer->Allocate(vtx_size + idx_size, sizeof(ImDrawVert));
+			char * vtx_dst = static_cast<char *>(range.mpData);
+			char * idx_dst = vtx_dst + vtx_size;
+			for (int n = 0; n < draw_data->CmdListsCount; n++)
+			{
+				if (mvRetainedLists[mvFrameLists[n]].mbResident)
+					continue;
+
+				const ImDrawList* cmd_list = draw_data->CmdLists[n];
+				const std::size_t list_vtx_size = cmd_list->VtxBuffer.size() * sizeof(ImDrawVert);
+				const std::size_t list_idx_size = cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+				std::memcpy(vtx_dst, cmd_list->VtxBuffer.Data, list_vtx_size);
+				std::memcpy(idx_dst, cmd_list->IdxBuffer.Data, list_idx_size);
+				vtx_dst += list_vtx_size;
+				idx_dst += list_idx_size;
+			}
+			mpStreamBuffer->Commit(range);
+			stats.mStreamedBytes = static_cast<std::size_t>(vtx_size + idx_size);
+		}
+
+		// Backup GL state (the element buffer binding is part of the vertex array state)
+		GLint last_program, last_texture, last_array_buffer = 0, last_vertex_array;
 		gl::GetIntegerv(gl::CURRENT_PROGRAM, &last_program);
 		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
-		gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
-		gl::GetIntegerv(gl::ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
+		if (!mbUseDSA)
+			gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
 		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
 
 		// Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
@@ -332,43 +907,60 @@ namespace app
 		draw_data->ScaleClipRects(io.DisplayFramebufferScale);
 
 		// Setup orthographic projection matrix
-		const float ortho_projection[4][4] =
-		{
-			{ 2.0f / io.DisplaySize.x, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, 2.0f / -io.DisplaySize.y, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, -1.0f, 0.0f },
-			{ -1.0f, 1.0f, 0.0f, 1.0f },
-		};
+		const Mat4 ortho_projection = Mat4::Ortho(0.0f, io.DisplaySize.x, io.DisplaySize.y, 0.0f, -1.0f, 1.0f);
 		gl::UseProgram(g_ShaderHandle);
 		gl::Uniform1i(g_AttribLocationTex, 0);
-		gl::UniformMatrix4fv(g_AttribLocationProjMtx, 1, gl::FALSE_, &ortho_projection[0][0]);
+		gl::UniformMatrix4fv(g_AttribLocationProjMtx, 1, gl::FALSE_, ortho_projection.data());
 		gl::BindVertexArray(g_VaoHandle);
 
+		// ImDrawIdx can be redefined as unsigned int in imconfig.h for lists with more than 64k vertices
+		const GLenum index_type = sizeof(ImDrawIdx) == 2 ? gl::UNSIGNED_SHORT : gl::UNSIGNED_INT;
+		GLint stream_base_vertex = static_cast<GLint>(range.mOffset / sizeof(ImDrawVert));
+		const char* stream_idx_offset = reinterpret_cast<const char*>(range.mOffset + vtx_size);
 		for (int n = 0; n < draw_data->CmdListsCount; n++)
 		{
 			const ImDrawList* cmd_list = draw_data->CmdLists[n];
-			const ImDrawIdx* idx_buffer_offset = 0;
-
-			gl::BindBuffer(gl::ARRAY_BUFFER, g_VboHandle);
-			gl::BufferData(gl::ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.size() * sizeof(ImDrawVert), (GLvoid*)&cmd_list->VtxBuffer.front(), gl::STREAM_DRAW);
+			const RetainedList & retained = mvRetainedLists[mvFrameLists[n]];
 
-			gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-			gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx), (GLvoid*)&cmd_list->IdxBuffer.front(), gl::STREAM_DRAW);
+			GLint base_vertex = 0;
+			const char* idx_buffer_offset = nullptr;
+			if (retained.mbResident)
+			{
+				BindStreamBuffer(retained.mBuffer, 0);
+				idx_buffer_offset = reinterpret_cast<const char*>(retained.mVtxSize);
+			}
+			else
+			{
+				if (range.mBuffer)
+					BindStreamBuffer(range.mBuffer, range.mGeneration);
+				base_vertex = stream_base_vertex;
+				idx_buffer_offset = stream_idx_offset;
+				stream_base_vertex += cmd_list->VtxBuffer.size();
+				stream_idx_offset += cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx);
+			}
 
 			for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
 			{
+				gl::Scissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
 				if (pcmd->UserCallback)
 				{
 					pcmd->UserCallback(cmd_list, pcmd);
+
+					// the callbacks can draw with their own program and vertex array (i.e. GlyphCache)
+					gl::Enable(gl::BLEND);
+					gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+					gl::UseProgram(g_ShaderHandle);
+					gl::ActiveTexture(gl::TEXTURE0);
+					gl::BindVertexArray(g_VaoHandle);
 				}
 				else
 				{
 					GLuint id = static_cast<GLuint>(reinterpret_cast<std::uintptr_t>(pcmd->TextureId));
-					gl::BindTexture(gl::TEXTURE_2D, id);
-					gl::Scissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-					gl::DrawElements(gl::TRIANGLES, (GLsizei)pcmd->ElemCount, gl::UNSIGNED_SHORT, idx_buffer_offset);
+					if (mbUseDSA)	my_gl_core::ext::BindTextureUnit(0, id);
+					else			gl::BindTexture(gl::TEXTURE_2D, id);
+					gl::DrawElementsBaseVertex(gl::TRIANGLES, (GLsizei)pcmd->ElemCount, index_type, idx_buffer_offset, base_vertex);
 				}
-				idx_buffer_offset += pcmd->ElemCount;
+				idx_buffer_offset += pcmd->ElemCount * sizeof(ImDrawIdx);
 			}
 		}
 
@@ -377,12 +969,14 @@ namespace app
 		gl::ActiveTexture(gl::TEXTURE0);
 		gl::BindTexture(gl::TEXTURE_2D, last_texture);
 		//gl::BindTexture(gl::TEXTURE_2D, last_texture_id);
-		gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
-		gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
+		if (!mbUseDSA)
+			gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
 		gl::BindVertexArray(last_vertex_array);
 		gl::Disable(gl::SCISSOR_TEST);
 		gl::Enable(gl::DEPTH_TEST);
 
+		EvictRetainedLists();
+
 		gl::GetError();
 	}
 
@@ -399,5 +993,13 @@ namespace app
 	{
 		mpImpl->Render();
 	}
+	void ImGuiSystem::ShowStatsWindow(bool * opened) const
+	{
+		mpImpl->ShowStatsWindow(opened);
+	}
+	void ImGuiSystem::ShowGpuResourcesWindow(bool * opened) const
+	{
+		mpImpl->ShowGpuResourcesWindow(opened);
+	}
 
 }
@@ -20,6 +20,13 @@ namespace app
 		void Update(Window & window);
 		void Render() const;
 
+		/// \brief	Shows a window with the stats of the ImGui system (i.e. memory usage, draw list cache).
+		/// Needs to be called between ImGuiSystem::Update and ImGuiSystem::Render.
+		void ShowStatsWindow(bool * opened = nullptr) const;
+		/// \brief	Shows the GL objects of the resource registry by owner and a graph of the GPU memory
+		/// of the last frames. Needs to be called between ImGuiSystem::Update and ImGuiSystem::Render.
+		void ShowGpuResourcesWindow(bool * opened = nullptr) const;
+
 	private:
 		class ImGuiSystem_impl;
 		std::unique_ptr<ImGuiSystem_impl>	mpImpl;
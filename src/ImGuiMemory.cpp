@@ -0,0 +1,274 @@
+/*!
+\brief	Allocator installed in the ImGui memory hooks (ImGuiIO::MemAllocFn/MemFreeFn).
+*/
+
+#include "ImGuiMemory.h"
+
+#include "GUI.h"		// namespace ImGui
+
+#include <cstdlib>		// std::malloc
+#include <algorithm>	// std::max
+
+namespace app
+{
+	namespace imgui_memory
+	{
+		namespace
+		{
+			enum BlockKind : unsigned
+			{
+				BLOCK_HEAP,
+				BLOCK_POOL,
+				BLOCK_ARENA,
+			};
+
+			/// \brief	Stored right before every block, 16 bytes so that the blocks keep the malloc alignment.
+			struct alignas(16) BlockHeader
+			{
+				void *		mpOwner;	// Pool or ArenaPage the block comes from
+				unsigned	mKind;
+				unsigned	mSize;		// bytes requested
+			};
+
+			struct FreeBlock
+			{
+				FreeBlock * mpNext;
+			};
+
+			/// \brief	Free list of blocks of the same size, refilled in chunks that are never returned.
+			struct Pool
+			{
+				FreeBlock * mpFree;
+			};
+
+			/// \brief	Bump allocated page, it can be reused as soon as all its blocks are freed.
+			struct alignas(16) ArenaPage
+			{
+				ArenaPage *	mpNext;		// list of all the pages
+				std::size_t	mUsed;
+				unsigned	mLive;
+			};
+
+			const std::size_t POOL_CLASS_NUM = 8;		// blocks of 32, 64, ... 4096 bytes (header included)
+			const std::size_t POOL_MIN_BLOCK = 32;
+			const std::size_t POOL_CHUNK_SIZE = 64 * 1024;
+			const std::size_t ARENA_PAGE_SIZE = 64 * 1024;
+			const std::size_t ARENA_MAX_ALLOC = ARENA_PAGE_SIZE / 4;
+
+			// IMPORTANT(Borja): Only trivially destructible state, ImGui can free blocks
+			// after the static objects of this translation unit have been destroyed.
+			Pool		g_pools[POOL_CLASS_NUM];
+			ArenaPage *	g_pages = nullptr;
+			ArenaPage *	g_current_page = nullptr;
+			unsigned	g_transient_depth = 0;
+			bool		g_installed = false;
+			std::size_t	g_live_bytes = 0;
+			Stats		g_frame_stats;
+			Stats		g_last_frame_stats;
+
+			std::size_t PoolBlockSize(std::size_t pool_class)
+			{
+				return POOL_MIN_BLOCK << pool_class;
+			}
+
+			/// \return	POOL_CLASS_NUM if the block is too big for the pools.
+			std::size_t FindPoolClass(std::size_t total_size)
+			{
+				std::size_t pool_class = 0;
+				while (pool_class < POOL_CLASS_NUM && PoolBlockSize(pool_class) < total_size)
+					++pool_class;
+				return pool_class;
+			}
+
+			void * HeapAlloc(std::size_t size)
+			{
+				++g_frame_stats.mHeapAllocs;
+				return std::malloc(size);
+			}
+
+			BlockHeader * PoolAlloc(std::size_t pool_class)
+			{
+				Pool & pool = g_pools[pool_class];
+				if (!pool.mpFree)
+				{
+					const std::size_t block_size = PoolBlockSize(pool_class);
+					char * chunk = static_cast<char *>(HeapAlloc(POOL_CHUNK_SIZE));
+					if (!chunk)
+						return nullptr;
+
+					for (std::size_t offset = 0; offset + block_size <= POOL_CHUNK_SIZE; offset += block_size)
+					{
+						FreeBlock * block = reinterpret_cast<FreeBlock *>(chunk + offset);
+						block->mpNext = pool.mpFree;
+						pool.mpFree = block;
+					}
+				}
+
+				FreeBlock * block = pool.mpFree;
+				pool.mpFree = block->mpNext;
+
+				BlockHeader * header = reinterpret_cast<BlockHeader *>(block);
+				header->mpOwner = &pool;
+				header->mKind = BLOCK_POOL;
+				return header;
+			}
+
+			ArenaPage * AcquireArenaPage()
+			{
+				// reuse a page that has no blocks alive
+				for (ArenaPage * page = g_pages; page; page = page->mpNext)
+				{
+					if (page->mLive == 0 && page != g_current_page)
+					{
+						page->mUsed = 0;
+						return page;
+					}
+				}
+
+				ArenaPage * page = static_cast<ArenaPage *>(HeapAlloc(ARENA_PAGE_SIZE));
+				if (!page)
+					return nullptr;
+				page->mUsed = 0;
+				page->mLive = 0;
+				page->mpNext = g_pages;
+				g_pages = page;
+				return page;
+			}
+
+			BlockHeader * ArenaAlloc(std::size_t total_size)
+			{
+				const std::size_t capacity = ARENA_PAGE_SIZE - sizeof(ArenaPage);
+				total_size = (total_size + alignof(BlockHeader) - 1) / alignof(BlockHeader) * alignof(BlockHeader);
+
+				if (!g_current_page || g_current_page->mUsed + total_size > capacity)
+				{
+					ArenaPage * page = AcquireArenaPage();
+					if (!page)
+						return nullptr;
+					g_current_page = page;
+				}
+
+				ArenaPage * page = g_current_page;
+				BlockHeader * header = reinterpret_cast<BlockHeader *>(reinterpret_cast<char *>(page + 1) + page->mUsed);
+				page->mUsed += total_size;
+				++page->mLive;
+
+				header->mpOwner = page;
+				header->mKind = BLOCK_ARENA;
+				++g_frame_stats.mArenaAllocs;
+				return header;
+			}
+		}
+
+		void Install()
+		{
+			ImGuiIO & io = ImGui::GetIO();
+			io.MemAllocFn = Alloc;
+			io.MemFreeFn = Free;
+			g_installed = true;
+		}
+		bool isInstalled()
+		{
+			return g_installed;
+		}
+
+		void * Alloc(std::size_t size)
+		{
+			const std::size_t total_size = size + sizeof(BlockHeader);
+
+			BlockHeader * header = nullptr;
+			if (g_transient_depth > 0 && total_size <= ARENA_MAX_ALLOC)
+			{
+				header = ArenaAlloc(total_size);
+			}
+			else
+			{
+				const std::size_t pool_class = FindPoolClass(total_size);
+				if (pool_class < POOL_CLASS_NUM)
+				{
+					header = PoolAlloc(pool_class);
+				}
+				else if ((header = static_cast<BlockHeader *>(HeapAlloc(total_size))) != nullptr)
+				{
+					header->mpOwner = nullptr;
+					header->mKind = BLOCK_HEAP;
+				}
+			}
+
+			if (!header)
+				return nullptr;
+
+			header->mSize = static_cast<unsigned>(size);
+
+			++g_frame_stats.mAllocs;
+			g_frame_stats.mBytes += size;
+			g_live_bytes += size;
+			g_frame_stats.mPeakLiveBytes = std::max(g_frame_stats.mPeakLiveBytes, g_live_bytes);
+			return header + 1;
+		}
+
+		void Free(void * ptr)
+		{
+			if (!ptr)
+				return;
+
+			BlockHeader * header = static_cast<BlockHeader *>(ptr) - 1;
+			++g_frame_stats.mFrees;
+			g_live_bytes -= header->mSize;
+
+			switch (header->mKind)
+			{
+			case BLOCK_POOL:
+			{
+				Pool * pool = static_cast<Pool *>(header->mpOwner);
+				FreeBlock * block = reinterpret_cast<FreeBlock *>(header);
+				block->mpNext = pool->mpFree;
+				pool->mpFree = block;
+			} break;
+			case BLOCK_ARENA:
+			{
+				ArenaPage * page = static_cast<ArenaPage *>(header->mpOwner);
+				// the current page can be rewound straight away once it is empty
+				if (--page->mLive == 0 && page == g_current_page)
+					page->mUsed = 0;
+			} break;
+			default:
+			{
+				std::free(header);
+			} break;
+			}
+		}
+
+		void BeginTransient()
+		{
+			++g_transient_depth;
+		}
+		void EndTransient()
+		{
+			if (g_transient_depth > 0)
+				--g_transient_depth;
+		}
+
+		void NewFrame()
+		{
+			g_frame_stats.mLiveBytes = g_live_bytes;
+			g_last_frame_stats = g_frame_stats;
+
+			g_frame_stats = Stats{};
+			g_frame_stats.mLiveBytes = g_live_bytes;
+			g_frame_stats.mPeakLiveBytes = g_live_bytes;
+
+			if (g_current_page && g_current_page->mLive == 0)
+				g_current_page->mUsed = 0;
+		}
+
+		const Stats & getFrameStats()
+		{
+			return g_frame_stats;
+		}
+		const Stats & getLastFrameStats()
+		{
+			return g_last_frame_stats;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+/*!
+\brief	Allocator installed in the ImGui memory hooks (ImGuiIO::MemAllocFn/MemFreeFn).
+*/
+
+#pragma once
+
+#include <cstddef>	// std::size_t
+
+namespace app
+{
+	/// \brief	Small allocations come from size-class pools and the ones done inside a transient
+	/// scope from a per-frame arena, so steady-state frames don't reach the heap.
+	/// IMPORTANT(Borja): The hooks stay installed until the program exits because ImGui frees its
+	/// static state from its destructors.
+	namespace imgui_memory
+	{
+		struct Stats
+		{
+			unsigned	mAllocs{ 0 };			// calls to Alloc
+			unsigned	mFrees{ 0 };			// calls to Free
+			unsigned	mHeapAllocs{ 0 };		// allocations that reached malloc (pool chunks, arena pages, big blocks)
+			unsigned	mArenaAllocs{ 0 };		// allocations served by the frame arena
+			std::size_t	mBytes{ 0 };			// bytes requested
+			std::size_t	mLiveBytes{ 0 };		// bytes alive at the end of the frame
+			std::size_t	mPeakLiveBytes{ 0 };	// max bytes alive at the same time during the frame
+		};
+
+		/// \brief	Sets the hooks, needs to be called before ImGui allocates anything.
+		void Install();
+		bool isInstalled();
+
+		void * Alloc(std::size_t size);
+		void Free(void * ptr);
+
+		/// \brief	Allocations done between Begin/EndTransient come from the frame arena.
+		/// Its pages are reference counted, so a block that outlives the frame only pins its page.
+		void BeginTransient();
+		void EndTransient();
+
+		/// \brief	Closes the stats of the frame and recycles the arena pages.
+		void NewFrame();
+
+		/// \return	Stats of the frame in progress.
+		const Stats & getFrameStats();
+		/// \return	Stats of the last completed frame.
+		const Stats & getLastFrameStats();
+	}
+}
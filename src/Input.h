@@ -6,6 +6,9 @@
 
 namespace app
 {
+	class ActionMap;
+	class Gamepads;
+
 	class Input
 	{
 	private:
@@ -16,6 +19,14 @@ namespace app
 		// Type of the callbacks that can be set in order to be notified when an input happens.
 		using key_callback = std::function<void(unsigned char key)>;
 		using mouse_callback = std::function<void(unsigned char button, int x, int y)>;
+		/// \brief	Raw key event, scancode is the SDL_Scancode of the physical key and modifiers a
+		/// combination of Input::KeyModifiers. Key repeats are reported with repeat set to true.
+		using key_event_callback = std::function<void(unsigned scancode, bool down, bool repeat, unsigned modifiers)>;
+		/// \brief	UTF-8 text the user typed (already translated by the keyboard layout, IME, etc.).
+		using text_callback = std::function<void(const char * utf8_text)>;
+		/// \brief	Single mouse motion sample, dx and dy are relative to the previous sample
+		/// and timestamp is in milliseconds.
+		using motion_callback = std::function<void(int x, int y, int dx, int dy, unsigned timestamp)>;
 
 		// Handy values to get the 
 		enum MouseButtons
@@ -25,12 +36,31 @@ namespace app
 			MOUSE_WHEEL = 2
 		};
 
+		enum KeyModifiers
+		{
+			MOD_SHIFT = 1 << 0,
+			MOD_CTRL = 1 << 1,
+			MOD_ALT = 1 << 2,
+			MOD_SUPER = 1 << 3
+		};
+
 	public:
 
 		/// \return X coordinate of the mouse position in window coordinates.
 		int getMouseX() const;
 		/// \return Y coordinate of the mouse position in window coordinates.
 		int getMouseY() const;
+		/// \return Relative horizontal mouse motion accumulated during the last frame (also valid in relative mode).
+		int getMouseDeltaX() const;
+		/// \return Relative vertical mouse motion accumulated during the last frame (also valid in relative mode).
+		int getMouseDeltaY() const;
+		/// \return Horizontal wheel scroll of the last frame, positive to the right.
+		float getMouseWheelX() const;
+		/// \return Vertical wheel scroll of the last frame, positive away from the user.
+		float getMouseWheelY() const;
+		/// \brief	In relative mode the cursor is hidden and only the deltas change.
+		void setRelativeMouseMode(bool relative);
+		bool isRelativeMouseMode() const;
 		/// \return The number of keyboard keys that the input handles.
 		std::size_t getKeyNum() const;
 		/// \return The number of mouse buttons that the input handles.
@@ -45,6 +75,13 @@ namespace app
 		/// \return True while the input mouse button is pressed.
 		bool MousePressed(unsigned b) const;
 
+		/// \brief	Actions bound to the keys and mouse buttons, updated with the rest of the input.
+		ActionMap & getActions();
+		const ActionMap & getActions() const;
+		/// \brief	Connected gamepads, updated with the rest of the input.
+		Gamepads & getGamepads();
+		const Gamepads & getGamepads() const;
+
 		/// \brief	Callback is called the frame that the user presses a keyboard key.
 		void setKeyTriggeredCallBack(key_callback key_triggered_callback);
 		/// \brief	Callback is called all the frames a keyboard key is pressed.
@@ -57,6 +94,13 @@ namespace app
 		void setMousePressedCallBack(mouse_callback mouse_pressed_callback);
 		/// \brief	Callback is called when a mouse button was pressed the prvious frame but not this one.
 		void setMouseReleasedCallBack(mouse_callback mouse_released_callback);
+		/// \brief	Callback is called for every key event as the window receives it (not once per frame).
+		void setKeyEventCallBack(key_event_callback event_callback);
+		/// \brief	Callback is called for every text input event as the window receives it.
+		void setTextInputCallBack(text_callback text_input_callback);
+		/// \brief	Callback is called for every mouse motion event the window receives. The rest of the
+		/// input only sees the coalesced motion of the frame, use this to get the full polling rate.
+		void setMouseMotionCallBack(motion_callback mouse_motion_callback);
 
 	private:
 		// Use pimpl pattern in order to hide the underlying window API.
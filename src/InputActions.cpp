@@ -0,0 +1,606 @@
+/*!
+\brief	Named actions bound to keys, mouse buttons and chords, with their state updated once per frame.
+*/
+
+#include "InputActions.h"
+#include "Input.h"		// Input::KeyModifiers
+
+#include "SDL\SDL.h"	// SDL_GetScancodeFromName, SDL_GetScancodeName
+#include "Log.h"
+
+#include <array>		// std::array
+#include <bitset>		// std::bitset
+#include <cctype>		// std::tolower
+#include <cstdlib>		// std::atoi
+#include <string>		// std::to_string
+
+namespace app
+{
+	namespace
+	{
+		// keyboard slots are the scancodes, the mouse buttons go after them
+		const unsigned SCANCODE_NUM = SDL_NUM_SCANCODES;
+		const unsigned MOUSE_BUTTON_NUM = 8;
+		const unsigned SLOT_NUM = SCANCODE_NUM + MOUSE_BUTTON_NUM;
+		const unsigned INVALID_ENTRY = ~0u;
+
+		const unsigned char PRESSED_FLAG = 1 << 0;
+		const unsigned char TRIGGERED_FLAG = 1 << 1;
+		const unsigned char RELEASED_FLAG = 1 << 2;
+
+		const struct { unsigned mModifier; const char * mName; } s_Modifiers[] =
+		{
+			{ Input::MOD_CTRL, "Ctrl" },
+			{ Input::MOD_SHIFT, "Shift" },
+			{ Input::MOD_ALT, "Alt" },
+			{ Input::MOD_SUPER, "Super" },
+		};
+
+		bool EqualsNoCase(const std::string & a, const char * b)
+		{
+			std::size_t i = 0;
+			for (; i < a.size() && b[i] != '\0'; ++i)
+			{
+				if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+					return false;
+			}
+			return i == a.size() && b[i] == '\0';
+		}
+	}
+
+	class ActionMap::ActionMap_impl
+	{
+	public:
+		ActionMap_impl();
+
+		ActionId AddAction(const char * name);
+		ActionId FindAction(const char * name) const;
+		const std::string & getActionName(ActionId action) const { return mvActions[action].mName; }
+		std::size_t getActionNum() const { return mvActions.size(); }
+
+		unsigned Bind(ActionId action, const Binding & binding);
+		void Rebind(ActionId action, unsigned index, const Binding & binding);
+		void Unbind(ActionId action);
+		const std::vector<Binding> & getBindings(ActionId action) const { return mvActions[action].mvBindings; }
+
+		void AddListener(ActionId action, listener action_listener);
+
+		unsigned char getFlags(ActionId action) const { return action < mvActions.size() ? mvActions[action].mFlags : 0; }
+
+		void ProcessKey(unsigned scancode, bool down, unsigned modifiers);
+		void ProcessMouseButton(unsigned button, bool down);
+		void ReleaseAll();
+		void Update();
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		/// \brief	A binding compiled into the lists of its key and its chord key.
+		struct Entry
+		{
+			ActionId	mAction;
+			unsigned	mSlot;
+			unsigned	mModifiers;
+			unsigned	mChord;
+			unsigned	mNext;			// next entry of the same key, or of the free list
+			unsigned	mNextChord;		// next entry with the same chord key
+			bool		mbActive;
+		};
+
+		struct Action
+		{
+			std::string				mName;
+			std::vector<Binding>	mvBindings;
+			std::vector<unsigned>	mvEntries;		// of each binding, INVALID_ENTRY if it couldn't be bound
+			std::vector<listener>	mvListeners;
+			unsigned				mActive{ 0 };	// bindings held
+			unsigned char			mFlags{ 0 };
+			bool					mbLatched{ false };	// activated since the last update, so a press
+														// and release in the same frame still triggers
+			bool					mbDirty{ false };
+		};
+
+		static unsigned getSlot(const Binding & binding);
+		static unsigned getSpecificity(const Entry & entry);
+		bool Matches(const Entry & entry) const;
+
+		unsigned Link(ActionId action, const Binding & binding);
+		void Unlink(unsigned entry);
+		void Activate(unsigned slot);
+		void Deactivate(unsigned slot);
+		void AddActive(ActionId action);
+		void RemoveActive(ActionId action);
+		void MarkDirty(ActionId action);
+
+		std::vector<Action>			mvActions;
+		std::vector<Entry>			mvEntries;
+		unsigned					mFreeEntry{ INVALID_ENTRY };
+		std::array<unsigned, SLOT_NUM>		mSlotHeads;
+		std::array<unsigned, SCANCODE_NUM>	mChordHeads;
+
+		std::bitset<SLOT_NUM>	mDown;
+		unsigned				mModifiers{ 0 };
+
+		// IMPORTANT(Borja): Both have capacity for all the actions, so marking them never allocates.
+		std::vector<ActionId>	mvDirty;
+		std::vector<ActionId>	mvUpdating;
+
+		Stats mStats;
+	};
+
+	ActionMap::ActionMap_impl::ActionMap_impl()
+	{
+		mSlotHeads.fill(INVALID_ENTRY);
+		mChordHeads.fill(INVALID_ENTRY);
+	}
+
+	ActionMap::ActionId ActionMap::ActionMap_impl::AddAction(const char * name)
+	{
+		const ActionId existing = FindAction(name);
+		if (existing != INVALID_ACTION)
+			return existing;
+
+		mvActions.emplace_back();
+		mvActions.back().mName = name;
+		mvDirty.reserve(mvActions.size());
+		mvUpdating.reserve(mvActions.size());
+		mStats.mActions = static_cast<unsigned>(mvActions.size());
+		return static_cast<ActionId>(mvActions.size() - 1);
+	}
+
+	ActionMap::ActionId ActionMap::ActionMap_impl::FindAction(const char * name) const
+	{
+		for (std::size_t i = 0; i < mvActions.size(); ++i)
+		{
+			if (mvActions[i].mName == name)
+				return static_cast<ActionId>(i);
+		}
+		return INVALID_ACTION;
+	}
+
+	unsigned ActionMap::ActionMap_impl::Bind(ActionId action, const Binding & binding)
+	{
+		Action & state = mvActions[action];
+		state.mvBindings.push_back(binding);
+		state.mvEntries.push_back(Link(action, binding));
+		return static_cast<unsigned>(state.mvBindings.size() - 1);
+	}
+
+	void ActionMap::ActionMap_impl::Rebind(ActionId action, unsigned index, const Binding & binding)
+	{
+		Action & state = mvActions[action];
+		if (index >= state.mvBindings.size())
+		{
+			Bind(action, binding);
+			return;
+		}
+		Unlink(state.mvEntries[index]);
+		state.mvBindings[index] = binding;
+		state.mvEntries[index] = Link(action, binding);
+	}
+
+	void ActionMap::ActionMap_impl::Unbind(ActionId action)
+	{
+		Action & state = mvActions[action];
+		for (const unsigned entry : state.mvEntries)
+			Unlink(entry);
+		state.mvBindings.clear();
+		state.mvEntries.clear();
+	}
+
+	void ActionMap::ActionMap_impl::AddListener(ActionId action, listener action_listener)
+	{
+		if (action_listener)
+			mvActions[action].mvListeners.push_back(action_listener);
+	}
+
+	unsigned ActionMap::ActionMap_impl::getSlot(const Binding & binding)
+	{
+		if (binding.mDevice == Device::Mouse)
+			return binding.mCode < MOUSE_BUTTON_NUM ? SCANCODE_NUM + binding.mCode : INVALID_ENTRY;
+		return binding.mCode < SCANCODE_NUM ? binding.mCode : INVALID_ENTRY;
+	}
+
+	unsigned ActionMap::ActionMap_impl::getSpecificity(const Entry & entry)
+	{
+		unsigned specificity = entry.mChord != 0 ? 1 : 0;
+		for (unsigned modifiers = entry.mModifiers; modifiers != 0; modifiers &= modifiers - 1)
+			++specificity;
+		return specificity;
+	}
+
+	bool ActionMap::ActionMap_impl::Matches(const Entry & entry) const
+	{
+		return (mModifiers & entry.mModifiers) == entry.mModifiers && (entry.mChord == 0 || mDown[entry.mChord]);
+	}
+
+	unsigned ActionMap::ActionMap_impl::Link(ActionId action, const Binding & binding)
+	{
+		const unsigned slot = getSlot(binding);
+		if (slot == INVALID_ENTRY || binding.mChord >= SCANCODE_NUM)
+		{
+			APP_LOG_WARNING(log::Category::Input, "Action {}: {} can't be bound", mvActions[action].mName, getBindingName(binding));
+			return INVALID_ENTRY;
+		}
+
+		unsigned entry = mFreeEntry;
+		if (entry != INVALID_ENTRY)
+		{
+			mFreeEntry = mvEntries[entry].mNext;
+		}
+		else
+		{
+			entry = static_cast<unsigned>(mvEntries.size());
+			mvEntries.emplace_back();
+		}
+
+		Entry & compiled = mvEntries[entry];
+		compiled.mAction = action;
+		compiled.mSlot = slot;
+		compiled.mModifiers = binding.mModifiers;
+		compiled.mChord = binding.mChord;
+		compiled.mbActive = false;
+		compiled.mNext = mSlotHeads[slot];
+		mSlotHeads[slot] = entry;
+		compiled.mNextChord = INVALID_ENTRY;
+		if (binding.mChord != 0)
+		{
+			compiled.mNextChord = mChordHeads[binding.mChord];
+			mChordHeads[binding.mChord] = entry;
+		}
+
+		++mStats.mBindings;
+		return entry;
+	}
+
+	void ActionMap::ActionMap_impl::Unlink(unsigned entry)
+	{
+		if (entry == INVALID_ENTRY)
+			return;
+
+		Entry & compiled = mvEntries[entry];
+		if (compiled.mbActive)
+		{
+			compiled.mbActive = false;
+			RemoveActive(compiled.mAction);
+		}
+
+		// the lists of a key are short, only the bindings of that key
+		auto unlink = [this, entry](unsigned & head, unsigned Entry::* next)
+		{
+			for (unsigned * link = &head; *link != INVALID_ENTRY; link = &(mvEntries[*link].*next))
+			{
+				if (*link == entry)
+				{
+					*link = mvEntries[entry].*next;
+					return;
+				}
+			}
+		};
+		unlink(mSlotHeads[compiled.mSlot], &Entry::mNext);
+		if (compiled.mChord != 0)
+			unlink(mChordHeads[compiled.mChord], &Entry::mNextChord);
+
+		compiled.mNext = mFreeEntry;
+		mFreeEntry = entry;
+		--mStats.mBindings;
+	}
+
+	void ActionMap::ActionMap_impl::ProcessKey(unsigned scancode, bool down, unsigned modifiers)
+	{
+		mModifiers = modifiers;
+		if (scancode >= SCANCODE_NUM || scancode == 0 || mDown[scancode] == down)
+			return;
+
+		mDown[scancode] = down;
+		if (down)
+		{
+			Activate(scancode);
+			return;
+		}
+
+		Deactivate(scancode);
+		// releasing the chord key releases the bindings that needed it
+		for (unsigned entry = mChordHeads[scancode]; entry != INVALID_ENTRY; entry = mvEntries[entry].mNextChord)
+		{
+			Entry & compiled = mvEntries[entry];
+			if (compiled.mbActive)
+			{
+				compiled.mbActive = false;
+				RemoveActive(compiled.mAction);
+			}
+		}
+	}
+
+	void ActionMap::ActionMap_impl::ProcessMouseButton(unsigned button, bool down)
+	{
+		if (button >= MOUSE_BUTTON_NUM)
+			return;
+
+		const unsigned slot = SCANCODE_NUM + button;
+		if (mDown[slot] == down)
+			return;
+		mDown[slot] = down;
+		if (down)	Activate(slot);
+		else		Deactivate(slot);
+	}
+
+	void ActionMap::ActionMap_impl::ReleaseAll()
+	{
+		for (unsigned slot = 0; slot < SLOT_NUM; ++slot)
+		{
+			if (mDown[slot])
+				Deactivate(slot);
+		}
+		mDown.reset();
+		mModifiers = 0;
+	}
+
+	void ActionMap::ActionMap_impl::Activate(unsigned slot)
+	{
+		// only the most specific bindings that match are activated
+		unsigned best = 0;
+		bool found = false;
+		for (unsigned entry = mSlotHeads[slot]; entry != INVALID_ENTRY; entry = mvEntries[entry].mNext)
+		{
+			const Entry & compiled = mvEntries[entry];
+			if (Matches(compiled) && (!found || getSpecificity(compiled) > best))
+			{
+				best = getSpecificity(compiled);
+				found = true;
+			}
+		}
+		if (!found)
+			return;
+
+		for (unsigned entry = mSlotHeads[slot]; entry != INVALID_ENTRY; entry = mvEntries[entry].mNext)
+		{
+			Entry & compiled = mvEntries[entry];
+			if (!compiled.mbActive && Matches(compiled) && getSpecificity(compiled) == best)
+			{
+				compiled.mbActive = true;
+				AddActive(compiled.mAction);
+			}
+		}
+	}
+
+	void ActionMap::ActionMap_impl::Deactivate(unsigned slot)
+	{
+		for (unsigned entry = mSlotHeads[slot]; entry != INVALID_ENTRY; entry = mvEntries[entry].mNext)
+		{
+			Entry & compiled = mvEntries[entry];
+			if (compiled.mbActive)
+			{
+				compiled.mbActive = false;
+				RemoveActive(compiled.mAction);
+			}
+		}
+	}
+
+	void ActionMap::ActionMap_impl::AddActive(ActionId action)
+	{
+		Action & state = mvActions[action];
+		if (state.mActive++ == 0)
+		{
+			state.mbLatched = true;
+			MarkDirty(action);
+		}
+	}
+
+	void ActionMap::ActionMap_impl::RemoveActive(ActionId action)
+	{
+		Action & state = mvActions[action];
+		if (--state.mActive == 0)
+			MarkDirty(action);
+	}
+
+	void ActionMap::ActionMap_impl::MarkDirty(ActionId action)
+	{
+		Action & state = mvActions[action];
+		if (!state.mbDirty)
+		{
+			state.mbDirty = true;
+			mvDirty.push_back(action);
+		}
+	}
+
+	void ActionMap::ActionMap_impl::Update()
+	{
+		mStats.mChanged = 0;
+		mStats.mDispatched = 0;
+
+		// the actions whose flags have to change next frame are marked again while updating
+		mvUpdating.swap(mvDirty);
+		for (const ActionId action : mvUpdating)
+		{
+			Action & state = mvActions[action];
+			state.mbDirty = false;
+
+			const bool was_pressed = (state.mFlags & PRESSED_FLAG) != 0;
+			unsigned char flags = 0;
+			if (state.mbLatched && !was_pressed)	flags = PRESSED_FLAG | TRIGGERED_FLAG;
+			else if (state.mActive > 0)				flags = PRESSED_FLAG;
+			else if (was_pressed)					flags = RELEASED_FLAG;
+			state.mbLatched = false;
+			state.mFlags = flags;
+			++mStats.mChanged;
+
+			if (flags & (TRIGGERED_FLAG | RELEASED_FLAG))
+			{
+				const Phase phase = (flags & TRIGGERED_FLAG) ? Phase::Triggered : Phase::Released;
+				for (const listener & action_listener : state.mvListeners)
+					action_listener(action, phase);
+				mStats.mDispatched += static_cast<unsigned>(state.mvListeners.size());
+			}
+
+			// clear the edge next frame, and release the presses that didn't last a frame
+			if ((flags & (TRIGGERED_FLAG | RELEASED_FLAG)) != 0 || (flags != 0 && state.mActive == 0))
+				MarkDirty(action);
+		}
+		mvUpdating.clear();
+	}
+
+	ActionMap::ActionMap()
+		: mpImpl(std::make_unique<ActionMap_impl>())
+	{}
+	ActionMap::~ActionMap()
+	{}
+
+	ActionMap::ActionId ActionMap::AddAction(const char * name)
+	{
+		return mpImpl->AddAction(name);
+	}
+	ActionMap::ActionId ActionMap::FindAction(const char * name) const
+	{
+		return mpImpl->FindAction(name);
+	}
+	const std::string & ActionMap::getActionName(ActionId action) const
+	{
+		return mpImpl->getActionName(action);
+	}
+	std::size_t ActionMap::getActionNum() const
+	{
+		return mpImpl->getActionNum();
+	}
+
+	unsigned ActionMap::Bind(ActionId action, const Binding & binding)
+	{
+		return mpImpl->Bind(action, binding);
+	}
+	void ActionMap::Rebind(ActionId action, unsigned index, const Binding & binding)
+	{
+		mpImpl->Rebind(action, index, binding);
+	}
+	void ActionMap::Unbind(ActionId action)
+	{
+		mpImpl->Unbind(action);
+	}
+	const std::vector<ActionMap::Binding> & ActionMap::getBindings(ActionId action) const
+	{
+		return mpImpl->getBindings(action);
+	}
+
+	bool ActionMap::ParseBinding(const char * text, Binding & binding)
+	{
+		binding = Binding();
+		bool has_key = false;
+
+		std::string token;
+		for (const char * c = text; ; ++c)
+		{
+			if (*c != '+' && *c != '\0')
+			{
+				token += *c;
+				continue;
+			}
+
+			// trim
+			const std::size_t begin = token.find_first_not_of(" \t");
+			const std::size_t end = token.find_last_not_of(" \t");
+			token = begin == std::string::npos ? std::string() : token.substr(begin, end - begin + 1);
+			if (token.empty())
+				return false;
+
+			unsigned modifier = 0;
+			for (const auto & named : s_Modifiers)
+			{
+				if (EqualsNoCase(token, named.mName))
+					modifier = named.mModifier;
+			}
+
+			if (modifier != 0)
+			{
+				binding.mModifiers |= modifier;
+			}
+			else
+			{
+				// a key before the last one is held with it
+				if (has_key)
+				{
+					if (binding.mDevice != Device::Keyboard)
+						return false;
+					binding.mChord = binding.mCode;
+				}
+
+				if (token.size() > 5 && EqualsNoCase(token.substr(0, 5), "mouse"))
+				{
+					binding.mDevice = Device::Mouse;
+					binding.mCode = static_cast<unsigned>(std::atoi(token.c_str() + 5));
+					if (binding.mCode == 0 || binding.mCode >= MOUSE_BUTTON_NUM)
+						return false;
+				}
+				else
+				{
+					const SDL_Scancode scancode = SDL_GetScancodeFromName(token.c_str());
+					if (scancode == SDL_SCANCODE_UNKNOWN)
+						return false;
+					binding.mDevice = Device::Keyboard;
+					binding.mCode = static_cast<unsigned>(scancode);
+				}
+				has_key = true;
+			}
+
+			if (*c == '\0')
+				break;
+			token.clear();
+		}
+		return has_key;
+	}
+
+	std::string ActionMap::getBindingName(const Binding & binding)
+	{
+		std::string name;
+		for (const auto & named : s_Modifiers)
+		{
+			if (binding.mModifiers & named.mModifier)
+				(name += named.mName) += '+';
+		}
+		if (binding.mChord != 0)
+			(name += SDL_GetScancodeName(static_cast<SDL_Scancode>(binding.mChord))) += '+';
+		if (binding.mDevice == Device::Mouse)
+			name += "Mouse " + std::to_string(binding.mCode);
+		else
+			name += SDL_GetScancodeName(static_cast<SDL_Scancode>(binding.mCode));
+		return name;
+	}
+
+	void ActionMap::AddListener(ActionId action, listener action_listener)
+	{
+		mpImpl->AddListener(action, action_listener);
+	}
+
+	bool ActionMap::ActionTriggered(ActionId action) const
+	{
+		return (mpImpl->getFlags(action) & TRIGGERED_FLAG) != 0;
+	}
+	bool ActionMap::ActionPressed(ActionId action) const
+	{
+		return (mpImpl->getFlags(action) & PRESSED_FLAG) != 0;
+	}
+	bool ActionMap::ActionReleased(ActionId action) const
+	{
+		return (mpImpl->getFlags(action) & RELEASED_FLAG) != 0;
+	}
+
+	void ActionMap::ProcessKey(unsigned scancode, bool down, unsigned modifiers)
+	{
+		mpImpl->ProcessKey(scancode, down, modifiers);
+	}
+	void ActionMap::ProcessMouseButton(unsigned button, bool down)
+	{
+		mpImpl->ProcessMouseButton(button, down);
+	}
+	void ActionMap::ReleaseAll()
+	{
+		mpImpl->ReleaseAll();
+	}
+	void ActionMap::Update()
+	{
+		mpImpl->Update();
+	}
+
+	const ActionMap::Stats & ActionMap::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
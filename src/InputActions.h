@@ -0,0 +1,107 @@
+/*!
+\brief	Named actions bound to keys, mouse buttons and chords, with their state updated once per frame.
+*/
+
+#pragma once
+
+#include "Delegate.h"	// app::Delegate
+
+#include <vector>		// std::vector
+#include <string>		// std::string
+#include <memory>		// std::unique_ptr
+
+namespace app
+{
+	/// \brief	The game asks for actions ("Jump", "Save") instead of keys, so the keys can be rebound.
+	/// The bindings are compiled into a table indexed by scancode (and mouse button) so an event only
+	/// visits the bindings of its key, and only the actions that changed are visited every frame.
+	/// When several bindings of the same key match, the most specific one wins: with "S" and "Ctrl+S"
+	/// bound, pressing Ctrl+S only activates the second.
+	/// Owned by app::Input, which feeds it the events. Actions are identified by their index.
+	class ActionMap
+	{
+	public:
+		using ActionId = unsigned;
+		static const ActionId INVALID_ACTION = ~0u;
+
+		enum class Phase
+		{
+			Triggered,
+			Released,
+		};
+		/// \brief	Called from Input::Update the frame the action is triggered or released.
+		/// IMPORTANT(Borja): Listeners can't add actions or change the bindings.
+		using listener = Delegate<void(ActionId action, Phase phase)>;
+
+		enum class Device : unsigned char
+		{
+			Keyboard,
+			Mouse,
+		};
+
+		struct Binding
+		{
+			Device		mDevice{ Device::Keyboard };
+			unsigned	mCode{ 0 };			// SDL_Scancode or Input::MouseButtons
+			unsigned	mModifiers{ 0 };	// Input::KeyModifiers held with it
+			unsigned	mChord{ 0 };		// SDL_Scancode of another key held with it, 0 if none
+		};
+
+		struct Stats
+		{
+			unsigned	mActions{ 0 };
+			unsigned	mBindings{ 0 };
+			unsigned	mChanged{ 0 };		// actions visited by the last Update
+			unsigned	mDispatched{ 0 };	// listener calls of the last Update
+		};
+
+		ActionMap();
+		~ActionMap();
+		ActionMap(const ActionMap &) = delete;
+		ActionMap & operator=(const ActionMap &) = delete;
+
+		/// \return	The action with that name, created if it doesn't exist.
+		ActionId AddAction(const char * name);
+		/// \return	INVALID_ACTION if there isn't an action with that name.
+		ActionId FindAction(const char * name) const;
+		const std::string & getActionName(ActionId action) const;
+		std::size_t getActionNum() const;
+
+		/// \brief	Only the lists of the keys of the binding are touched, the rest of the table is kept.
+		/// \return	Index of the binding in the action.
+		unsigned Bind(ActionId action, const Binding & binding);
+		/// \brief	Replaces one binding, i.e. to rebind it from the settings while the game runs.
+		void Rebind(ActionId action, unsigned index, const Binding & binding);
+		/// \brief	Removes all the bindings of the action, released if it was pressed.
+		void Unbind(ActionId action);
+		const std::vector<Binding> & getBindings(ActionId action) const;
+
+		/// \brief	Reads bindings as "Space", "Ctrl+S", "Mouse 1" or "Tab+W" (a chord), the key names
+		/// are the SDL ones. Returns false if a key name is unknown.
+		static bool ParseBinding(const char * text, Binding & binding);
+		static std::string getBindingName(const Binding & binding);
+
+		void AddListener(ActionId action, listener action_listener);
+
+		/// \return	True the first frame the action is pressed.
+		bool ActionTriggered(ActionId action) const;
+		/// \return	True while the action is pressed.
+		bool ActionPressed(ActionId action) const;
+		/// \return	True the frame after the action was released.
+		bool ActionReleased(ActionId action) const;
+
+		/// \brief	Events as app::Input receives them, key repeats have to be filtered before.
+		void ProcessKey(unsigned scancode, bool down, unsigned modifiers);
+		void ProcessMouseButton(unsigned button, bool down);
+		/// \brief	Releases everything, i.e. when the window loses the focus.
+		void ReleaseAll();
+		/// \brief	Updates the state of the actions that changed since the last call and calls their listeners.
+		void Update();
+
+		const Stats & getStats() const;
+
+	private:
+		class ActionMap_impl;
+		std::unique_ptr<ActionMap_impl> mpImpl;
+	};
+}
@@ -0,0 +1,381 @@
+/*!
+\brief	Work-stealing job system to spread the per-frame work over all the cores.
+*/
+
+#include "JobSystem.h"
+
+#include <thread>				// std::thread, std::this_thread
+#include <condition_variable>	// std::condition_variable
+#include <deque>				// std::deque
+#include <algorithm>			// std::min, std::max
+#include <chrono>				// std::chrono::high_resolution_clock
+
+namespace app
+{
+	namespace
+	{
+		/// \brief	Job system of the worker threads, and the index of their deque.
+		thread_local const void * t_pJobSystem = nullptr;
+		thread_local unsigned t_QueueIndex = 0;
+	}
+
+	class JobSystem::JobSystem_impl
+	{
+	public:
+		explicit JobSystem_impl(unsigned worker_count);
+		~JobSystem_impl();
+
+		void Run(Job job, JobCounter * counter);
+		void Run(Job job, JobCounter * counter, JobCounter & dependency);
+		void RunOnMainThread(Job job, JobCounter * counter);
+		void ParallelFor(std::size_t count, std::size_t grain, RangeJob body, JobCounter * counter);
+
+		void Wait(JobCounter & counter);
+		void RunMainThreadJobs();
+
+		void NewFrame();
+		JobCounter & getFrameCounter() { return mFrameCounter; }
+		void JoinFrame();
+
+		unsigned getWorkerCount() const { return static_cast<unsigned>(mvWorkers.size()); }
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		struct QueuedJob
+		{
+			Job				mFunction;
+			JobCounter *	mpCounter;
+		};
+		/// \brief	The owner pushes and pops from the back, the thieves steal from the front.
+		struct WorkerQueue
+		{
+			std::mutex				mMutex;
+			std::deque<QueuedJob>	mJobs;
+		};
+
+		/// \brief	Queues the job in the deque of the calling thread and wakes up a worker.
+		void Push(QueuedJob job);
+		/// \brief	Runs a job of the queue, or one stolen from another queue.
+		/// \return	False if all the queues were empty.
+		bool TryRunJob(unsigned queue_index);
+		void Execute(QueuedJob & job);
+		void WorkerLoop(unsigned queue_index);
+		/// \return	Deque of the calling thread, the threads that aren't workers use the one of the main thread.
+		unsigned getQueueIndex() const;
+
+		std::vector<std::unique_ptr<WorkerQueue>> mvQueues;	// 0 belongs to the main thread
+		std::vector<std::thread> mvWorkers;
+		std::atomic<unsigned> mQueuedJobs{ 0 };
+
+		// the idle workers sleep until a job is pushed
+		std::mutex mSleepMutex;
+		std::condition_variable mWakeUp;
+		bool mbQuit{ false };
+
+		std::thread::id mMainThread;
+		std::mutex mMainThreadMutex;
+		std::vector<QueuedJob> mvMainThreadJobs;
+		std::vector<QueuedJob> mvRunningMainThreadJobs;
+
+		JobCounter mFrameCounter;
+
+		// accumulated during the frame, moved to mStats in NewFrame
+		std::atomic<unsigned> mJobs{ 0 };
+		std::atomic<unsigned> mSteals{ 0 };
+		std::atomic<unsigned> mMainThreadJobs{ 0 };
+		Stats mStats;
+	};
+
+	JobSystem::JobSystem_impl::JobSystem_impl(unsigned worker_count)
+		: mMainThread(std::this_thread::get_id())
+	{
+		mvQueues.reserve(worker_count + 1);
+		for (unsigned i = 0; i < worker_count + 1; ++i)
+			mvQueues.push_back(std::make_unique<WorkerQueue>());
+
+		mvWorkers.reserve(worker_count);
+		for (unsigned i = 0; i < worker_count; ++i)
+			mvWorkers.emplace_back([this, i]() { WorkerLoop(i + 1); });
+
+		mStats.mWorkers = worker_count;
+	}
+	JobSystem::JobSystem_impl::~JobSystem_impl()
+	{
+		// the jobs still queued can push more jobs, run everything before stopping the workers
+		const unsigned index = getQueueIndex();
+		do
+		{
+			RunMainThreadJobs();
+			while (TryRunJob(index)) {}
+		} while (mQueuedJobs.load() > 0);
+
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+			mbQuit = true;
+		}
+		mWakeUp.notify_all();
+		for (std::thread & worker : mvWorkers)
+			worker.join();
+	}
+
+	void JobSystem::JobSystem_impl::Run(Job job, JobCounter * counter)
+	{
+		if (counter)
+			AddPending(*counter);
+		Push(QueuedJob{ std::move(job), counter });
+	}
+	void JobSystem::JobSystem_impl::Run(Job job, JobCounter * counter, JobCounter & dependency)
+	{
+		// the counter is incremented now so that waiting for it also waits for the dependency
+		if (counter)
+			AddPending(*counter);
+
+		const QueuedJob queued{ std::move(job), counter };
+		if (!AddContinuation(dependency, [this, queued]() { Push(queued); }))
+			Push(queued);
+	}
+	void JobSystem::JobSystem_impl::RunOnMainThread(Job job, JobCounter * counter)
+	{
+		if (counter)
+			AddPending(*counter);
+
+		std::lock_guard<std::mutex> lock(mMainThreadMutex);
+		mvMainThreadJobs.push_back(QueuedJob{ std::move(job), counter });
+	}
+	void JobSystem::JobSystem_impl::ParallelFor(std::size_t count, std::size_t grain, RangeJob body, JobCounter * counter)
+	{
+		if (count == 0)
+			return;
+
+		// a few ranges per thread, so that the threads that finish early can steal the rest
+		if (grain == 0)
+			grain = std::max<std::size_t>(count / (4 * mvQueues.size()), 1);
+
+		// shared by the jobs of all the ranges
+		const std::shared_ptr<const RangeJob> shared_body = std::make_shared<const RangeJob>(std::move(body));
+		for (std::size_t begin = 0; begin < count; begin += grain)
+		{
+			const std::size_t end = std::min(begin + grain, count);
+			Run([shared_body, begin, end]() { (*shared_body)(begin, end); }, counter);
+		}
+	}
+
+	void JobSystem::JobSystem_impl::Wait(JobCounter & counter)
+	{
+		const bool main_thread = std::this_thread::get_id() == mMainThread;
+		const unsigned index = getQueueIndex();
+		while (!counter.isDone())
+		{
+			if (main_thread)
+				RunMainThreadJobs();
+			if (!TryRunJob(index))
+				std::this_thread::yield();
+		}
+	}
+	void JobSystem::JobSystem_impl::RunMainThreadJobs()
+	{
+		if (std::this_thread::get_id() != mMainThread)
+			return;
+
+		// the jobs can queue more main thread jobs
+		while (true)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMainThreadMutex);
+				mvRunningMainThreadJobs.swap(mvMainThreadJobs);
+			}
+			if (mvRunningMainThreadJobs.empty())
+				break;
+
+			for (QueuedJob & job : mvRunningMainThreadJobs)
+				Execute(job);
+			mMainThreadJobs.fetch_add(static_cast<unsigned>(mvRunningMainThreadJobs.size()), std::memory_order_relaxed);
+			mvRunningMainThreadJobs.clear();
+		}
+	}
+
+	void JobSystem::JobSystem_impl::NewFrame()
+	{
+		mStats.mJobs = mJobs.exchange(0, std::memory_order_relaxed);
+		mStats.mSteals = mSteals.exchange(0, std::memory_order_relaxed);
+		mStats.mMainThreadJobs = mMainThreadJobs.exchange(0, std::memory_order_relaxed);
+	}
+	void JobSystem::JobSystem_impl::JoinFrame()
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		Wait(mFrameCounter);
+		RunMainThreadJobs();
+		mStats.mJoinMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void JobSystem::JobSystem_impl::Push(QueuedJob job)
+	{
+		WorkerQueue & queue = *mvQueues[getQueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mMutex);
+			queue.mJobs.push_back(std::move(job));
+		}
+		mQueuedJobs.fetch_add(1);
+
+		// IMPORTANT(Borja): Taking the lock makes sure that a worker that has just seen no jobs
+		// is already waiting, otherwise the notification could get lost.
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+		}
+		mWakeUp.notify_one();
+	}
+	bool JobSystem::JobSystem_impl::TryRunJob(unsigned queue_index)
+	{
+		QueuedJob job{ nullptr, nullptr };
+		bool found = false;
+		{
+			WorkerQueue & queue = *mvQueues[queue_index];
+			std::lock_guard<std::mutex> lock(queue.mMutex);
+			if (!queue.mJobs.empty())
+			{
+				job = std::move(queue.mJobs.back());
+				queue.mJobs.pop_back();
+				found = true;
+			}
+		}
+
+		// steal the oldest job of the next thread that has any
+		const std::size_t queue_count = mvQueues.size();
+		for (std::size_t i = 1; i < queue_count && !found; ++i)
+		{
+			WorkerQueue & victim = *mvQueues[(queue_index + i) % queue_count];
+			std::lock_guard<std::mutex> lock(victim.mMutex);
+			if (!victim.mJobs.empty())
+			{
+				job = std::move(victim.mJobs.front());
+				victim.mJobs.pop_front();
+				found = true;
+				mSteals.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (!found)
+			return false;
+
+		mQueuedJobs.fetch_sub(1);
+		Execute(job);
+		return true;
+	}
+	void JobSystem::JobSystem_impl::Execute(QueuedJob & job)
+	{
+		job.mFunction();
+		mJobs.fetch_add(1, std::memory_order_relaxed);
+
+		if (job.mpCounter)
+		{
+			std::vector<std::function<void()>> continuations;
+			FinishPending(*job.mpCounter, continuations);
+			for (const std::function<void()> & continuation : continuations)
+				continuation();
+		}
+	}
+	void JobSystem::JobSystem_impl::WorkerLoop(unsigned queue_index)
+	{
+		t_pJobSystem = this;
+		t_QueueIndex = queue_index;
+
+		while (true)
+		{
+			if (TryRunJob(queue_index))
+				continue;
+
+			std::unique_lock<std::mutex> lock(mSleepMutex);
+			mWakeUp.wait(lock, [this]() { return mbQuit || mQueuedJobs.load() > 0; });
+			if (mbQuit && mQueuedJobs.load() == 0)
+				break;
+		}
+
+		t_pJobSystem = nullptr;
+	}
+	unsigned JobSystem::JobSystem_impl::getQueueIndex() const
+	{
+		return t_pJobSystem == this ? t_QueueIndex : 0;
+	}
+
+	JobSystem::JobSystem(unsigned worker_count)
+		: mpImpl(std::make_unique<JobSystem_impl>(worker_count))
+	{}
+	JobSystem::~JobSystem() {}
+
+	void JobSystem::Run(Job job, JobCounter * counter)
+	{
+		mpImpl->Run(std::move(job), counter);
+	}
+	void JobSystem::Run(Job job, JobCounter * counter, JobCounter & dependency)
+	{
+		mpImpl->Run(std::move(job), counter, dependency);
+	}
+	void JobSystem::RunOnMainThread(Job job, JobCounter * counter)
+	{
+		mpImpl->RunOnMainThread(std::move(job), counter);
+	}
+	void JobSystem::ParallelFor(std::size_t count, std::size_t grain, RangeJob body, JobCounter * counter)
+	{
+		mpImpl->ParallelFor(count, grain, std::move(body), counter);
+	}
+	void JobSystem::ParallelFor(std::size_t count, std::size_t grain, RangeJob body)
+	{
+		JobCounter counter;
+		mpImpl->ParallelFor(count, grain, std::move(body), &counter);
+		mpImpl->Wait(counter);
+	}
+	void JobSystem::Wait(JobCounter & counter)
+	{
+		mpImpl->Wait(counter);
+	}
+	void JobSystem::RunMainThreadJobs()
+	{
+		mpImpl->RunMainThreadJobs();
+	}
+	void JobSystem::NewFrame()
+	{
+		mpImpl->NewFrame();
+	}
+	JobCounter & JobSystem::getFrameCounter()
+	{
+		return mpImpl->getFrameCounter();
+	}
+	void JobSystem::JoinFrame()
+	{
+		mpImpl->JoinFrame();
+	}
+	unsigned JobSystem::getWorkerCount() const
+	{
+		return mpImpl->getWorkerCount();
+	}
+	const JobSystem::Stats & JobSystem::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+	unsigned JobSystem::getDefaultWorkerCount()
+	{
+		const unsigned cores = std::thread::hardware_concurrency();
+		return cores > 1 ? cores - 1 : 0;
+	}
+
+	void JobSystem::AddPending(JobCounter & counter)
+	{
+		counter.mPending.fetch_add(1, std::memory_order_relaxed);
+	}
+	void JobSystem::FinishPending(JobCounter & counter, std::vector<std::function<void()>> & continuations)
+	{
+		// IMPORTANT(Borja): The counter can be destroyed as soon as it reaches zero, the decrement
+		// happens with the lock held and ~JobCounter takes it, so it waits until we are done.
+		std::lock_guard<std::mutex> lock(counter.mMutex);
+		if (counter.mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			continuations.swap(counter.mvContinuations);
+	}
+	bool JobSystem::AddContinuation(JobCounter & counter, std::function<void()> continuation)
+	{
+		std::lock_guard<std::mutex> lock(counter.mMutex);
+		if (counter.mPending.load(std::memory_order_acquire) == 0)
+			return false;
+		counter.mvContinuations.push_back(std::move(continuation));
+		return true;
+	}
+}
@@ -0,0 +1,109 @@
+/*!
+\brief	Work-stealing job system to spread the per-frame work over all the cores.
+*/
+
+#pragma once
+
+#include <memory>		// std::unique_ptr
+#include <functional>	// std::function
+#include <atomic>		// std::atomic
+#include <mutex>		// std::mutex
+#include <vector>		// std::vector
+#include <cstddef>		// std::size_t
+
+namespace app
+{
+	/// \brief	Number of jobs that haven't finished yet, JobSystem::Wait returns when it reaches zero
+	/// and the jobs that depend on it are started.
+	/// IMPORTANT(Borja): Needs to outlive the jobs that signal it.
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		/// \brief	Waits until the job that brought it to zero has released it.
+		~JobCounter() { std::lock_guard<std::mutex> lock(mMutex); }
+		JobCounter(const JobCounter &) = delete;
+		JobCounter & operator=(const JobCounter &) = delete;
+
+		bool isDone() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<unsigned> mPending{ 0 };
+		/// \brief	Schedules the jobs waiting for the counter, protected by mMutex.
+		std::vector<std::function<void()>> mvContinuations;
+		std::mutex mMutex;
+	};
+
+	/// \brief	Runs jobs on a worker thread per core (the main thread is one more worker while it waits).
+	/// Every thread pushes and pops its jobs from the back of its own deque, the idle threads steal
+	/// from the front of the others.
+	/// The jobs that need the main thread (GL calls, SDL events...) are queued with
+	/// JobSystem::RunOnMainThread and run by JobSystem::RunMainThreadJobs or while the main thread waits.
+	class JobSystem
+	{
+	public:
+		typedef std::function<void()> Job;
+		/// \brief	Processes the elements [begin, end) of a JobSystem::ParallelFor.
+		typedef std::function<void(std::size_t begin, std::size_t end)> RangeJob;
+
+		struct Stats
+		{
+			unsigned	mWorkers{ 0 };			// worker threads, without the main thread
+			unsigned	mJobs{ 0 };				// jobs run in the last frame
+			unsigned	mSteals{ 0 };			// jobs stolen from other threads in the last frame
+			unsigned	mMainThreadJobs{ 0 };	// jobs run on the main thread in the last frame
+			double		mJoinMs{ 0.0 };			// time the main thread spent in JobSystem::JoinFrame
+		};
+
+		/// \param	worker_count	Threads created besides the main thread,
+		/// by default one less than the number of cores.
+		explicit JobSystem(unsigned worker_count = getDefaultWorkerCount());
+		/// \brief	Runs the jobs that are still queued before joining the workers.
+		~JobSystem();
+		JobSystem(const JobSystem &) = delete;
+		JobSystem & operator=(const JobSystem &) = delete;
+
+		/// \brief	Queues the job in the deque of the calling thread.
+		/// \param	counter	Incremented now and decremented when the job finishes, can be nullptr.
+		void Run(Job job, JobCounter * counter = nullptr);
+		/// \brief	Queues the job once the dependency reaches zero.
+		void Run(Job job, JobCounter * counter, JobCounter & dependency);
+		/// \brief	Queues a job that can only run on the thread that created the JobSystem.
+		void RunOnMainThread(Job job, JobCounter * counter = nullptr);
+
+		/// \brief	Splits [0, count) in ranges of grain elements (0 picks one) and runs a job per range.
+		void ParallelFor(std::size_t count, std::size_t grain, RangeJob body, JobCounter * counter);
+		/// \brief	Same as above but returns when all the ranges have been processed.
+		void ParallelFor(std::size_t count, std::size_t grain, RangeJob body);
+
+		/// \brief	Runs jobs (and the main thread jobs when called from the main thread)
+		/// until the counter reaches zero.
+		void Wait(JobCounter & counter);
+		/// \brief	Runs the jobs queued with JobSystem::RunOnMainThread, only from the main thread.
+		void RunMainThreadJobs();
+
+		/// \brief	Starts a frame, the per-frame jobs should use JobSystem::getFrameCounter.
+		void NewFrame();
+		JobCounter & getFrameCounter();
+		/// \brief	Waits for the jobs of the frame and runs the main thread jobs,
+		/// needs to be called between the update and the render.
+		void JoinFrame();
+
+		unsigned getWorkerCount() const;
+		const Stats & getStats() const;
+
+		static unsigned getDefaultWorkerCount();
+
+	private:
+		// access to the internals of JobCounter for JobSystem_impl
+		static void AddPending(JobCounter & counter);
+		/// \brief	Moves the continuations to the vector if the counter reaches zero.
+		static void FinishPending(JobCounter & counter, std::vector<std::function<void()>> & continuations);
+		/// \return	False if the counter is already done, the continuation needs to be run by the caller.
+		static bool AddContinuation(JobCounter & counter, std::function<void()> continuation);
+
+		class JobSystem_impl;
+		std::unique_ptr<JobSystem_impl> mpImpl;
+	};
+}
@@ -0,0 +1,633 @@
+/*!
+\brief	Asynchronous logger: the threads write binary records that a background thread formats and writes.
+*/
+
+#include "Log.h"
+
+#include <vector>				// std::vector
+#include <memory>				// std::unique_ptr
+#include <algorithm>			// std::min, std::stable_sort
+#include <chrono>				// std::chrono::high_resolution_clock
+#include <thread>				// std::thread
+#include <mutex>				// std::mutex
+#include <condition_variable>	// std::condition_variable
+#include <fstream>				// std::ofstream
+#include <iostream>				// std::cout
+#include <cstdio>				// std::snprintf
+#include <cstring>				// std::memcpy, std::strlen
+#include <cstddef>				// offsetof
+
+namespace app
+{
+	namespace log
+	{
+		namespace detail
+		{
+			std::atomic<std::uint32_t> g_EnabledMask{ 0 };
+
+			/// \brief	The record is encoded in the thread before copying it to the ring buffer at once.
+			class RecordWriter
+			{
+			public:
+				static const std::size_t MAX_SIZE = 512;
+
+				bool Append(const void * data, std::size_t size)
+				{
+					if (size > MAX_SIZE - mSize)
+						return false;
+					std::memcpy(mData + mSize, data, size);
+					mSize += size;
+					return true;
+				}
+
+				unsigned char	mData[MAX_SIZE];
+				std::size_t		mSize;
+				std::uint16_t	mArgCount;
+			};
+		}
+
+		namespace
+		{
+			typedef std::chrono::high_resolution_clock Clock;
+
+			/// \brief	Bytes of the ring buffer of every thread, power of two.
+			const std::size_t s_BufferSize = 64 * 1024;
+			/// \brief	Maximum time the sink waits before writing the records.
+			const std::chrono::milliseconds s_SinkPeriod{ 5 };
+
+			enum class ArgType : unsigned char
+			{
+				Bool, Char, Int, UInt, Double, String, Pointer,
+			};
+
+			/// \brief	Fixed part of every record, followed by the arguments.
+			struct RecordHeader
+			{
+				std::uint32_t	mSize;		// of the whole record
+				Severity		mSeverity;
+				Category		mCategory;
+				std::uint16_t	mArgCount;
+				const char *	mFormat;
+				long long		mTime;		// nanoseconds since the logger was started
+			};
+
+			/// \brief	Lock free ring of a single producer (its thread) and a single consumer (the sink).
+			struct ThreadBuffer
+			{
+				ThreadBuffer() : mpData(new unsigned char[s_BufferSize]) {}
+
+				std::atomic<std::size_t>	mHead{ 0 };		// written by the producer
+				char						mPadding0[64];	// keeps the indices in different cache lines
+				std::atomic<std::size_t>	mTail{ 0 };		// written by the consumer
+				char						mPadding1[64];
+				std::atomic<unsigned>		mDropped{ 0 };
+				std::atomic<bool>			mbOwned{ true };	// false once its thread exits
+				std::unique_ptr<unsigned char[]>	mpData;
+			};
+
+			/// \brief	Gives the buffer back when its thread exits, the next thread that logs reuses it.
+			/// The records still in it are drained as usual, the ring only ever has one producer at a time.
+			struct ThreadBufferOwner
+			{
+				~ThreadBufferOwner()
+				{
+					if (mpBuffer)
+						mpBuffer->mbOwned.store(false, std::memory_order_release);
+				}
+
+				ThreadBuffer * mpBuffer{ nullptr };
+			};
+
+			struct Logger
+			{
+				Clock::time_point mStart{ Clock::now() };
+				Severity mMinSeverity{ Severity::Debug };
+				std::uint32_t mDisabledCategories{ 0 };
+
+				/// \brief	Stops the sink if the application didn't.
+				~Logger();
+
+				// the buffers of all the threads, a thread finds its own with t_Buffer
+				// IMPORTANT(Borja): They are never released, a thread can be writing to its buffer at any
+				// time. The buffers of the threads that exited are reused by the new ones instead.
+				std::mutex mBuffersMutex;
+				std::vector<std::unique_ptr<ThreadBuffer>> mvBuffers;
+
+				std::atomic<bool> mbRunning{ false };
+				std::thread mThread;
+				std::mutex mWakeMutex;
+				std::condition_variable mWakeUp;
+				std::condition_variable mFlushed;
+				std::atomic<bool> mbWakeRequested{ false };
+				bool mbQuit{ false };
+				unsigned long long mFlushRequests{ 0 };
+				unsigned long long mFlushedRequests{ 0 };
+
+				std::ofstream mFile;
+				std::ostream * mpOutput{ &std::cout };
+				std::mutex mSyncMutex;		// writes before starting the sink
+
+				std::atomic<unsigned long long> mWritten{ 0 };
+				unsigned long long mDroppedReported{ 0 };
+				std::atomic<unsigned long long> mDropped{ 0 };
+
+				// used by the sink only
+				struct Line
+				{
+					long long	mTime;
+					std::string	mText;
+				};
+				std::vector<Line> mvLines;
+				std::vector<unsigned char> mvRecord;
+			};
+			Logger & get_logger()
+			{
+				static Logger logger;
+				return logger;
+			}
+
+			thread_local ThreadBufferOwner t_Buffer;
+			thread_local detail::RecordWriter t_Record;
+
+			void UpdateEnabledMask(Logger & logger)
+			{
+				std::uint32_t mask = 0;
+				for (unsigned category = 0; category < static_cast<unsigned>(Category::Count); ++category)
+				{
+					if (logger.mDisabledCategories & (1u << category))
+						continue;
+					for (unsigned severity = static_cast<unsigned>(logger.mMinSeverity); severity < static_cast<unsigned>(Severity::Count); ++severity)
+						mask |= 1u << (category * static_cast<unsigned>(Severity::Count) + severity);
+				}
+				detail::g_EnabledMask.store(mask, std::memory_order_relaxed);
+			}
+
+			/// \brief	Sets the default filter before main runs.
+			struct DefaultFilter
+			{
+				DefaultFilter()
+				{
+#if _DEBUG
+					setMinSeverity(Severity::Debug);
+#else
+					setMinSeverity(Severity::Info);
+#endif
+				}
+			} s_DefaultFilter;
+
+			const char * getSeverityName(Severity severity)
+			{
+				switch (severity)
+				{
+				case Severity::Debug: return "Debug";
+				case Severity::Info: return "Info";
+				case Severity::Warning: return "Warning";
+				case Severity::Error: return "Error";
+				case Severity::Count: break;
+				}
+				return "_unknown_severity_";
+			}
+			const char * getCategoryName(Category category)
+			{
+				switch (category)
+				{
+				case Category::App: return "App";
+				case Category::Window: return "Window";
+				case Category::Input: return "Input";
+				case Category::GL: return "GL";
+				case Category::Jobs: return "Jobs";
+				case Category::Assets: return "Assets";
+				case Category::Count: break;
+				}
+				return "_unknown_category_";
+			}
+
+			template <typename T>
+			T ReadValue(const unsigned char *& data)
+			{
+				T value;
+				std::memcpy(&value, data, sizeof(value));
+				data += sizeof(value);
+				return value;
+			}
+
+			/// \brief	Replaces every {} of the format with the next argument, the rest of them are appended.
+			std::string FormatRecord(const unsigned char * record)
+			{
+				RecordHeader header;
+				std::memcpy(&header, record, sizeof(header));
+				const unsigned char * data = record + sizeof(header);
+				const unsigned char * const end = record + header.mSize;
+
+				char prefix[64];
+				std::snprintf(prefix, sizeof(prefix), "[%10.4f] [%s] [%s] ", header.mTime / 1e9,
+							  getSeverityName(header.mSeverity), getCategoryName(header.mCategory));
+				std::string text = prefix;
+
+				const auto append_arg = [&data, end, &text]()
+				{
+					if (data >= end)
+					{
+						text += "{}";
+						return;
+					}
+
+					char buffer[64];
+					switch (static_cast<ArgType>(*data++))
+					{
+					case ArgType::Bool:
+						text += ReadValue<unsigned char>(data) ? "true" : "false";
+						break;
+					case ArgType::Char:
+						text += ReadValue<char>(data);
+						break;
+					case ArgType::Int:
+						std::snprintf(buffer, sizeof(buffer), "%lld", ReadValue<long long>(data));
+						text += buffer;
+						break;
+					case ArgType::UInt:
+						std::snprintf(buffer, sizeof(buffer), "%llu", ReadValue<unsigned long long>(data));
+						text += buffer;
+						break;
+					case ArgType::Double:
+						std::snprintf(buffer, sizeof(buffer), "%g", ReadValue<double>(data));
+						text += buffer;
+						break;
+					case ArgType::String:
+					{
+						const std::uint16_t length = ReadValue<std::uint16_t>(data);
+						text.append(reinterpret_cast<const char *>(data), length);
+						data += length;
+					} break;
+					case ArgType::Pointer:
+						std::snprintf(buffer, sizeof(buffer), "%p", ReadValue<const void *>(data));
+						text += buffer;
+						break;
+					}
+				};
+
+				for (const char * c = header.mFormat; *c; ++c)
+				{
+					if (c[0] == '{' && c[1] == '}')
+					{
+						append_arg();
+						++c;
+					}
+					else
+						text += *c;
+				}
+				while (data < end)
+				{
+					text += ' ';
+					append_arg();
+				}
+				return text;
+			}
+
+			/// \brief	Copies the bytes [offset, offset + size) of the ring, which can wrap around.
+			void ReadRing(const ThreadBuffer & buffer, std::size_t offset, void * dst, std::size_t size)
+			{
+				const std::size_t start = offset & (s_BufferSize - 1);
+				const std::size_t first = std::min(size, s_BufferSize - start);
+				std::memcpy(dst, buffer.mpData.get() + start, first);
+				std::memcpy(static_cast<unsigned char *>(dst) + first, buffer.mpData.get(), size - first);
+			}
+			void WriteRing(ThreadBuffer & buffer, std::size_t offset, const void * src, std::size_t size)
+			{
+				const std::size_t start = offset & (s_BufferSize - 1);
+				const std::size_t first = std::min(size, s_BufferSize - start);
+				std::memcpy(buffer.mpData.get() + start, src, first);
+				std::memcpy(buffer.mpData.get(), static_cast<const unsigned char *>(src) + first, size - first);
+			}
+
+			/// \brief	Formats the records of all the threads in the order they were written.
+			void Drain(Logger & logger)
+			{
+				unsigned long long dropped = 0;
+				{
+					std::lock_guard<std::mutex> lock(logger.mBuffersMutex);
+					for (const std::unique_ptr<ThreadBuffer> & buffer : logger.mvBuffers)
+					{
+						const std::size_t head = buffer->mHead.load(std::memory_order_acquire);
+						std::size_t tail = buffer->mTail.load(std::memory_order_relaxed);
+						while (tail != head)
+						{
+							std::uint32_t size;
+							ReadRing(*buffer, tail, &size, sizeof(size));
+							logger.mvRecord.resize(size);
+							ReadRing(*buffer, tail, logger.mvRecord.data(), size);
+							tail += size;
+
+							RecordHeader header;
+							std::memcpy(&header, logger.mvRecord.data(), sizeof(header));
+							logger.mvLines.push_back(Logger::Line{ header.mTime, FormatRecord(logger.mvRecord.data()) });
+						}
+						buffer->mTail.store(tail, std::memory_order_release);
+						dropped += buffer->mDropped.load(std::memory_order_relaxed);
+					}
+				}
+
+				std::stable_sort(logger.mvLines.begin(), logger.mvLines.end(), [](const Logger::Line & a, const Logger::Line & b)
+				{
+					return a.mTime < b.mTime;
+				});
+				for (const Logger::Line & line : logger.mvLines)
+					*logger.mpOutput << line.mText << '\n';
+
+				logger.mDropped.store(dropped, std::memory_order_relaxed);
+				if (dropped > logger.mDroppedReported)
+				{
+					*logger.mpOutput << "[log] " << dropped - logger.mDroppedReported << " records dropped, the buffer of their thread was full\n";
+					logger.mDroppedReported = dropped;
+				}
+				if (!logger.mvLines.empty())
+					logger.mpOutput->flush();
+
+				logger.mWritten.fetch_add(logger.mvLines.size(), std::memory_order_relaxed);
+				logger.mvLines.clear();
+			}
+
+			void SinkLoop(Logger & logger)
+			{
+				for (;;)
+				{
+					unsigned long long requests;
+					bool quit;
+					{
+						std::unique_lock<std::mutex> lock(logger.mWakeMutex);
+						logger.mWakeUp.wait_for(lock, s_SinkPeriod, [&logger]()
+						{
+							return logger.mbQuit || logger.mFlushRequests != logger.mFlushedRequests || logger.mbWakeRequested.load();
+						});
+						logger.mbWakeRequested.store(false);
+						requests = logger.mFlushRequests;
+						quit = logger.mbQuit;
+					}
+
+					Drain(logger);
+
+					{
+						std::lock_guard<std::mutex> lock(logger.mWakeMutex);
+						logger.mFlushedRequests = requests;
+					}
+					logger.mFlushed.notify_all();
+
+					if (quit)
+						break;
+				}
+			}
+
+			ThreadBuffer & getThreadBuffer(Logger & logger)
+			{
+				if (t_Buffer.mpBuffer == nullptr)
+				{
+					std::lock_guard<std::mutex> lock(logger.mBuffersMutex);
+					for (const std::unique_ptr<ThreadBuffer> & buffer : logger.mvBuffers)
+					{
+						// the acquire pairs with the release of the owner, the last writes of the old thread are visible
+						if (!buffer->mbOwned.load(std::memory_order_acquire))
+						{
+							buffer->mbOwned.store(true, std::memory_order_relaxed);
+							t_Buffer.mpBuffer = buffer.get();
+							break;
+						}
+					}
+					if (t_Buffer.mpBuffer == nullptr)
+					{
+						logger.mvBuffers.push_back(std::make_unique<ThreadBuffer>());
+						t_Buffer.mpBuffer = logger.mvBuffers.back().get();
+					}
+				}
+				return *t_Buffer.mpBuffer;
+			}
+
+			void StopSink(Logger & logger)
+			{
+				if (!logger.mbRunning.load())
+					return;
+
+				// the records written from now on are written synchronously
+				logger.mbRunning.store(false);
+				{
+					std::lock_guard<std::mutex> lock(logger.mWakeMutex);
+					logger.mbQuit = true;
+				}
+				logger.mWakeUp.notify_all();
+				logger.mThread.join();
+
+				// a record committed while stopping stays in its buffer until the logger is started again
+				Drain(logger);
+
+				if (logger.mFile.is_open())
+					logger.mFile.close();
+				logger.mpOutput = &std::cout;
+			}
+
+			Logger::~Logger()
+			{
+				StopSink(*this);
+			}
+		}
+
+		void Start(const char * filename)
+		{
+			Logger & logger = get_logger();
+			if (logger.mbRunning.load())
+				return;
+
+			if (filename)
+			{
+				logger.mFile.open(filename);
+				if (logger.mFile)
+					logger.mpOutput = &logger.mFile;
+				else
+					std::cout << "Couldn't open the log file " << filename << ", logging to the console" << std::endl;
+			}
+
+			logger.mbQuit = false;
+			logger.mThread = std::thread(SinkLoop, std::ref(logger));
+			logger.mbRunning.store(true);
+		}
+		void Stop()
+		{
+			StopSink(get_logger());
+		}
+		void Flush()
+		{
+			Logger & logger = get_logger();
+			if (!logger.mbRunning.load())
+				return;
+
+			std::unique_lock<std::mutex> lock(logger.mWakeMutex);
+			const unsigned long long request = ++logger.mFlushRequests;
+			logger.mWakeUp.notify_all();
+			logger.mFlushed.wait(lock, [&logger, request]() { return logger.mFlushedRequests >= request; });
+		}
+
+		void setMinSeverity(Severity severity)
+		{
+			Logger & logger = get_logger();
+			logger.mMinSeverity = severity;
+			UpdateEnabledMask(logger);
+		}
+		void setCategoryEnabled(Category category, bool enabled)
+		{
+			Logger & logger = get_logger();
+			const std::uint32_t bit = 1u << static_cast<unsigned>(category);
+			logger.mDisabledCategories = enabled ? logger.mDisabledCategories & ~bit : logger.mDisabledCategories | bit;
+			UpdateEnabledMask(logger);
+		}
+
+		Stats getStats()
+		{
+			Logger & logger = get_logger();
+			Stats stats;
+			stats.mWritten = logger.mWritten.load(std::memory_order_relaxed);
+			stats.mDropped = logger.mDropped.load(std::memory_order_relaxed);
+			{
+				std::lock_guard<std::mutex> lock(logger.mBuffersMutex);
+				stats.mThreads = 0;
+				stats.mBuffers = static_cast<unsigned>(logger.mvBuffers.size());
+				for (const std::unique_ptr<ThreadBuffer> & buffer : logger.mvBuffers)
+					stats.mThreads += buffer->mbOwned.load(std::memory_order_relaxed) ? 1 : 0;
+			}
+			return stats;
+		}
+
+		namespace detail
+		{
+			RecordWriter & BeginRecord(Severity severity, Category category, const char * format)
+			{
+				RecordWriter & record = t_Record;
+				RecordHeader header;
+				header.mSize = 0;	// written by CommitRecord
+				header.mSeverity = severity;
+				header.mCategory = category;
+				header.mArgCount = 0;
+				header.mFormat = format;
+				header.mTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - get_logger().mStart).count();
+
+				record.mSize = 0;
+				record.mArgCount = 0;
+				record.Append(&header, sizeof(header));
+				return record;
+			}
+
+			void CommitRecord(RecordWriter & record)
+			{
+				const std::uint32_t size = static_cast<std::uint32_t>(record.mSize);
+				std::memcpy(record.mData + offsetof(RecordHeader, mSize), &size, sizeof(size));
+				std::memcpy(record.mData + offsetof(RecordHeader, mArgCount), &record.mArgCount, sizeof(record.mArgCount));
+
+				Logger & logger = get_logger();
+				if (!logger.mbRunning.load(std::memory_order_acquire))
+				{
+					const std::string text = FormatRecord(record.mData);
+					std::lock_guard<std::mutex> lock(logger.mSyncMutex);
+					std::cout << text << std::endl;
+					logger.mWritten.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				ThreadBuffer & buffer = getThreadBuffer(logger);
+				const std::size_t head = buffer.mHead.load(std::memory_order_relaxed);
+				const std::size_t tail = buffer.mTail.load(std::memory_order_acquire);
+				const std::size_t used = head - tail;
+				if (s_BufferSize - used < size)
+				{
+					buffer.mDropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				WriteRing(buffer, head, record.mData, size);
+				buffer.mHead.store(head + size, std::memory_order_release);
+
+				// the sink wakes up on its own every few ms, only bursts need to wake it up sooner
+				if (used + size > s_BufferSize / 2 && !logger.mbWakeRequested.exchange(true))
+					logger.mWakeUp.notify_one();
+			}
+
+			namespace
+			{
+				template <typename T>
+				void EncodeValue(RecordWriter & record, ArgType type, const T & value)
+				{
+					unsigned char bytes[1 + sizeof(T)];
+					bytes[0] = static_cast<unsigned char>(type);
+					std::memcpy(bytes + 1, &value, sizeof(T));
+					if (record.Append(bytes, sizeof(bytes)))
+						++record.mArgCount;
+				}
+				void EncodeString(RecordWriter & record, const char * value, std::size_t length)
+				{
+					const std::size_t header_size = 1 + sizeof(std::uint16_t);
+					if (record.mSize + header_size > RecordWriter::MAX_SIZE)
+						return;
+
+					// truncated to the space left in the record
+					const std::uint16_t stored = static_cast<std::uint16_t>(std::min(length, RecordWriter::MAX_SIZE - record.mSize - header_size));
+					const unsigned char type = static_cast<unsigned char>(ArgType::String);
+					record.Append(&type, 1);
+					record.Append(&stored, sizeof(stored));
+					record.Append(value, stored);
+					++record.mArgCount;
+				}
+			}
+
+			void Encode(RecordWriter & record, bool value)
+			{
+				EncodeValue(record, ArgType::Bool, static_cast<unsigned char>(value ? 1 : 0));
+			}
+			void Encode(RecordWriter & record, char value)
+			{
+				EncodeValue(record, ArgType::Char, value);
+			}
+			void Encode(RecordWriter & record, int value)
+			{
+				EncodeValue(record, ArgType::Int, static_cast<long long>(value));
+			}
+			void Encode(RecordWriter & record, unsigned value)
+			{
+				EncodeValue(record, ArgType::UInt, static_cast<unsigned long long>(value));
+			}
+			void Encode(RecordWriter & record, long value)
+			{
+				EncodeValue(record, ArgType::Int, static_cast<long long>(value));
+			}
+			void Encode(RecordWriter & record, unsigned long value)
+			{
+				EncodeValue(record, ArgType::UInt, static_cast<unsigned long long>(value));
+			}
+			void Encode(RecordWriter & record, long long value)
+			{
+				EncodeValue(record, ArgType::Int, value);
+			}
+			void Encode(RecordWriter & record, unsigned long long value)
+			{
+				EncodeValue(record, ArgType::UInt, value);
+			}
+			void Encode(RecordWriter & record, double value)
+			{
+				EncodeValue(record, ArgType::Double, value);
+			}
+			void Encode(RecordWriter & record, const char * value)
+			{
+				if (value == nullptr)
+					value = "(null)";
+				EncodeString(record, value, std::strlen(value));
+			}
+			void Encode(RecordWriter & record, const unsigned char * value)
+			{
+				Encode(record, reinterpret_cast<const char *>(value));
+			}
+			void Encode(RecordWriter & record, const std::string & value)
+			{
+				EncodeString(record, value.data(), value.size());
+			}
+			void Encode(RecordWriter & record, const void * value)
+			{
+				EncodeValue(record, ArgType::Pointer, value);
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+/*!
+\brief	Asynchronous logger: the threads write binary records that a background thread formats and writes.
+*/
+
+#pragma once
+
+#include <atomic>		// std::atomic
+#include <string>		// std::string
+#include <cstdint>		// std::uint32_t
+
+namespace app
+{
+	namespace log
+	{
+		enum class Severity : unsigned char
+		{
+			Debug,
+			Info,
+			Warning,
+			Error,
+			Count,
+		};
+
+		enum class Category : unsigned char
+		{
+			App,
+			Window,
+			Input,
+			GL,
+			Jobs,
+			Assets,
+			Count,
+		};
+
+		struct Stats
+		{
+			unsigned long long	mWritten;	// records written by the sink
+			unsigned long long	mDropped;	// records lost because the buffer of their thread was full
+			unsigned			mThreads;	// running threads that have logged something
+			unsigned			mBuffers;	// 64 KB each, reused by new threads when theirs exit
+		};
+
+		/// \brief	Starts the thread that writes the records, to the file or to std::cout if filename is null.
+		/// Before starting (and after stopping) the records are written as they come, synchronously.
+		void Start(const char * filename = nullptr);
+		/// \brief	Writes all the pending records and joins the thread.
+		void Stop();
+		/// \brief	Returns when the records written before calling it are in the file.
+		void Flush();
+
+		/// \brief	Records below it are filtered out, by default Debug in debug builds and Info in release.
+		void setMinSeverity(Severity severity);
+		void setCategoryEnabled(Category category, bool enabled);
+
+		Stats getStats();
+
+		namespace detail
+		{
+			/// \brief	A bit per severity and category, bit = category * Severity::Count + severity.
+			extern std::atomic<std::uint32_t> g_EnabledMask;
+		}
+
+		/// \brief	Only an atomic load, the APP_LOG macros check it before evaluating the arguments.
+		inline bool isEnabled(Severity severity, Category category)
+		{
+			const unsigned bit = static_cast<unsigned>(category) * static_cast<unsigned>(Severity::Count) + static_cast<unsigned>(severity);
+			return (detail::g_EnabledMask.load(std::memory_order_relaxed) & (1u << bit)) != 0;
+		}
+
+		namespace detail
+		{
+			/// \brief	Record being encoded by the calling thread.
+			class RecordWriter;
+
+			RecordWriter & BeginRecord(Severity severity, Category category, const char * format);
+			/// \brief	Queues the record in the ring buffer of the thread, it is dropped if the buffer is full.
+			void CommitRecord(RecordWriter & record);
+
+			// the arguments are stored with a type tag and formatted by the sink thread,
+			// the strings are copied (truncated if the record gets too big)
+			void Encode(RecordWriter & record, bool value);
+			void Encode(RecordWriter & record, char value);
+			void Encode(RecordWriter & record, int value);
+			void Encode(RecordWriter & record, unsigned value);
+			void Encode(RecordWriter & record, long value);
+			void Encode(RecordWriter & record, unsigned long value);
+			void Encode(RecordWriter & record, long long value);
+			void Encode(RecordWriter & record, unsigned long long value);
+			void Encode(RecordWriter & record, double value);
+			void Encode(RecordWriter & record, const char * value);
+			void Encode(RecordWriter & record, const unsigned char * value);	// i.e. gl::GetString
+			void Encode(RecordWriter & record, const std::string & value);
+			void Encode(RecordWriter & record, const void * value);
+
+			inline void EncodeArgs(RecordWriter &) {}
+			template <typename T, typename ... Args>
+			void EncodeArgs(RecordWriter & record, const T & arg, const Args & ... args)
+			{
+				Encode(record, arg);
+				EncodeArgs(record, args...);
+			}
+
+			template <typename ... Args>
+			void Write(Severity severity, Category category, const char * format, const Args & ... args)
+			{
+				RecordWriter & record = BeginRecord(severity, category, format);
+				EncodeArgs(record, args...);
+				CommitRecord(record);
+			}
+		}
+	}
+}
+
+/// \brief	Logs a message where every {} of the format is replaced by the next argument:
+/// APP_LOG_ERROR(app::log::Category::GL, "Error {} in {}", error, name);
+/// IMPORTANT(Borja): The format needs to be a string literal, only its pointer is stored.
+#define APP_LOG(severity, category, ...)	\
+	do { if (app::log::isEnabled(severity, category)) app::log::detail::Write(severity, category, __VA_ARGS__); } while (0)
+#define APP_LOG_DEBUG(category, ...)	APP_LOG(app::log::Severity::Debug, category, __VA_ARGS__)
+#define APP_LOG_INFO(category, ...)		APP_LOG(app::log::Severity::Info, category, __VA_ARGS__)
+#define APP_LOG_WARNING(category, ...)	APP_LOG(app::log::Severity::Warning, category, __VA_ARGS__)
+#define APP_LOG_ERROR(category, ...)	APP_LOG(app::log::Severity::Error, category, __VA_ARGS__)
@@ -0,0 +1,446 @@
+/*!
+\brief	Draw commands submitted by any renderer, sorted by their state and executed with the fewest state changes.
+*/
+
+#include "RenderQueue.h"
+
+#include "VectorMath.h"	// app::Vec2, app::Vec4, app::Mat4
+#include "Log.h"
+
+#include <vector>			// std::vector
+#include <unordered_map>	// std::unordered_map
+#include <algorithm>		// std::is_sorted, std::min
+#include <chrono>			// std::chrono::high_resolution_clock
+#include <cstdint>			// std::uint64_t
+#include <cstring>			// std::memcpy
+#include <utility>			// std::swap, std::pair, std::make_pair
+
+namespace app
+{
+	namespace
+	{
+		// sort key layout, see RenderQueue
+		const unsigned KEY_INDEX_BITS = 24;
+		const unsigned KEY_TEXTURE_BITS = 10;
+		const unsigned KEY_VERTEX_ARRAY_BITS = 8;
+		const unsigned KEY_PROGRAM_BITS = 10;
+		const unsigned KEY_DEPTH_BITS = 2;
+		const unsigned KEY_BLEND_BITS = 2;
+
+		const unsigned KEY_TEXTURE_SHIFT = KEY_INDEX_BITS;
+		const unsigned KEY_VERTEX_ARRAY_SHIFT = KEY_TEXTURE_SHIFT + KEY_TEXTURE_BITS;
+		const unsigned KEY_PROGRAM_SHIFT = KEY_VERTEX_ARRAY_SHIFT + KEY_VERTEX_ARRAY_BITS;
+		const unsigned KEY_DEPTH_SHIFT = KEY_PROGRAM_SHIFT + KEY_PROGRAM_BITS;
+		const unsigned KEY_BLEND_SHIFT = KEY_DEPTH_SHIFT + KEY_DEPTH_BITS;
+		const unsigned KEY_LAYER_SHIFT = KEY_BLEND_SHIFT + KEY_BLEND_BITS;
+		static_assert(KEY_LAYER_SHIFT + 8 == 64, "The sort key needs to fill 64 bits");
+
+		const std::uint64_t KEY_INDEX_MASK = (1ull << KEY_INDEX_BITS) - 1;
+
+		/// \brief	Stable LSD radix sort of the keys, a byte per pass.
+		/// The passes of the bytes below first_byte and of the bytes that are the same in every key are
+		/// skipped: the keys are submitted in index order, so the index bytes never need to be sorted.
+		void RadixSort(std::vector<std::uint64_t> & keys, std::vector<std::uint64_t> & scratch, unsigned first_byte)
+		{
+			const std::size_t count = keys.size();
+			scratch.resize(count);
+
+			// the histograms of all the passes in a single read
+			std::size_t histograms[8][256] = {};
+			for (const std::uint64_t key : keys)
+			{
+				for (unsigned byte = first_byte; byte < 8; ++byte)
+					++histograms[byte][(key >> (byte * 8)) & 0xFF];
+			}
+
+			std::uint64_t * src = keys.data();
+			std::uint64_t * dst = scratch.data();
+			for (unsigned byte = first_byte; byte < 8; ++byte)
+			{
+				std::size_t * histogram = histograms[byte];
+				const unsigned shift = byte * 8;
+				if (histogram[(src[0] >> shift) & 0xFF] == count)
+					continue;
+
+				std::size_t offset = 0;
+				for (unsigned digit = 0; digit < 256; ++digit)
+				{
+					const std::size_t digit_count = histogram[digit];
+					histogram[digit] = offset;
+					offset += digit_count;
+				}
+				for (std::size_t i = 0; i < count; ++i)
+					dst[histogram[(src[i] >> shift) & 0xFF]++] = src[i];
+				std::swap(src, dst);
+			}
+
+			if (src != keys.data())
+				keys.swap(scratch);
+		}
+	}
+
+	class RenderQueue::RenderQueue_impl
+	{
+	public:
+		RenderQueue_impl();
+
+		void setLayer(unsigned char layer) { mLayer = layer; }
+		void setBlendMode(BlendMode blend_mode) { mBlendMode = blend_mode; }
+		void setDepthMode(DepthMode depth_mode) { mDepthMode = depth_mode; }
+
+		enum class UniformType : unsigned char
+		{
+			Int,
+			Float,
+			Vec2,
+			Vec4,
+			Mat4,
+		};
+		void AddUniform(GLint location, UniformType type, const float * values, unsigned count, int int_value);
+
+		void Submit(const DrawCommand & command);
+		void Execute();
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		struct Command
+		{
+			DrawCommand	mDraw;
+			BlendMode	mBlendMode;
+			DepthMode	mDepthMode;
+			unsigned	mFirstUniform;
+			unsigned	mUniformCount;
+		};
+
+		struct Uniform
+		{
+			GLint		mLocation;
+			UniformType	mType;
+			int			mInt;
+			float		mValues[16];
+		};
+
+		/// \brief	Small id of the object, given in the order they are submitted. The ids that don't fit
+		/// in the key share the last one, the commands are still drawn right but they don't get grouped.
+		static std::uint64_t getId(std::unordered_map<GLuint, unsigned> & ids, GLuint name, unsigned bits);
+		/// \return	Number of state changes from the previous command to the next one.
+		static unsigned CountChanges(const Command * previous, const Command & next);
+		void ApplyBlendMode(BlendMode blend_mode);
+		void ApplyDepthMode(DepthMode depth_mode);
+		void ApplyUniform(const Uniform & uniform);
+
+		std::vector<Command>		mvCommands;
+		std::vector<std::uint64_t>	mvKeys;
+		std::vector<std::uint64_t>	mvSortScratch;
+		std::vector<Uniform>		mvUniforms;
+		/// \brief	Uniforms set since the last submit, they go to the next command.
+		unsigned mFirstPendingUniform{ 0 };
+
+		std::unordered_map<GLuint, unsigned> mProgramIds;
+		std::unordered_map<GLuint, unsigned> mVertexArrayIds;
+		std::unordered_map<GLuint, unsigned> mTextureIds;
+		/// \brief	First uniform and count of the last command submitted with each program.
+		std::unordered_map<GLuint, std::pair<unsigned, unsigned>> mProgramUniforms;
+
+		unsigned char	mLayer{ 0 };
+		BlendMode		mBlendMode{ BlendMode::Opaque };
+		DepthMode		mDepthMode{ DepthMode::Off };
+		bool			mbUseDSA{ false };
+
+		Stats mStats;
+	};
+
+	RenderQueue::RenderQueue_impl::RenderQueue_impl()
+	{
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
+		mvCommands.reserve(1024);
+		mvKeys.reserve(1024);
+	}
+
+	void RenderQueue::RenderQueue_impl::AddUniform(GLint location, UniformType type, const float * values, unsigned count, int int_value)
+	{
+		Uniform uniform;
+		uniform.mLocation = location;
+		uniform.mType = type;
+		uniform.mInt = int_value;
+		if (count > 0)
+			std::memcpy(uniform.mValues, values, count * sizeof(float));
+		mvUniforms.push_back(uniform);
+	}
+
+	std::uint64_t RenderQueue::RenderQueue_impl::getId(std::unordered_map<GLuint, unsigned> & ids, GLuint name, unsigned bits)
+	{
+		const unsigned max_id = (1u << bits) - 1;
+		const unsigned id = ids.emplace(name, static_cast<unsigned>(ids.size())).first->second;
+		return std::min(id, max_id);
+	}
+
+	void RenderQueue::RenderQueue_impl::Submit(const DrawCommand & command)
+	{
+		if (mvCommands.size() > KEY_INDEX_MASK)
+		{
+			APP_LOG_ERROR(log::Category::GL, "RenderQueue: more than {} commands in a frame, the command is dropped", KEY_INDEX_MASK + 1);
+			return;
+		}
+
+		const std::uint64_t index = mvCommands.size();
+		std::uint64_t key = (static_cast<std::uint64_t>(mLayer) << KEY_LAYER_SHIFT) | index;
+		if (mBlendMode == BlendMode::Opaque)
+		{
+			key |= (static_cast<std::uint64_t>(mDepthMode) << KEY_DEPTH_SHIFT) |
+				   (getId(mProgramIds, command.mProgram, KEY_PROGRAM_BITS) << KEY_PROGRAM_SHIFT) |
+				   (getId(mVertexArrayIds, command.mVertexArray, KEY_VERTEX_ARRAY_BITS) << KEY_VERTEX_ARRAY_SHIFT) |
+				   (getId(mTextureIds, command.mTexture, KEY_TEXTURE_BITS) << KEY_TEXTURE_SHIFT);
+		}
+		else
+		{
+			// blended commands composite in the order they are drawn, only the index sorts them
+			key |= 1ull << KEY_BLEND_SHIFT;
+		}
+		mvKeys.push_back(key);
+
+		// a command without uniforms uses the ones of the last command submitted with its program,
+		// they would be overwritten by any other command of the program sorted in between
+		Command queued{ command, mBlendMode, mDepthMode, mFirstPendingUniform,
+						static_cast<unsigned>(mvUniforms.size()) - mFirstPendingUniform };
+		auto & program_uniforms = mProgramUniforms[command.mProgram];
+		if (queued.mUniformCount == 0)
+		{
+			queued.mFirstUniform = program_uniforms.first;
+			queued.mUniformCount = program_uniforms.second;
+		}
+		else
+		{
+			program_uniforms = std::make_pair(queued.mFirstUniform, queued.mUniformCount);
+		}
+		mvCommands.push_back(queued);
+		mFirstPendingUniform = static_cast<unsigned>(mvUniforms.size());
+	}
+
+	unsigned RenderQueue::RenderQueue_impl::CountChanges(const Command * previous, const Command & next)
+	{
+		if (previous == nullptr)
+			return 5;
+		return (previous->mDraw.mProgram != next.mDraw.mProgram ? 1 : 0) +
+			   (previous->mDraw.mVertexArray != next.mDraw.mVertexArray ? 1 : 0) +
+			   (previous->mDraw.mTexture != next.mDraw.mTexture ? 1 : 0) +
+			   (previous->mBlendMode != next.mBlendMode ? 1 : 0) +
+			   (previous->mDepthMode != next.mDepthMode ? 1 : 0);
+	}
+
+	void RenderQueue::RenderQueue_impl::Execute()
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		mStats = Stats();
+		mStats.mCommands = static_cast<unsigned>(mvCommands.size());
+		mStats.mUniforms = static_cast<unsigned>(mvUniforms.size());
+		if (mvCommands.empty())
+		{
+			mvUniforms.clear();
+			mFirstPendingUniform = 0;
+			mProgramUniforms.clear();
+			return;
+		}
+
+		// what drawing them as they came would have cost, to compare
+		for (std::size_t i = 0; i < mvCommands.size(); ++i)
+			mStats.mSubmissionStateChanges += CountChanges(i > 0 ? &mvCommands[i - 1] : nullptr, mvCommands[i]);
+
+		// most of the time a single subsystem submits everything already sorted
+		if (!std::is_sorted(mvKeys.begin(), mvKeys.end()))
+			RadixSort(mvKeys, mvSortScratch, KEY_INDEX_BITS / 8);
+		const auto sorted = std::chrono::high_resolution_clock::now();
+		mStats.mSortMs = std::chrono::duration<double, std::milli>(sorted - start).count();
+
+		// Backup GL state
+		GLint last_program, last_texture, last_vertex_array;
+		GLint last_blend_src, last_blend_dst;
+		GLboolean last_depth_mask;
+		const GLboolean last_blend = gl::IsEnabled(gl::BLEND);
+		const GLboolean last_depth_test = gl::IsEnabled(gl::DEPTH_TEST);
+		gl::GetIntegerv(gl::CURRENT_PROGRAM, &last_program);
+		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+		gl::GetIntegerv(gl::BLEND_SRC_RGB, &last_blend_src);
+		gl::GetIntegerv(gl::BLEND_DST_RGB, &last_blend_dst);
+		gl::GetBooleanv(gl::DEPTH_WRITEMASK, &last_depth_mask);
+		gl::ActiveTexture(gl::TEXTURE0);
+
+		const Command * previous = nullptr;
+		for (const std::uint64_t key : mvKeys)
+		{
+			const Command & command = mvCommands[key & KEY_INDEX_MASK];
+			const DrawCommand & draw = command.mDraw;
+			mStats.mStateChanges += CountChanges(previous, command);
+
+			if (previous == nullptr || previous->mDraw.mProgram != draw.mProgram)
+			{
+				gl::UseProgram(draw.mProgram);
+				++mStats.mProgramChanges;
+			}
+			if (previous == nullptr || previous->mDraw.mVertexArray != draw.mVertexArray)
+				gl::BindVertexArray(draw.mVertexArray);
+			if (previous == nullptr || previous->mDraw.mTexture != draw.mTexture)
+			{
+				if (mbUseDSA)	my_gl_core::ext::BindTextureUnit(0, draw.mTexture);
+				else			gl::BindTexture(gl::TEXTURE_2D, draw.mTexture);
+				++mStats.mTextureChanges;
+			}
+			if (previous == nullptr || previous->mBlendMode != command.mBlendMode)
+				ApplyBlendMode(command.mBlendMode);
+			if (previous == nullptr || previous->mDepthMode != command.mDepthMode)
+				ApplyDepthMode(command.mDepthMode);
+			previous = &command;
+
+			for (unsigned u = 0; u < command.mUniformCount; ++u)
+				ApplyUniform(mvUniforms[command.mFirstUniform + u]);
+
+			if (draw.mIndexType == 0)
+			{
+				if (draw.mInstances == 1 && draw.mBaseInstance == 0)
+					gl::DrawArrays(draw.mMode, draw.mFirst, draw.mCount);
+				else
+					gl::DrawArraysInstancedBaseInstance(draw.mMode, draw.mFirst, draw.mCount, draw.mInstances, draw.mBaseInstance);
+			}
+			else
+			{
+				const GLvoid * indices = reinterpret_cast<const GLvoid *>(static_cast<std::size_t>(draw.mFirst));
+				gl::DrawElementsInstancedBaseVertexBaseInstance(draw.mMode, draw.mCount, draw.mIndexType, indices,
+																draw.mInstances, draw.mBaseVertex, draw.mBaseInstance);
+			}
+		}
+
+		// Restore modified GL state
+		gl::UseProgram(last_program);
+		gl::BindTexture(gl::TEXTURE_2D, last_texture);
+		gl::BindVertexArray(last_vertex_array);
+		gl::BlendFunc(last_blend_src, last_blend_dst);
+		if (last_blend)	gl::Enable(gl::BLEND);
+		else			gl::Disable(gl::BLEND);
+		if (last_depth_test)	gl::Enable(gl::DEPTH_TEST);
+		else					gl::Disable(gl::DEPTH_TEST);
+		gl::DepthMask(last_depth_mask);
+		CheckOGLError();
+
+		mvCommands.clear();
+		mvKeys.clear();
+		mvUniforms.clear();
+		mFirstPendingUniform = 0;
+		mProgramIds.clear();
+		mVertexArrayIds.clear();
+		mTextureIds.clear();
+		mProgramUniforms.clear();
+
+		mStats.mExecuteMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sorted).count();
+	}
+
+	void RenderQueue::RenderQueue_impl::ApplyBlendMode(BlendMode blend_mode)
+	{
+		switch (blend_mode)
+		{
+		case BlendMode::Opaque:
+		{
+			gl::Disable(gl::BLEND);
+		} break;
+		case BlendMode::Alpha:
+		{
+			gl::Enable(gl::BLEND);
+			gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+		} break;
+		case BlendMode::Additive:
+		{
+			gl::Enable(gl::BLEND);
+			gl::BlendFunc(gl::SRC_ALPHA, gl::ONE);
+		} break;
+		}
+	}
+
+	void RenderQueue::RenderQueue_impl::ApplyDepthMode(DepthMode depth_mode)
+	{
+		switch (depth_mode)
+		{
+		case DepthMode::Off:
+		{
+			gl::Disable(gl::DEPTH_TEST);
+		} break;
+		case DepthMode::Test:
+		{
+			gl::Enable(gl::DEPTH_TEST);
+			gl::DepthMask(gl::FALSE_);
+		} break;
+		case DepthMode::TestWrite:
+		{
+			gl::Enable(gl::DEPTH_TEST);
+			gl::DepthMask(gl::TRUE_);
+		} break;
+		}
+	}
+
+	void RenderQueue::RenderQueue_impl::ApplyUniform(const Uniform & uniform)
+	{
+		switch (uniform.mType)
+		{
+		case UniformType::Int:		gl::Uniform1i(uniform.mLocation, uniform.mInt); break;
+		case UniformType::Float:	gl::Uniform1f(uniform.mLocation, uniform.mValues[0]); break;
+		case UniformType::Vec2:		gl::Uniform2fv(uniform.mLocation, 1, uniform.mValues); break;
+		case UniformType::Vec4:		gl::Uniform4fv(uniform.mLocation, 1, uniform.mValues); break;
+		case UniformType::Mat4:		gl::UniformMatrix4fv(uniform.mLocation, 1, gl::FALSE_, uniform.mValues); break;
+		}
+	}
+
+	RenderQueue::RenderQueue()
+		: mpImpl(std::make_unique<RenderQueue_impl>())
+	{}
+	RenderQueue::~RenderQueue()
+	{}
+
+	void RenderQueue::setLayer(unsigned char layer)
+	{
+		mpImpl->setLayer(layer);
+	}
+	void RenderQueue::setBlendMode(BlendMode blend_mode)
+	{
+		mpImpl->setBlendMode(blend_mode);
+	}
+	void RenderQueue::setDepthMode(DepthMode depth_mode)
+	{
+		mpImpl->setDepthMode(depth_mode);
+	}
+
+	void RenderQueue::setUniform(GLint location, int value)
+	{
+		mpImpl->AddUniform(location, RenderQueue_impl::UniformType::Int, nullptr, 0, value);
+	}
+	void RenderQueue::setUniform(GLint location, float value)
+	{
+		mpImpl->AddUniform(location, RenderQueue_impl::UniformType::Float, &value, 1, 0);
+	}
+	void RenderQueue::setUniform(GLint location, const Vec2 & value)
+	{
+		const float values[2] = { value.x, value.y };
+		mpImpl->AddUniform(location, RenderQueue_impl::UniformType::Vec2, values, 2, 0);
+	}
+	void RenderQueue::setUniform(GLint location, const Vec4 & value)
+	{
+		mpImpl->AddUniform(location, RenderQueue_impl::UniformType::Vec4, &value.x, 4, 0);
+	}
+	void RenderQueue::setUniform(GLint location, const Mat4 & value)
+	{
+		mpImpl->AddUniform(location, RenderQueue_impl::UniformType::Mat4, value.data(), 16, 0);
+	}
+
+	void RenderQueue::Submit(const DrawCommand & command)
+	{
+		mpImpl->Submit(command);
+	}
+	void RenderQueue::Execute()
+	{
+		mpImpl->Execute();
+	}
+
+	const RenderQueue::Stats & RenderQueue::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
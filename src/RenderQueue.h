@@ -0,0 +1,105 @@
+/*!
+\brief	Draw commands submitted by any renderer, sorted by their state and executed with the fewest state changes.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"	// GLuint, GLenum
+
+#include <memory>		// std::unique_ptr
+
+namespace app
+{
+	struct Vec2;
+	struct Vec4;
+	struct Mat4;
+
+	/// \brief	The commands are sorted with a 64 bit key, from the highest bits:
+	/// layer (8) | blended (2) | depth (2) | program (10) | vertex array (8) | texture (10) | submission index (24)
+	/// so the layers are drawn in order, the opaque commands of a layer before the blended ones, and
+	/// the opaque commands that share a program, vertex array and texture go together.
+	/// The blended commands of a layer keep the order they were submitted in (their state fields are 0),
+	/// reordering them would change how overlapping ones composite.
+	/// The programs, vertex arrays and textures get small ids in the order they are first submitted.
+	/// The sort is stable: commands with the same state are drawn in the order they were submitted.
+	/// IMPORTANT(Borja): A command that sets uniforms has to set all the ones its program reads, the
+	/// commands in between in submission order may not be drawn in between. A command submitted
+	/// without uniforms gets the ones of the last command submitted with the same program.
+	/// IMPORTANT(Borja): The queue only tracks the state in the key, anything else a command needs
+	/// (i.e. the buffers of its vertex array) has to stay valid until RenderQueue::Execute.
+	class RenderQueue
+	{
+	public:
+		enum class BlendMode : unsigned char
+		{
+			Opaque,
+			Alpha,
+			Additive,
+		};
+
+		enum class DepthMode : unsigned char
+		{
+			Off,
+			Test,			// without writing
+			TestWrite,
+		};
+
+		/// \brief	A draw call and the objects it is drawn with.
+		struct DrawCommand
+		{
+			GLuint		mProgram;
+			GLuint		mVertexArray;
+			GLuint		mTexture;		// TEXTURE_2D bound to unit 0, 0 if it doesn't use one
+			GLenum		mMode;			// gl::TRIANGLES, gl::TRIANGLE_STRIP...
+			GLenum		mIndexType;		// 0 draws arrays, otherwise the indices of the vertex array
+			GLint		mFirst;			// first vertex, or byte offset of the first index
+			GLsizei		mCount;
+			GLsizei		mInstances;		// 1 if it isn't instanced
+			GLint		mBaseVertex;
+			GLuint		mBaseInstance;
+		};
+
+		struct Stats
+		{
+			unsigned	mCommands{ 0 };
+			unsigned	mStateChanges{ 0 };				// applied by Execute, in sorted order
+			unsigned	mSubmissionStateChanges{ 0 };	// the submission order would have needed
+			unsigned	mProgramChanges{ 0 };
+			unsigned	mTextureChanges{ 0 };
+			unsigned	mUniforms{ 0 };
+			double		mSortMs{ 0.0 };
+			double		mExecuteMs{ 0.0 };
+		};
+
+		RenderQueue();
+		~RenderQueue();
+		RenderQueue(const RenderQueue &) = delete;
+		RenderQueue & operator=(const RenderQueue &) = delete;
+
+		/// \brief	State of the commands submitted after the call.
+		void setLayer(unsigned char layer);
+		void setBlendMode(BlendMode blend_mode);
+		void setDepthMode(DepthMode depth_mode);
+
+		/// \brief	Uniforms of the next command submitted, set right before its draw call.
+		/// The next command needs all the uniforms of its program, see RenderQueue.
+		void setUniform(GLint location, int value);
+		void setUniform(GLint location, float value);
+		void setUniform(GLint location, const Vec2 & value);
+		void setUniform(GLint location, const Vec4 & value);
+		void setUniform(GLint location, const Mat4 & value);
+
+		void Submit(const DrawCommand & command);
+
+		/// \brief	Sorts and executes the commands submitted since the last call, the GL state
+		/// it touches is restored at the end.
+		void Execute();
+
+		/// \return	Stats of the last RenderQueue::Execute call.
+		const Stats & getStats() const;
+
+	private:
+		class RenderQueue_impl;
+		std::unique_ptr<RenderQueue_impl> mpImpl;
+	};
+}
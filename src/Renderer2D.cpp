@@ -0,0 +1,567 @@
+/*!
+\brief	Batched 2D renderer for sprites, lines and quads.
+*/
+
+#include "Renderer2D.h"
+
+#include "Window.h"
+#include "VectorMath.h"	// app::Mat4
+#include "RenderQueue.h"
+
+#include "my_gl_core.h"
+#include "my_gl_stream_buffer.h"	// my_gl_core::StreamBuffer
+#include "my_gl_resources.h"	// my_gl_core::create_program, my_gl_core::delete_program...
+
+#include <vector>		// std::vector
+#include <algorithm>	// std::sort, std::is_sorted
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <cmath>		// std::atan2, std::sqrt
+#include <cstddef>		// offsetof
+#include <cstdint>		// std::uint64_t
+#include <unordered_map>	// std::unordered_map
+
+namespace app
+{
+	class Renderer2D::Renderer2D_impl
+	{
+	public:
+		Renderer2D_impl();
+		~Renderer2D_impl();
+
+		void Begin(Window & window);
+		void End(RenderQueue * queue);
+
+		void setLayer(unsigned char layer) { mLayer = layer; }
+		void setBlendMode(BlendMode blend_mode) { mBlendMode = blend_mode; }
+
+		void Submit(float x, float y, float w, float h, float rotation, unsigned color,
+					GLuint texture, float u0, float v0, float u1, float v1);
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		/// \brief	Per-instance data as the vertex shader reads it (32 bytes).
+		struct Instance
+		{
+			float			mRect[4];	// center x, center y, width, height
+			float			mRotation;
+			unsigned short	mUV[4];		// normalized u0, v0, u1, v1
+			unsigned		mColor;
+		};
+
+		// sort key layout, the lowest bits are the index of the instance so that the
+		// keys can be sorted on their own and quads with the same state keep their order
+		static const unsigned KEY_INDEX_BITS = 30;
+		static const unsigned KEY_TEXTURE_BITS = 24;
+		static const unsigned KEY_BLEND_BITS = 2;
+
+		void CreateDeviceObjects();
+		/// \return	False if the vertex array points to another buffer, or to a retired stream buffer
+		/// whose name GL gave to the range's buffer.
+		bool isStreamBufferBound(const my_gl_core::StreamBuffer::Range & range) const
+		{
+			return range.mBuffer == mBoundStreamBuffer && range.mGeneration == mBoundStreamGeneration;
+		}
+		void BindStreamBuffer(const my_gl_core::StreamBuffer::Range & range);
+		/// \return	Id of the texture in this frame, the key only has room for KEY_TEXTURE_BITS.
+		std::uint64_t getTextureId(GLuint texture);
+		/// \return	Texture to bind for the state of a key.
+		GLuint getKeyTexture(std::uint64_t state) const;
+		void ApplyBlendMode(BlendMode blend_mode);
+		void ReadGpuTime();
+		void SubmitBatches(RenderQueue & queue, const my_gl_core::StreamBuffer::Range & range, const Mat4 & projection);
+
+		// instance data and sort keys are kept apart, the sort only moves the keys
+		std::vector<Instance>		mvInstances;
+		std::vector<std::uint64_t>	mvKeys;
+
+		// the keys hold dense per-frame ids of the textures instead of their names
+		std::unordered_map<GLuint, unsigned>	mTextureIds;
+		std::vector<GLuint>						mvTextures;	// indexed by id
+		GLuint		mLastTexture{ 0 };	// sprites come in runs of the same texture, skip the lookup for them
+		unsigned	mLastTextureId{ 0 };
+
+		unsigned char	mLayer{ 0 };
+		BlendMode		mBlendMode{ BlendMode::Alpha };
+
+		Window * mpWindow{ nullptr };
+		my_gl_core::StreamBuffer * mpStreamBuffer{ nullptr };
+		GLuint mBoundStreamBuffer{ 0 };
+		unsigned mBoundStreamGeneration{ 0 };
+		bool mbUseDSA{ false };
+
+		GLuint	mProgram{ 0 }, mVertShader{ 0 }, mFragShader{ 0 };
+		GLuint	mVao{ 0 };
+		GLuint	mWhiteTexture{ 0 };
+		GLint	mLocationTex{ 0 }, mLocationProjMtx{ 0 };
+		GLint	mLocationRect{ 0 }, mLocationRotation{ 0 }, mLocationUV{ 0 }, mLocationColor{ 0 };
+
+		// GPU timer queries, read a few frames later so that we never wait for them
+		static const unsigned QUERY_NUM = 4;
+		GLuint		mQueries[QUERY_NUM]{};
+		bool		mbQueryPending[QUERY_NUM]{};
+		unsigned	mQueryIndex{ 0 };
+
+		Stats mStats;
+	};
+
+	Renderer2D::Renderer2D_impl::Renderer2D_impl()
+	{
+		mvInstances.reserve(4096);
+		mvKeys.reserve(4096);
+		CreateDeviceObjects();
+	}
+	Renderer2D::Renderer2D_impl::~Renderer2D_impl()
+	{
+		gl::DeleteQueries(QUERY_NUM, mQueries);
+		my_gl_core::delete_texture(mWhiteTexture);
+		my_gl_core::delete_vertex_array(mVao);
+
+		gl::DetachShader(mProgram, mVertShader);
+		gl::DeleteShader(mVertShader);
+		gl::DetachShader(mProgram, mFragShader);
+		gl::DeleteShader(mFragShader);
+		my_gl_core::delete_program(mProgram);
+	}
+
+	void Renderer2D::Renderer2D_impl::CreateDeviceObjects()
+	{
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
+
+		// the corners of the quad come from gl_VertexID, only the instances have attributes
+		const GLchar * vertex_shader =
+			"#version 330\n"
+			"uniform mat4 ProjMtx;\n"
+			"in vec4 Rect;\n"
+			"in float Rotation;\n"
+			"in vec4 UVRect;\n"
+			"in vec4 Color;\n"
+			"out vec2 Frag_UV;\n"
+			"out vec4 Frag_Color;\n"
+			"void main()\n"
+			"{\n"
+			"	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+			"	vec2 local = (corner - 0.5) * Rect.zw;\n"
+			"	float c = cos(Rotation);\n"
+			"	float s = sin(Rotation);\n"
+			"	vec2 pos = Rect.xy + vec2(c * local.x - s * local.y, s * local.x + c * local.y);\n"
+			"	Frag_UV = mix(UVRect.xy, UVRect.zw, corner);\n"
+			"	Frag_Color = Color;\n"
+			"	gl_Position = ProjMtx * vec4(pos, 0, 1);\n"
+			"}\n";
+
+		const GLchar * fragment_shader =
+			"#version 330\n"
+			"uniform sampler2D Texture;\n"
+			"in vec2 Frag_UV;\n"
+			"in vec4 Frag_Color;\n"
+			"out vec4 Out_Color;\n"
+			"void main()\n"
+			"{\n"
+			"	Out_Color = Frag_Color * texture(Texture, Frag_UV);\n"
+			"}\n";
+
+		mProgram = my_gl_core::create_program("Renderer2D");
+		mVertShader = gl::CreateShader(gl::VERTEX_SHADER);
+		mFragShader = gl::CreateShader(gl::FRAGMENT_SHADER);
+		gl::ShaderSource(mVertShader, 1, &vertex_shader, 0);
+		gl::ShaderSource(mFragShader, 1, &fragment_shader, 0);
+		gl::CompileShader(mVertShader);
+		gl::CompileShader(mFragShader);
+		gl::AttachShader(mProgram, mVertShader);
+		gl::AttachShader(mProgram, mFragShader);
+		gl::LinkProgram(mProgram);
+
+		mLocationTex = gl::GetUniformLocation(mProgram, "Texture");
+		mLocationProjMtx = gl::GetUniformLocation(mProgram, "ProjMtx");
+		mLocationRect = gl::GetAttribLocation(mProgram, "Rect");
+		mLocationRotation = gl::GetAttribLocation(mProgram, "Rotation");
+		mLocationUV = gl::GetAttribLocation(mProgram, "UVRect");
+		mLocationColor = gl::GetAttribLocation(mProgram, "Color");
+
+		// 1x1 white texture used by the untextured quads, so that everything goes through the same shader
+		const unsigned white = 0xFFFFFFFF;
+		GLint last_texture, last_vertex_array;
+		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+
+		mWhiteTexture = my_gl_core::create_texture(gl::TEXTURE_2D, "Renderer2D");
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, mWhiteTexture, my_gl_core::get_texture_size(gl::RGBA8, 1, 1));
+		gl::BindTexture(gl::TEXTURE_2D, mWhiteTexture);
+		gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::NEAREST);
+		gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::NEAREST);
+		gl::TexImage2D(gl::TEXTURE_2D, 0, gl::RGBA, 1, 1, 0, gl::RGBA, gl::UNSIGNED_BYTE, &white);
+
+		// the buffer is set in BindStreamBuffer
+		const GLuint locations[] = { (GLuint)mLocationRect, (GLuint)mLocationRotation, (GLuint)mLocationUV, (GLuint)mLocationColor };
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			mVao = create_vertex_array("Renderer2D");
+			for (const GLuint location : locations)
+			{
+				ext::EnableVertexArrayAttrib(mVao, location);
+				ext::VertexArrayAttribBinding(mVao, location, 0);
+			}
+			ext::VertexArrayAttribFormat(mVao, mLocationRect, 4, gl::FLOAT, gl::FALSE_, (GLuint)offsetof(Instance, mRect));
+			ext::VertexArrayAttribFormat(mVao, mLocationRotation, 1, gl::FLOAT, gl::FALSE_, (GLuint)offsetof(Instance, mRotation));
+			ext::VertexArrayAttribFormat(mVao, mLocationUV, 4, gl::UNSIGNED_SHORT, gl::TRUE_, (GLuint)offsetof(Instance, mUV));
+			ext::VertexArrayAttribFormat(mVao, mLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, (GLuint)offsetof(Instance, mColor));
+			ext::VertexArrayBindingDivisor(mVao, 0, 1);
+		}
+		else
+		{
+			mVao = my_gl_core::create_vertex_array("Renderer2D");
+			gl::BindVertexArray(mVao);
+			for (const GLuint location : locations)
+			{
+				gl::EnableVertexAttribArray(location);
+				gl::VertexAttribDivisor(location, 1);
+			}
+		}
+
+		gl::GenQueries(QUERY_NUM, mQueries);
+
+		gl::BindTexture(gl::TEXTURE_2D, last_texture);
+		gl::BindVertexArray(last_vertex_array);
+		CheckOGLError();
+	}
+
+	void Renderer2D::Renderer2D_impl::BindStreamBuffer(const my_gl_core::StreamBuffer::Range & range)
+	{
+		if (isStreamBufferBound(range))
+			return;
+		mBoundStreamBuffer = range.mBuffer;
+		mBoundStreamGeneration = range.mGeneration;
+		const GLuint buffer = range.mBuffer;
+
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::VertexArrayVertexBuffer(mVao, 0, buffer, 0, sizeof(Instance));
+			return;
+		}
+
+		// IMPORTANT(Borja): Our vertex array needs to be bound.
+		gl::BindBuffer(gl::ARRAY_BUFFER, buffer);
+		gl::VertexAttribPointer(mLocationRect, 4, gl::FLOAT, gl::FALSE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mRect));
+		gl::VertexAttribPointer(mLocationRotation, 1, gl::FLOAT, gl::FALSE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mRotation));
+		gl::VertexAttribPointer(mLocationUV, 4, gl::UNSIGNED_SHORT, gl::TRUE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mUV));
+		gl::VertexAttribPointer(mLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, sizeof(Instance), (GLvoid*)offsetof(Instance, mColor));
+	}
+
+	void Renderer2D::Renderer2D_impl::Begin(Window & window)
+	{
+		mpWindow = &window;
+		mpStreamBuffer = &window.getStreamBuffer();
+		mvInstances.clear();
+		mvKeys.clear();
+		mTextureIds.clear();
+		mvTextures.clear();
+		mLastTexture = 0;
+		mLastTextureId = 0;
+		getTextureId(0);	// id 0 is the white texture
+		mLayer = 0;
+		mBlendMode = BlendMode::Alpha;
+	}
+
+	void Renderer2D::Renderer2D_impl::Submit(float x, float y, float w, float h, float rotation, unsigned color,
+											 GLuint texture, float u0, float v0, float u1, float v1)
+	{
+		const std::uint64_t index = mvInstances.size();
+		if (index >= (1ull << KEY_INDEX_BITS))
+			return;
+		const std::uint64_t texture_id = getTextureId(texture);
+		if (texture_id >= (1ull << KEY_TEXTURE_BITS))
+			return;
+
+		auto to_unorm16 = [](float v) { return static_cast<unsigned short>(v <= 0.f ? 0.f : v >= 1.f ? 65535.f : v * 65535.f + 0.5f); };
+
+		Instance instance;
+		instance.mRect[0] = x;
+		instance.mRect[1] = y;
+		instance.mRect[2] = w;
+		instance.mRect[3] = h;
+		instance.mRotation = rotation;
+		instance.mUV[0] = to_unorm16(u0);
+		instance.mUV[1] = to_unorm16(v0);
+		instance.mUV[2] = to_unorm16(u1);
+		instance.mUV[3] = to_unorm16(v1);
+		instance.mColor = color;
+		mvInstances.push_back(instance);
+
+		const std::uint64_t key = (static_cast<std::uint64_t>(mLayer) << (KEY_INDEX_BITS + KEY_TEXTURE_BITS + KEY_BLEND_BITS))
+								| (static_cast<std::uint64_t>(mBlendMode) << (KEY_INDEX_BITS + KEY_TEXTURE_BITS))
+								| (texture_id << KEY_INDEX_BITS)
+								| index;
+		mvKeys.push_back(key);
+	}
+
+	std::uint64_t Renderer2D::Renderer2D_impl::getTextureId(GLuint texture)
+	{
+		if (texture == mLastTexture && !mvTextures.empty())
+			return mLastTextureId;
+
+		const auto inserted = mTextureIds.emplace(texture, static_cast<unsigned>(mvTextures.size()));
+		if (inserted.second)
+			mvTextures.push_back(texture);
+		mLastTexture = texture;
+		mLastTextureId = inserted.first->second;
+		return mLastTextureId;
+	}
+
+	GLuint Renderer2D::Renderer2D_impl::getKeyTexture(std::uint64_t state) const
+	{
+		const GLuint texture = mvTextures[static_cast<std::size_t>((state >> KEY_INDEX_BITS) & ((1u << KEY_TEXTURE_BITS) - 1))];
+		return texture ? texture : mWhiteTexture;
+	}
+
+	void Renderer2D::Renderer2D_impl::ApplyBlendMode(BlendMode blend_mode)
+	{
+		switch (blend_mode)
+		{
+		case BlendMode::Opaque:
+		{
+			gl::Disable(gl::BLEND);
+		} break;
+		case BlendMode::Alpha:
+		{
+			gl::Enable(gl::BLEND);
+			gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+		} break;
+		case BlendMode::Additive:
+		{
+			gl::Enable(gl::BLEND);
+			gl::BlendFunc(gl::SRC_ALPHA, gl::ONE);
+		} break;
+		}
+	}
+
+	void Renderer2D::Renderer2D_impl::ReadGpuTime()
+	{
+		// the oldest query is the next one we are going to reuse
+		const unsigned oldest = (mQueryIndex + 1) % QUERY_NUM;
+		if (!mbQueryPending[oldest])
+			return;
+
+		GLuint64 available = 0;
+		gl::GetQueryObjectui64v(mQueries[oldest], gl::QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return;
+
+		GLuint64 elapsed_ns = 0;
+		gl::GetQueryObjectui64v(mQueries[oldest], gl::QUERY_RESULT, &elapsed_ns);
+		mStats.mGpuMs = static_cast<double>(elapsed_ns) / 1000000.0;
+		mbQueryPending[oldest] = false;
+	}
+
+	void Renderer2D::Renderer2D_impl::End(RenderQueue * queue)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		mStats.mQuads = static_cast<unsigned>(mvInstances.size());
+		mStats.mDrawCalls = 0;
+		ReadGpuTime();
+
+		if (mvInstances.empty() || !mpWindow)
+		{
+			mStats.mCpuMs = 0.0;
+			return;
+		}
+
+		// most of the time the quads are submitted grouped by state already
+		if (!std::is_sorted(mvKeys.begin(), mvKeys.end()))
+			std::sort(mvKeys.begin(), mvKeys.end());
+
+		// gather the instances in sorted order straight into the stream buffer
+		const std::uint64_t index_mask = (1ull << KEY_INDEX_BITS) - 1;
+		const GLsizeiptr size = static_cast<GLsizeiptr>(mvInstances.size() * sizeof(Instance));
+		const my_gl_core::StreamBuffer::Range range = mpStreamBuffer->Allocate(size, sizeof(Instance));
+		{
+			Instance * dst = static_cast<Instance *>(range.mpData);
+			for (const std::uint64_t key : mvKeys)
+				*dst++ = mvInstances[key & index_mask];
+		}
+		mpStreamBuffer->Commit(range);
+
+		const float w = static_cast<float>(mpWindow->getWindowWidth());
+		const float h = static_cast<float>(mpWindow->getWindowHeight());
+		const Mat4 ortho_projection = Mat4::Ortho(0.0f, w, h, 0.0f, -1.0f, 1.0f);
+		if (queue)
+		{
+			SubmitBatches(*queue, range, ortho_projection);
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			mStats.mCpuMs = elapsed.count();
+			return;
+		}
+
+		// Backup GL state
+		GLint last_program, last_texture, last_array_buffer = 0, last_vertex_array;
+		GLint last_blend_src, last_blend_dst;
+		const GLboolean last_blend = gl::IsEnabled(gl::BLEND);
+		const GLboolean last_depth_test = gl::IsEnabled(gl::DEPTH_TEST);
+		gl::GetIntegerv(gl::CURRENT_PROGRAM, &last_program);
+		gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+		gl::GetIntegerv(gl::BLEND_SRC_RGB, &last_blend_src);
+		gl::GetIntegerv(gl::BLEND_DST_RGB, &last_blend_dst);
+		const bool rebind_buffer = !isStreamBufferBound(range);
+		if (!mbUseDSA && rebind_buffer)
+			gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
+
+		gl::BeginQuery(gl::TIME_ELAPSED, mQueries[mQueryIndex]);
+
+		gl::Disable(gl::DEPTH_TEST);
+		gl::UseProgram(mProgram);
+		gl::Uniform1i(mLocationTex, 0);
+		gl::UniformMatrix4fv(mLocationProjMtx, 1, gl::FALSE_, ortho_projection.data());
+		gl::ActiveTexture(gl::TEXTURE0);
+		gl::BindVertexArray(mVao);
+		BindStreamBuffer(range);
+
+		// one draw call per run of quads with the same blend mode and texture
+		const std::uint64_t state_mask = ~index_mask;
+		const std::size_t first_instance = static_cast<std::size_t>(range.mOffset / sizeof(Instance));
+		const unsigned blend_shift = KEY_INDEX_BITS + KEY_TEXTURE_BITS;
+		std::uint64_t last_blend_key = ~0ull;
+		std::size_t batch_start = 0;
+		while (batch_start < mvKeys.size())
+		{
+			const std::uint64_t state = mvKeys[batch_start] & state_mask;
+			std::size_t batch_end = batch_start + 1;
+			while (batch_end < mvKeys.size() && (mvKeys[batch_end] & state_mask) == state)
+				++batch_end;
+
+			const std::uint64_t blend_key = (state >> blend_shift) & ((1u << KEY_BLEND_BITS) - 1);
+			if (blend_key != last_blend_key)
+			{
+				ApplyBlendMode(static_cast<BlendMode>(blend_key));
+				last_blend_key = blend_key;
+			}
+
+			const GLuint texture = getKeyTexture(state);
+			if (mbUseDSA)	my_gl_core::ext::BindTextureUnit(0, texture);
+			else			gl::BindTexture(gl::TEXTURE_2D, texture);
+
+			gl::DrawArraysInstancedBaseInstance(gl::TRIANGLE_STRIP, 0, 4,
+				static_cast<GLsizei>(batch_end - batch_start), static_cast<GLuint>(first_instance + batch_start));
+			++mStats.mDrawCalls;
+
+			batch_start = batch_end;
+		}
+
+		gl::EndQuery(gl::TIME_ELAPSED);
+		mbQueryPending[mQueryIndex] = true;
+		mQueryIndex = (mQueryIndex + 1) % QUERY_NUM;
+
+		// Restore modified GL state
+		gl::UseProgram(last_program);
+		gl::BindTexture(gl::TEXTURE_2D, last_texture);
+		if (!mbUseDSA && rebind_buffer)
+			gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
+		gl::BindVertexArray(last_vertex_array);
+		gl::BlendFunc(last_blend_src, last_blend_dst);
+		if (last_blend)	gl::Enable(gl::BLEND);
+		else			gl::Disable(gl::BLEND);
+		if (last_depth_test)	gl::Enable(gl::DEPTH_TEST);
+		CheckOGLError();
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		mStats.mCpuMs = elapsed.count();
+	}
+
+	void Renderer2D::Renderer2D_impl::SubmitBatches(RenderQueue & queue, const my_gl_core::StreamBuffer::Range & range, const Mat4 & projection)
+	{
+		// IMPORTANT(Borja): The stream buffer is attached to our vertex array now, the queue only binds it.
+		// Attaching another buffer before RenderQueue::Execute would move the batches already submitted.
+		if (mbUseDSA)
+		{
+			BindStreamBuffer(range);
+		}
+		else if (!isStreamBufferBound(range))
+		{
+			GLint last_array_buffer, last_vertex_array;
+			gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
+			gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
+			gl::BindVertexArray(mVao);
+			BindStreamBuffer(range);
+			gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
+			gl::BindVertexArray(last_vertex_array);
+			CheckOGLError();
+		}
+
+		// same runs as the direct path, each one a command with the state of its key
+		const std::uint64_t index_mask = (1ull << KEY_INDEX_BITS) - 1;
+		const std::uint64_t state_mask = ~index_mask;
+		const std::size_t first_instance = static_cast<std::size_t>(range.mOffset / sizeof(Instance));
+		const unsigned blend_shift = KEY_INDEX_BITS + KEY_TEXTURE_BITS;
+		const unsigned layer_shift = blend_shift + KEY_BLEND_BITS;
+		std::size_t batch_start = 0;
+		while (batch_start < mvKeys.size())
+		{
+			const std::uint64_t state = mvKeys[batch_start] & state_mask;
+			std::size_t batch_end = batch_start + 1;
+			while (batch_end < mvKeys.size() && (mvKeys[batch_end] & state_mask) == state)
+				++batch_end;
+
+			const GLuint texture = getKeyTexture(state);
+
+			// the blend modes of both are in the same order
+			const std::uint64_t blend_key = (state >> blend_shift) & ((1u << KEY_BLEND_BITS) - 1);
+			queue.setLayer(static_cast<unsigned char>(state >> layer_shift));
+			queue.setBlendMode(static_cast<RenderQueue::BlendMode>(blend_key));
+			queue.setDepthMode(RenderQueue::DepthMode::Off);
+			queue.setUniform(mLocationTex, 0);
+			queue.setUniform(mLocationProjMtx, projection);
+			queue.Submit(RenderQueue::DrawCommand{ mProgram, mVao, texture, gl::TRIANGLE_STRIP, 0, 0, 4,
+												   static_cast<GLsizei>(batch_end - batch_start), 0,
+												   static_cast<GLuint>(first_instance + batch_start) });
+			++mStats.mDrawCalls;
+
+			batch_start = batch_end;
+		}
+	}
+
+	Renderer2D::Renderer2D()
+		: mpImpl(std::make_unique<Renderer2D_impl>())
+	{}
+	Renderer2D::~Renderer2D() {}
+
+	void Renderer2D::Begin(Window & window)
+	{
+		mpImpl->Begin(window);
+	}
+	void Renderer2D::End(RenderQueue * queue)
+	{
+		mpImpl->End(queue);
+	}
+	void Renderer2D::setLayer(unsigned char layer)
+	{
+		mpImpl->setLayer(layer);
+	}
+	void Renderer2D::setBlendMode(BlendMode blend_mode)
+	{
+		mpImpl->setBlendMode(blend_mode);
+	}
+	void Renderer2D::DrawQuad(float x, float y, float w, float h, float rotation, unsigned color)
+	{
+		mpImpl->Submit(x, y, w, h, rotation, color, 0, 0.f, 0.f, 1.f, 1.f);
+	}
+	void Renderer2D::DrawSprite(float x, float y, float w, float h, float rotation, unsigned color,
+								unsigned texture, float u0, float v0, float u1, float v1)
+	{
+		mpImpl->Submit(x, y, w, h, rotation, color, texture, u0, v0, u1, v1);
+	}
+	void Renderer2D::DrawLine(float x0, float y0, float x1, float y1, float thickness, unsigned color)
+	{
+		// a line is a quad centered in the segment and rotated along it
+		const float dx = x1 - x0;
+		const float dy = y1 - y0;
+		const float length = std::sqrt(dx * dx + dy * dy);
+		mpImpl->Submit((x0 + x1) * 0.5f, (y0 + y1) * 0.5f, length, thickness, std::atan2(dy, dx), color,
+					   0, 0.f, 0.f, 1.f, 1.f);
+	}
+	const Renderer2D::Stats & Renderer2D::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
@@ -0,0 +1,67 @@
+/*!
+\brief	Batched 2D renderer for sprites, lines and quads.
+*/
+
+#pragma once
+
+#include <memory>	// std::unique_ptr
+
+namespace app
+{
+	class Window;
+	class RenderQueue;
+
+	/// \brief	Draws textured/colored quads with instanced rendering. The quads submitted between
+	/// Renderer2D::Begin and Renderer2D::End are sorted by layer, blend mode and texture and every run
+	/// that shares the same state becomes a single draw call.
+	/// Coordinates are in pixels with the origin in the top left corner of the window (like ImGui).
+	class Renderer2D
+	{
+	public:
+		enum class BlendMode
+		{
+			Opaque,
+			Alpha,
+			Additive,
+		};
+
+		struct Stats
+		{
+			unsigned	mQuads{ 0 };
+			unsigned	mDrawCalls{ 0 };
+			double		mCpuMs{ 0.0 };		// time spent sorting, uploading and submitting in Renderer2D::End
+			double		mGpuMs{ 0.0 };		// GPU time of the draw calls (a few frames late), not measured when queued
+		};
+
+		Renderer2D();
+		~Renderer2D();
+
+		/// \brief	Starts a new batch, the window provides the projection and the stream buffer.
+		void Begin(Window & window);
+		/// \brief	Sorts and renders all the quads submitted since Renderer2D::Begin.
+		/// \param	queue	If given, the draw calls are submitted to it instead and drawn by RenderQueue::Execute,
+		///					which has to be called before the next Renderer2D::End.
+		void End(RenderQueue * queue = nullptr);
+
+		/// \brief	Quads submitted after this call are drawn on top of the ones on lower layers.
+		void setLayer(unsigned char layer);
+		void setBlendMode(BlendMode blend_mode);
+
+		/// \param	x, y		Center of the quad.
+		/// \param	rotation	In radians.
+		/// \param	color		RGBA packed as 0xAABBGGRR (same as ImGui).
+		void DrawQuad(float x, float y, float w, float h, float rotation, unsigned color);
+		/// \param	texture		OpenGL texture name.
+		/// \param	u0, v0, u1, v1	Texture coordinates of the top left and bottom right corners.
+		void DrawSprite(float x, float y, float w, float h, float rotation, unsigned color,
+						unsigned texture, float u0 = 0.f, float v0 = 0.f, float u1 = 1.f, float v1 = 1.f);
+		void DrawLine(float x0, float y0, float x1, float y1, float thickness, unsigned color);
+
+		/// \return	Stats of the last Renderer2D::End call.
+		const Stats & getStats() const;
+
+	private:
+		class Renderer2D_impl;
+		std::unique_ptr<Renderer2D_impl> mpImpl;
+	};
+}
@@ -0,0 +1,511 @@
+/*!
+\brief	Programs built from GLSL files, rebuilt without blocking the frame when the files change.
+*/
+
+#include "ShaderLibrary.h"
+
+#include "my_gl_resources.h"	// my_gl_core::create_program, my_gl_core::delete_program
+#include "Log.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>	// FindFirstChangeNotificationA, GetFileAttributesExA
+#else
+#include <sys/inotify.h>	// inotify_init1, inotify_add_watch
+#include <unistd.h>			// read, close
+#endif
+
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <fstream>		// std::ifstream
+#include <iterator>		// std::istreambuf_iterator
+#include <string>		// std::string
+#include <vector>		// std::vector
+
+namespace app
+{
+	namespace
+	{
+		/// \brief	Reports the files that changed since the last Poll. It watches their directories
+		/// since most editors save by writing a new file and renaming it over the old one.
+		class FileWatcher
+		{
+		public:
+			FileWatcher()
+			{
+#ifndef _WIN32
+				mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+				if (mInotify < 0)
+					APP_LOG_WARNING(log::Category::Assets, "inotify is not available, the shaders won't be reloaded");
+#endif
+			}
+			~FileWatcher()
+			{
+#ifdef _WIN32
+				for (const Directory & directory : mvDirectories)
+				{
+					if (directory.mHandle != INVALID_HANDLE_VALUE)
+						FindCloseChangeNotification(directory.mHandle);
+				}
+#else
+				if (mInotify >= 0)
+					close(mInotify);	// removes the watches
+#endif
+			}
+			FileWatcher(const FileWatcher &) = delete;
+			FileWatcher & operator=(const FileWatcher &) = delete;
+
+			/// \return	Index of the file, the one Poll reports.
+			std::size_t Add(const std::string & path)
+			{
+				File file;
+				const std::size_t slash = path.find_last_of("/\\");
+				const std::string directory = slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+				file.mName = slash == std::string::npos ? path : path.substr(slash + 1);
+				file.mDirectory = AddDirectory(directory);
+#ifdef _WIN32
+				file.mPath = path;
+				file.mWriteTime = GetWriteTime(path);
+#endif
+				mvFiles.push_back(file);
+				return mvFiles.size() - 1;
+			}
+
+			/// \brief	Doesn't block, appends the indices of the files that changed.
+			void Poll(std::vector<std::size_t> & changed)
+			{
+#ifdef _WIN32
+				// the notification doesn't say which file changed, their write times do
+				for (std::size_t d = 0; d < mvDirectories.size(); ++d)
+				{
+					Directory & directory = mvDirectories[d];
+					if (directory.mHandle == INVALID_HANDLE_VALUE || WaitForSingleObject(directory.mHandle, 0) != WAIT_OBJECT_0)
+						continue;
+					FindNextChangeNotification(directory.mHandle);
+
+					for (std::size_t f = 0; f < mvFiles.size(); ++f)
+					{
+						File & file = mvFiles[f];
+						if (file.mDirectory != d)
+							continue;
+						const unsigned long long write_time = GetWriteTime(file.mPath);
+						if (write_time != file.mWriteTime && write_time != 0)
+						{
+							file.mWriteTime = write_time;
+							changed.push_back(f);
+						}
+					}
+				}
+#else
+				if (mInotify < 0)
+					return;
+
+				alignas(inotify_event) char buffer[4096];
+				for (;;)
+				{
+					const ssize_t size = read(mInotify, buffer, sizeof(buffer));
+					if (size <= 0)
+						break;
+					for (ssize_t offset = 0; offset < size; )
+					{
+						const inotify_event * event = reinterpret_cast<const inotify_event *>(buffer + offset);
+						offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+						if (event->len == 0)
+							continue;
+						for (std::size_t f = 0; f < mvFiles.size(); ++f)
+						{
+							const File & file = mvFiles[f];
+							if (mvDirectories[file.mDirectory].mWatch == event->wd && file.mName == event->name)
+								changed.push_back(f);
+						}
+					}
+				}
+#endif
+			}
+
+		private:
+			struct Directory
+			{
+				std::string	mPath;
+#ifdef _WIN32
+				HANDLE		mHandle;
+#else
+				int			mWatch;
+#endif
+			};
+			struct File
+			{
+				std::size_t			mDirectory;
+				std::string			mName;
+#ifdef _WIN32
+				std::string			mPath;
+				unsigned long long	mWriteTime;
+#endif
+			};
+
+			std::size_t AddDirectory(const std::string & path)
+			{
+				for (std::size_t d = 0; d < mvDirectories.size(); ++d)
+				{
+					if (mvDirectories[d].mPath == path)
+						return d;
+				}
+
+				Directory directory;
+				directory.mPath = path;
+#ifdef _WIN32
+				directory.mHandle = FindFirstChangeNotificationA(path.c_str(), FALSE,
+																 FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+				if (directory.mHandle == INVALID_HANDLE_VALUE)
+					APP_LOG_WARNING(log::Category::Assets, "Couldn't watch the directory {}", path);
+#else
+				directory.mWatch = mInotify >= 0 ? inotify_add_watch(mInotify, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) : -1;
+				if (mInotify >= 0 && directory.mWatch < 0)
+					APP_LOG_WARNING(log::Category::Assets, "Couldn't watch the directory {}", path);
+#endif
+				mvDirectories.push_back(directory);
+				return mvDirectories.size() - 1;
+			}
+
+#ifdef _WIN32
+			/// \return	0 if the file can't be read (i.e. while it is being replaced).
+			static unsigned long long GetWriteTime(const std::string & path)
+			{
+				WIN32_FILE_ATTRIBUTE_DATA data;
+				if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+					return 0;
+				return (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+			}
+#else
+			int mInotify{ -1 };
+#endif
+			std::vector<Directory> mvDirectories;
+			std::vector<File> mvFiles;
+		};
+
+		std::string GetInfoLog(GLuint object, bool program)
+		{
+			GLint length = 0;
+			if (program)
+				gl::GetProgramiv(object, gl::INFO_LOG_LENGTH, &length);
+			else
+				gl::GetShaderiv(object, gl::INFO_LOG_LENGTH, &length);
+			if (length <= 1)
+				return std::string();
+
+			std::string log(static_cast<std::size_t>(length), '\0');
+			if (program)
+				gl::GetProgramInfoLog(object, length, nullptr, &log[0]);
+			else
+				gl::GetShaderInfoLog(object, length, nullptr, &log[0]);
+			log.resize(static_cast<std::size_t>(length - 1));	// without the null
+			return log;
+		}
+	}
+
+	class ShaderLibrary::ShaderLibrary_impl
+	{
+	public:
+		explicit ShaderLibrary_impl(const char * owner);
+		~ShaderLibrary_impl();
+
+		ProgramId Load(const char * vertex_file, const char * fragment_file);
+		GLuint getProgram(ProgramId id) const;
+		unsigned getVersion(ProgramId id) const;
+		void Update();
+		void ReloadAll();
+		const Stats & getStats() const;
+
+	private:
+		enum class Stage
+		{
+			Idle,
+			CompileFragment,	// the vertex shader is compiling
+			Link,
+			Wait,				// linking
+		};
+		enum : unsigned { VERTEX, FRAGMENT, SHADER_NUM };
+
+		struct Program
+		{
+			std::string	mFiles[SHADER_NUM];
+			GLuint		mProgram{ 0 };		// last one that linked
+			unsigned	mVersion{ 0 };
+			bool		mbDirty{ false };	// the files changed, it is rebuilt when the current build finishes
+
+			// build in progress
+			Stage		mStage{ Stage::Idle };
+			GLuint		mShaders[SHADER_NUM]{ 0, 0 };
+			GLuint		mNewProgram{ 0 };
+			std::chrono::high_resolution_clock::time_point mBuildStart;
+		};
+
+		/// \brief	Reads the files and issues the first stage, or all of them with parallel compile.
+		/// \return	False if the files can't be read.
+		bool StartBuild(Program & program);
+		/// \brief	Issues the next stage of the build.
+		/// \param	block	Wait for the link to finish even if the driver compiles in parallel.
+		void Advance(Program & program, bool block);
+		/// \brief	Swaps the program if it linked, logs the errors otherwise.
+		void FinishBuild(Program & program);
+		void DeleteBuild(Program & program);
+
+		const char * mOwner;
+		bool mbParallelCompile{ false };
+		FileWatcher mWatcher;
+		std::vector<Program> mvPrograms;
+		/// \brief	Program of every file of mWatcher.
+		std::vector<ProgramId> mvFilePrograms;
+		std::vector<std::size_t> mvChangedFiles;
+		Stats mStats;
+	};
+
+	ShaderLibrary::ShaderLibrary_impl::ShaderLibrary_impl(const char * owner)
+		: mOwner(owner)
+	{
+		mbParallelCompile = my_gl_core::get_caps().parallel_shader_compile;
+		// as many threads as the driver wants
+		if (mbParallelCompile)
+			my_gl_core::ext::MaxShaderCompilerThreads(0xFFFFFFFFu);
+		mStats.mbParallelCompile = mbParallelCompile;
+	}
+	ShaderLibrary::ShaderLibrary_impl::~ShaderLibrary_impl()
+	{
+		for (Program & program : mvPrograms)
+		{
+			DeleteBuild(program);
+			my_gl_core::delete_program(program.mProgram);
+		}
+	}
+
+	ShaderLibrary::ProgramId ShaderLibrary::ShaderLibrary_impl::Load(const char * vertex_file, const char * fragment_file)
+	{
+		const ProgramId id = static_cast<ProgramId>(mvPrograms.size());
+		mvPrograms.emplace_back();
+		Program & program = mvPrograms.back();
+		program.mFiles[VERTEX] = vertex_file;
+		program.mFiles[FRAGMENT] = fragment_file;
+		for (const std::string & file : program.mFiles)
+		{
+			mWatcher.Add(file);
+			mvFilePrograms.push_back(id);
+		}
+		++mStats.mPrograms;
+
+		if (StartBuild(program))
+		{
+			while (program.mStage != Stage::Idle)
+				Advance(program, true);
+		}
+		return id;
+	}
+
+	GLuint ShaderLibrary::ShaderLibrary_impl::getProgram(ProgramId id) const
+	{
+		return mvPrograms[id].mProgram;
+	}
+
+	unsigned ShaderLibrary::ShaderLibrary_impl::getVersion(ProgramId id) const
+	{
+		return mvPrograms[id].mVersion;
+	}
+
+	void ShaderLibrary::ShaderLibrary_impl::Update()
+	{
+		mWatcher.Poll(mvChangedFiles);
+		for (const std::size_t file : mvChangedFiles)
+			mvPrograms[mvFilePrograms[file]].mbDirty = true;
+		mvChangedFiles.clear();
+
+		// without parallel compile every stage blocks the driver for a while, one per frame
+		bool issued = false;
+		mStats.mPending = 0;
+		for (Program & program : mvPrograms)
+		{
+			if (program.mStage == Stage::Idle && !program.mbDirty)
+				continue;
+			if (!mbParallelCompile && issued)
+			{
+				++mStats.mPending;
+				continue;
+			}
+
+			if (program.mStage == Stage::Idle)
+			{
+				program.mbDirty = false;
+				StartBuild(program);
+			}
+			else
+			{
+				Advance(program, false);
+			}
+			issued = true;
+			if (program.mStage != Stage::Idle)
+				++mStats.mPending;
+		}
+	}
+
+	void ShaderLibrary::ShaderLibrary_impl::ReloadAll()
+	{
+		for (Program & program : mvPrograms)
+			program.mbDirty = true;
+	}
+
+	const ShaderLibrary::Stats & ShaderLibrary::ShaderLibrary_impl::getStats() const
+	{
+		return mStats;
+	}
+
+	bool ShaderLibrary::ShaderLibrary_impl::StartBuild(Program & program)
+	{
+		std::string sources[SHADER_NUM];
+		for (unsigned s = 0; s < SHADER_NUM; ++s)
+		{
+			std::ifstream file{ program.mFiles[s], std::ios::binary };
+			if (!file)
+			{
+				APP_LOG_WARNING(log::Category::GL, "Couldn't read the shader {}", program.mFiles[s]);
+				return false;
+			}
+			sources[s].assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+
+		program.mBuildStart = std::chrono::high_resolution_clock::now();
+		const GLenum types[SHADER_NUM] = { gl::VERTEX_SHADER, gl::FRAGMENT_SHADER };
+		for (unsigned s = 0; s < SHADER_NUM; ++s)
+		{
+			const GLchar * source = sources[s].c_str();
+			program.mShaders[s] = gl::CreateShader(types[s]);
+			gl::ShaderSource(program.mShaders[s], 1, &source, nullptr);
+		}
+
+		// the compile and link calls return right away, COMPLETION_STATUS tells when they are done
+		if (mbParallelCompile)
+		{
+			gl::CompileShader(program.mShaders[VERTEX]);
+			gl::CompileShader(program.mShaders[FRAGMENT]);
+			program.mStage = Stage::Link;
+			Advance(program, false);
+		}
+		else
+		{
+			gl::CompileShader(program.mShaders[VERTEX]);
+			program.mStage = Stage::CompileFragment;
+		}
+		CheckOGLError();
+		return true;
+	}
+
+	void ShaderLibrary::ShaderLibrary_impl::Advance(Program & program, bool block)
+	{
+		switch (program.mStage)
+		{
+		case Stage::Idle:
+			break;
+		case Stage::CompileFragment:
+		{
+			gl::CompileShader(program.mShaders[FRAGMENT]);
+			program.mStage = Stage::Link;
+		} break;
+		case Stage::Link:
+		{
+			program.mNewProgram = my_gl_core::create_program(mOwner);
+			gl::AttachShader(program.mNewProgram, program.mShaders[VERTEX]);
+			gl::AttachShader(program.mNewProgram, program.mShaders[FRAGMENT]);
+			gl::LinkProgram(program.mNewProgram);
+			program.mStage = Stage::Wait;
+		} break;
+		case Stage::Wait:
+		{
+			if (mbParallelCompile && !block)
+			{
+				GLint done = gl::FALSE_;
+				gl::GetProgramiv(program.mNewProgram, my_gl_core::ext::COMPLETION_STATUS, &done);
+				if (done == gl::FALSE_)
+					break;
+			}
+			FinishBuild(program);
+		} break;
+		}
+		CheckOGLError();
+	}
+
+	void ShaderLibrary::ShaderLibrary_impl::FinishBuild(Program & program)
+	{
+		GLint linked = gl::FALSE_;
+		gl::GetProgramiv(program.mNewProgram, gl::LINK_STATUS, &linked);
+		if (linked != gl::FALSE_)
+		{
+			// the old program can still be in use by the commands in flight, GL deletes it when they finish
+			my_gl_core::delete_program(program.mProgram);
+			program.mProgram = program.mNewProgram;
+			program.mNewProgram = 0;
+			++program.mVersion;
+			if (program.mVersion > 1)
+				++mStats.mReloads;
+
+			mStats.mLastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - program.mBuildStart).count();
+			APP_LOG_INFO(log::Category::GL, "Shaders {} + {} built in {} ms", program.mFiles[VERTEX], program.mFiles[FRAGMENT], mStats.mLastBuildMs);
+		}
+		else
+		{
+			++mStats.mFailures;
+			for (unsigned s = 0; s < SHADER_NUM; ++s)
+			{
+				GLint compiled = gl::FALSE_;
+				gl::GetShaderiv(program.mShaders[s], gl::COMPILE_STATUS, &compiled);
+				if (compiled == gl::FALSE_)
+					APP_LOG_ERROR(log::Category::GL, "Shader {} doesn't compile:\n{}", program.mFiles[s], GetInfoLog(program.mShaders[s], false));
+			}
+			APP_LOG_ERROR(log::Category::GL, "Program {} + {} doesn't link, keeping the last one that did:\n{}",
+						  program.mFiles[VERTEX], program.mFiles[FRAGMENT], GetInfoLog(program.mNewProgram, true));
+		}
+		DeleteBuild(program);
+	}
+
+	void ShaderLibrary::ShaderLibrary_impl::DeleteBuild(Program & program)
+	{
+		for (GLuint & shader : program.mShaders)
+		{
+			if (shader == 0)
+				continue;
+			if (program.mNewProgram)
+				gl::DetachShader(program.mNewProgram, shader);
+			gl::DeleteShader(shader);
+			shader = 0;
+		}
+		my_gl_core::delete_program(program.mNewProgram);
+		program.mStage = Stage::Idle;
+	}
+
+	ShaderLibrary::ShaderLibrary(const char * owner)
+		: mpImpl(std::make_unique<ShaderLibrary_impl>(owner))
+	{
+	}
+	ShaderLibrary::~ShaderLibrary() = default;
+
+	ShaderLibrary::ProgramId ShaderLibrary::Load(const char * vertex_file, const char * fragment_file)
+	{
+		return mpImpl->Load(vertex_file, fragment_file);
+	}
+	GLuint ShaderLibrary::getProgram(ProgramId id) const
+	{
+		return mpImpl->getProgram(id);
+	}
+	unsigned ShaderLibrary::getVersion(ProgramId id) const
+	{
+		return mpImpl->getVersion(id);
+	}
+	void ShaderLibrary::Update()
+	{
+		mpImpl->Update();
+	}
+	void ShaderLibrary::ReloadAll()
+	{
+		mpImpl->ReloadAll();
+	}
+	const ShaderLibrary::Stats & ShaderLibrary::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
@@ -0,0 +1,64 @@
+/*!
+\brief	Programs built from GLSL files, rebuilt without blocking the frame when the files change.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"	// GLuint
+
+#include <memory>		// std::unique_ptr
+
+namespace app
+{
+	/// \brief	Loads programs from a vertex and a fragment shader file and watches the files
+	/// (inotify on Linux, change notifications of their directories on Windows).
+	/// Update rebuilds the programs whose files changed: with KHR/ARB_parallel_shader_compile the driver
+	/// compiles them in its own threads and Update only polls them, otherwise a single stage
+	/// (compile vertex, compile fragment, link) is issued per frame.
+	/// A rebuilt program replaces the old one in Update, and only if it links: on error the last good
+	/// program is kept and the info logs are logged.
+	/// IMPORTANT(Borja): Not thread safe, it needs to be used from the thread of the GL context.
+	class ShaderLibrary
+	{
+	public:
+		typedef unsigned ProgramId;
+
+		struct Stats
+		{
+			unsigned			mPrograms{ 0 };
+			unsigned			mPending{ 0 };			// builds in progress
+			unsigned long long	mReloads{ 0 };			// programs replaced after a change
+			unsigned long long	mFailures{ 0 };			// builds that didn't compile or link
+			double				mLastBuildMs{ 0.0 };	// from the start of the last build to the swap
+			bool				mbParallelCompile{ false };
+		};
+
+		/// \param	owner	Of the programs in the resource registry.
+		explicit ShaderLibrary(const char * owner = "ShaderLibrary");
+		~ShaderLibrary();
+		ShaderLibrary(const ShaderLibrary &) = delete;
+		ShaderLibrary & operator=(const ShaderLibrary &) = delete;
+
+		/// \brief	Builds the program right away (blocking) and starts watching its files.
+		/// If it doesn't build its program is 0 until the files are fixed.
+		ProgramId Load(const char * vertex_file, const char * fragment_file);
+
+		/// \return	The last program that linked, 0 if none did.
+		GLuint getProgram(ProgramId id) const;
+		/// \brief	Incremented every time the program is replaced, the locations of its uniforms
+		/// need to be queried again when it changes.
+		unsigned getVersion(ProgramId id) const;
+
+		/// \brief	Checks the files and the builds in progress, and swaps the programs that finished.
+		/// Called once per frame.
+		void Update();
+		/// \brief	Rebuilds every program as if their files had changed.
+		void ReloadAll();
+
+		const Stats & getStats() const;
+
+	private:
+		class ShaderLibrary_impl;
+		std::unique_ptr<ShaderLibrary_impl> mpImpl;
+	};
+}
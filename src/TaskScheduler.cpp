@@ -0,0 +1,293 @@
+/*!
+\brief	Resumable tasks for the operations that take several frames (loading, streaming, animations).
+*/
+
+#include "TaskScheduler.h"
+#include "JobSystem.h"	// JobCounter
+
+#include <vector>		// std::vector
+#include <algorithm>	// std::max
+#include <chrono>		// std::chrono::high_resolution_clock
+
+namespace app
+{
+	Await Await::Done()
+	{
+		return Await{};
+	}
+	Await Await::NextFrame()
+	{
+		return Frames(1);
+	}
+	Await Await::Frames(unsigned frames)
+	{
+		Await await;
+		await.mType = Type::Frames;
+		await.mFrames = frames;
+		return await;
+	}
+	Await Await::Seconds(float seconds)
+	{
+		Await await;
+		await.mType = Type::Seconds;
+		await.mSeconds = seconds;
+		return await;
+	}
+	Await Await::Fence(GLsync fence)
+	{
+		Await await;
+		await.mType = Type::Fence;
+		await.mFence = fence;
+		return await;
+	}
+	Await Await::Gpu()
+	{
+		Await await;
+		await.mType = Type::Gpu;
+		return await;
+	}
+	Await Await::Jobs(const JobCounter & counter)
+	{
+		Await await;
+		await.mType = Type::Jobs;
+		await.mpCounter = &counter;
+		return await;
+	}
+
+	class TaskScheduler::TaskScheduler_impl
+	{
+	public:
+		TaskScheduler_impl();
+		~TaskScheduler_impl();
+
+		TaskId Start(TaskFunction function);
+		void Cancel(TaskId id);
+		bool isRunning(TaskId id) const;
+		void Update();
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		struct Task
+		{
+			TaskId				mId{ 0 };
+			TaskFunction		mFunction;
+			TaskState			mState;
+			Await				mAwait;
+			unsigned			mStartFrame{ 0 };
+			unsigned			mResumeFrame{ 0 };
+			Clock::time_point	mStartTime;
+			Clock::time_point	mResumeTime;
+			bool				mbCancelled{ false };
+		};
+
+		/// \brief	Calls the task function and records what it waits for.
+		/// \return	True if the task has finished.
+		bool Resume(Task & task);
+		bool isReady(Task & task) const;
+		/// \brief	Deletes the fence created by Await::Gpu.
+		static void ReleaseAwait(Task & task);
+
+		std::vector<Task> mvTasks;
+		/// \brief	Tasks started by other tasks during Update, added to mvTasks after resuming the rest.
+		std::vector<Task> mvStarted;
+		bool mbUpdating{ false };
+
+		TaskId mNextId{ 1 };
+		unsigned mFrame{ 0 };
+		Clock::time_point mNow;
+		Stats mStats;
+	};
+
+	TaskScheduler::TaskScheduler_impl::TaskScheduler_impl()
+		: mNow(Clock::now())
+	{
+		mvTasks.reserve(32);
+		mvStarted.reserve(8);
+	}
+	TaskScheduler::TaskScheduler_impl::~TaskScheduler_impl()
+	{
+		// IMPORTANT(Borja): Needs the GL context if a task is waiting for the GPU.
+		for (Task & task : mvTasks)
+			ReleaseAwait(task);
+	}
+
+	TaskScheduler::TaskId TaskScheduler::TaskScheduler_impl::Start(TaskFunction function)
+	{
+		Task task;
+		task.mId = mNextId++;
+		if (mNextId == 0)
+			mNextId = 1;
+		task.mFunction = std::move(function);
+		task.mStartFrame = mFrame;
+		task.mStartTime = mNow = Clock::now();
+
+		if (Resume(task))
+		{
+			++mStats.mFinished;
+			return 0;
+		}
+
+		// the task being resumed lives in mvTasks, it can't grow until all of them have been resumed
+		const TaskId id = task.mId;
+		if (mbUpdating)	mvStarted.push_back(std::move(task));
+		else			mvTasks.push_back(std::move(task));
+		mStats.mRunning = static_cast<unsigned>(mvTasks.size() + mvStarted.size());
+		return id;
+	}
+	void TaskScheduler::TaskScheduler_impl::Cancel(TaskId id)
+	{
+		for (std::vector<Task> * tasks : { &mvTasks, &mvStarted })
+		{
+			for (Task & task : *tasks)
+			{
+				if (task.mId == id && !task.mbCancelled)
+				{
+					// removed at the end of Update, the task may be the one calling Cancel
+					ReleaseAwait(task);
+					task.mbCancelled = true;
+				}
+			}
+		}
+	}
+	bool TaskScheduler::TaskScheduler_impl::isRunning(TaskId id) const
+	{
+		for (const std::vector<Task> * tasks : { &mvTasks, &mvStarted })
+		{
+			for (const Task & task : *tasks)
+			{
+				if (task.mId == id)
+					return !task.mbCancelled;
+			}
+		}
+		return false;
+	}
+
+	void TaskScheduler::TaskScheduler_impl::Update()
+	{
+		++mFrame;
+		mNow = Clock::now();
+		mStats.mResumed = 0;
+
+		mbUpdating = true;
+		for (std::size_t i = 0; i < mvTasks.size(); ++i)
+		{
+			Task & task = mvTasks[i];
+			if (task.mbCancelled || !isReady(task))
+				continue;
+
+			++mStats.mResumed;
+			if (Resume(task))
+			{
+				task.mbCancelled = true;
+				++mStats.mFinished;
+			}
+		}
+		mbUpdating = false;
+
+		// remove the finished tasks, the order doesn't matter
+		for (std::size_t i = 0; i < mvTasks.size();)
+		{
+			if (mvTasks[i].mbCancelled)
+			{
+				mvTasks[i] = std::move(mvTasks.back());
+				mvTasks.pop_back();
+			}
+			else
+				++i;
+		}
+		for (Task & task : mvStarted)
+		{
+			if (!task.mbCancelled)
+				mvTasks.push_back(std::move(task));
+		}
+		mvStarted.clear();
+
+		mStats.mRunning = static_cast<unsigned>(mvTasks.size());
+	}
+
+	bool TaskScheduler::TaskScheduler_impl::Resume(Task & task)
+	{
+		ReleaseAwait(task);
+		task.mState.mFrame = mFrame - task.mStartFrame;
+		task.mState.mElapsed = std::chrono::duration<float>(mNow - task.mStartTime).count();
+
+		task.mAwait = task.mFunction(task.mState);
+		switch (task.mAwait.mType)
+		{
+		case Await::Type::Done:
+			return true;
+		case Await::Type::Frames:
+			task.mResumeFrame = mFrame + std::max(task.mAwait.mFrames, 1u);
+			break;
+		case Await::Type::Seconds:
+			task.mResumeTime = mNow + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(task.mAwait.mSeconds));
+			break;
+		case Await::Type::Gpu:
+			task.mAwait.mFence = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+			break;
+		case Await::Type::Fence:
+		case Await::Type::Jobs:
+			break;
+		}
+		return false;
+	}
+	bool TaskScheduler::TaskScheduler_impl::isReady(Task & task) const
+	{
+		const Await & await = task.mAwait;
+		switch (await.mType)
+		{
+		case Await::Type::Done:
+			return false;
+		case Await::Type::Frames:
+			return mFrame >= task.mResumeFrame;
+		case Await::Type::Seconds:
+			return mNow >= task.mResumeTime;
+		case Await::Type::Fence:
+		case Await::Type::Gpu:
+		{
+			// a failed wait resumes the task, otherwise it would wait forever
+			const GLenum result = gl::ClientWaitSync(await.mFence, 0, 0);
+			return result != gl::TIMEOUT_EXPIRED;
+		}
+		case Await::Type::Jobs:
+			return await.mpCounter->isDone();
+		}
+		return true;
+	}
+	void TaskScheduler::TaskScheduler_impl::ReleaseAwait(Task & task)
+	{
+		if (task.mAwait.mType == Await::Type::Gpu && task.mAwait.mFence)
+		{
+			gl::DeleteSync(task.mAwait.mFence);
+			task.mAwait.mFence = nullptr;
+		}
+	}
+
+	TaskScheduler::TaskScheduler()
+		: mpImpl(std::make_unique<TaskScheduler_impl>())
+	{}
+	TaskScheduler::~TaskScheduler() {}
+
+	TaskScheduler::TaskId TaskScheduler::Start(TaskFunction task)
+	{
+		return mpImpl->Start(std::move(task));
+	}
+	void TaskScheduler::Cancel(TaskId task)
+	{
+		mpImpl->Cancel(task);
+	}
+	bool TaskScheduler::isRunning(TaskId task) const
+	{
+		return mpImpl->isRunning(task);
+	}
+	void TaskScheduler::Update()
+	{
+		mpImpl->Update();
+	}
+	const TaskScheduler::Stats & TaskScheduler::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
@@ -0,0 +1,114 @@
+/*!
+\brief	Resumable tasks for the operations that take several frames (loading, streaming, animations).
+*/
+
+#pragma once
+
+#include "my_gl_core.h"	// GLsync
+
+#include <memory>		// std::unique_ptr
+#include <functional>	// std::function
+
+namespace app
+{
+	class JobCounter;
+
+	/// \brief	What a task waits for before being resumed.
+	class Await
+	{
+	public:
+		enum class Type
+		{
+			Done,		// the task has finished
+			Frames,		// resumed after some calls to TaskScheduler::Update
+			Seconds,
+			Fence,		// a GL fence owned by the caller
+			Gpu,		// the GPU executing everything issued before suspending
+			Jobs,		// a JobCounter reaching zero
+		};
+
+		static Await Done();
+		static Await NextFrame();
+		static Await Frames(unsigned frames);
+		static Await Seconds(float seconds);
+		static Await Fence(GLsync fence);
+		static Await Gpu();
+		static Await Jobs(const JobCounter & counter);
+
+		Type				mType{ Type::Done };
+		unsigned			mFrames{ 0 };
+		float				mSeconds{ 0.f };
+		GLsync				mFence{ nullptr };
+		const JobCounter *	mpCounter{ nullptr };
+	};
+
+	/// \brief	State of a running task, passed to the task function every time it is resumed.
+	struct TaskState
+	{
+		unsigned	mResumePoint{ 0 };	// written by TASK_AWAIT, 0 starts from the beginning
+		unsigned	mFrame{ 0 };		// frames since the task was started
+		float		mElapsed{ 0.f };	// seconds since the task was started
+	};
+
+	/// \brief	Resumes the tasks whose awaited condition is met, from the main thread so that
+	/// they can use GL. Allocates when a task is started, not when tasks are resumed.
+	///
+	/// A task is a function that runs until it returns an Await, and is called again when it is met.
+	/// The TASK_* macros let it continue where it was, so it is written as straight code:
+	///
+	///		scheduler.Start([counter = std::make_shared<app::JobCounter>()](app::TaskState & task) mutable
+	///		{
+	///			TASK_BEGIN(task);
+	///			jobs.Run(LoadFile, counter.get());
+	///			TASK_AWAIT(task, app::Await::Jobs(*counter));
+	///			Upload();
+	///			TASK_AWAIT(task, app::Await::Gpu());
+	///			TASK_END(task);
+	///		});
+	///
+	/// IMPORTANT(Borja): The local variables are lost when the task is suspended, everything that
+	/// needs to live across a TASK_AWAIT has to be captured by the lambda (or be a member of the object).
+	/// Locals declared between two TASK_AWAIT need their own scope.
+	class TaskScheduler
+	{
+	public:
+		typedef unsigned TaskId;
+		typedef std::function<Await(TaskState & task)> TaskFunction;
+
+		struct Stats
+		{
+			unsigned	mRunning{ 0 };		// tasks that haven't finished
+			unsigned	mResumed{ 0 };		// tasks resumed in the last update
+			unsigned	mFinished{ 0 };		// tasks finished since the scheduler was created
+		};
+
+		TaskScheduler();
+		~TaskScheduler();
+		TaskScheduler(const TaskScheduler &) = delete;
+		TaskScheduler & operator=(const TaskScheduler &) = delete;
+
+		/// \brief	Runs the task until its first TASK_AWAIT.
+		/// \return	0 if the task finished without suspending.
+		TaskId Start(TaskFunction task);
+		/// \brief	The task is not resumed again.
+		void Cancel(TaskId task);
+		bool isRunning(TaskId task) const;
+
+		/// \brief	Resumes the tasks that are ready, needs to be called once per frame after Window::Update.
+		void Update();
+
+		const Stats & getStats() const;
+
+	private:
+		class TaskScheduler_impl;
+		std::unique_ptr<TaskScheduler_impl> mpImpl;
+	};
+}
+
+// Implementation of the resume points, every TASK_AWAIT is a case of a switch on TaskState::mResumePoint.
+#define TASK_BEGIN(task)	switch ((task).mResumePoint) { case 0:
+#define TASK_AWAIT(task, await)	TASK_AWAIT_IMPL(task, await, __COUNTER__ + 1)
+// __COUNTER__ instead of __LINE__, which is not a constant with edit and continue
+#define TASK_AWAIT_IMPL(task, await, point)	\
+	do { (task).mResumePoint = (point); return (await); case (point):; } while (0)
+#define TASK_END(task)	} (task).mResumePoint = 0; return app::Await::Done()
@@ -0,0 +1,571 @@
+/*!
+\brief	Packs many small images into a few big OpenGL textures.
+*/
+
+#include "TextureAtlas.h"
+
+#include "my_gl_core.h"
+#include "my_gl_resources.h"	// my_gl_core::create_texture, my_gl_core::delete_texture...
+
+// IMPORTANT(Borja): imgui_draw.cpp compiles its own static copy for the font baker.
+#ifdef _MSC_VER
+#pragma warning (disable: 4505) // unreferenced local function has been removed (stb stuff)
+#pragma warning (push)
+#pragma warning (disable: 4456) // declaration of 'xx' hides previous local declaration
+#endif
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui\stb_rect_pack.h"
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
+
+#include <vector>		// std::vector
+#include <algorithm>	// std::min
+#include <cstring>		// std::memcpy
+
+namespace app
+{
+	class TextureAtlas::TextureAtlas_impl
+	{
+	public:
+		TextureAtlas_impl(int page_size, unsigned max_pages, int padding, Format format);
+		~TextureAtlas_impl();
+
+		Handle Insert(int width, int height, const void * pixels);
+		void Update(Handle handle, const void * pixels);
+		void Remove(Handle handle);
+
+		bool isValid(Handle handle) const { return FindImage(handle) != nullptr; }
+		Region Lookup(Handle handle);
+
+		void Defragment();
+		void NewFrame();
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		struct Page
+		{
+			GLuint						mTexture{ 0 };
+			stbrp_context				mContext;
+			std::vector<stbrp_node>		mvNodes;
+			unsigned					mImages{ 0 };
+		};
+
+		struct Image
+		{
+			int				mX{ 0 }, mY{ 0 };
+			int				mWidth{ 0 }, mHeight{ 0 };
+			unsigned		mPage{ 0 };
+			unsigned		mGeneration{ 1 };
+			unsigned		mLastUsedFrame{ 0 };
+			bool			mbAlive{ false };
+			// IMPORTANT(Borja): A copy of the pixels is kept so that the images can be moved between
+			// pages, GL 4.2 can't copy between textures without a framebuffer round trip.
+			// It includes the padding to the right and below the image, cleared and uploaded with it,
+			// so that the padding never keeps the texels of an image that was there before.
+			std::vector<unsigned char>	mvPixels;
+		};
+
+		// handles are the index of the image slot plus a generation, so that a stale handle
+		// doesn't find the image that reuses its slot
+		static const unsigned SLOT_BITS = 20;
+		static const unsigned GENERATION_MAX = (1u << (32 - SLOT_BITS)) - 1;
+
+		Handle MakeHandle(unsigned slot) const { return (mvImages[slot].mGeneration << SLOT_BITS) | slot; }
+		const Image * FindImage(Handle handle) const;
+		Image * FindImage(Handle handle);
+
+		void CreatePage();
+		void ResetPage(Page & page);
+		bool PackImage(unsigned slot);
+		void RemoveImage(unsigned slot);
+		/// \brief	Frees the slot of an image that is not in any page anymore.
+		void ReleaseSlot(unsigned slot);
+		bool EvictLeastRecentlyUsed();
+
+		/// \brief	IMPORTANT(Borja): Without DSA the page texture is bound to the active unit,
+		/// the caller needs to restore the binding.
+		void UploadImage(const Image & image);
+		void CopyPixels(Image & image, const void * pixels) const;
+		GLint BackupTextureBinding() const;
+		void RestoreTextureBinding(GLint texture) const;
+
+		std::size_t getFreeArea() const;
+		void UpdateOccupancy();
+
+		const int		mPageSize;
+		const unsigned	mMaxPages;
+		const int		mPadding;
+		const Format	mFormat;
+		const std::size_t	mBytesPerPixel;
+		bool			mbUseDSA{ false };
+
+		std::vector<std::unique_ptr<Page>>	mvPages;	// the contexts point to the nodes, the pages can't move
+		std::vector<Image>		mvImages;
+		std::vector<unsigned>	mvFreeSlots;
+		std::size_t				mLiveArea{ 0 };			// padded pixels used by live images
+		unsigned				mFrame{ 1 };
+
+		Stats mStats;
+	};
+
+	TextureAtlas::TextureAtlas_impl::TextureAtlas_impl(int page_size, unsigned max_pages, int padding, Format format)
+		: mPageSize(std::min(page_size, 65535))
+		, mMaxPages(max_pages ? max_pages : 1)
+		, mPadding(padding > 0 ? padding : 0)
+		, mFormat(format)
+		, mBytesPerPixel(format == Format::R8 ? 1 : 4)
+	{
+		mbUseDSA = my_gl_core::get_caps().direct_state_access;
+	}
+	TextureAtlas::TextureAtlas_impl::~TextureAtlas_impl()
+	{
+		for (const std::unique_ptr<Page> & page : mvPages)
+			my_gl_core::delete_texture(page->mTexture);
+	}
+
+	const TextureAtlas::TextureAtlas_impl::Image * TextureAtlas::TextureAtlas_impl::FindImage(Handle handle) const
+	{
+		const unsigned slot = handle & ((1u << SLOT_BITS) - 1);
+		if (handle == INVALID_HANDLE || slot >= mvImages.size())
+			return nullptr;
+
+		const Image & image = mvImages[slot];
+		if (!image.mbAlive || image.mGeneration != (handle >> SLOT_BITS))
+			return nullptr;
+		return &image;
+	}
+	TextureAtlas::TextureAtlas_impl::Image * TextureAtlas::TextureAtlas_impl::FindImage(Handle handle)
+	{
+		return const_cast<Image *>(static_cast<const TextureAtlas_impl *>(this)->FindImage(handle));
+	}
+
+	GLint TextureAtlas::TextureAtlas_impl::BackupTextureBinding() const
+	{
+		GLint last_texture = 0;
+		if (!mbUseDSA)
+			gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
+		return last_texture;
+	}
+	void TextureAtlas::TextureAtlas_impl::RestoreTextureBinding(GLint texture) const
+	{
+		if (!mbUseDSA)
+			gl::BindTexture(gl::TEXTURE_2D, texture);
+	}
+
+	void TextureAtlas::TextureAtlas_impl::ResetPage(Page & page)
+	{
+		// as many nodes as pixels of width is what stb_rect_pack needs to never run out of them
+		page.mvNodes.resize(mPageSize);
+		stbrp_init_target(&page.mContext, mPageSize, mPageSize, page.mvNodes.data(), mPageSize);
+		page.mImages = 0;
+	}
+
+	void TextureAtlas::TextureAtlas_impl::CreatePage()
+	{
+		std::unique_ptr<Page> page = std::make_unique<Page>();
+		ResetPage(*page);
+
+		// cleared so that the padding between images doesn't bleed garbage when filtering
+		const std::vector<unsigned char> zeros(static_cast<std::size_t>(mPageSize) * mPageSize * mBytesPerPixel, 0);
+		const GLenum internal_format = mFormat == Format::R8 ? gl::R8 : gl::RGBA8;
+		const GLenum pixel_format = mFormat == Format::R8 ? gl::RED : gl::RGBA;
+		GLint last_unpack_alignment;
+		gl::GetIntegerv(gl::UNPACK_ALIGNMENT, &last_unpack_alignment);
+		gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
+		page->mTexture = my_gl_core::create_texture(gl::TEXTURE_2D, "TextureAtlas");
+		my_gl_core::set_resource_size(my_gl_core::ResourceType::Texture, page->mTexture, my_gl_core::get_texture_size(internal_format, mPageSize, mPageSize));
+		if (mbUseDSA)
+		{
+			using namespace my_gl_core;
+			ext::TextureParameteri(page->mTexture, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			ext::TextureParameteri(page->mTexture, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			ext::TextureParameteri(page->mTexture, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE);
+			ext::TextureParameteri(page->mTexture, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
+			ext::TextureStorage2D(page->mTexture, 1, internal_format, mPageSize, mPageSize);
+			ext::TextureSubImage2D(page->mTexture, 0, 0, 0, mPageSize, mPageSize, pixel_format, gl::UNSIGNED_BYTE, zeros.data());
+		}
+		else
+		{
+			const GLint last_texture = BackupTextureBinding();
+			gl::BindTexture(gl::TEXTURE_2D, page->mTexture);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE);
+			gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
+			gl::TexStorage2D(gl::TEXTURE_2D, 1, internal_format, mPageSize, mPageSize);
+			gl::TexSubImage2D(gl::TEXTURE_2D, 0, 0, 0, mPageSize, mPageSize, pixel_format, gl::UNSIGNED_BYTE, zeros.data());
+			RestoreTextureBinding(last_texture);
+		}
+		gl::PixelStorei(gl::UNPACK_ALIGNMENT, last_unpack_alignment);
+		CheckOGLError();
+
+		mvPages.push_back(std::move(page));
+		mStats.mPages = static_cast<unsigned>(mvPages.size());
+	}
+
+	void TextureAtlas::TextureAtlas_impl::UploadImage(const Image & image)
+	{
+		// the rect packed for the image includes the padding, it always fits in the page
+		const GLuint texture = mvPages[image.mPage]->mTexture;
+		const GLenum pixel_format = mFormat == Format::R8 ? gl::RED : gl::RGBA;
+		const GLsizei width = image.mWidth + mPadding;
+		const GLsizei height = image.mHeight + mPadding;
+		GLint last_unpack_alignment;
+		gl::GetIntegerv(gl::UNPACK_ALIGNMENT, &last_unpack_alignment);
+		gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
+		if (mbUseDSA)
+		{
+			my_gl_core::ext::TextureSubImage2D(texture, 0, image.mX, image.mY, width, height,
+											   pixel_format, gl::UNSIGNED_BYTE, image.mvPixels.data());
+		}
+		else
+		{
+			gl::BindTexture(gl::TEXTURE_2D, texture);
+			gl::TexSubImage2D(gl::TEXTURE_2D, 0, image.mX, image.mY, width, height,
+							  pixel_format, gl::UNSIGNED_BYTE, image.mvPixels.data());
+		}
+		gl::PixelStorei(gl::UNPACK_ALIGNMENT, last_unpack_alignment);
+		++mStats.mUploads;
+	}
+
+	void TextureAtlas::TextureAtlas_impl::CopyPixels(Image & image, const void * pixels) const
+	{
+		const std::size_t row_size = static_cast<std::size_t>(image.mWidth) * mBytesPerPixel;
+		const std::size_t padded_row_size = static_cast<std::size_t>(image.mWidth + mPadding) * mBytesPerPixel;
+		image.mvPixels.assign(padded_row_size * (image.mHeight + mPadding), 0);
+		if (!pixels)
+			return;
+
+		const unsigned char * source = static_cast<const unsigned char *>(pixels);
+		for (int y = 0; y < image.mHeight; ++y)
+			std::memcpy(image.mvPixels.data() + y * padded_row_size, source + y * row_size, row_size);
+	}
+
+	bool TextureAtlas::TextureAtlas_impl::PackImage(unsigned slot)
+	{
+		Image & image = mvImages[slot];
+
+		stbrp_rect rect;
+		rect.id = static_cast<int>(slot);
+		rect.w = static_cast<stbrp_coord>(image.mWidth + mPadding);
+		rect.h = static_cast<stbrp_coord>(image.mHeight + mPadding);
+
+		// the skyline keeps its state between calls, so the pages can be filled one rect at a time
+		for (std::size_t i = 0; i < mvPages.size(); ++i)
+		{
+			Page & page = *mvPages[i];
+			stbrp_pack_rects(&page.mContext, &rect, 1);
+			if (rect.was_packed)
+			{
+				image.mX = rect.x;
+				image.mY = rect.y;
+				image.mPage = static_cast<unsigned>(i);
+				++page.mImages;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TextureAtlas::TextureAtlas_impl::RemoveImage(unsigned slot)
+	{
+		// the skyline can't reuse holes, only whole pages or a defragmentation recover the space
+		Page & page = *mvPages[mvImages[slot].mPage];
+		if (--page.mImages == 0)
+			ResetPage(page);
+
+		ReleaseSlot(slot);
+	}
+
+	void TextureAtlas::TextureAtlas_impl::ReleaseSlot(unsigned slot)
+	{
+		Image & image = mvImages[slot];
+		mLiveArea -= static_cast<std::size_t>(image.mWidth + mPadding) * (image.mHeight + mPadding);
+
+		image.mbAlive = false;
+		image.mvPixels.clear();
+		image.mvPixels.shrink_to_fit();
+		image.mGeneration = image.mGeneration == GENERATION_MAX ? 1 : image.mGeneration + 1;
+		mvFreeSlots.push_back(slot);
+
+		--mStats.mImages;
+	}
+
+	bool TextureAtlas::TextureAtlas_impl::EvictLeastRecentlyUsed()
+	{
+		unsigned victim = static_cast<unsigned>(mvImages.size());
+		for (unsigned slot = 0; slot < mvImages.size(); ++slot)
+		{
+			const Image & image = mvImages[slot];
+			// the images used this frame may already be in a draw list
+			if (!image.mbAlive || image.mLastUsedFrame == mFrame)
+				continue;
+			if (victim == mvImages.size() || image.mLastUsedFrame < mvImages[victim].mLastUsedFrame)
+				victim = slot;
+		}
+
+		if (victim == mvImages.size())
+			return false;
+
+		RemoveImage(victim);
+		++mStats.mEvictions;
+		return true;
+	}
+
+	std::size_t TextureAtlas::TextureAtlas_impl::getFreeArea() const
+	{
+		const std::size_t page_area = static_cast<std::size_t>(mPageSize) * mPageSize;
+		return page_area * mMaxPages - mLiveArea;
+	}
+
+	void TextureAtlas::TextureAtlas_impl::UpdateOccupancy()
+	{
+		const std::size_t page_area = static_cast<std::size_t>(mPageSize) * mPageSize;
+		mStats.mOccupancy = mvPages.empty() ? 0.f : static_cast<float>(static_cast<double>(mLiveArea) / (page_area * mvPages.size()));
+	}
+
+	TextureAtlas::Handle TextureAtlas::TextureAtlas_impl::Insert(int width, int height, const void * pixels)
+	{
+		if (width <= 0 || height <= 0 || width + mPadding > mPageSize || height + mPadding > mPageSize)
+			return INVALID_HANDLE;
+
+		unsigned slot;
+		if (!mvFreeSlots.empty())
+		{
+			slot = mvFreeSlots.back();
+			mvFreeSlots.pop_back();
+		}
+		else
+		{
+			if (mvImages.size() >= (1u << SLOT_BITS))
+				return INVALID_HANDLE;
+			slot = static_cast<unsigned>(mvImages.size());
+			mvImages.emplace_back();
+		}
+
+		Image & image = mvImages[slot];
+		image.mWidth = width;
+		image.mHeight = height;
+		const std::size_t area = static_cast<std::size_t>(width + mPadding) * (height + mPadding);
+
+		// new pages first, then recover the holes and only then evict what hasn't been used this frame
+		bool defragmented = false;
+		while (!PackImage(slot))
+		{
+			if (mvPages.size() < mMaxPages)
+			{
+				CreatePage();
+			}
+			else if (!defragmented && getFreeArea() >= area)
+			{
+				Defragment();
+				defragmented = true;
+			}
+			else if (EvictLeastRecentlyUsed())
+			{
+				defragmented = false;
+			}
+			else
+			{
+				mvFreeSlots.push_back(slot);
+				return INVALID_HANDLE;
+			}
+		}
+
+		image.mbAlive = true;
+		image.mLastUsedFrame = mFrame;
+		CopyPixels(image, pixels);
+
+		const GLint last_texture = BackupTextureBinding();
+		UploadImage(image);
+		RestoreTextureBinding(last_texture);
+		CheckOGLError();
+
+		mLiveArea += area;
+		++mStats.mImages;
+		++mStats.mInsertions;
+		UpdateOccupancy();
+		return MakeHandle(slot);
+	}
+
+	void TextureAtlas::TextureAtlas_impl::Update(Handle handle, const void * pixels)
+	{
+		Image * image = FindImage(handle);
+		if (!image || !pixels)
+			return;
+
+		CopyPixels(*image, pixels);
+
+		const GLint last_texture = BackupTextureBinding();
+		UploadImage(*image);
+		RestoreTextureBinding(last_texture);
+		CheckOGLError();
+	}
+
+	void TextureAtlas::TextureAtlas_impl::Remove(Handle handle)
+	{
+		if (!FindImage(handle))
+			return;
+
+		RemoveImage(handle & ((1u << SLOT_BITS) - 1));
+		UpdateOccupancy();
+	}
+
+	TextureAtlas::Region TextureAtlas::TextureAtlas_impl::Lookup(Handle handle)
+	{
+		Region region;
+		Image * image = FindImage(handle);
+		if (!image)
+			return region;
+
+		image->mLastUsedFrame = mFrame;
+
+		const float inv_size = 1.f / static_cast<float>(mPageSize);
+		region.mTexture = mvPages[image->mPage]->mTexture;
+		region.mX = image->mX;
+		region.mY = image->mY;
+		region.mWidth = image->mWidth;
+		region.mHeight = image->mHeight;
+		region.mU0 = image->mX * inv_size;
+		region.mV0 = image->mY * inv_size;
+		region.mU1 = (image->mX + image->mWidth) * inv_size;
+		region.mV1 = (image->mY + image->mHeight) * inv_size;
+		return region;
+	}
+
+	void TextureAtlas::TextureAtlas_impl::Defragment()
+	{
+		// IMPORTANT(Borja): The images used this frame may already be in a draw list with their
+		// current texture coordinates, the pages that have any of them keep their layout. Their
+		// skylines are kept too, so they can still take the images of the other pages.
+		std::vector<bool> pinned(mvPages.size(), false);
+		for (const Image & image : mvImages)
+		{
+			if (image.mbAlive && image.mLastUsedFrame == mFrame)
+				pinned[image.mPage] = true;
+		}
+
+		std::vector<stbrp_rect> rects;
+		for (unsigned slot = 0; slot < mvImages.size(); ++slot)
+		{
+			const Image & image = mvImages[slot];
+			if (!image.mbAlive || pinned[image.mPage])
+				continue;
+
+			stbrp_rect rect;
+			rect.id = static_cast<int>(slot);
+			rect.w = static_cast<stbrp_coord>(image.mWidth + mPadding);
+			rect.h = static_cast<stbrp_coord>(image.mHeight + mPadding);
+			rects.push_back(rect);
+		}
+
+		// packing everything at once lets stb_rect_pack sort by height, which wastes a lot less
+		// than the insertion order did
+		for (std::size_t i = 0; i < mvPages.size(); ++i)
+		{
+			if (!pinned[i])
+				ResetPage(*mvPages[i]);
+		}
+
+		const GLint last_texture = BackupTextureBinding();
+		std::size_t used_pages = 0;
+		while (!rects.empty() && used_pages < mMaxPages)
+		{
+			if (used_pages == mvPages.size())
+				CreatePage();
+
+			Page & page = *mvPages[used_pages];
+			stbrp_pack_rects(&page.mContext, rects.data(), static_cast<int>(rects.size()));
+
+			std::vector<stbrp_rect> remaining;
+			for (const stbrp_rect & rect : rects)
+			{
+				if (!rect.was_packed)
+				{
+					remaining.push_back(rect);
+					continue;
+				}
+
+				Image & image = mvImages[rect.id];
+				const bool moved = image.mPage != used_pages || image.mX != rect.x || image.mY != rect.y;
+				image.mPage = static_cast<unsigned>(used_pages);
+				image.mX = rect.x;
+				image.mY = rect.y;
+				++page.mImages;
+				if (moved)
+					UploadImage(image);
+			}
+			rects.swap(remaining);
+			++used_pages;
+		}
+		RestoreTextureBinding(last_texture);
+
+		// repacking is not guaranteed to be as good as the old layout for every input, only images
+		// that weren't used this frame can be left out
+		for (const stbrp_rect & rect : rects)
+		{
+			ReleaseSlot(rect.id);
+			++mStats.mEvictions;
+		}
+
+		// release the pages left empty
+		while (mvPages.size() > 1 && mvPages.back()->mImages == 0)
+		{
+			my_gl_core::delete_texture(mvPages.back()->mTexture);
+			mvPages.pop_back();
+		}
+		CheckOGLError();
+
+		mStats.mPages = static_cast<unsigned>(mvPages.size());
+		++mStats.mDefragmentations;
+		UpdateOccupancy();
+	}
+
+	void TextureAtlas::TextureAtlas_impl::NewFrame()
+	{
+		++mFrame;
+		mStats.mInsertions = 0;
+		mStats.mUploads = 0;
+	}
+
+	TextureAtlas::TextureAtlas(int page_size, unsigned max_pages, int padding, Format format)
+		: mpImpl(std::make_unique<TextureAtlas_impl>(page_size, max_pages, padding, format))
+	{}
+	TextureAtlas::~TextureAtlas() {}
+
+	TextureAtlas::Handle TextureAtlas::Insert(int width, int height, const void * pixels)
+	{
+		return mpImpl->Insert(width, height, pixels);
+	}
+	void TextureAtlas::Update(Handle handle, const void * pixels)
+	{
+		mpImpl->Update(handle, pixels);
+	}
+	void TextureAtlas::Remove(Handle handle)
+	{
+		mpImpl->Remove(handle);
+	}
+	bool TextureAtlas::isValid(Handle handle) const
+	{
+		return mpImpl->isValid(handle);
+	}
+	TextureAtlas::Region TextureAtlas::Lookup(Handle handle)
+	{
+		return mpImpl->Lookup(handle);
+	}
+	void TextureAtlas::Defragment()
+	{
+		mpImpl->Defragment();
+	}
+	void TextureAtlas::NewFrame()
+	{
+		mpImpl->NewFrame();
+	}
+	const TextureAtlas::Stats & TextureAtlas::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
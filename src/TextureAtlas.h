@@ -0,0 +1,85 @@
+/*!
+\brief	Packs many small images into a few big OpenGL textures.
+*/
+
+#pragma once
+
+#include <memory>	// std::unique_ptr
+
+namespace app
+{
+	/// \brief	Runtime texture atlas built on stb_rect_pack. Images are RGBA8 (or R8, i.e. the distance
+	/// fields of app::GlyphCache) and are identified by a handle, the texture and texture coordinates of an image can change when the atlas
+	/// is defragmented, so they need to be looked up every frame instead of stored.
+	/// Images that share a page share the texture binding, so they can be batched together
+	/// by ImGui (ImDrawCmd::TextureId) and by app::Renderer2D.
+	/// When the atlas is full the least recently used images are evicted.
+	/// IMPORTANT(Borja): Needs a current OpenGL context during the whole lifetime of the object.
+	class TextureAtlas
+	{
+	public:
+		typedef unsigned Handle;
+		static const Handle INVALID_HANDLE = 0;
+
+		/// \brief	Format of the pages and of the pixels of every image.
+		enum class Format
+		{
+			RGBA8,
+			R8
+		};
+
+		/// \brief	Where an image is right now.
+		struct Region
+		{
+			unsigned	mTexture{ 0 };		// OpenGL texture name of the page
+			int			mX{ 0 }, mY{ 0 };	// position in pixels inside the page
+			int			mWidth{ 0 }, mHeight{ 0 };
+			float		mU0{ 0.f }, mV0{ 0.f }, mU1{ 0.f }, mV1{ 0.f };
+		};
+
+		struct Stats
+		{
+			unsigned	mPages{ 0 };
+			unsigned	mImages{ 0 };
+			float		mOccupancy{ 0.f };		// pixels used by live images / pixels of all the pages
+			unsigned	mInsertions{ 0 };		// in the current frame
+			unsigned	mUploads{ 0 };			// TexSubImage2D calls in the current frame
+			unsigned	mEvictions{ 0 };		// total images evicted to make room
+			unsigned	mDefragmentations{ 0 };	// total times the pages have been repacked
+		};
+
+		/// \param	page_size	Width and height of every texture.
+		/// \param	max_pages	Number of textures the atlas can create before evicting.
+		/// \param	padding		Empty pixels between images so that filtering doesn't bleed.
+		TextureAtlas(int page_size = 1024, unsigned max_pages = 4, int padding = 1, Format format = Format::RGBA8);
+		~TextureAtlas();
+
+		/// \brief	Copies the image in the atlas.
+		/// \param	pixels	width * height pixels of the atlas format (can be null and updated later).
+		/// \return	INVALID_HANDLE if the image doesn't fit in a page or everything is in use this frame.
+		Handle Insert(int width, int height, const void * pixels);
+		/// \brief	Replaces the pixels of the image, the size can't change.
+		void Update(Handle handle, const void * pixels);
+		void Remove(Handle handle);
+
+		/// \return	False if the image was removed or evicted.
+		bool isValid(Handle handle) const;
+		/// \brief	Marks the image as used this frame, so it won't be evicted until the next one.
+		/// \return	Empty region (mTexture = 0) if the handle is not valid.
+		Region Lookup(Handle handle);
+
+		/// \brief	Repacks the images, recovering the space of the removed ones. The pages with
+		/// images used this frame keep their layout, the rest of the images are repacked around them.
+		/// Empty pages are released.
+		void Defragment();
+
+		/// \brief	Advances the frame used by the eviction and resets the per frame stats.
+		void NewFrame();
+
+		const Stats & getStats() const;
+
+	private:
+		class TextureAtlas_impl;
+		std::unique_ptr<TextureAtlas_impl> mpImpl;
+	};
+}
@@ -0,0 +1,268 @@
+/*!
+\brief	Matrix constructors and the SSE/AVX2 batch kernels of the vector math library.
+*/
+
+#include "VectorMath.h"
+
+#if APP_MATH_AVX2
+#include <immintrin.h>	// _mm256_loadu_ps, _mm256_add_ps...
+#endif
+
+namespace app
+{
+	Mat4 Mat4::Translation(const Vec3 & t)
+	{
+		return Mat4(Vec4(1.f, 0.f, 0.f, 0.f), Vec4(0.f, 1.f, 0.f, 0.f), Vec4(0.f, 0.f, 1.f, 0.f), Vec4(t, 1.f));
+	}
+
+	Mat4 Mat4::Scale(const Vec3 & s)
+	{
+		return Mat4(Vec4(s.x, 0.f, 0.f, 0.f), Vec4(0.f, s.y, 0.f, 0.f), Vec4(0.f, 0.f, s.z, 0.f), Vec4(0.f, 0.f, 0.f, 1.f));
+	}
+
+	Mat4 Mat4::Rotation(const Quat & q)
+	{
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Mat4(Vec4(1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy), 0.f),
+					Vec4(2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx), 0.f),
+					Vec4(2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy), 0.f),
+					Vec4(0.f, 0.f, 0.f, 1.f));
+	}
+
+	Mat4 Mat4::Ortho(float left, float right, float bottom, float top, float near_z, float far_z)
+	{
+		const float w = right - left;
+		const float h = top - bottom;
+		const float d = far_z - near_z;
+		return Mat4(Vec4(2.f / w, 0.f, 0.f, 0.f),
+					Vec4(0.f, 2.f / h, 0.f, 0.f),
+					Vec4(0.f, 0.f, -2.f / d, 0.f),
+					Vec4(-(right + left) / w, -(top + bottom) / h, -(far_z + near_z) / d, 1.f));
+	}
+
+	Mat4 Mat4::Perspective(float fovy_radians, float aspect, float near_z, float far_z)
+	{
+		const float f = 1.f / std::tan(fovy_radians * 0.5f);
+		const float d = near_z - far_z;
+		return Mat4(Vec4(f / aspect, 0.f, 0.f, 0.f),
+					Vec4(0.f, f, 0.f, 0.f),
+					Vec4(0.f, 0.f, (far_z + near_z) / d, -1.f),
+					Vec4(0.f, 0.f, 2.f * far_z * near_z / d, 0.f));
+	}
+
+	Mat4 Transpose(const Mat4 & m)
+	{
+		const Vec4 * c = m.mColumns;
+		return Mat4(Vec4(c[0].x, c[1].x, c[2].x, c[3].x),
+					Vec4(c[0].y, c[1].y, c[2].y, c[3].y),
+					Vec4(c[0].z, c[1].z, c[2].z, c[3].z),
+					Vec4(c[0].w, c[1].w, c[2].w, c[3].w));
+	}
+
+	Quat Slerp(const Quat & a, const Quat & b, float t)
+	{
+		float cos_theta = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		const float sign = cos_theta < 0.f ? -1.f : 1.f;	// q and -q are the same rotation
+		cos_theta *= sign;
+
+		float wa = 1.f - t, wb = t;
+		// almost the same rotation, sin(theta) would divide by ~0 and the linear interpolation is as good
+		if (cos_theta < 0.9995f)
+		{
+			const float theta = std::acos(cos_theta);
+			const float inv_sin = 1.f / std::sin(theta);
+			wa = std::sin(wa * theta) * inv_sin;
+			wb = std::sin(wb * theta) * inv_sin;
+		}
+		wb *= sign;
+		return Normalize(Quat(a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb));
+	}
+
+	namespace scalar
+	{
+		Mat4 Multiply(const Mat4 & a, const Mat4 & b)
+		{
+			Mat4 r;
+			for (int c = 0; c < 4; ++c)
+			{
+				const Vec4 & bc = b.mColumns[c];
+				const Vec4 * ac = a.mColumns;
+				r.mColumns[c] = Vec4(ac[0].x * bc.x + ac[1].x * bc.y + ac[2].x * bc.z + ac[3].x * bc.w,
+									 ac[0].y * bc.x + ac[1].y * bc.y + ac[2].y * bc.z + ac[3].y * bc.w,
+									 ac[0].z * bc.x + ac[1].z * bc.y + ac[2].z * bc.z + ac[3].z * bc.w,
+									 ac[0].w * bc.x + ac[1].w * bc.y + ac[2].w * bc.z + ac[3].w * bc.w);
+			}
+			return r;
+		}
+
+		// the SIMD kernels use them for the elements that don't fill a register
+		static void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t begin, std::size_t end)
+		{
+			const Vec4 * c = m.mColumns;
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const float x = in.mpX[i], y = in.mpY[i], z = in.mpZ[i];
+				out.mpX[i] = c[0].x * x + c[1].x * y + c[2].x * z + c[3].x;
+				out.mpY[i] = c[0].y * x + c[1].y * y + c[2].y * z + c[3].y;
+				out.mpZ[i] = c[0].z * x + c[1].z * y + c[2].z * z + c[3].z;
+			}
+		}
+
+		static void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t begin, std::size_t end)
+		{
+			// the center is transformed as a point, the extent by the absolute value of the 3x3 part
+			const Vec4 * c = m.mColumns;
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const float cx = (in.mpMinX[i] + in.mpMaxX[i]) * 0.5f, ex = (in.mpMaxX[i] - in.mpMinX[i]) * 0.5f;
+				const float cy = (in.mpMinY[i] + in.mpMaxY[i]) * 0.5f, ey = (in.mpMaxY[i] - in.mpMinY[i]) * 0.5f;
+				const float cz = (in.mpMinZ[i] + in.mpMaxZ[i]) * 0.5f, ez = (in.mpMaxZ[i] - in.mpMinZ[i]) * 0.5f;
+
+				const float tx = c[0].x * cx + c[1].x * cy + c[2].x * cz + c[3].x;
+				const float ty = c[0].y * cx + c[1].y * cy + c[2].y * cz + c[3].y;
+				const float tz = c[0].z * cx + c[1].z * cy + c[2].z * cz + c[3].z;
+				const float rx = std::abs(c[0].x) * ex + std::abs(c[1].x) * ey + std::abs(c[2].x) * ez;
+				const float ry = std::abs(c[0].y) * ex + std::abs(c[1].y) * ey + std::abs(c[2].y) * ez;
+				const float rz = std::abs(c[0].z) * ex + std::abs(c[1].z) * ey + std::abs(c[2].z) * ez;
+
+				out.mpMinX[i] = tx - rx; out.mpMaxX[i] = tx + rx;
+				out.mpMinY[i] = ty - ry; out.mpMaxY[i] = ty + ry;
+				out.mpMinZ[i] = tz - rz; out.mpMaxZ[i] = tz + rz;
+			}
+		}
+
+		void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t count)
+		{
+			TransformPoints(m, in, out, 0, count);
+		}
+
+		void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t count)
+		{
+			TransformAabbs(m, in, out, 0, count);
+		}
+	}
+
+	// The same kernel for SSE (4 lanes) and AVX2 (8 lanes), every lane is a point or a box.
+	// The elements of the matrix are broadcast once and the arrays are read and written unaligned,
+	// the remaining elements go through the scalar kernel.
+#if APP_MATH_AVX2
+	namespace
+	{
+		typedef __m256 Lanes;
+		const std::size_t LANES = 8;
+		inline Lanes Set1(float f) { return _mm256_set1_ps(f); }
+		inline Lanes LoadLanes(const float * p) { return _mm256_loadu_ps(p); }
+		inline void StoreLanes(float * p, Lanes v) { _mm256_storeu_ps(p, v); }
+		inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+		inline Lanes Sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+		inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	}
+#elif APP_MATH_SSE
+	namespace
+	{
+		typedef __m128 Lanes;
+		const std::size_t LANES = 4;
+		inline Lanes Set1(float f) { return _mm_set1_ps(f); }
+		inline Lanes LoadLanes(const float * p) { return _mm_loadu_ps(p); }
+		inline void StoreLanes(float * p, Lanes v) { _mm_storeu_ps(p, v); }
+		inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+		inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+		inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	}
+#endif
+
+#if APP_MATH_SSE
+	namespace
+	{
+		/// \brief	The matrix broadcast to every lane, the 3x3 part also as absolute values.
+		struct LanesMatrix
+		{
+			explicit LanesMatrix(const Mat4 & m)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					const Vec4 & column = m.mColumns[c];
+					mColumns[c][0] = Set1(column.x); mAbs[c][0] = Set1(std::abs(column.x));
+					mColumns[c][1] = Set1(column.y); mAbs[c][1] = Set1(std::abs(column.y));
+					mColumns[c][2] = Set1(column.z); mAbs[c][2] = Set1(std::abs(column.z));
+				}
+			}
+
+			/// \brief	Row r of m * (x, y, z, 1).
+			Lanes Row(int r, Lanes x, Lanes y, Lanes z) const
+			{
+				return Add(Add(Mul(mColumns[0][r], x), Mul(mColumns[1][r], y)), Add(Mul(mColumns[2][r], z), mColumns[3][r]));
+			}
+			/// \brief	Row r of abs(m) * (x, y, z, 0).
+			Lanes AbsRow(int r, Lanes x, Lanes y, Lanes z) const
+			{
+				return Add(Add(Mul(mAbs[0][r], x), Mul(mAbs[1][r], y)), Mul(mAbs[2][r], z));
+			}
+
+			Lanes mColumns[4][3];	// the last row is not used by affine transforms
+			Lanes mAbs[4][3];
+		};
+	}
+
+	void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t count)
+	{
+		const LanesMatrix lm(m);
+		const std::size_t simd_count = count - count % LANES;
+		for (std::size_t i = 0; i < simd_count; i += LANES)
+		{
+			const Lanes x = LoadLanes(in.mpX + i), y = LoadLanes(in.mpY + i), z = LoadLanes(in.mpZ + i);
+			StoreLanes(out.mpX + i, lm.Row(0, x, y, z));
+			StoreLanes(out.mpY + i, lm.Row(1, x, y, z));
+			StoreLanes(out.mpZ + i, lm.Row(2, x, y, z));
+		}
+		scalar::TransformPoints(m, in, out, simd_count, count);
+	}
+
+	void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t count)
+	{
+		const LanesMatrix lm(m);
+		const Lanes half = Set1(0.5f);
+		const std::size_t simd_count = count - count % LANES;
+		for (std::size_t i = 0; i < simd_count; i += LANES)
+		{
+			const Lanes min_x = LoadLanes(in.mpMinX + i), max_x = LoadLanes(in.mpMaxX + i);
+			const Lanes min_y = LoadLanes(in.mpMinY + i), max_y = LoadLanes(in.mpMaxY + i);
+			const Lanes min_z = LoadLanes(in.mpMinZ + i), max_z = LoadLanes(in.mpMaxZ + i);
+			const Lanes cx = Mul(Add(min_x, max_x), half), ex = Mul(Sub(max_x, min_x), half);
+			const Lanes cy = Mul(Add(min_y, max_y), half), ey = Mul(Sub(max_y, min_y), half);
+			const Lanes cz = Mul(Add(min_z, max_z), half), ez = Mul(Sub(max_z, min_z), half);
+
+			const Lanes tx = lm.Row(0, cx, cy, cz), rx = lm.AbsRow(0, ex, ey, ez);
+			const Lanes ty = lm.Row(1, cx, cy, cz), ry = lm.AbsRow(1, ex, ey, ez);
+			const Lanes tz = lm.Row(2, cx, cy, cz), rz = lm.AbsRow(2, ex, ey, ez);
+			StoreLanes(out.mpMinX + i, Sub(tx, rx)); StoreLanes(out.mpMaxX + i, Add(tx, rx));
+			StoreLanes(out.mpMinY + i, Sub(ty, ry)); StoreLanes(out.mpMaxY + i, Add(ty, ry));
+			StoreLanes(out.mpMinZ + i, Sub(tz, rz)); StoreLanes(out.mpMaxZ + i, Add(tz, rz));
+		}
+		scalar::TransformAabbs(m, in, out, simd_count, count);
+	}
+#else
+	void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t count)
+	{
+		scalar::TransformPoints(m, in, out, count);
+	}
+
+	void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t count)
+	{
+		scalar::TransformAabbs(m, in, out, count);
+	}
+#endif
+
+	const char * getMathPath()
+	{
+#if APP_MATH_AVX2
+		return "AVX2";
+#elif APP_MATH_SSE
+		return "SSE";
+#else
+		return "Scalar";
+#endif
+	}
+}
@@ -0,0 +1,221 @@
+/*!
+\brief	Vectors, matrices and quaternions, with SSE/AVX2 implementations selected at compile time.
+*/
+
+#pragma once
+
+// APP_MATH_SCALAR forces the scalar implementation, otherwise the best instruction set the
+// compiler targets is used (/arch:AVX2 enables the AVX2 batch kernels, x64 always has SSE2).
+#if !defined(APP_MATH_SCALAR)
+#	if defined(__AVX2__)
+#		define APP_MATH_AVX2 1
+#	endif
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define APP_MATH_SSE 1
+#	endif
+#endif
+
+#if APP_MATH_SSE
+#include <xmmintrin.h>	// _mm_loadu_ps, _mm_add_ps...
+#endif
+
+#include <cmath>		// std::sqrt, std::sin, std::cos, std::tan
+#include <cstddef>		// std::size_t
+
+namespace app
+{
+	struct Vec2
+	{
+		constexpr Vec2() : x(0.f), y(0.f) {}
+		constexpr Vec2(float x_, float y_) : x(x_), y(y_) {}
+
+		float x, y;
+	};
+
+	struct Vec3
+	{
+		constexpr Vec3() : x(0.f), y(0.f), z(0.f) {}
+		constexpr Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+
+		float x, y, z;
+	};
+
+	/// \brief	Loaded in a single SSE register, the components need to be contiguous.
+	struct Vec4
+	{
+		constexpr Vec4() : x(0.f), y(0.f), z(0.f), w(0.f) {}
+		constexpr Vec4(float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+		constexpr Vec4(const Vec3 & v, float w_) : x(v.x), y(v.y), z(v.z), w(w_) {}
+
+		float x, y, z, w;
+	};
+
+	/// \brief	Rotation as a unit quaternion, (x, y, z) is the vector part.
+	struct Quat
+	{
+		constexpr Quat() : x(0.f), y(0.f), z(0.f), w(1.f) {}
+		constexpr Quat(float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+
+		/// \param	axis	Needs to be normalized.
+		static Quat FromAxisAngle(const Vec3 & axis, float radians);
+
+		float x, y, z, w;
+	};
+
+	/// \brief	Column major like OpenGL, Mat4::data can be passed to gl::UniformMatrix4fv without transposing.
+	struct Mat4
+	{
+		/// \brief	Identity.
+		constexpr Mat4() : mColumns{ Vec4(1.f, 0.f, 0.f, 0.f), Vec4(0.f, 1.f, 0.f, 0.f), Vec4(0.f, 0.f, 1.f, 0.f), Vec4(0.f, 0.f, 0.f, 1.f) } {}
+		constexpr Mat4(const Vec4 & c0, const Vec4 & c1, const Vec4 & c2, const Vec4 & c3) : mColumns{ c0, c1, c2, c3 } {}
+
+		static Mat4 Translation(const Vec3 & t);
+		static Mat4 Scale(const Vec3 & s);
+		static Mat4 Rotation(const Quat & q);
+		/// \brief	Same as glOrtho, Ortho(0, width, height, 0, -1, 1) maps pixels with y down.
+		static Mat4 Ortho(float left, float right, float bottom, float top, float near_z, float far_z);
+		/// \brief	Same as gluPerspective, right handed looking down -z to a [-1, 1] depth.
+		static Mat4 Perspective(float fovy_radians, float aspect, float near_z, float far_z);
+
+		const float * data() const { return &mColumns[0].x; }
+
+		Vec4 mColumns[4];
+	};
+
+	// Vec2
+	inline Vec2 operator+(const Vec2 & a, const Vec2 & b) { return Vec2(a.x + b.x, a.y + b.y); }
+	inline Vec2 operator-(const Vec2 & a, const Vec2 & b) { return Vec2(a.x - b.x, a.y - b.y); }
+	inline Vec2 operator*(const Vec2 & a, float s) { return Vec2(a.x * s, a.y * s); }
+	inline float Dot(const Vec2 & a, const Vec2 & b) { return a.x * b.x + a.y * b.y; }
+	inline float Length(const Vec2 & v) { return std::sqrt(Dot(v, v)); }
+
+	// Vec3
+	inline Vec3 operator+(const Vec3 & a, const Vec3 & b) { return Vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+	inline Vec3 operator-(const Vec3 & a, const Vec3 & b) { return Vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+	inline Vec3 operator*(const Vec3 & a, float s) { return Vec3(a.x * s, a.y * s, a.z * s); }
+	inline float Dot(const Vec3 & a, const Vec3 & b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline Vec3 Cross(const Vec3 & a, const Vec3 & b)
+	{
+		return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+	inline float Length(const Vec3 & v) { return std::sqrt(Dot(v, v)); }
+	inline Vec3 Normalize(const Vec3 & v) { return v * (1.f / Length(v)); }
+
+	// Vec4
+#if APP_MATH_SSE
+	inline __m128 Load(const Vec4 & v) { return _mm_loadu_ps(&v.x); }
+	inline Vec4 Store(__m128 r) { Vec4 v; _mm_storeu_ps(&v.x, r); return v; }
+
+	inline Vec4 operator+(const Vec4 & a, const Vec4 & b) { return Store(_mm_add_ps(Load(a), Load(b))); }
+	inline Vec4 operator-(const Vec4 & a, const Vec4 & b) { return Store(_mm_sub_ps(Load(a), Load(b))); }
+	inline Vec4 operator*(const Vec4 & a, const Vec4 & b) { return Store(_mm_mul_ps(Load(a), Load(b))); }
+	inline Vec4 operator*(const Vec4 & a, float s) { return Store(_mm_mul_ps(Load(a), _mm_set1_ps(s))); }
+	inline float Dot(const Vec4 & a, const Vec4 & b)
+	{
+		const __m128 m = _mm_mul_ps(Load(a), Load(b));
+		const __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));	// x + z, y + w
+		return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+	}
+#else
+	inline Vec4 operator+(const Vec4 & a, const Vec4 & b) { return Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+	inline Vec4 operator-(const Vec4 & a, const Vec4 & b) { return Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+	inline Vec4 operator*(const Vec4 & a, const Vec4 & b) { return Vec4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+	inline Vec4 operator*(const Vec4 & a, float s) { return Vec4(a.x * s, a.y * s, a.z * s, a.w * s); }
+	inline float Dot(const Vec4 & a, const Vec4 & b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+#endif
+
+	// Quat
+	inline Quat operator*(const Quat & a, const Quat & b)
+	{
+		return Quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+					a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+					a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+					a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+	}
+	inline Quat Conjugate(const Quat & q) { return Quat(-q.x, -q.y, -q.z, q.w); }
+	inline Quat Normalize(const Quat & q)
+	{
+		const float inv_length = 1.f / std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		return Quat(q.x * inv_length, q.y * inv_length, q.z * inv_length, q.w * inv_length);
+	}
+	/// \brief	Rotates the vector by the unit quaternion.
+	inline Vec3 Rotate(const Quat & q, const Vec3 & v)
+	{
+		// v + 2w (u x v) + 2 u x (u x v), with u the vector part
+		const Vec3 u(q.x, q.y, q.z);
+		const Vec3 t = Cross(u, v) * 2.f;
+		return v + t * q.w + Cross(u, t);
+	}
+	/// \brief	Spherical interpolation through the shortest arc.
+	Quat Slerp(const Quat & a, const Quat & b, float t);
+
+	inline Quat Quat::FromAxisAngle(const Vec3 & axis, float radians)
+	{
+		const float s = std::sin(radians * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f));
+	}
+
+	// Mat4
+#if APP_MATH_SSE
+	inline Vec4 operator*(const Mat4 & m, const Vec4 & v)
+	{
+		__m128 r = _mm_mul_ps(Load(m.mColumns[0]), _mm_set1_ps(v.x));
+		r = _mm_add_ps(r, _mm_mul_ps(Load(m.mColumns[1]), _mm_set1_ps(v.y)));
+		r = _mm_add_ps(r, _mm_mul_ps(Load(m.mColumns[2]), _mm_set1_ps(v.z)));
+		r = _mm_add_ps(r, _mm_mul_ps(Load(m.mColumns[3]), _mm_set1_ps(v.w)));
+		return Store(r);
+	}
+#else
+	inline Vec4 operator*(const Mat4 & m, const Vec4 & v)
+	{
+		return m.mColumns[0] * v.x + m.mColumns[1] * v.y + m.mColumns[2] * v.z + m.mColumns[3] * v.w;
+	}
+#endif
+	/// \brief	Every column of the result is a with the column of b applied.
+	inline Mat4 operator*(const Mat4 & a, const Mat4 & b)
+	{
+		return Mat4(a * b.mColumns[0], a * b.mColumns[1], a * b.mColumns[2], a * b.mColumns[3]);
+	}
+	/// \brief	m * (p, 1) without the projection.
+	inline Vec3 TransformPoint(const Mat4 & m, const Vec3 & p)
+	{
+		const Vec4 r = m * Vec4(p, 1.f);
+		return Vec3(r.x, r.y, r.z);
+	}
+	/// \brief	m * (v, 0), the translation doesn't apply.
+	inline Vec3 TransformVector(const Mat4 & m, const Vec3 & v)
+	{
+		const Vec4 r = m * Vec4(v, 0.f);
+		return Vec3(r.x, r.y, r.z);
+	}
+	Mat4 Transpose(const Mat4 & m);
+
+	/// \brief	Points in SoA layout, every component in its own array.
+	struct PointsSoA
+	{
+		float * mpX;
+		float * mpY;
+		float * mpZ;
+	};
+	/// \brief	Axis aligned boxes in SoA layout.
+	struct AabbsSoA
+	{
+		float * mpMinX, * mpMinY, * mpMinZ;
+		float * mpMaxX, * mpMaxY, * mpMaxZ;
+	};
+
+	/// \brief	Transforms count points by an affine matrix, in and out can be the same arrays.
+	void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t count);
+	/// \brief	Boxes that enclose the transformed boxes (Arvo's method), in and out can be the same arrays.
+	void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t count);
+	/// \brief	Name of the implementation of the batch kernels: "AVX2", "SSE" or "Scalar".
+	const char * getMathPath();
+
+	/// \brief	Reference implementations, used to benchmark the SIMD ones.
+	namespace scalar
+	{
+		Mat4 Multiply(const Mat4 & a, const Mat4 & b);
+		void TransformPoints(const Mat4 & m, const PointsSoA & in, const PointsSoA & out, std::size_t count);
+		void TransformAabbs(const Mat4 & m, const AabbsSoA & in, const AabbsSoA & out, std::size_t count);
+	}
+}
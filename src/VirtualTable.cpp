@@ -0,0 +1,358 @@
+/*!
+\brief	ImGui table that only builds the rows that are visible, for tables of millions of rows.
+*/
+
+#include "VirtualTable.h"
+
+#include "GUI.h"		// namespace ImGui
+
+#include <vector>		// std::vector
+#include <algorithm>	// std::upper_bound, std::stable_sort, std::inplace_merge
+#include <numeric>		// std::iota
+#include <thread>		// std::thread
+#include <atomic>		// std::atomic
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <cstdint>		// std::uint32_t
+#include <cstdio>		// std::snprintf
+
+namespace app
+{
+	class VirtualTable::VirtualTable_impl
+	{
+	public:
+		explicit VirtualTable_impl(TableDataSource & source);
+		~VirtualTable_impl();
+
+		void Draw(const char * label, float width, float height);
+
+		void InvalidateRows();
+		void ScrollToRow(std::size_t view_row);
+		std::size_t getRowAtOffset(double y) const;
+
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		void UpdateRows();
+		double getRowTop(std::size_t view_row) const;
+		double getRowHeight(std::size_t view_row) const;
+
+		void RequestSort(unsigned column);
+		/// \brief	Swaps the order if the sort thread is done.
+		void PollSort();
+		void CancelSort();
+		/// \brief	Runs in the sort thread. Sorts chunks of rows and then merges them, so it can
+		/// report its progress and be cancelled between steps.
+		void SortRows(std::size_t row_count, unsigned column, bool descending);
+
+		TableDataSource & mSource;
+
+		// rows
+		bool					mbRowsValid{ false };
+		std::size_t				mRowCount{ 0 };
+		std::vector<double>		mvRowOffsets;		// top of every row (and the bottom of the table), only for variable heights
+		double					mFixedHeight{ 1.0 };
+		std::vector<std::uint32_t>	mvOrder;		// row of the data source for every row of the view, empty if unsorted
+
+		// scrolling
+		double	mScroll{ 0.0 };
+		float	mGrabOffset{ 0.f };
+
+		// sorting
+		int							mSortColumn{ -1 };
+		bool						mbSortDescending{ false };
+		std::thread					mSortThread;
+		std::atomic<bool>			mbCancelSort{ false };
+		std::atomic<bool>			mbSortDone{ false };
+		std::atomic<float>			mSortProgress{ 0.f };
+		std::vector<std::uint32_t>	mvSortResult;		// only touched by the sort thread until it is joined
+		double						mSortMs{ 0.0 };
+
+		Stats mStats;
+	};
+
+	VirtualTable::VirtualTable_impl::VirtualTable_impl(TableDataSource & source)
+		: mSource(source)
+	{}
+	VirtualTable::VirtualTable_impl::~VirtualTable_impl()
+	{
+		CancelSort();
+	}
+
+	void VirtualTable::VirtualTable_impl::UpdateRows()
+	{
+		if (mbRowsValid)
+			return;
+
+		mRowCount = mSource.getRowCount();
+		mvRowOffsets.clear();
+		if (mSource.hasVariableRowHeight())
+		{
+			// the heights are cached in view order, they are rebuilt when the order changes
+			mvRowOffsets.resize(mRowCount + 1);
+			double offset = 0.0;
+			for (std::size_t row = 0; row < mRowCount; ++row)
+			{
+				mvRowOffsets[row] = offset;
+				offset += mSource.getRowHeight(mvOrder.empty() ? row : mvOrder[row]);
+			}
+			mvRowOffsets[mRowCount] = offset;
+		}
+		mbRowsValid = true;
+	}
+
+	double VirtualTable::VirtualTable_impl::getRowTop(std::size_t view_row) const
+	{
+		return mvRowOffsets.empty() ? view_row * mFixedHeight : mvRowOffsets[view_row];
+	}
+	double VirtualTable::VirtualTable_impl::getRowHeight(std::size_t view_row) const
+	{
+		return mvRowOffsets.empty() ? mFixedHeight : mvRowOffsets[view_row + 1] - mvRowOffsets[view_row];
+	}
+
+	std::size_t VirtualTable::VirtualTable_impl::getRowAtOffset(double y) const
+	{
+		if (mRowCount == 0 || y <= 0.0)
+			return 0;
+
+		std::size_t row;
+		if (mvRowOffsets.empty())
+		{
+			row = static_cast<std::size_t>(y / mFixedHeight);
+		}
+		else
+		{
+			// first row that starts after y, the one before contains it
+			const auto it = std::upper_bound(mvRowOffsets.begin(), mvRowOffsets.end(), y);
+			row = static_cast<std::size_t>(it - mvRowOffsets.begin()) - 1;
+		}
+		return std::min(row, mRowCount - 1);
+	}
+
+	void VirtualTable::VirtualTable_impl::ScrollToRow(std::size_t view_row)
+	{
+		UpdateRows();
+		if (view_row < mRowCount)
+			mScroll = getRowTop(view_row);
+	}
+
+	void VirtualTable::VirtualTable_impl::InvalidateRows()
+	{
+		CancelSort();
+		mvOrder.clear();
+		mSortColumn = -1;
+		mbRowsValid = false;
+	}
+
+	void VirtualTable::VirtualTable_impl::CancelSort()
+	{
+		if (mSortThread.joinable())
+		{
+			mbCancelSort = true;
+			mSortThread.join();
+		}
+		mbCancelSort = false;
+		mbSortDone = false;
+		mStats.mbSorting = false;
+	}
+
+	void VirtualTable::VirtualTable_impl::RequestSort(unsigned column)
+	{
+		CancelSort();
+
+		const bool descending = mSortColumn == static_cast<int>(column) ? !mbSortDescending : false;
+		mSortColumn = static_cast<int>(column);
+		mbSortDescending = descending;
+		mSortProgress = 0.f;
+		mStats.mbSorting = true;
+		mSortThread = std::thread(&VirtualTable_impl::SortRows, this, mRowCount, column, descending);
+	}
+
+	void VirtualTable::VirtualTable_impl::SortRows(std::size_t row_count, unsigned column, bool descending)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		std::vector<std::uint32_t> order(row_count);
+		std::iota(order.begin(), order.end(), 0u);
+
+		// stable, so the rows that compare equal keep the order of the data source
+		const TableDataSource & source = mSource;
+		auto less = [&source, column, descending](std::uint32_t a, std::uint32_t b)
+		{
+			return descending ? source.Less(column, b, a) : source.Less(column, a, b);
+		};
+
+		const std::size_t chunk_size = 1 << 16;
+		for (std::size_t first = 0; first < row_count; first += chunk_size)
+		{
+			if (mbCancelSort)
+				return;
+			std::stable_sort(order.begin() + first, order.begin() + std::min(first + chunk_size, row_count), less);
+			mSortProgress = 0.5f * static_cast<float>(std::min(first + chunk_size, row_count)) / static_cast<float>(row_count);
+		}
+
+		std::size_t passes = 0, pass = 0;
+		for (std::size_t width = chunk_size; width < row_count; width *= 2)
+			++passes;
+		for (std::size_t width = chunk_size; width < row_count; width *= 2, ++pass)
+		{
+			for (std::size_t first = 0; first + width < row_count; first += 2 * width)
+			{
+				if (mbCancelSort)
+					return;
+				std::inplace_merge(order.begin() + first, order.begin() + first + width,
+								   order.begin() + std::min(first + 2 * width, row_count), less);
+			}
+			mSortProgress = 0.5f + 0.5f * static_cast<float>(pass + 1) / static_cast<float>(passes);
+		}
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		mSortMs = elapsed.count();
+		mvSortResult.swap(order);
+		mSortProgress = 1.f;
+		mbSortDone = true;
+	}
+
+	void VirtualTable::VirtualTable_impl::PollSort()
+	{
+		mStats.mSortProgress = mSortProgress;
+		if (!mbSortDone)
+			return;
+
+		mSortThread.join();
+		mbSortDone = false;
+		mvOrder.swap(mvSortResult);
+		mvSortResult.clear();
+		mStats.mbSorting = false;
+		mStats.mLastSortMs = mSortMs;
+
+		// the variable heights follow the order of the view
+		if (!mvRowOffsets.empty())
+			mbRowsValid = false;
+	}
+
+	void VirtualTable::VirtualTable_impl::Draw(const char * label, float width, float height)
+	{
+		PollSort();
+		UpdateRows();
+
+		ImGuiIO & io = ImGui::GetIO();
+		const ImGuiStyle & style = ImGui::GetStyle();
+		mFixedHeight = ImGui::GetTextLineHeightWithSpacing();
+
+		ImGui::BeginChild(label, ImVec2(width, height), true, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		const ImVec2 avail = ImGui::GetContentRegionAvail();
+		ImDrawList * draw_list = ImGui::GetWindowDrawList();
+
+		// headers, clicking one sorts by that column
+		const unsigned columns = mSource.getColumnCount();
+		const float scrollbar_width = style.ScrollbarSize;
+		const float column_width = columns ? (avail.x - scrollbar_width) / columns : 0.f;
+		const float header_height = ImGui::GetTextLineHeight() + 2.f * style.FramePadding.y + style.ItemSpacing.y;
+		char buffer[256];
+		for (unsigned column = 0; column < columns; ++column)
+		{
+			const bool sorted = mSortColumn == static_cast<int>(column);
+			std::snprintf(buffer, sizeof(buffer), "%s%s###column%u", mSource.getColumnName(column),
+						  sorted ? (mbSortDescending ? " v" : " ^") : "", column);
+			ImGui::SetCursorScreenPos(ImVec2(origin.x + column * column_width, origin.y));
+			if (ImGui::Button(buffer, ImVec2(column_width - style.ItemSpacing.x, 0.f)))
+				RequestSort(column);
+		}
+
+		// scrolling, in doubles
+		const float body_top = origin.y + header_height;
+		const float body_height = avail.y - header_height;
+		const double total_height = getRowTop(mRowCount);
+		const double max_scroll = std::max(total_height - body_height, 0.0);
+		if (ImGui::IsWindowHovered() && io.MouseWheel != 0.f)
+			mScroll -= io.MouseWheel * 3.0 * mFixedHeight;
+
+		const float track_x = origin.x + avail.x - scrollbar_width;
+		const float thumb_height = total_height > 0.0 ? std::max(static_cast<float>(body_height * std::min(body_height / total_height, 1.0)), style.GrabMinSize) : body_height;
+		if (body_height > 0.f)
+		{
+			ImGui::SetCursorScreenPos(ImVec2(track_x, body_top));
+			ImGui::InvisibleButton("##scrollbar", ImVec2(scrollbar_width, body_height));
+			if (ImGui::IsItemActive() && body_height > thumb_height)
+			{
+				const float thumb_top = body_top + static_cast<float>(max_scroll > 0.0 ? mScroll / max_scroll : 0.0) * (body_height - thumb_height);
+				if (ImGui::IsMouseClicked(0))
+				{
+					const bool on_thumb = io.MousePos.y >= thumb_top && io.MousePos.y < thumb_top + thumb_height;
+					mGrabOffset = on_thumb ? io.MousePos.y - thumb_top : thumb_height * 0.5f;
+				}
+				mScroll = (io.MousePos.y - body_top - mGrabOffset) / (body_height - thumb_height) * max_scroll;
+			}
+		}
+		mScroll = std::min(std::max(mScroll, 0.0), max_scroll);
+
+		const float thumb_top = body_top + static_cast<float>(max_scroll > 0.0 ? mScroll / max_scroll : 0.0) * (body_height - thumb_height);
+		draw_list->AddRectFilled(ImVec2(track_x, body_top), ImVec2(track_x + scrollbar_width, body_top + body_height),
+								 ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_ScrollbarBg]));
+		draw_list->AddRectFilled(ImVec2(track_x, thumb_top), ImVec2(track_x + scrollbar_width, thumb_top + thumb_height),
+								 ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_ScrollbarGrab]), style.ScrollbarRounding);
+
+		// only the visible rows, every cell is clipped on the CPU so the rows don't add draw commands
+		const ImU32 text_color = ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_Text]);
+		const ImU32 alt_color = ImGui::ColorConvertFloat4ToU32(ImVec4(1.f, 1.f, 1.f, 0.04f));
+		const float body_bottom = body_top + body_height;
+		unsigned visible_rows = 0;
+		std::size_t row = getRowAtOffset(mScroll);
+		float y = body_top + static_cast<float>(getRowTop(row) - mScroll);
+		draw_list->PushClipRect(ImVec4(origin.x, body_top, track_x, body_bottom));
+		for (; row < mRowCount && y < body_bottom; ++row, ++visible_rows)
+		{
+			const float row_height = static_cast<float>(getRowHeight(row));
+			const std::size_t data_row = mvOrder.empty() ? row : mvOrder[row];
+			if (row & 1)
+				draw_list->AddRectFilled(ImVec2(origin.x, y), ImVec2(track_x, y + row_height), alt_color);
+
+			for (unsigned column = 0; column < columns; ++column)
+			{
+				const float x = origin.x + column * column_width;
+				const ImVec4 clip_rect(x, std::max(y, body_top), x + column_width - style.ItemSpacing.x, std::min(y + row_height, body_bottom));
+				mSource.getCellText(data_row, column, buffer, sizeof(buffer));
+				draw_list->AddText(ImGui::GetWindowFont_(), ImGui::GetWindowFontSize(), ImVec2(x + style.FramePadding.x, y), text_color,
+								   buffer, nullptr, 0.f, &clip_rect);
+			}
+			y += row_height;
+		}
+		draw_list->PopClipRect();
+
+		if (mStats.mbSorting)
+		{
+			std::snprintf(buffer, sizeof(buffer), "Sorting... %d%%", static_cast<int>(mStats.mSortProgress * 100.f));
+			draw_list->AddText(ImVec2(origin.x + style.FramePadding.x, body_bottom - ImGui::GetTextLineHeight()), text_color, buffer);
+		}
+		ImGui::EndChild();
+
+		mStats.mVisibleRows = visible_rows;
+	}
+
+	VirtualTable::VirtualTable(TableDataSource & source)
+		: mpImpl(std::make_unique<VirtualTable_impl>(source))
+	{}
+	VirtualTable::~VirtualTable() {}
+
+	void VirtualTable::Draw(const char * label, float width, float height)
+	{
+		mpImpl->Draw(label, width, height);
+	}
+	void VirtualTable::InvalidateRows()
+	{
+		mpImpl->InvalidateRows();
+	}
+	void VirtualTable::ScrollToRow(std::size_t view_row)
+	{
+		mpImpl->ScrollToRow(view_row);
+	}
+	std::size_t VirtualTable::getRowAtOffset(double y) const
+	{
+		return mpImpl->getRowAtOffset(y);
+	}
+	const VirtualTable::Stats & VirtualTable::getStats() const
+	{
+		return mpImpl->getStats();
+	}
+}
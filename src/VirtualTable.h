@@ -0,0 +1,69 @@
+/*!
+\brief	ImGui table that only builds the rows that are visible, for tables of millions of rows.
+*/
+
+#pragma once
+
+#include <memory>	// std::unique_ptr
+#include <cstddef>	// std::size_t
+
+namespace app
+{
+	/// \brief	Pull based source of the rows of a VirtualTable, only the visible rows are requested.
+	/// IMPORTANT(Borja): TableDataSource::Less is called from the sort thread while the other
+	/// functions are called from the main thread, the data can't change while a sort is running.
+	class TableDataSource
+	{
+	public:
+		virtual ~TableDataSource() {}
+
+		virtual std::size_t getRowCount() const = 0;
+		virtual unsigned getColumnCount() const = 0;
+		virtual const char * getColumnName(unsigned column) const = 0;
+		/// \brief	Writes the null terminated text of the cell in the buffer.
+		virtual void getCellText(std::size_t row, unsigned column, char * buffer, std::size_t buffer_size) const = 0;
+		/// \return	True if row_a goes before row_b when sorting by the column in ascending order.
+		virtual bool Less(unsigned column, std::size_t row_a, std::size_t row_b) const = 0;
+
+		/// \brief	Rows have the height of a line of text unless this returns true.
+		virtual bool hasVariableRowHeight() const { return false; }
+		/// \return	Height of the row in pixels, only called if TableDataSource::hasVariableRowHeight.
+		/// The heights are cached until VirtualTable::InvalidateRows.
+		virtual float getRowHeight(std::size_t /*row*/) const { return 0.f; }
+	};
+
+	/// \brief	Draws the rows of a TableDataSource in an ImGui child window with its own scrolling
+	/// (in doubles, ImGui's float scrolling loses precision with millions of rows).
+	/// Clicking a header sorts the table by that column in a background thread, the old order
+	/// is shown until the new one is ready.
+	class VirtualTable
+	{
+	public:
+		struct Stats
+		{
+			unsigned	mVisibleRows{ 0 };		// rows drawn in the last call to VirtualTable::Draw
+			bool		mbSorting{ false };
+			float		mSortProgress{ 0.f };	// 0 to 1
+			double		mLastSortMs{ 0.0 };		// duration of the last completed sort
+		};
+
+		explicit VirtualTable(TableDataSource & source);
+		~VirtualTable();
+
+		/// \brief	ImGui widget, needs to be called inside a window.
+		void Draw(const char * label, float width, float height);
+
+		/// \brief	Needs to be called when rows are added or removed, or their heights change.
+		/// Cancels the sort in progress and shows the rows unsorted.
+		void InvalidateRows();
+		void ScrollToRow(std::size_t view_row);
+		/// \return	Index in the sorted view of the row at y pixels from the top of the table, O(log n).
+		std::size_t getRowAtOffset(double y) const;
+
+		const Stats & getStats() const;
+
+	private:
+		class VirtualTable_impl;
+		std::unique_ptr<VirtualTable_impl> mpImpl;
+	};
+}
@@ -6,15 +6,22 @@ Headers are separated though so that the user can include what he uses.
 
 #include "Window.h"		// Window
 #include "Input.h"		// Input
+#include "InputActions.h"	// ActionMap
+#include "Gamepads.h"	// Gamepads
 
 #include "SDL\SDL.h"	// SDL functions
 #include "my_gl_core.h"	// namespace gl
+#include "my_gl_stream_buffer.h"	// my_gl_core::StreamBuffer
+#include "my_gl_resources.h"	// my_gl_core::update_resources, my_gl_core::report_resource_leaks
+#include "my_gl_trace.h"	// my_gl_core::begin_requested_trace, my_gl_core::end_trace_frame
+#include "DynamicResolution.h"	// app::DynamicResolution
+#include "Log.h"		// APP_LOG_INFO
 
 #include <stdexcept>	// std::runtime_error
 #include <memory>		// std::uniuqe_ptr, std::make_unique
 #include <array>		// std::array
+#include <chrono>		// std::chrono::high_resolution_clock
 
-#include <iostream>		// std::cout
 #include <cctype>		// std::tolower
 
 namespace app
@@ -23,19 +30,33 @@ namespace app
 	class Input::Input_impl
 	{
 	public:
+		~Input_impl();
+		/// \brief	Clears the per-frame accumulators, called before processing the events of a frame.
+		void BeginFrame();
 		void Update();
 		bool ProcessEvent(const SDL_Event & event);
+		/// \brief	Processes a run of consecutive SDL_MOUSEMOTION events at once.
+		void ProcessMotion(const SDL_Event * events, int count);
 
 		bool KeyTriggered(const unsigned k) const;
 		bool KeyPressed(const unsigned k) const;
 		bool MouseTriggered(const unsigned b) const;
 		bool MousePressed(const unsigned b) const;
 
+		ActionMap & getActions() { return mActions; }
+		Gamepads & getGamepads() { return mGamepads; }
+
 		std::size_t getKeyNum() const { return mvKeyboardKeys.size(); }
 		std::size_t getMouseButtonNum() const { return mvMouseButtons.size(); }
 
 		int getMouseX() const { return mMouse_x; }
 		int getMouseY() const { return mMouse_y; }
+		int getMouseDeltaX() const { return mMouseDelta_x; }
+		int getMouseDeltaY() const { return mMouseDelta_y; }
+		float getMouseWheelX() const { return mWheel_x; }
+		float getMouseWheelY() const { return mWheel_y; }
+		void setRelativeMouseMode(bool relative);
+		bool isRelativeMouseMode() const;
 
 		void setKeyTriggeredCallBack(key_callback key_triggered_callback);
 		void setKeyPressedCallBack(key_callback key_pressed_callback);
@@ -43,6 +64,9 @@ namespace app
 		void setMouseTriggeredCallBack(mouse_callback mouse_triggered_callback);
 		void setMousePressedCallBack(mouse_callback mouse_pressed_callback);
 		void setMouseReleasedCallBack(mouse_callback mouse_released_callback);
+		void setKeyEventCallBack(key_event_callback event_callback);
+		void setTextInputCallBack(text_callback text_input_callback);
+		void setMouseMotionCallBack(motion_callback mouse_motion_callback);
 
 	private:
 		int getKeyState(unsigned k) const;
@@ -51,6 +75,12 @@ namespace app
 		static unsigned UpdateKeyState(unsigned char & prev, unsigned char & curr);
 		static void DummyKeyCallBack(unsigned char) {}
 		static void DummyMouseCallBack(unsigned char, int, int) {}
+		static void DummyKeyEventCallBack(unsigned, bool, bool, unsigned) {}
+		static void DummyTextCallBack(const char *) {}
+		static void DummyMotionCallBack(int, int, int, int, unsigned) {}
+		static unsigned getModifiers(Uint16 sdl_mod);
+		void AddController(int device_index);
+		void RemoveController(SDL_JoystickID id);
 
 		static const unsigned char PRESSED_FLAG = 1 << 0;
 		static const unsigned char TRIGGERED_FLAG = 1 << 1;
@@ -70,6 +100,9 @@ namespace app
 
 		// mouse position
 		int mMouse_x{ 0 }, mMouse_y{ 0 };
+		// per-frame accumulators
+		int mMouseDelta_x{ 0 }, mMouseDelta_y{ 0 };
+		float mWheel_x{ 0.f }, mWheel_y{ 0.f };
 
 		key_callback mKeyTriggeredCallBack{ DummyKeyCallBack };
 		key_callback mKeyPressededCallBack{ DummyKeyCallBack };
@@ -78,8 +111,28 @@ namespace app
 		mouse_callback mMouseTriggeredCallBack{ DummyMouseCallBack };
 		mouse_callback mMousePressededCallBack{ DummyMouseCallBack };
 		mouse_callback mMouseReleasedCallBack{ DummyMouseCallBack };
+
+		key_event_callback mKeyEventCallBack{ DummyKeyEventCallBack };
+		text_callback mTextInputCallBack{ DummyTextCallBack };
+		motion_callback mMouseMotionCallBack{ DummyMotionCallBack };
+		bool mbHasMotionCallBack{ false };
+
+		ActionMap mActions;
+
+		Gamepads mGamepads;
+		/// \brief	Open game controller of every gamepad slot.
+		std::array<SDL_GameController *, Gamepads::MAX_GAMEPADS> mvControllers{};
 	};
 
+	Input::Input_impl::~Input_impl()
+	{
+		for (SDL_GameController * controller : mvControllers)
+		{
+			if (controller)
+				SDL_GameControllerClose(controller);
+		}
+	}
+
 	bool Input::Input_impl::ProcessEvent(const SDL_Event & event)
 	{
 		const unsigned k = std::tolower(SDL_GetKeyFromScancode(event.key.keysym.scancode));
@@ -90,11 +143,20 @@ namespace app
 		{
 			if (k < mvKeyboardKeys.size())
 				mvKeyboardKeys[k].mCurr = 1;
+			if (!event.key.repeat)
+				mActions.ProcessKey(event.key.keysym.scancode, true, getModifiers(event.key.keysym.mod));
+			mKeyEventCallBack(event.key.keysym.scancode, true, event.key.repeat != 0, getModifiers(event.key.keysym.mod));
 		} break;
 		case SDL_KEYUP:
 		{
 			if (k < mvKeyboardKeys.size())
 				mvKeyboardKeys[k].mCurr = 0;
+			mActions.ProcessKey(event.key.keysym.scancode, false, getModifiers(event.key.keysym.mod));
+			mKeyEventCallBack(event.key.keysym.scancode, false, false, getModifiers(event.key.keysym.mod));
+		} break;
+		case SDL_TEXTINPUT:
+		{
+			mTextInputCallBack(event.text.text);
 		} break;
 
 		// mouse
@@ -102,16 +164,42 @@ namespace app
 		{
 			if (event.button.button < mvMouseButtons.size())
 				mvMouseButtons[event.button.button].mCurr = 1;
+			mActions.ProcessMouseButton(event.button.button, true);
 		} break;
 		case SDL_MOUSEBUTTONUP:
 		{
 			if (event.button.button < mvMouseButtons.size())
 				mvMouseButtons[event.button.button].mCurr = 0;
+			mActions.ProcessMouseButton(event.button.button, false);
 		} break;
 		case SDL_MOUSEMOTION:
 		{
-			mMouse_x = event.motion.x;
-			mMouse_y = event.motion.y;
+			ProcessMotion(&event, 1);
+		} break;
+		case SDL_MOUSEWHEEL:
+		{
+			const float direction = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1.f : 1.f;
+			mWheel_x += direction * event.wheel.x;
+			mWheel_y += direction * event.wheel.y;
+		} break;
+
+		// gamepads
+		case SDL_CONTROLLERDEVICEADDED:
+		{
+			AddController(event.cdevice.which);
+		} break;
+		case SDL_CONTROLLERDEVICEREMOVED:
+		{
+			RemoveController(event.cdevice.which);
+		} break;
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP:
+		{
+			mGamepads.ProcessButton(event.cbutton.which, event.cbutton.button, event.type == SDL_CONTROLLERBUTTONDOWN);
+		} break;
+		case SDL_CONTROLLERAXISMOTION:
+		{
+			mGamepads.ProcessAxis(event.caxis.which, event.caxis.axis, event.caxis.value, event.caxis.timestamp);
 		} break;
 		default:
 		{
@@ -121,6 +209,52 @@ namespace app
 
 		return true;
 	}
+	void Input::Input_impl::ProcessMotion(const SDL_Event * events, int count)
+	{
+		if (count <= 0)
+			return;
+
+		if (mbHasMotionCallBack)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				const SDL_MouseMotionEvent & motion = events[i].motion;
+				mMouseMotionCallBack(motion.x, motion.y, motion.xrel, motion.yrel, motion.timestamp);
+			}
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			mMouseDelta_x += events[i].motion.xrel;
+			mMouseDelta_y += events[i].motion.yrel;
+		}
+
+		// only the last absolute position matters
+		mMouse_x = events[count - 1].motion.x;
+		mMouse_y = events[count - 1].motion.y;
+	}
+	void Input::Input_impl::BeginFrame()
+	{
+		mMouseDelta_x = mMouseDelta_y = 0;
+		mWheel_x = mWheel_y = 0.f;
+	}
+	void Input::Input_impl::setRelativeMouseMode(bool relative)
+	{
+		SDL_SetRelativeMouseMode(relative ? SDL_TRUE : SDL_FALSE);
+	}
+	bool Input::Input_impl::isRelativeMouseMode() const
+	{
+		return SDL_GetRelativeMouseMode() == SDL_TRUE;
+	}
+	unsigned Input::Input_impl::getModifiers(Uint16 sdl_mod)
+	{
+		unsigned modifiers = 0;
+		if (sdl_mod & KMOD_SHIFT)	modifiers |= MOD_SHIFT;
+		if (sdl_mod & KMOD_CTRL)	modifiers |= MOD_CTRL;
+		if (sdl_mod & KMOD_ALT)		modifiers |= MOD_ALT;
+		if (sdl_mod & KMOD_GUI)		modifiers |= MOD_SUPER;
+		return modifiers;
+	}
 	unsigned Input::Input_impl::UpdateKeyState(unsigned char & prev, unsigned char & curr)
 	{
 		unsigned flags = 0;
@@ -167,6 +301,44 @@ namespace app
 			if (flags & PRESSED_FLAG)	mMousePressededCallBack(static_cast<unsigned char>(i), mMouse_x, mMouse_y);
 			if (flags & RELEASED_FLAG)	mMouseReleasedCallBack(static_cast<unsigned char>(i), mMouse_x, mMouse_y);
 		}
+
+		mActions.Update();
+		mGamepads.Update();
+	}
+	void Input::Input_impl::AddController(int device_index)
+	{
+		SDL_GameController * controller = SDL_GameControllerOpen(device_index);
+		if (!controller)
+		{
+			APP_LOG_WARNING(log::Category::Input, "Can't open the game controller {}: {}", device_index, SDL_GetError());
+			return;
+		}
+
+		// the controllers connected at startup can be reported twice
+		const SDL_JoystickID id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller));
+		const char * name = SDL_GameControllerName(controller);
+		const bool known = mGamepads.FindGamepad(id) >= 0;
+		const int pad = mGamepads.Connect(id, name);
+		if (known || pad < 0)
+		{
+			if (pad < 0)
+				APP_LOG_WARNING(log::Category::Input, "Ignoring the game controller {}, all the gamepads are in use", name ? name : "");
+			SDL_GameControllerClose(controller);
+			return;
+		}
+
+		mvControllers[pad] = controller;
+		APP_LOG_INFO(log::Category::Input, "Gamepad {} connected: {}", pad, mGamepads.getName(pad));
+	}
+	void Input::Input_impl::RemoveController(SDL_JoystickID id)
+	{
+		const int pad = mGamepads.Disconnect(id);
+		if (pad < 0)
+			return;
+
+		SDL_GameControllerClose(mvControllers[pad]);
+		mvControllers[pad] = nullptr;
+		APP_LOG_INFO(log::Category::Input, "Gamepad {} disconnected", pad);
 	}
 
 	bool Input::Input_impl::KeyTriggered(const unsigned k) const
@@ -224,6 +396,19 @@ namespace app
 	{
 		mMouseReleasedCallBack = mouse_released_callback ? mouse_released_callback : DummyMouseCallBack;
 	}
+	void Input::Input_impl::setKeyEventCallBack(key_event_callback event_callback)
+	{
+		mKeyEventCallBack = event_callback ? event_callback : DummyKeyEventCallBack;
+	}
+	void Input::Input_impl::setTextInputCallBack(text_callback text_input_callback)
+	{
+		mTextInputCallBack = text_input_callback ? text_input_callback : DummyTextCallBack;
+	}
+	void Input::Input_impl::setMouseMotionCallBack(motion_callback mouse_motion_callback)
+	{
+		mbHasMotionCallBack = static_cast<bool>(mouse_motion_callback);
+		mMouseMotionCallBack = mouse_motion_callback ? mouse_motion_callback : DummyMotionCallBack;
+	}
 #pragma endregion
 
 #pragma region // Input
@@ -248,6 +433,30 @@ namespace app
 	{
 		return mpInputImpl->getMouseY();
 	}
+	int Input::getMouseDeltaX() const
+	{
+		return mpInputImpl->getMouseDeltaX();
+	}
+	int Input::getMouseDeltaY() const
+	{
+		return mpInputImpl->getMouseDeltaY();
+	}
+	float Input::getMouseWheelX() const
+	{
+		return mpInputImpl->getMouseWheelX();
+	}
+	float Input::getMouseWheelY() const
+	{
+		return mpInputImpl->getMouseWheelY();
+	}
+	void Input::setRelativeMouseMode(bool relative)
+	{
+		mpInputImpl->setRelativeMouseMode(relative);
+	}
+	bool Input::isRelativeMouseMode() const
+	{
+		return mpInputImpl->isRelativeMouseMode();
+	}
 
 	bool Input::KeyTriggered(unsigned k) const
 	{
@@ -266,6 +475,23 @@ namespace app
 		return mpInputImpl->MousePressed(b);
 	}
 
+	ActionMap & Input::getActions()
+	{
+		return mpInputImpl->getActions();
+	}
+	const ActionMap & Input::getActions() const
+	{
+		return mpInputImpl->getActions();
+	}
+	Gamepads & Input::getGamepads()
+	{
+		return mpInputImpl->getGamepads();
+	}
+	const Gamepads & Input::getGamepads() const
+	{
+		return mpInputImpl->getGamepads();
+	}
+
 	void Input::setKeyTriggeredCallBack(key_callback key_triggered_callback)
 	{
 		mpInputImpl->setKeyTriggeredCallBack(key_triggered_callback);
@@ -290,6 +516,18 @@ namespace app
 	{
 		mpInputImpl->setMouseReleasedCallBack(mouse_released_callback);
 	}
+	void Input::setKeyEventCallBack(key_event_callback event_callback)
+	{
+		mpInputImpl->setKeyEventCallBack(event_callback);
+	}
+	void Input::setTextInputCallBack(text_callback text_input_callback)
+	{
+		mpInputImpl->setTextInputCallBack(text_input_callback);
+	}
+	void Input::setMouseMotionCallBack(motion_callback mouse_motion_callback)
+	{
+		mpInputImpl->setMouseMotionCallBack(mouse_motion_callback);
+	}
 #pragma endregion
 
 #pragma region // Window_impl
@@ -307,6 +545,8 @@ namespace app
 		int getWindowWidth() const { return mWidth; }
 		int getWindowHeight() const { return mHeight; }
 		Input & getInput() { return mInput; }
+		my_gl_core::StreamBuffer & getStreamBuffer() { return *mpStreamBuffer; }
+		DynamicResolution & getDynamicResolution() { return *mpDynamicResolution; }
 		bool isOpened() const { return mbOpened; }
 
 	private:
@@ -318,6 +558,10 @@ namespace app
 
 		SDL_Window * mpSDL_Window{ nullptr };
 		SDL_GLContext mpGLContext{ nullptr };
+		std::unique_ptr<my_gl_core::StreamBuffer> mpStreamBuffer;
+		std::unique_ptr<DynamicResolution> mpDynamicResolution;
+		/// \brief	End of the last swap, the CPU time of a frame goes from it to the next swap.
+		std::chrono::high_resolution_clock::time_point mFrameStart;
 
 		Input mInput;
 		float mDt{ 0.f };
@@ -354,22 +598,40 @@ namespace app
 			SDL_DestroyWindow(mpSDL_Window);
 			throw std::runtime_error{ "OpenGL functions couldn't be loaded." };
 		}
+		my_gl_core::probe_caps();
+
+		const my_gl_core::Caps & caps = my_gl_core::get_caps();
+
+		using app::log::Category;
+		APP_LOG_INFO(Category::GL, "Number of gl functions that failed to load: {}", gl_sys_loaded.GetNumMissing());
+		APP_LOG_INFO(Category::GL, "GL Vendor: {}", gl::GetString(gl::VENDOR));
+		APP_LOG_INFO(Category::GL, "GL Renderer: {}", gl::GetString(gl::RENDERER));
+		APP_LOG_INFO(Category::GL, "GL Version: {}", gl::GetString(gl::VERSION));
+		APP_LOG_INFO(Category::GL, "GLSL Version: {}", gl::GetString(gl::SHADING_LANGUAGE_VERSION));
+		APP_LOG_INFO(Category::GL, "GL Tier: {} (detected {})", my_gl_core::get_tier_name(my_gl_core::get_tier()),
+					 my_gl_core::get_tier_name(my_gl_core::get_detected_tier()));
+		APP_LOG_INFO(Category::GL, "Direct state access: {}, Buffer storage: {}, Multi bind: {}, Parallel shader compile: {}",
+					 caps.direct_state_access, caps.buffer_storage, caps.multi_bind, caps.parallel_shader_compile);
 
-		std::cout << std::endl
-			<< "------------------- OpenGL -------------------" << std::endl
-			<< "Number of gl functions that failed to load: " << gl_sys_loaded.GetNumMissing() << std::endl
-			<< "GL Vendor: " << gl::GetString(gl::VENDOR) << std::endl
-			<< "GL Renderer: " << gl::GetString(gl::RENDERER) << std::endl
-			<< "GL Version: " << gl::GetString(gl::VERSION) << std::endl
-			<< "GLSL Version: " << gl::GetString(gl::SHADING_LANGUAGE_VERSION) << std::endl
-			<< "----------------------------------------------" << std::endl
-			<< std::endl;
+		// before creating anything, the trace has to have every object
+		my_gl_core::begin_requested_trace(mWidth, mHeight);
 
+		const GLsizeiptr stream_partition_size = 4 * 1024 * 1024;
+		mpStreamBuffer = std::make_unique<my_gl_core::StreamBuffer>(stream_partition_size);
+		mpDynamicResolution = std::make_unique<DynamicResolution>(mWidth, mHeight);
+		mFrameStart = std::chrono::high_resolution_clock::now();
 	}
 	Window::Window_impl::~Window_impl()
 	{
 		if (mpSDL_Window)
 		{
+			my_gl_core::stop_trace();
+			// needs the context to release its GL objects
+			mpStreamBuffer.reset();
+			mpDynamicResolution.reset();
+			// everything else that uses the context should be gone by now
+			my_gl_core::report_resource_leaks();
+
 			SDL_GL_DeleteContext(mpGLContext);
 			mpGLContext = nullptr;
 
@@ -387,23 +649,48 @@ namespace app
 		mDt = (curr_ticks - mLastTicks) / 1000.f;
 		mLastTicks = curr_ticks;
 
-		// pool all the events
-		SDL_Event sdl_event;
-		while (SDL_PollEvent(&sdl_event))
-		{
-			if (mInput.mpInputImpl->ProcessEvent(sdl_event))
-				continue;
+		// pool all the events in batches, runs of mouse motion events are processed at once so that
+		// the cost doesn't grow with the polling rate of the mouse
+		Input::Input_impl & input = *mInput.mpInputImpl;
+		input.BeginFrame();
 
-			switch (sdl_event.type)
-			{
-			case SDL_WINDOWEVENT:
+		const int batch_size = 64;
+		SDL_Event events[batch_size];
+		int event_num = 0;
+
+		SDL_PumpEvents();
+		while ((event_num = SDL_PeepEvents(events, batch_size, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) > 0)
+		{
+			for (int i = 0; i < event_num;)
 			{
-				ProcessEvent(sdl_event.window);
-			} break;
+				const SDL_Event & sdl_event = events[i];
+
+				if (sdl_event.type == SDL_MOUSEMOTION)
+				{
+					int motion_num = 1;
+					while (i + motion_num < event_num && events[i + motion_num].type == SDL_MOUSEMOTION)
+						++motion_num;
+
+					input.ProcessMotion(&sdl_event, motion_num);
+					i += motion_num;
+					continue;
+				}
+				++i;
+
+				if (input.ProcessEvent(sdl_event))
+					continue;
+
+				switch (sdl_event.type)
+				{
+				case SDL_WINDOWEVENT:
+				{
+					ProcessEvent(sdl_event.window);
+				} break;
+				}
 			}
 		}
 
-		mInput.mpInputImpl->Update();
+		input.Update();
 		return true;
 	}
 	void Window::Window_impl::ProcessEvent(const SDL_WindowEvent & window_event)
@@ -414,11 +701,25 @@ namespace app
 		{
 			Close();
 		} break;
+		case SDL_WINDOWEVENT_FOCUS_LOST:
+		{
+			// the key ups go to the window that has the focus, nothing would release the actions
+			mInput.getActions().ReleaseAll();
+			// SDL doesn't send the gamepad events in the background either
+			mInput.getGamepads().ReleaseAll(window_event.timestamp);
+		} break;
 		}
 	}
 	void Window::Window_impl::SwapBuffers()
 	{
+		mpStreamBuffer->EndFrame();
+		my_gl_core::update_resources();
+
+		const auto now = std::chrono::high_resolution_clock::now();
+		mpDynamicResolution->EndFrame(std::chrono::duration<double, std::milli>(now - mFrameStart).count());
+		my_gl_core::end_trace_frame();
 		SDL_GL_SwapWindow(mpSDL_Window);
+		mFrameStart = std::chrono::high_resolution_clock::now();
 	}
 	void Window::Window_impl::Close()
 	{
@@ -453,6 +754,10 @@ namespace app
 	{
 		return mpWindowImpl->getInput();
 	}
+	my_gl_core::StreamBuffer & Window::getStreamBuffer() const
+	{
+		return mpWindowImpl->getStreamBuffer();
+	}
 	int Window::getWindowWidth() const
 	{
 		return mpWindowImpl->getWindowWidth();
@@ -461,6 +766,38 @@ namespace app
 	{
 		return mpWindowImpl->getWindowHeight();
 	}
+	void Window::setDynamicResolution(const ResolutionSettings & settings)
+	{
+		mpWindowImpl->getDynamicResolution().setSettings(settings);
+	}
+	const ResolutionSettings & Window::getDynamicResolution() const
+	{
+		return mpWindowImpl->getDynamicResolution().getSettings();
+	}
+	void Window::BeginScene()
+	{
+		mpWindowImpl->getDynamicResolution().BeginScene();
+	}
+	void Window::EndScene()
+	{
+		mpWindowImpl->getDynamicResolution().EndScene();
+	}
+	int Window::getSceneWidth() const
+	{
+		return mpWindowImpl->getDynamicResolution().getStats().mWidth;
+	}
+	int Window::getSceneHeight() const
+	{
+		return mpWindowImpl->getDynamicResolution().getStats().mHeight;
+	}
+	float Window::getResolutionScale() const
+	{
+		return mpWindowImpl->getDynamicResolution().getStats().mScale;
+	}
+	const ResolutionStats & Window::getResolutionStats() const
+	{
+		return mpWindowImpl->getDynamicResolution().getStats();
+	}
 	bool Window::isOpened() const
 	{
 		return mpWindowImpl->isOpened();
@@ -477,11 +814,45 @@ namespace app
 		SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, depth_size);
 		SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, stencil_size);
 
-		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+		if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) < 0)
 			throw std::runtime_error{ "SDL could not initialize SDL!" };
 	}
 	void Shutdown()
 	{
 		SDL_Quit();
 	}
+	void RunHeadless(int w, int h, const std::function<void()> & function)
+	{
+		SDL_Window * window = SDL_CreateWindow("Headless",
+			SDL_WINDOWPOS_UNDEFINED,
+			SDL_WINDOWPOS_UNDEFINED,
+			w,
+			h,
+			SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+		if (!window)
+			throw std::runtime_error{ "SDL couldn't create the headless window!" };
+
+		SDL_GLContext context = SDL_GL_CreateContext(window);
+		if (!context)
+		{
+			SDL_DestroyWindow(window);
+			throw std::runtime_error{ "OpenGL context couldn't be created!" };
+		}
+
+		try
+		{
+			if (!gl::sys::LoadFunctions())
+				throw std::runtime_error{ "OpenGL functions couldn't be loaded." };
+			my_gl_core::probe_caps();
+			function();
+		}
+		catch (...)
+		{
+			SDL_GL_DeleteContext(context);
+			SDL_DestroyWindow(window);
+			throw;
+		}
+		SDL_GL_DeleteContext(context);
+		SDL_DestroyWindow(window);
+	}
 }
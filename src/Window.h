@@ -5,14 +5,24 @@
 #pragma once
 
 #include <memory>		// std::unique_ptr
+#include <functional>	// std::function
 
 // TODO(Borja): Window resize
 // TODO(Borja): Fullscreen
 
+// Needed by Window::getStreamBuffer
+namespace my_gl_core
+{
+	class StreamBuffer;
+}
+
 namespace app
 {
 	// Needed by Window::getInput
 	class Input;
+	// Needed by Window::setDynamicResolution and Window::getResolutionStats, defined in DynamicResolution.h
+	struct ResolutionSettings;
+	struct ResolutionStats;
 	
 	/// \brief	Wraps a window api and all the functionality of a window.
 	/// IMPORTANT(Borja): Only supports the creation of one window.
@@ -39,10 +49,28 @@ namespace app
 		float getDt() const;
 		/// \brief	Returns the object that handles the input for this window.
 		Input & getInput() const;
+		/// \brief	Returns the buffer all the renderers share to stream their per-frame data,
+		/// it is fenced every time Window::SwapBuffers is called.
+		my_gl_core::StreamBuffer & getStreamBuffer() const;
 
 		int getWindowWidth() const;
 		int getWindowHeight() const;
 
+		/// \brief	Draws the scene to an offscreen target at a fraction of the window resolution,
+		/// the fraction is adjusted every frame to keep the frame time within the budget.
+		void setDynamicResolution(const ResolutionSettings & settings);
+		const ResolutionSettings & getDynamicResolution() const;
+		/// \brief	The scene goes between BeginScene and EndScene, in window coordinates (the viewport is
+		/// the one scaled), and the UI after EndScene at the native resolution.
+		/// IMPORTANT(Borja): The target is cleared in BeginScene, and EndScene leaves the default framebuffer bound.
+		void BeginScene();
+		void EndScene();
+		/// \brief	Size the scene is drawn at, the size of the window when the dynamic resolution is disabled.
+		int getSceneWidth() const;
+		int getSceneHeight() const;
+		float getResolutionScale() const;
+		const ResolutionStats & getResolutionStats() const;
+
 		/// \return False if Window::Close has been called.
 		bool isOpened() const;
 
@@ -57,4 +85,7 @@ namespace app
 					int depth_size = 24, int stencil_size = 1);
 	/// \brief	This function needs to be called after destroying the window.
 	void Shutdown();
+	/// \brief	Calls the function with the GL context of a hidden window of that size, i.e. to replay a GL trace.
+	/// IMPORTANT(Borja): Same as a Window it needs app::Initialize, and they can't exist at the same time.
+	void RunHeadless(int w, int h, const std::function<void()> & function);
 }
@@ -1,27 +1,170 @@
 
 #include "Window.h"
+#include "DynamicResolution.h"	// app::ResolutionSettings
 #include "Input.h"
+#include "InputActions.h"
+#include "Gamepads.h"
 
 #include "my_gl_core.h"
+#include "my_gl_resources.h"	// my_gl_core::set_resource_budget
+#include "my_gl_trace.h"		// my_gl_core::request_trace, my_gl_core::replay_trace
 #include "IMGUISystem.h"
+#include "Renderer2D.h"
+#include "RenderQueue.h"
+#include "GlyphCache.h"
+#include "GpuPlot.h"
+#include "VirtualTable.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "Application.h"
+#include "AssetPack.h"
+#include "ShaderLibrary.h"
+#include "Log.h"
+#include "VectorMath.h"	// app::Mat4, app::Vec2, app::TransformPoints...
 #include "GUI.h"
 
-#include <iostream>	// std::cout
+#include <cstring>	// std::strcmp
+#include <cstdlib>	// std::atoi, std::atof
+#include <cmath>	// std::sin, std::cos, std::sqrt
+#include <vector>	// std::vector
+#include <random>	// std::mt19937, std::normal_distribution, std::uniform_real_distribution
+#include <cstdio>	// std::snprintf
+#include <chrono>	// std::chrono::high_resolution_clock
+#include <memory>	// std::make_shared, std::unique_ptr
+#include <utility>	// std::swap
+#include <string>	// std::string, std::getline
+#include <fstream>	// std::ifstream
+#include <sstream>	// std::istringstream
+#include <iterator>	// std::istreambuf_iterator
+#include <algorithm>	// std::min
 
-void update(app::Window & window)
+/// \brief	Number of quads drawn every frame with app::Renderer2D (-quads <N>).
+unsigned g_bench_quads = 0;
+/// \brief	TrueType font drawn with app::GlyphCache (-font <file.ttf>).
+const char * g_font_file = nullptr;
+/// \brief	Samples of the series plotted with app::GpuPlot (-plot <N>).
+unsigned g_plot_samples = 0;
+/// \brief	Rows of the table shown with app::VirtualTable (-table <N>).
+unsigned g_table_rows = 0;
+/// \brief	Steps and frames per second of the app::Application loop (-sim_hz <N>, -render_hz <N>).
+app::Application::Settings g_loop_settings;
+/// \brief	Worker threads of the app::JobSystem, -1 uses one less than the cores (-jobs <N>).
+int g_job_workers = -1;
+/// \brief	Elements processed by the app::JobSystem scaling benchmark (-job_bench <N>).
+unsigned g_job_bench = 0;
+/// \brief	Points and boxes transformed by the scalar vs SIMD math benchmark (-math_bench <N>).
+unsigned g_math_bench = 0;
+/// \brief	Frames of the gamepad input benchmark (-input_bench <N>).
+unsigned g_input_bench = 0;
+/// \brief	Pack the assets are read from (-pack <file.pack>).
+const char * g_asset_pack = nullptr;
+/// \brief	Pack written before opening the window and the list of its assets (-build_pack <file.pack> <list.txt>).
+const char * g_build_pack = nullptr;
+const char * g_build_pack_list = nullptr;
+/// \brief	File the log is written to instead of the console (-log <file>).
+const char * g_log_file = nullptr;
+/// \brief	Shaders of the fullscreen pass drawn behind everything, reloaded when they change (-shader <file.vert> <file.frag>).
+const char * g_shader_vertex = nullptr;
+const char * g_shader_fragment = nullptr;
+/// \brief	Draws the scene at the resolution that fits in a frame budget (-dynamic_res <ms>).
+app::ResolutionSettings g_resolution_settings;
+/// \brief	GL trace replayed instead of opening the window, finishing every call when it is the sync one
+/// (-gl_replay <file.trace>, -gl_replay_sync <file.trace>).
+const char * g_gl_replay = nullptr;
+bool g_gl_replay_sync = false;
+
+/// \brief	Position of the quads drawn by render_quads, computed by the jobs of update.
+struct QuadTransform
+{
+	float x, y, t;
+};
+/// \brief	Quads of the last two steps, interpolated by render_quads.
+std::vector<QuadTransform> g_quads;
+std::vector<QuadTransform> g_prev_quads;
+
+/// \brief	Actions of the demo, bound by bind_actions.
+struct DemoActions
+{
+	app::ActionMap::ActionId mMagenta;
+	app::ActionMap::ActionId mYellow;
+	app::ActionMap::ActionId mCyan;
+	app::ActionMap::ActionId mReloadShaders;
+};
+DemoActions g_actions;
+
+/// \brief	The keys typed in an ImGui text box (i.e. a binding in show_actions) don't fire actions.
+/// WantCaptureKeyboard is the one of the last ImGui frame, the same the keys were typed in.
+bool actions_enabled()
+{
+	return !ImGui::GetIO().WantCaptureKeyboard;
+}
+
+void bind_actions(app::ActionMap & actions, app::ShaderLibrary & shaders)
+{
+	const struct { app::ActionMap::ActionId * mpAction; const char * mName; const char * mBinding; } defaults[] =
+	{
+		{ &g_actions.mMagenta, "Magenta", "A" },
+		{ &g_actions.mYellow, "Yellow", "S" },
+		{ &g_actions.mCyan, "Cyan", "D" },
+		{ &g_actions.mReloadShaders, "Reload shaders", "Ctrl+R" },
+	};
+	for (const auto & action : defaults)
+	{
+		*action.mpAction = actions.AddAction(action.mName);
+		app::ActionMap::Binding binding;
+		if (app::ActionMap::ParseBinding(action.mBinding, binding))
+			actions.Bind(*action.mpAction, binding);
+	}
+
+	actions.AddListener(g_actions.mReloadShaders, [&shaders](app::ActionMap::ActionId, app::ActionMap::Phase phase)
+	{
+		if (phase == app::ActionMap::Phase::Triggered && actions_enabled())
+			shaders.ReloadAll();
+	});
+}
+
+/// \brief	Called once per app::Window::Update, there can be any number of steps in between.
+void handle_input(const app::Window & window)
 {
 	const app::Input & input = window.getInput();
+	const app::ActionMap & actions = input.getActions();
 
-	if (input.KeyPressed('A'))		gl::ClearColor(1.f, 0.2f, 1.f, 1.f);
-	if (input.KeyTriggered('S'))	gl::ClearColor(1.f, 1.2f, 0.f, 1.f);
-	if (input.KeyTriggered('D'))	gl::ClearColor(0.f, 1.2f, 1.f, 1.f);
+	if (actions_enabled())
+	{
+		if (actions.ActionPressed(g_actions.mMagenta))		gl::ClearColor(1.f, 0.2f, 1.f, 1.f);
+		if (actions.ActionTriggered(g_actions.mYellow))	gl::ClearColor(1.f, 1.2f, 0.f, 1.f);
+		if (actions.ActionTriggered(g_actions.mCyan))		gl::ClearColor(0.f, 1.2f, 1.f, 1.f);
+	}
 
 	if (input.MouseTriggered(app::Input::MOUSE_L))
-		std::cout << ',' << '\n';
+		APP_LOG_DEBUG(app::log::Category::Input, "Left button triggered");
 	if (input.MousePressed(app::Input::MOUSE_R))
-		std::cout << 'e' << '\n';
+		APP_LOG_DEBUG(app::log::Category::Input, "Right button pressed");
 	if (input.MouseTriggered(app::Input::MOUSE_WHEEL))
-		std::cout << 'w' << '\n';
+		APP_LOG_DEBUG(app::log::Category::Input, "Wheel triggered");
+}
+
+/// \brief	Step of the simulation, the time is the one at the end of the step.
+void update(const app::Window & window, app::JobSystem & jobs, float time)
+{
+	// the quads are animated by the workers while the main thread keeps going, joined before rendering
+	// or before the next step
+	jobs.Wait(jobs.getFrameCounter());
+	std::swap(g_prev_quads, g_quads);
+	const float w = static_cast<float>(window.getWindowWidth());
+	const float h = static_cast<float>(window.getWindowHeight());
+	g_quads.resize(g_bench_quads);
+	jobs.ParallelFor(g_bench_quads, 0, [w, h, time](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const float fi = static_cast<float>(i);
+			QuadTransform & quad = g_quads[i];
+			quad.t = time + fi * 0.01f;
+			quad.x = w * (0.5f + 0.45f * std::sin(quad.t * 0.7f + fi));
+			quad.y = h * (0.5f + 0.45f * std::cos(quad.t * 1.3f + fi * 0.5f));
+		}
+	}, &jobs.getFrameCounter());
 }
 
 void render()
@@ -29,54 +172,873 @@ void render()
 	gl::Clear(gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT);	CheckOGLError();
 }
 
+/// \brief	Submits a fullscreen triangle with the program of g_shader_vertex and g_shader_fragment, the vertex
+/// shader has to make it from gl_VertexID. The uniforms are Time (in seconds) and Resolution (in pixels).
+void render_background(app::Window & window, app::RenderQueue & queue, const app::ShaderLibrary & shaders,
+					   app::ShaderLibrary::ProgramId id, GLuint vertex_array, float time)
+{
+	const GLuint program = shaders.getProgram(id);
+	if (program == 0)
+		return;
+
+	// the locations can change when the program is rebuilt
+	static unsigned version = 0;
+	static GLint location_time = -1, location_resolution = -1;
+	if (version != shaders.getVersion(id))
+	{
+		version = shaders.getVersion(id);
+		location_time = gl::GetUniformLocation(program, "Time");
+		location_resolution = gl::GetUniformLocation(program, "Resolution");
+	}
+
+	// behind the quads, on their lowest layer
+	queue.setLayer(0);
+	queue.setBlendMode(app::RenderQueue::BlendMode::Opaque);
+	queue.setDepthMode(app::RenderQueue::DepthMode::Off);
+	queue.setUniform(location_time, time);
+	queue.setUniform(location_resolution, app::Vec2{ static_cast<float>(window.getSceneWidth()), static_cast<float>(window.getSceneHeight()) });
+	queue.Submit(app::RenderQueue::DrawCommand{ program, vertex_array, 0, gl::TRIANGLES, 0, 0, 3, 1, 0, 0 });
+}
+
+/// \brief	Draws the g_quads rotating quads, spread over a few layers and blend modes.
+/// \param	alpha	Interpolation from g_prev_quads to g_quads.
+void render_quads(app::Window & window, app::Renderer2D & renderer, app::RenderQueue & queue, float alpha)
+{
+	const bool interpolate = g_prev_quads.size() == g_quads.size();
+	renderer.Begin(window);
+	for (unsigned i = 0; i < g_quads.size(); ++i)
+	{
+		QuadTransform quad = g_quads[i];
+		if (interpolate)
+		{
+			const QuadTransform & prev = g_prev_quads[i];
+			quad.x = prev.x + (quad.x - prev.x) * alpha;
+			quad.y = prev.y + (quad.y - prev.y) * alpha;
+			quad.t = prev.t + (quad.t - prev.t) * alpha;
+		}
+		const unsigned color = 0x80000000 | ((i * 2654435761u) & 0x00FFFFFF);
+
+		renderer.setLayer(static_cast<unsigned char>(i & 3));
+		renderer.setBlendMode((i & 1) ? app::Renderer2D::BlendMode::Additive : app::Renderer2D::BlendMode::Alpha);
+		renderer.DrawQuad(quad.x, quad.y, 8.f, 8.f, quad.t, color);
+	}
+	renderer.End(&queue);
+}
+
+void show_renderer_stats(const app::Renderer2D & renderer)
+{
+	const app::Renderer2D::Stats & stats = renderer.getStats();
+	ImGui::Begin("Renderer2D");
+	ImGui::Text("Quads: %u", stats.mQuads);
+	ImGui::Text("Draw calls: %u", stats.mDrawCalls);
+	ImGui::Text("CPU: %.3f ms", stats.mCpuMs);
+	ImGui::Text("GPU: %.3f ms", stats.mGpuMs);
+	if (stats.mCpuMs > 0.0)
+		ImGui::Text("Quads/ms (CPU): %.0f", stats.mQuads / stats.mCpuMs);
+	ImGui::End();
+}
+
+void show_render_queue_stats(const app::RenderQueue & queue)
+{
+	const app::RenderQueue::Stats & stats = queue.getStats();
+	ImGui::Begin("RenderQueue");
+	ImGui::Text("Commands: %u (%u uniforms)", stats.mCommands, stats.mUniforms);
+	ImGui::Text("State changes: %u (%u in submission order)", stats.mStateChanges, stats.mSubmissionStateChanges);
+	ImGui::Text("Program changes: %u, texture changes: %u", stats.mProgramChanges, stats.mTextureChanges);
+	ImGui::Text("Sort: %.3f ms, execute: %.3f ms", stats.mSortMs, stats.mExecuteMs);
+	ImGui::End();
+}
+
+/// \brief	Lists the actions and rebinds their first binding with the text typed (i.e. "Ctrl+Shift+S").
+void show_actions(app::ActionMap & actions)
+{
+	const app::ActionMap::Stats & stats = actions.getStats();
+	ImGui::Begin("Input actions");
+	ImGui::Text("Actions: %u, bindings: %u", stats.mActions, stats.mBindings);
+	ImGui::Text("Last update: %u changed, %u listeners called", stats.mChanged, stats.mDispatched);
+	for (app::ActionMap::ActionId action = 0; action < actions.getActionNum(); ++action)
+	{
+		const std::vector<app::ActionMap::Binding> & bindings = actions.getBindings(action);
+		char text[64];
+		std::snprintf(text, sizeof(text), "%s", bindings.empty() ? "" : app::ActionMap::getBindingName(bindings[0]).c_str());
+
+		ImGui::PushID(static_cast<int>(action));
+		if (ImGui::InputText(actions.getActionName(action).c_str(), text, sizeof(text), ImGuiInputTextFlags_EnterReturnsTrue))
+		{
+			app::ActionMap::Binding binding;
+			if (app::ActionMap::ParseBinding(text, binding))
+				actions.Rebind(action, 0, binding);
+			else
+				APP_LOG_WARNING(app::log::Category::Input, "Unknown binding: {}", text);
+		}
+		if (actions.ActionPressed(action))
+		{
+			ImGui::SameLine();
+			ImGui::Text("pressed");
+		}
+		ImGui::PopID();
+	}
+	ImGui::End();
+}
+
+/// \brief	Shows the connected gamepads and how many samples of their left stick came since the last frame.
+void show_gamepads(const app::Gamepads & gamepads)
+{
+	using app::Gamepads;
+	static const char * s_button_names[Gamepads::BUTTON_COUNT] =
+	{
+		"A", "B", "X", "Y", "Back", "Guide", "Start", "LS", "RS", "LB", "RB", "Up", "Down", "Left", "Right"
+	};
+	// where every gamepad was read up to, a simulation step would keep one the same way
+	static unsigned long long s_cursors[Gamepads::MAX_GAMEPADS] = {};
+
+	const Gamepads::Stats & stats = gamepads.getStats();
+	ImGui::Begin("Gamepads");
+	ImGui::Text("Connected: %u, last frame: %u events, %u gamepads updated", stats.mConnected, stats.mEvents, stats.mUpdated);
+	for (unsigned pad = 0; pad < Gamepads::MAX_GAMEPADS; ++pad)
+	{
+		if (!gamepads.isConnected(pad))
+			continue;
+
+		ImGui::Separator();
+		ImGui::Text("%u: %s", pad, gamepads.getName(pad).c_str());
+		ImGui::Text("Left (%.2f, %.2f), right (%.2f, %.2f), triggers %.2f %.2f",
+					gamepads.getAxis(pad, Gamepads::AXIS_LEFT_X), gamepads.getAxis(pad, Gamepads::AXIS_LEFT_Y),
+					gamepads.getAxis(pad, Gamepads::AXIS_RIGHT_X), gamepads.getAxis(pad, Gamepads::AXIS_RIGHT_Y),
+					gamepads.getAxis(pad, Gamepads::AXIS_TRIGGER_LEFT), gamepads.getAxis(pad, Gamepads::AXIS_TRIGGER_RIGHT));
+
+		std::string pressed;
+		for (unsigned button = 0; button < Gamepads::BUTTON_COUNT; ++button)
+		{
+			if (gamepads.ButtonPressed(pad, button))
+				pressed.append(s_button_names[button]).append(" ");
+		}
+		ImGui::Text("Pressed: %s", pressed.c_str());
+
+		Gamepads::AxisSample samples[Gamepads::HISTORY_SIZE];
+		const std::size_t count = gamepads.ReadAxisHistory(pad, Gamepads::AXIS_LEFT_X, s_cursors[pad], samples, Gamepads::HISTORY_SIZE);
+		ImGui::Text("Left X samples: %u in %u ms", static_cast<unsigned>(count), count > 0 ? samples[count - 1].mTimestamp - samples[0].mTimestamp : 0u);
+	}
+	ImGui::End();
+}
+
+void show_shader_stats(app::ShaderLibrary & shaders)
+{
+	const app::ShaderLibrary::Stats & stats = shaders.getStats();
+	ImGui::Begin("ShaderLibrary");
+	ImGui::Text("Programs: %u (%u building, %s)", stats.mPrograms, stats.mPending, stats.mbParallelCompile ? "parallel compile" : "a stage per frame");
+	ImGui::Text("Reloads: %llu (%llu failed builds)", stats.mReloads, stats.mFailures);
+	ImGui::Text("Last build: %.3f ms", stats.mLastBuildMs);
+	if (ImGui::Button("Reload all"))
+		shaders.ReloadAll();
+	ImGui::End();
+}
+
+void show_resolution_stats(app::Window & window)
+{
+	const app::ResolutionStats & stats = window.getResolutionStats();
+	app::ResolutionSettings settings = window.getDynamicResolution();
+	ImGui::Begin("Dynamic resolution");
+	ImGui::Text("Scale: %.2f (%dx%d, %llu changes)", stats.mScale, stats.mWidth, stats.mHeight, stats.mChanges);
+	ImGui::Text("CPU: %.3f ms, GPU: %.3f ms", stats.mCpuMs, stats.mGpuMs);
+	float target_ms = static_cast<float>(settings.mTargetMs);
+	bool changed = ImGui::Checkbox("Enabled", &settings.mbEnabled);
+	changed |= ImGui::SliderFloat("Budget (ms)", &target_ms, 2.f, 50.f);
+	changed |= ImGui::SliderFloat("Min scale", &settings.mMinScale, 0.1f, 1.f);
+	if (changed)
+	{
+		settings.mTargetMs = target_ms;
+		window.setDynamicResolution(settings);
+	}
+	ImGui::End();
+}
+
+void show_loop_stats(const app::Application & application)
+{
+	const app::Application::Stats & stats = application.getStats();
+	ImGui::Begin("Application");
+	ImGui::Text("Simulated: %.2f s, %u steps in the last frame", application.getTime(), stats.mSteps);
+	ImGui::Text("Steps: %llu (%llu dropped), frames: %llu", stats.mTotalSteps, stats.mDroppedSteps, stats.mFrames);
+	ImGui::Text("Alpha: %.2f", stats.mAlpha);
+	ImGui::Text("Simulate: %.3f ms, render: %.3f ms", stats.mSimulateMs, stats.mRenderMs);
+	ImGui::End();
+}
+
+void show_job_stats(const app::JobSystem & jobs, const app::TaskScheduler & tasks)
+{
+	const app::JobSystem::Stats & stats = jobs.getStats();
+	ImGui::Begin("JobSystem");
+	ImGui::Text("Workers: %u (+ main thread)", stats.mWorkers);
+	ImGui::Text("Jobs: %u (%u stolen, %u on the main thread)", stats.mJobs, stats.mSteals, stats.mMainThreadJobs);
+	ImGui::Text("Join: %.3f ms", stats.mJoinMs);
+	const app::TaskScheduler::Stats & task_stats = tasks.getStats();
+	ImGui::Text("Tasks: %u (%u resumed, %u finished)", task_stats.mRunning, task_stats.mResumed, task_stats.mFinished);
+	ImGui::End();
+}
+
+/// \brief	Times a parallel for of g_job_bench elements with every worker count up to the number of cores.
+void run_job_benchmark()
+{
+	std::vector<float> values(g_job_bench);
+	const auto body = [&values](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const float x = static_cast<float>(i);
+			values[i] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+		}
+	};
+
+	double single_thread_ms = 0.0;
+	for (unsigned workers = 0; workers <= app::JobSystem::getDefaultWorkerCount(); ++workers)
+	{
+		app::JobSystem jobs{ workers };
+		jobs.ParallelFor(values.size(), 0, body);	// warm up
+
+		const unsigned runs = 5;
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned run = 0; run < runs; ++run)
+			jobs.ParallelFor(values.size(), 0, body);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+
+		if (workers == 0)
+			single_thread_ms = ms;
+		APP_LOG_INFO(app::log::Category::Jobs, "Benchmark, {} threads: {} ms (x{})", workers + 1, ms, single_thread_ms / ms);
+	}
+}
+
+/// \brief	Times the scalar and SIMD implementations of the app math with g_math_bench elements.
+void run_math_benchmark()
+{
+	const std::size_t count = g_math_bench;
+	const app::Mat4 transform = app::Mat4::Translation(app::Vec3(10.0f, -5.0f, 2.0f)) *
+								app::Mat4::Rotation(app::Quat::FromAxisAngle(app::Normalize(app::Vec3(1.0f, 2.0f, 3.0f)), 0.5f)) *
+								app::Mat4::Scale(app::Vec3(2.0f, 2.0f, 2.0f));
+
+	std::mt19937 generator;
+	std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+	std::vector<float> points(count * 6);
+	for (float & value : points)
+		value = distribution(generator);
+	const app::PointsSoA points_in{ &points[0], &points[count], &points[count * 2] };
+	const app::PointsSoA points_out{ &points[count * 3], &points[count * 4], &points[count * 5] };
+
+	std::vector<float> boxes(count * 12);
+	for (std::size_t i = 0; i < count * 3; ++i)
+	{
+		boxes[i] = distribution(generator);
+		boxes[count * 3 + i] = boxes[i] + std::abs(distribution(generator)) * 0.1f;
+	}
+	const app::AabbsSoA boxes_in{ &boxes[0], &boxes[count], &boxes[count * 2], &boxes[count * 3], &boxes[count * 4], &boxes[count * 5] };
+	const app::AabbsSoA boxes_out{ &boxes[count * 6], &boxes[count * 7], &boxes[count * 8], &boxes[count * 9], &boxes[count * 10], &boxes[count * 11] };
+
+	std::vector<app::Mat4> matrices(count, transform);
+	app::Mat4 product;
+
+	// best of a few runs, after a warm up one
+	const auto measure = [](const auto & body)
+	{
+		body();
+		double best_ms = 0.0;
+		for (unsigned run = 0; run < 5; ++run)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			body();
+			const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			best_ms = run == 0 || ms < best_ms ? ms : best_ms;
+		}
+		return best_ms;
+	};
+	const auto report = [count](const char * name, double scalar_ms, double simd_ms)
+	{
+		APP_LOG_INFO(app::log::Category::App, "Math benchmark, {} x{}: scalar {} ms, {} {} ms (x{})",
+					 name, count, scalar_ms, app::getMathPath(), simd_ms, scalar_ms / simd_ms);
+	};
+
+	report("Mat4 multiply",
+		   measure([&] { for (const app::Mat4 & m : matrices) product = app::scalar::Multiply(product, m); }),
+		   measure([&] { for (const app::Mat4 & m : matrices) product = product * m; }));
+	report("TransformPoints",
+		   measure([&] { app::scalar::TransformPoints(transform, points_in, points_out, count); }),
+		   measure([&] { app::TransformPoints(transform, points_in, points_out, count); }));
+	report("TransformAabbs",
+		   measure([&] { app::scalar::TransformAabbs(transform, boxes_in, boxes_out, count); }),
+		   measure([&] { app::TransformAabbs(transform, boxes_in, boxes_out, count); }));
+	// uses the results, so that the loops aren't optimized away
+	APP_LOG_DEBUG(app::log::Category::App, "Math benchmark checksum: {}", product.mColumns[3].x + points[count * 3] + boxes[count * 6]);
+}
+
+/// \brief	Times the gamepad update of g_input_bench frames with no gamepads, with all of them connected
+/// but idle, and with all of them moving a stick and pressing a button every frame.
+void run_input_benchmark()
+{
+	const unsigned pads = app::Gamepads::MAX_GAMEPADS;
+	app::Gamepads gamepads;
+
+	// best of a few runs, in microseconds per frame
+	const auto measure = [&gamepads](unsigned active)
+	{
+		double best_ms = 0.0;
+		for (unsigned run = 0; run < 5; ++run)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned frame = 0; frame < g_input_bench; ++frame)
+			{
+				for (unsigned pad = 0; pad < active; ++pad)
+				{
+					const int value = static_cast<int>((frame * 997u + pad * 131u) % 65536u) - 32768;
+					gamepads.ProcessAxis(static_cast<int>(pad), app::Gamepads::AXIS_LEFT_X, value, frame);
+					gamepads.ProcessButton(static_cast<int>(pad), app::Gamepads::BUTTON_A, frame % 2 == 0);
+				}
+				gamepads.Update();
+			}
+			const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			best_ms = run == 0 || ms < best_ms ? ms : best_ms;
+		}
+		return best_ms * 1000.0 / g_input_bench;
+	};
+
+	const double none_us = measure(0);
+	for (unsigned pad = 0; pad < pads; ++pad)
+		gamepads.Connect(static_cast<int>(pad), "Benchmark");
+	const double idle_us = measure(0);
+	const double active_us = measure(pads);
+	APP_LOG_INFO(app::log::Category::Input, "Input benchmark, {} frames: no gamepads {} us/frame, {} idle {} us/frame, {} active {} us/frame",
+				 g_input_bench, none_us, pads, idle_us, pads, active_us);
+}
+
+/// \brief	Writes g_build_pack with the assets of g_build_pack_list, a line per asset:
+/// <name> <file> [lz4] [<width> <height>], where the size is the one of a raw RGBA8 image.
+/// Then compares reading all the files against reading all the assets of the pack.
+void build_asset_pack()
+{
+	std::ifstream list{ g_build_pack_list };
+	if (!list)
+	{
+		APP_LOG_ERROR(app::log::Category::Assets, "Couldn't open the asset list {}", g_build_pack_list);
+		return;
+	}
+
+	app::AssetPackBuilder builder;
+	std::vector<std::string> files;
+	std::string line;
+	while (std::getline(list, line))
+	{
+		std::istringstream tokens{ line };
+		std::string name, file, option;
+		if (!(tokens >> name >> file))
+			continue;
+
+		app::AssetPack::Compression compression = app::AssetPack::Compression::None;
+		unsigned size[2] = { 0, 0 };
+		unsigned size_count = 0;
+		while (tokens >> option)
+		{
+			if (option == "lz4")		compression = app::AssetPack::Compression::LZ4;
+			else if (size_count < 2)	size[size_count++] = static_cast<unsigned>(std::atoi(option.c_str()));
+		}
+		builder.AddFile(name.c_str(), file.c_str(), compression, size[0], size[1]);
+		files.push_back(file);
+	}
+	const std::size_t pack_size = builder.Write(g_build_pack);
+
+	// IMPORTANT(Borja): Everything is in the file cache of the OS right after building the pack,
+	// the times of a cold start are only representative after a reboot.
+	std::size_t loose_bytes = 0;
+	unsigned loose_checksum = 0;
+	const auto loose_start = std::chrono::high_resolution_clock::now();
+	for (const std::string & file : files)
+	{
+		std::ifstream stream{ file, std::ios::binary };
+		const std::vector<char> data{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+		for (const char byte : data)
+			loose_checksum += static_cast<unsigned char>(byte);
+		loose_bytes += data.size();
+	}
+	const double loose_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loose_start).count();
+
+	unsigned pack_checksum = 0;
+	const auto pack_start = std::chrono::high_resolution_clock::now();
+	app::AssetPack pack{ g_build_pack };
+	for (const app::AssetPack::Asset & asset : pack.getAssets())
+	{
+		const app::AssetPack::Span data = pack.getData(asset);
+		const unsigned char * bytes = static_cast<const unsigned char *>(data.mpData);
+		for (std::size_t i = 0; i < data.mSize; ++i)
+			pack_checksum += bytes[i];
+	}
+	const double pack_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pack_start).count();
+
+	using app::log::Category;
+	APP_LOG_INFO(Category::Assets, "{} assets, {} bytes in {} bytes of pack", files.size(), loose_bytes, pack_size);
+	APP_LOG_INFO(Category::Assets, "Loose files: {} ms", loose_ms);
+	APP_LOG_INFO(Category::Assets, "Asset pack: {} ms (open {} ms, decompress {} ms)", pack_ms,
+				 pack.getStats().mOpenMs, pack.getStats().mDecompressMs);
+	if (loose_checksum != pack_checksum)
+		APP_LOG_ERROR(Category::Assets, "The assets of the pack don't match the files!");
+}
+
+/// \brief	Font of g_font_file, read straight from the pack when it has an asset with that name.
+app::GlyphCache::FontId load_font(app::GlyphCache & glyphs, app::AssetPack * pack)
+{
+	const app::AssetPack::Asset * asset = pack ? pack->Find(g_font_file) : nullptr;
+	if (asset == nullptr)
+		return glyphs.AddFontFromFile(g_font_file);
+
+	const app::AssetPack::Span data = pack->getData(*asset);
+	return glyphs.AddFontFromMemory(data.mpData, data.mSize, false);
+}
+
+/// \brief	Lists the assets of the pack and shows its images.
+void show_asset_pack(const app::AssetPack & pack, const std::vector<GLuint> & textures)
+{
+	const app::AssetPack::Stats & stats = pack.getStats();
+	ImGui::Begin("AssetPack");
+	ImGui::Text("Mapped: %u bytes, opened in %.3f ms", static_cast<unsigned>(stats.mMappedBytes), stats.mOpenMs);
+	ImGui::Text("Decompressed: %u bytes in %.3f ms", static_cast<unsigned>(stats.mDecompressedBytes), stats.mDecompressMs);
+	for (const app::AssetPack::Asset & asset : pack.getAssets())
+	{
+		ImGui::Text("%s: %u bytes (%u stored%s)", asset.mName, static_cast<unsigned>(asset.mSize),
+					static_cast<unsigned>(asset.mStoredSize), asset.mCompression == app::AssetPack::Compression::LZ4 ? ", LZ4" : "");
+	}
+	for (const GLuint texture : textures)
+		ImGui::Image((void *)(intptr_t)texture, ImVec2(128.f, 128.f));
+	ImGui::End();
+}
+
+/// \brief	Draws the same text at several sizes from a single bake, in its own pass and inside ImGui.
+void show_sdf_text(app::GlyphCache & glyphs, app::GlyphCache::FontId font, float time)
+{
+	const float size = 24.f + 72.f * (0.5f + 0.5f * std::sin(time));
+	glyphs.AddText(font, 20.f, 20.f, size, 0xFFFFFFFF, "Signed distance field text");
+
+	ImGui::Begin("GlyphCache");
+	const ImVec2 pos = ImGui::GetCursorScreenPos();
+	glyphs.AddImGuiText(ImGui::GetWindowDrawList(), font, pos.x, pos.y, 32.f, 0xFF00FFFF, "SDF text in ImGui");
+	ImGui::Dummy(ImVec2(glyphs.getTextWidth(font, 32.f, "SDF text in ImGui"), glyphs.getLineHeight(font, 32.f)));
+
+	const app::GlyphCache::Stats & stats = glyphs.getStats();
+	ImGui::Text("Glyphs rasterized: %u (last frame %u, %.3f ms)", stats.mRasterized, stats.mLastRasterized, stats.mRasterizeMs);
+	ImGui::Text("Glyphs cached: %u in %u pages (%u evictions)", stats.mGlyphs, stats.mPages, stats.mEvictions);
+	ImGui::Text("Quads: %u", stats.mQuads);
+	ImGui::End();
+}
+
+/// \brief	Continues the random walk plotted by show_plot.
+void generate_random_walk(std::vector<float> & samples)
+{
+	static std::mt19937 generator;
+	static std::normal_distribution<float> step;
+	static float value = 0.f;
+
+	for (float & sample : samples)
+		sample = value += step(generator);
+}
+
+/// \brief	Generates the g_plot_samples samples of the random walk on a worker without stalling the frames,
+/// then appends 64 samples every frame to test the appends.
+app::TaskScheduler::TaskFunction load_plot(app::JobSystem & jobs, app::GpuPlot & plot, app::GpuPlot::SeriesId series)
+{
+	const auto counter = std::make_shared<app::JobCounter>();
+	const auto samples = std::make_shared<std::vector<float>>(g_plot_samples);
+	return [&jobs, &plot, series, counter, samples](app::TaskState & task)
+	{
+		TASK_BEGIN(task);
+		jobs.Run([samples]() { generate_random_walk(*samples); }, counter.get());
+		if (jobs.getWorkerCount() == 0)
+			jobs.Wait(*counter);	// without workers only a wait runs it
+		TASK_AWAIT(task, app::Await::Jobs(*counter));
+
+		plot.Append(series, samples->data(), samples->size());
+		TASK_AWAIT(task, app::Await::Gpu());
+		APP_LOG_INFO(app::log::Category::App, "Plot of {} samples loaded in {} s ({} frames)",
+					 samples->size(), task.mElapsed, task.mFrame);
+
+		samples->resize(64);
+		while (g_plot_samples)
+		{
+			generate_random_walk(*samples);
+			plot.Append(series, samples->data(), samples->size());
+			TASK_AWAIT(task, app::Await::NextFrame());
+		}
+		TASK_END(task);
+	};
+}
+
+void show_plot(app::GpuPlot & plot, app::GpuPlot::SeriesId series, app::GpuPlot::View & view)
+{
+	ImGui::Begin("GpuPlot");
+	plot.Plot("Random walk", series, view, ImGui::GetContentRegionAvailWidth(), 300.f, 0xFF40C0FF);
+
+	const app::GpuPlot::Stats & stats = plot.getStats();
+	ImGui::Text("Samples: %u, visible: %.0f", static_cast<unsigned>(plot.getSize(series)), view.mLength);
+	ImGui::Text("Level: %u, vertices: %u", stats.mLastLevel, stats.mVertices);
+	ImGui::Text("Uploaded: %u bytes, pyramid: %.3f ms", static_cast<unsigned>(stats.mUploadedBytes), stats.mPyramidMs);
+	ImGui::End();
+}
+
+/// \brief	Rows generated on the fly: index, a pseudo-random value and its hex representation.
+class TestTableSource : public app::TableDataSource
+{
+public:
+	explicit TestTableSource(std::size_t rows) : mRows(rows) {}
+
+	std::size_t getRowCount() const override { return mRows; }
+	unsigned getColumnCount() const override { return 3; }
+	const char * getColumnName(unsigned column) const override
+	{
+		static const char * names[] = { "Row", "Value", "Hex" };
+		return names[column];
+	}
+	void getCellText(std::size_t row, unsigned column, char * buffer, std::size_t buffer_size) const override
+	{
+		if (column == 0)		std::snprintf(buffer, buffer_size, "%u", static_cast<unsigned>(row));
+		else if (column == 1)	std::snprintf(buffer, buffer_size, "%u", getValue(row));
+		else					std::snprintf(buffer, buffer_size, "0x%08X", getValue(row));
+	}
+	bool Less(unsigned column, std::size_t row_a, std::size_t row_b) const override
+	{
+		return column == 0 ? row_a < row_b : getValue(row_a) < getValue(row_b);
+	}
+
+private:
+	static unsigned getValue(std::size_t row) { return static_cast<unsigned>(row * 2654435761u) ^ 0x5bd1e995u; }
+
+	std::size_t mRows;
+};
+
+void show_table(app::VirtualTable & table)
+{
+	ImGui::Begin("VirtualTable");
+	table.Draw("##table", 0.f, 400.f);
+
+	const app::VirtualTable::Stats & stats = table.getStats();
+	ImGui::Text("Visible rows: %u", stats.mVisibleRows);
+	if (stats.mbSorting)	ImGui::Text("Sorting: %.0f%%", stats.mSortProgress * 100.f);
+	else					ImGui::Text("Last sort: %.1f ms", stats.mLastSortMs);
+	ImGui::End();
+}
+
 void key_triggered(unsigned char k)
 {
-	std::cout << k << '\n';
+	APP_LOG_DEBUG(app::log::Category::Input, "Key triggered: {}", static_cast<char>(k));
 }
 
 void run(const char * name, int w, int h, const unsigned char close_key)
 {
 	app::Window window{ name, w, h };
+	// IMPORTANT(Borja): Before the JobSystem, which finishes the jobs the tasks wait for when destroyed.
+	app::TaskScheduler tasks;
+	app::JobSystem jobs{ g_job_workers >= 0 ? static_cast<unsigned>(g_job_workers) : app::JobSystem::getDefaultWorkerCount() };
+	// IMPORTANT(Borja): Before the objects that use the data of its assets.
+	std::unique_ptr<app::AssetPack> pack = g_asset_pack ? std::make_unique<app::AssetPack>(g_asset_pack) : nullptr;
 	app::ImGuiSystem imgui_sys;
+	app::Renderer2D renderer;
+	app::RenderQueue queue;
+	app::GlyphCache glyphs;
+	const app::GlyphCache::FontId font = g_font_file ? load_font(glyphs, pack.get()) : 0;
+	std::vector<GLuint> pack_textures;
+	if (pack)
+	{
+		APP_LOG_INFO(app::log::Category::Assets, "Asset pack {} opened in {} ms", g_asset_pack, pack->getStats().mOpenMs);
+		for (const app::AssetPack::Asset & asset : pack->getAssets())
+		{
+			if (asset.mWidth > 0)
+				pack_textures.push_back(pack->CreateTexture(asset, "AssetPack images"));
+		}
+	}
+	app::ShaderLibrary shaders;
+	const app::ShaderLibrary::ProgramId background = g_shader_fragment ? shaders.Load(g_shader_vertex, g_shader_fragment) : 0;
+	// the fullscreen triangle doesn't have attributes, but the core profile needs a vertex array bound
+	GLuint background_vao = g_shader_fragment ? my_gl_core::create_vertex_array("Background") : 0;
+	app::GpuPlot plot;
+	const app::GpuPlot::SeriesId series = plot.AddSeries();
+	app::GpuPlot::View view;
+	TestTableSource table_source{ g_table_rows };
+	app::VirtualTable table{ table_source };
 
 	window.getInput().setKeyTriggeredCallBack(key_triggered);
+	bind_actions(window.getInput().getActions(), shaders);
+	window.setDynamicResolution(g_resolution_settings);
+	if (g_plot_samples)
+		tasks.Start(load_plot(jobs, plot, series));
 
-	while (window.isOpened())
+	app::Application application{ g_loop_settings };
+	application.setFrameFunction([&]()
 	{
 		window.Update();
+		handle_input(window);
+		if (window.getInput().KeyTriggered(close_key))
+			window.Close();
+		return window.isOpened();
+	});
+	application.setSimulateFunction([&](double dt)
+	{
+		update(window, jobs, static_cast<float>(application.getTime() + dt));
+	});
+	application.setRenderFunction([&](float alpha)
+	{
+		const float time = static_cast<float>(application.getTime());
+		jobs.JoinFrame();
+
 		imgui_sys.Update(window);
+		glyphs.NewFrame(window);
+		plot.NewFrame(window);
+		tasks.Update();
+		shaders.Update();
 
 		ImGui::ShowTestWindow();
+		imgui_sys.ShowStatsWindow();
+		imgui_sys.ShowGpuResourcesWindow();
+		show_loop_stats(application);
+		show_job_stats(jobs, tasks);
+		if (g_bench_quads)
+			show_renderer_stats(renderer);
+		if (g_bench_quads || g_shader_fragment)
+			show_render_queue_stats(queue);
+		if (g_font_file)
+			show_sdf_text(glyphs, font, time);
+		if (g_plot_samples)
+			show_plot(plot, series, view);
+		if (g_table_rows)
+			show_table(table);
+		if (pack)
+			show_asset_pack(*pack, pack_textures);
+		if (g_shader_fragment)
+			show_shader_stats(shaders);
+		show_resolution_stats(window);
+		show_actions(window.getInput().getActions());
+		show_gamepads(window.getInput().getGamepads());
 
-		update(window);
 		render();
+		window.BeginScene();
+		if (g_shader_fragment)
+			render_background(window, queue, shaders, background, background_vao, time);
+		if (g_bench_quads)
+			render_quads(window, renderer, queue, alpha);
+		queue.Execute();
+		window.EndScene();
+		glyphs.Render();
 		imgui_sys.Render();
 
 		window.SwapBuffers();
+		jobs.NewFrame();
+	});
+	application.Run();
 
-		if (window.getInput().KeyTriggered(close_key))
-			window.Close();
+	for (GLuint & texture : pack_textures)
+		my_gl_core::delete_texture(texture);
+	my_gl_core::delete_vertex_array(background_vao);
+}
+
+/// \brief	Replays g_gl_replay in a hidden window of the size it was traced at, and reports the time of
+/// its frames and of the most expensive functions. The time of every call goes to <file.trace>.csv.
+void replay_gl_trace()
+{
+	using app::log::Category;
+
+	my_gl_core::TraceInfo info;
+	if (!my_gl_core::read_trace_info(g_gl_replay, info))
+	{
+		APP_LOG_ERROR(Category::GL, "{} isn't a GL trace", g_gl_replay);
+		return;
 	}
+
+	const std::string csv_file = std::string{ g_gl_replay } + ".csv";
+	my_gl_core::ReplaySettings settings;
+	settings.mbFinishEveryCall = g_gl_replay_sync;
+	settings.mCsvFile = csv_file.c_str();
+	my_gl_core::ReplayStats stats;
+	bool replayed = false;
+	app::RunHeadless(info.mWidth, info.mHeight, [&]
+	{
+		replayed = my_gl_core::replay_trace(g_gl_replay, settings, stats);
+	});
+	if (!replayed)
+		return;
+
+	APP_LOG_INFO(Category::GL, "Replayed {}: {} frames, {} calls, {} ms{}", g_gl_replay, stats.mFrames, stats.mCalls,
+				 stats.mTotalMs, g_gl_replay_sync ? " (finishing every call)" : "");
+	if (stats.mSkipped > 0)
+		APP_LOG_WARNING(Category::GL, "{} calls skipped, the tracer doesn't record the memory they read", stats.mSkipped);
+	if (stats.mDivergences > 0)
+		APP_LOG_WARNING(Category::GL, "{} objects got a different name than when traced, the replay may be wrong", stats.mDivergences);
+	for (std::size_t i = 0; i < stats.mvFrameMs.size(); ++i)
+		APP_LOG_INFO(Category::GL, "  Frame {}: {} ms", i, stats.mvFrameMs[i]);
+	const std::size_t top = std::min<std::size_t>(stats.mvFunctions.size(), 10);
+	for (std::size_t i = 0; i < top; ++i)
+	{
+		const my_gl_core::ReplayFunctionStats & function = stats.mvFunctions[i];
+		APP_LOG_INFO(Category::GL, "  gl{}: {} calls, {} ms (max {} ms)", function.mName, function.mCalls, function.mTotalMs, function.mMaxMs);
+	}
+	APP_LOG_INFO(Category::GL, "Time of every call written to {}", csv_file);
 }
 
-int main()
+/// \brief	Reads the options used to benchmark the different code paths.
+/// -gl_tier <4.2|4.4|4.5>: Limits the optional OpenGL functionality the renderers use.
+/// -quads <N>: Draws N quads every frame with app::Renderer2D and shows its stats.
+/// -font <file.ttf>: Draws text with app::GlyphCache and shows its stats.
+/// -plot <N>: Plots a series of N samples with app::GpuPlot and shows its stats.
+/// -table <N>: Shows a table of N rows with app::VirtualTable.
+/// -gpu_budget <MB>: Budget of the GL objects, the caches are evicted when it is exceeded.
+/// -sim_hz <N>: Steps per second of the simulation.
+/// -render_hz <N>: Frames per second, by default every iteration of the loop renders.
+/// -dynamic_res <ms>: Scales the resolution of the scene to draw the frames in that budget.
+/// -log <file>: Writes the log to the file instead of the console.
+/// -shader <file.vert> <file.frag>: Draws a fullscreen pass with the shaders, rebuilt every time they are saved.
+/// -pack <file.pack>: Reads the assets from an app::AssetPack, the font of -font too if the pack has it.
+/// -build_pack <file.pack> <list.txt>: Writes an app::AssetPack before opening the window and
+/// compares its read time against the loose files.
+/// -jobs <N>: Worker threads of the app::JobSystem.
+/// -job_bench <N>: Times a parallel for of N elements with 1 to cores threads before opening the window.
+/// -math_bench <N>: Times the scalar and SIMD math with N matrices, points and boxes before opening the window.
+/// -input_bench <N>: Times N frames of the gamepad update with no gamepads, idle ones and active ones before opening the window.
+/// -gl_trace <file> <frames>: Records every GL call of the first frames into the file.
+/// -gl_replay <file.trace>: Replays a GL trace instead of opening the window and reports the time of every call.
+/// -gl_replay_sync <file.trace>: Same but finishing every call, so their times include the GPU work.
+void parse_command_line(int argc, char * argv[])
+{
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-gl_tier") == 0)
+		{
+			const char * tier = argv[++i];
+			if (std::strcmp(tier, "4.2") == 0)		my_gl_core::override_tier(my_gl_core::Tier::GL_4_2);
+			else if (std::strcmp(tier, "4.4") == 0)	my_gl_core::override_tier(my_gl_core::Tier::GL_4_4);
+			else if (std::strcmp(tier, "4.5") == 0)	my_gl_core::override_tier(my_gl_core::Tier::GL_4_5);
+			else APP_LOG_WARNING(app::log::Category::App, "Unknown gl tier: {}", tier);
+		}
+		else if (std::strcmp(argv[i], "-quads") == 0)
+		{
+			const int quads = std::atoi(argv[++i]);
+			g_bench_quads = quads > 0 ? static_cast<unsigned>(quads) : 0;
+		}
+		else if (std::strcmp(argv[i], "-font") == 0)
+		{
+			g_font_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-plot") == 0)
+		{
+			const int samples = std::atoi(argv[++i]);
+			g_plot_samples = samples > 0 ? static_cast<unsigned>(samples) : 0;
+		}
+		else if (std::strcmp(argv[i], "-table") == 0)
+		{
+			const int rows = std::atoi(argv[++i]);
+			g_table_rows = rows > 0 ? static_cast<unsigned>(rows) : 0;
+		}
+		else if (std::strcmp(argv[i], "-gpu_budget") == 0)
+		{
+			const int megabytes = std::atoi(argv[++i]);
+			my_gl_core::set_resource_budget(nullptr, megabytes > 0 ? static_cast<GLsizeiptr>(megabytes) * 1024 * 1024 : 0);
+		}
+		else if (std::strcmp(argv[i], "-sim_hz") == 0)
+		{
+			const int rate = std::atoi(argv[++i]);
+			if (rate > 0)
+				g_loop_settings.mSimulateRate = rate;
+		}
+		else if (std::strcmp(argv[i], "-render_hz") == 0)
+		{
+			const int rate = std::atoi(argv[++i]);
+			g_loop_settings.mRenderRate = rate > 0 ? rate : 0.0;
+		}
+		else if (std::strcmp(argv[i], "-dynamic_res") == 0)
+		{
+			const double budget_ms = std::atof(argv[++i]);
+			g_resolution_settings.mbEnabled = budget_ms > 0.0;
+			if (budget_ms > 0.0)
+				g_resolution_settings.mTargetMs = budget_ms;
+		}
+		else if (std::strcmp(argv[i], "-log") == 0)
+		{
+			g_log_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-shader") == 0 && i + 2 < argc)
+		{
+			g_shader_vertex = argv[++i];
+			g_shader_fragment = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-pack") == 0)
+		{
+			g_asset_pack = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-build_pack") == 0 && i + 2 < argc)
+		{
+			g_build_pack = argv[++i];
+			g_build_pack_list = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-jobs") == 0)
+		{
+			g_job_workers = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "-job_bench") == 0)
+		{
+			const int elements = std::atoi(argv[++i]);
+			g_job_bench = elements > 0 ? static_cast<unsigned>(elements) : 0;
+		}
+		else if (std::strcmp(argv[i], "-math_bench") == 0)
+		{
+			const int elements = std::atoi(argv[++i]);
+			g_math_bench = elements > 0 ? static_cast<unsigned>(elements) : 0;
+		}
+		else if (std::strcmp(argv[i], "-input_bench") == 0)
+		{
+			const int frames = std::atoi(argv[++i]);
+			g_input_bench = frames > 0 ? static_cast<unsigned>(frames) : 0;
+		}
+		else if (std::strcmp(argv[i], "-gl_trace") == 0 && i + 2 < argc)
+		{
+			const char * file = argv[++i];
+			const int frames = std::atoi(argv[++i]);
+			if (frames > 0)
+				my_gl_core::request_trace(file, static_cast<unsigned>(frames));
+		}
+		else if (std::strcmp(argv[i], "-gl_replay") == 0 || std::strcmp(argv[i], "-gl_replay_sync") == 0)
+		{
+			g_gl_replay_sync = std::strcmp(argv[i], "-gl_replay_sync") == 0;
+			g_gl_replay = argv[++i];
+		}
+	}
+}
+
+int main(int argc, char * argv[])
 {
 	try
 	{
+		parse_command_line(argc, argv);
+		app::log::Start(g_log_file);
+		if (g_job_bench)
+			run_job_benchmark();
+		if (g_math_bench)
+			run_math_benchmark();
+		if (g_input_bench)
+			run_input_benchmark();
+		if (g_build_pack)
+			build_asset_pack();
+
 		app::Initialize(my_gl_core::get_opengl_mayor_v(), 
 						my_gl_core::get_opengl_minor_v());
 
-		const unsigned char scape = 27;
-		run("Test Window", 1280, 720, scape);
+		if (g_gl_replay)
+		{
+			replay_gl_trace();
+		}
+		else
+		{
+			const unsigned char scape = 27;
+			run("Test Window", 1280, 720, scape);
+		}
 
 		app::Shutdown();
 	}
 	catch (const std::exception & ex)
 	{
-		std::cout << "Exception caught on main: " << ex.what() << std::endl;
+		APP_LOG_ERROR(app::log::Category::App, "Exception caught on main: {}", ex.what());
 	}
 	catch (...)
 	{
-		std::cout << "Something very bad happened!!" << std::endl;
+		APP_LOG_ERROR(app::log::Category::App, "Something very bad happened!!");
 	}
+	app::log::Stop();
 }
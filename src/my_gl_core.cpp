@@ -37,7 +37,7 @@ namespace my_gl_core
 
 #if _DEBUG
 
-#include <iostream>	// std::cout
+#include "Log.h"	// APP_LOG_ERROR
 
 namespace my_gl_core
 {
@@ -59,7 +59,7 @@ namespace my_gl_core
 			case gl::INVALID_FRAMEBUFFER_OPERATION: error_name = "gl::INVALID_FRAMEBUFFER_OPERATION"; break;
 			}
 
-			std::cout << "OpenGL error occurred: " << error_name << " #" << error << std::endl;
+			APP_LOG_ERROR(app::log::Category::GL, "OpenGL error occurred: {} #{}", error_name, error);
 
 			return BreakOnError::s_value;
 		}
@@ -69,4 +69,194 @@ namespace my_gl_core
 
 // compile in here the OpenGL functions
 // (this way we can keep it in the external folder, it would be better not to do this)
-#include "gl_core\gl_core_4_2.cpp"
\ No newline at end of file
+#include "gl_core\gl_core_4_2.cpp"
+// the capability probe is compiled after the loader because it needs IntGetProcAddress
+#include <cstring>	// std::strcmp
+
+namespace my_gl_core
+{
+	namespace ext
+	{
+		void (CODEGEN_FUNCPTR *BufferStorage)(GLenum, GLsizeiptr, const void *, GLbitfield) = nullptr;
+
+		void (CODEGEN_FUNCPTR *BindBuffersRange)(GLenum, GLuint, GLsizei, const GLuint *, const GLintptr *, const GLsizeiptr *) = nullptr;
+		void (CODEGEN_FUNCPTR *BindTextures)(GLuint, GLsizei, const GLuint *) = nullptr;
+		void (CODEGEN_FUNCPTR *BindVertexBuffers)(GLuint, GLsizei, const GLuint *, const GLintptr *, const GLsizei *) = nullptr;
+
+		void (CODEGEN_FUNCPTR *CreateBuffers)(GLsizei, GLuint *) = nullptr;
+		void (CODEGEN_FUNCPTR *NamedBufferData)(GLuint, GLsizeiptr, const void *, GLenum) = nullptr;
+		void (CODEGEN_FUNCPTR *NamedBufferSubData)(GLuint, GLintptr, GLsizeiptr, const void *) = nullptr;
+		void (CODEGEN_FUNCPTR *NamedBufferStorage)(GLuint, GLsizeiptr, const void *, GLbitfield) = nullptr;
+		void * (CODEGEN_FUNCPTR *MapNamedBufferRange)(GLuint, GLintptr, GLsizeiptr, GLbitfield) = nullptr;
+		GLboolean (CODEGEN_FUNCPTR *UnmapNamedBuffer)(GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *FlushMappedNamedBufferRange)(GLuint, GLintptr, GLsizeiptr) = nullptr;
+		void (CODEGEN_FUNCPTR *CreateVertexArrays)(GLsizei, GLuint *) = nullptr;
+		void (CODEGEN_FUNCPTR *EnableVertexArrayAttrib)(GLuint, GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *VertexArrayAttribFormat)(GLuint, GLuint, GLint, GLenum, GLboolean, GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *VertexArrayAttribBinding)(GLuint, GLuint, GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *VertexArrayBindingDivisor)(GLuint, GLuint, GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *VertexArrayVertexBuffer)(GLuint, GLuint, GLuint, GLintptr, GLsizei) = nullptr;
+		void (CODEGEN_FUNCPTR *VertexArrayElementBuffer)(GLuint, GLuint) = nullptr;
+		void (CODEGEN_FUNCPTR *CreateTextures)(GLenum, GLsizei, GLuint *) = nullptr;
+		void (CODEGEN_FUNCPTR *TextureStorage2D)(GLuint, GLsizei, GLenum, GLsizei, GLsizei) = nullptr;
+		void (CODEGEN_FUNCPTR *TextureSubImage2D)(GLuint, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *) = nullptr;
+		void (CODEGEN_FUNCPTR *TextureParameteri)(GLuint, GLenum, GLint) = nullptr;
+		void (CODEGEN_FUNCPTR *BindTextureUnit)(GLuint, GLuint) = nullptr;
+
+		void (CODEGEN_FUNCPTR *MaxShaderCompilerThreads)(GLuint) = nullptr;
+	}
+
+	namespace impl
+	{
+		/// \brief	Result of the last my_gl_core::probe_caps call.
+		struct CapsState
+		{
+			static Caps s_detected;
+			static Caps s_active;
+			static Tier s_detected_tier;
+			static Tier s_override;
+			static bool s_has_override;
+		};
+		Caps CapsState::s_detected;
+		Caps CapsState::s_active;
+		Tier CapsState::s_detected_tier = Tier::GL_4_2;
+		Tier CapsState::s_override = Tier::GL_4_2;
+		bool CapsState::s_has_override = false;
+
+		/// \return	True if the function could be found.
+		template<typename FN>
+		bool LoadExtFunction(FN & fn, const char * name)
+		{
+			fn = reinterpret_cast<FN>(IntGetProcAddress(name));
+			return fn != nullptr;
+		}
+
+		bool HasExtension(const char * name)
+		{
+			GLint num_extensions = 0;
+			gl::GetIntegerv(gl::NUM_EXTENSIONS, &num_extensions);
+			for (GLint i = 0; i < num_extensions; ++i)
+			{
+				const char * ext_name = reinterpret_cast<const char *>(gl::GetStringi(gl::EXTENSIONS, i));
+				if (ext_name && std::strcmp(ext_name, name) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		/// \brief	Disables the features that are above the tier in use.
+		void UpdateActiveCaps()
+		{
+			const Tier tier = get_tier();
+			CapsState::s_active = CapsState::s_detected;
+			if (tier < Tier::GL_4_5)
+			{
+				CapsState::s_active.direct_state_access = false;
+			}
+			if (tier < Tier::GL_4_4)
+			{
+				CapsState::s_active.buffer_storage = false;
+				CapsState::s_active.multi_bind = false;
+			}
+		}
+	}
+
+	void probe_caps()
+	{
+		using namespace ext;
+
+		GLint mayor = 0, minor = 0;
+		gl::GetIntegerv(gl::MAJOR_VERSION, &mayor);
+		gl::GetIntegerv(gl::MINOR_VERSION, &minor);
+		const bool gl_4_4 = mayor > 4 || (mayor == 4 && minor >= 4);
+		const bool gl_4_5 = mayor > 4 || (mayor == 4 && minor >= 5);
+
+		Caps & caps = impl::CapsState::s_detected;
+		caps = Caps{};
+
+		// only flag a feature if all of its entry points are available
+		if (gl_4_4 || impl::HasExtension("GL_ARB_buffer_storage"))
+		{
+			caps.buffer_storage = impl::LoadExtFunction(BufferStorage, "glBufferStorage");
+		}
+		if (gl_4_4 || impl::HasExtension("GL_ARB_multi_bind"))
+		{
+			caps.multi_bind = impl::LoadExtFunction(BindBuffersRange, "glBindBuffersRange")
+							&& impl::LoadExtFunction(BindTextures, "glBindTextures")
+							&& impl::LoadExtFunction(BindVertexBuffers, "glBindVertexBuffers");
+		}
+		if (gl_4_5 || impl::HasExtension("GL_ARB_direct_state_access"))
+		{
+			caps.direct_state_access = impl::LoadExtFunction(CreateBuffers, "glCreateBuffers")
+				&& impl::LoadExtFunction(NamedBufferData, "glNamedBufferData")
+				&& impl::LoadExtFunction(NamedBufferSubData, "glNamedBufferSubData")
+				&& impl::LoadExtFunction(NamedBufferStorage, "glNamedBufferStorage")
+				&& impl::LoadExtFunction(MapNamedBufferRange, "glMapNamedBufferRange")
+				&& impl::LoadExtFunction(UnmapNamedBuffer, "glUnmapNamedBuffer")
+				&& impl::LoadExtFunction(FlushMappedNamedBufferRange, "glFlushMappedNamedBufferRange")
+				&& impl::LoadExtFunction(CreateVertexArrays, "glCreateVertexArrays")
+				&& impl::LoadExtFunction(EnableVertexArrayAttrib, "glEnableVertexArrayAttrib")
+				&& impl::LoadExtFunction(VertexArrayAttribFormat, "glVertexArrayAttribFormat")
+				&& impl::LoadExtFunction(VertexArrayAttribBinding, "glVertexArrayAttribBinding")
+				&& impl::LoadExtFunction(VertexArrayBindingDivisor, "glVertexArrayBindingDivisor")
+				&& impl::LoadExtFunction(VertexArrayVertexBuffer, "glVertexArrayVertexBuffer")
+				&& impl::LoadExtFunction(VertexArrayElementBuffer, "glVertexArrayElementBuffer")
+				&& impl::LoadExtFunction(CreateTextures, "glCreateTextures")
+				&& impl::LoadExtFunction(TextureStorage2D, "glTextureStorage2D")
+				&& impl::LoadExtFunction(TextureSubImage2D, "glTextureSubImage2D")
+				&& impl::LoadExtFunction(TextureParameteri, "glTextureParameteri")
+				&& impl::LoadExtFunction(BindTextureUnit, "glBindTextureUnit");
+		}
+		if (impl::HasExtension("GL_ARB_parallel_shader_compile"))
+		{
+			caps.parallel_shader_compile = impl::LoadExtFunction(MaxShaderCompilerThreads, "glMaxShaderCompilerThreadsARB");
+		}
+		else if (impl::HasExtension("GL_KHR_parallel_shader_compile"))
+		{
+			caps.parallel_shader_compile = impl::LoadExtFunction(MaxShaderCompilerThreads, "glMaxShaderCompilerThreadsKHR");
+		}
+
+		Tier & tier = impl::CapsState::s_detected_tier;
+		tier = Tier::GL_4_2;
+		if (caps.buffer_storage && caps.multi_bind)
+		{
+			tier = Tier::GL_4_4;
+			if (caps.direct_state_access)
+				tier = Tier::GL_4_5;
+		}
+
+		impl::UpdateActiveCaps();
+	}
+
+	const Caps & get_caps()
+	{
+		return impl::CapsState::s_active;
+	}
+	Tier get_detected_tier()
+	{
+		return impl::CapsState::s_detected_tier;
+	}
+	Tier get_tier()
+	{
+		const Tier detected = impl::CapsState::s_detected_tier;
+		if (impl::CapsState::s_has_override && impl::CapsState::s_override < detected)
+			return impl::CapsState::s_override;
+		return detected;
+	}
+	void override_tier(Tier tier)
+	{
+		impl::CapsState::s_override = tier;
+		impl::CapsState::s_has_override = true;
+		impl::UpdateActiveCaps();
+	}
+	const char * get_tier_name(Tier tier)
+	{
+		switch (tier)
+		{
+		case Tier::GL_4_2: return "GL 4.2 (bind-to-edit)";
+		case Tier::GL_4_4: return "GL 4.4 (buffer storage, multi bind)";
+		case Tier::GL_4_5: return "GL 4.5 (direct state access)";
+		}
+		return "_unknown_tier_";
+	}
+}
@@ -13,6 +13,85 @@ namespace my_gl_core
 
 	void break_on_error(bool b);
 	bool is_break_on_error_enabled();
+
+	/// \brief	Groups of optional functionality the renderers can branch on,
+	/// every tier includes all the features of the previous ones.
+	enum class Tier
+	{
+		GL_4_2,		// baseline: bind-to-edit, BufferData orphaning, glGet state backup
+		GL_4_4,		// + ARB_buffer_storage (persistent mapping), ARB_multi_bind
+		GL_4_5,		// + ARB_direct_state_access
+	};
+
+	/// \brief	Optional OpenGL functionality detected at runtime.
+	struct Caps
+	{
+		bool direct_state_access{ false };
+		bool buffer_storage{ false };
+		bool multi_bind{ false };
+		bool parallel_shader_compile{ false };
+	};
+
+	/// \brief	Detects the optional functionality and loads its entry points (my_gl_core::ext),
+	/// needs to be called after gl::sys::LoadFunctions.
+	void probe_caps();
+	/// \return	The functionality the renderers are allowed to use, 
+	/// this is what was detected limited by the tier override.
+	const Caps & get_caps();
+	/// \return	Highest tier the driver supports.
+	Tier get_detected_tier();
+	/// \return	Tier that is currently in use.
+	Tier get_tier();
+	/// \brief	Forces the renderers to use a lower tier (i.e. to benchmark the fallback paths).
+	/// Tiers above the detected one are clamped. Needs to be set before creating the GL resources.
+	void override_tier(Tier tier);
+	const char * get_tier_name(Tier tier);
+
+	/// \brief	Entry points and enums of the optional functionality, not provided by gl_core_4_2.
+	/// Only valid when the matching flag in my_gl_core::get_caps() is set.
+	namespace ext
+	{
+		enum : GLenum
+		{
+			MAP_PERSISTENT_BIT = 0x0040,
+			MAP_COHERENT_BIT = 0x0080,
+			DYNAMIC_STORAGE_BIT = 0x0100,
+			CLIENT_STORAGE_BIT = 0x0200,
+			COMPLETION_STATUS = 0x91B1,
+		};
+
+		// ARB_buffer_storage
+		extern void (CODEGEN_FUNCPTR *BufferStorage)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags);
+
+		// ARB_multi_bind
+		extern void (CODEGEN_FUNCPTR *BindBuffersRange)(GLenum target, GLuint first, GLsizei count, const GLuint * buffers, const GLintptr * offsets, const GLsizeiptr * sizes);
+		extern void (CODEGEN_FUNCPTR *BindTextures)(GLuint first, GLsizei count, const GLuint * textures);
+		extern void (CODEGEN_FUNCPTR *BindVertexBuffers)(GLuint first, GLsizei count, const GLuint * buffers, const GLintptr * offsets, const GLsizei * strides);
+
+		// ARB_direct_state_access
+		extern void (CODEGEN_FUNCPTR *CreateBuffers)(GLsizei n, GLuint * buffers);
+		extern void (CODEGEN_FUNCPTR *NamedBufferData)(GLuint buffer, GLsizeiptr size, const void * data, GLenum usage);
+		extern void (CODEGEN_FUNCPTR *NamedBufferSubData)(GLuint buffer, GLintptr offset, GLsizeiptr size, const void * data);
+		extern void (CODEGEN_FUNCPTR *NamedBufferStorage)(GLuint buffer, GLsizeiptr size, const void * data, GLbitfield flags);
+		extern void * (CODEGEN_FUNCPTR *MapNamedBufferRange)(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+		extern GLboolean (CODEGEN_FUNCPTR *UnmapNamedBuffer)(GLuint buffer);
+		extern void (CODEGEN_FUNCPTR *FlushMappedNamedBufferRange)(GLuint buffer, GLintptr offset, GLsizeiptr length);
+		extern void (CODEGEN_FUNCPTR *CreateVertexArrays)(GLsizei n, GLuint * arrays);
+		extern void (CODEGEN_FUNCPTR *EnableVertexArrayAttrib)(GLuint vaobj, GLuint index);
+		extern void (CODEGEN_FUNCPTR *VertexArrayAttribFormat)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+		extern void (CODEGEN_FUNCPTR *VertexArrayAttribBinding)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+		extern void (CODEGEN_FUNCPTR *VertexArrayBindingDivisor)(GLuint vaobj, GLuint bindingindex, GLuint divisor);
+		extern void (CODEGEN_FUNCPTR *VertexArrayVertexBuffer)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+		extern void (CODEGEN_FUNCPTR *VertexArrayElementBuffer)(GLuint vaobj, GLuint buffer);
+		extern void (CODEGEN_FUNCPTR *CreateTextures)(GLenum target, GLsizei n, GLuint * textures);
+		extern void (CODEGEN_FUNCPTR *TextureStorage2D)(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+		extern void (CODEGEN_FUNCPTR *TextureSubImage2D)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void * pixels);
+		extern void (CODEGEN_FUNCPTR *TextureParameteri)(GLuint texture, GLenum pname, GLint param);
+		extern void (CODEGEN_FUNCPTR *BindTextureUnit)(GLuint unit, GLuint texture);
+
+		// ARB_parallel_shader_compile / KHR_parallel_shader_compile
+		extern void (CODEGEN_FUNCPTR *MaxShaderCompilerThreads)(GLuint count);
+	}
 };
 
 #if _DEBUG
@@ -0,0 +1,345 @@
+/*!
+\brief	Registry of the GL objects of the application, with memory accounting, budgets and leak reports.
+*/
+
+#include "my_gl_resources.h"
+#include "Log.h"			// APP_LOG_WARNING
+
+#include <unordered_map>	// std::unordered_map
+#include <deque>			// std::deque
+#include <string>			// std::string
+#include <algorithm>		// std::sort, std::max
+#include <cstring>			// std::strcmp
+#include <cstdint>			// std::uint64_t
+
+namespace my_gl_core
+{
+	namespace
+	{
+		/// \brief	Frames of history kept for the memory graph.
+		constexpr unsigned s_HistoryFrames = 600;
+
+		struct Resource
+		{
+			unsigned	mOwner;
+			GLsizeiptr	mBytes;
+			unsigned	mFrame;		// frame it was created in
+		};
+
+		struct Registry
+		{
+			std::unordered_map<std::uint64_t, Resource> mResources;
+			std::vector<ResourceOwner> mvOwners;
+			std::vector<EvictionCallback> mvEvictionCallbacks;	// one per owner
+			std::deque<std::string> mOwnerNames;				// the owners point to them
+			ResourceUsage mTotals{};
+			GLsizeiptr mBudget{ 0 };
+			unsigned mFrame{ 0 };
+
+			std::vector<float> mvHistory;
+			int mHistoryOffset{ 0 };
+		};
+		Registry & get_registry()
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		std::uint64_t MakeKey(ResourceType type, GLuint name)
+		{
+			return (static_cast<std::uint64_t>(type) << 32) | name;
+		}
+
+		unsigned FindOwner(const char * owner)
+		{
+			Registry & registry = get_registry();
+			if (owner == nullptr)
+				owner = "_unknown_owner_";
+
+			for (unsigned i = 0; i < registry.mvOwners.size(); ++i)
+			{
+				if (std::strcmp(registry.mvOwners[i].mName, owner) == 0)
+					return i;
+			}
+
+			registry.mOwnerNames.emplace_back(owner);
+			ResourceOwner new_owner{};
+			new_owner.mName = registry.mOwnerNames.back().c_str();
+			registry.mvOwners.push_back(new_owner);
+			registry.mvEvictionCallbacks.emplace_back();
+			return static_cast<unsigned>(registry.mvOwners.size() - 1);
+		}
+
+		void AddResource(ResourceType type, GLuint name, const char * owner)
+		{
+			if (name == 0)
+				return;
+
+			Registry & registry = get_registry();
+			const unsigned owner_index = FindOwner(owner);
+			registry.mResources[MakeKey(type, name)] = Resource{ owner_index, 0, registry.mFrame };
+
+			const unsigned t = static_cast<unsigned>(type);
+			++registry.mvOwners[owner_index].mUsage.mCount[t];
+			++registry.mTotals.mCount[t];
+		}
+		void RemoveResource(ResourceType type, GLuint name)
+		{
+			Registry & registry = get_registry();
+			auto it = registry.mResources.find(MakeKey(type, name));
+			if (it == registry.mResources.end())
+				return;
+
+			const unsigned t = static_cast<unsigned>(type);
+			ResourceUsage & usage = registry.mvOwners[it->second.mOwner].mUsage;
+			usage.mBytes[t] -= it->second.mBytes;
+			--usage.mCount[t];
+			registry.mTotals.mBytes[t] -= it->second.mBytes;
+			--registry.mTotals.mCount[t];
+			registry.mResources.erase(it);
+		}
+
+		GLsizeiptr BytesPerPixel(GLenum internal_format)
+		{
+			switch (internal_format)
+			{
+			case gl::R8:
+			case gl::RED:				return 1;
+			case gl::RG8:
+			case gl::R16F:
+			case gl::DEPTH_COMPONENT16:	return 2;
+			case gl::RGB8:
+			case gl::RGB:
+			case gl::DEPTH_COMPONENT24:	return 3;
+			case gl::RGBA8:
+			case gl::RGBA:
+			case gl::R32F:
+			case gl::RG16F:
+			case gl::DEPTH24_STENCIL8:
+			case gl::DEPTH_COMPONENT32F:	return 4;
+			case gl::RGBA16F:
+			case gl::RG32F:				return 8;
+			case gl::RGBA32F:			return 16;
+			}
+			return 4;
+		}
+	}
+
+	const char * get_resource_type_name(ResourceType type)
+	{
+		switch (type)
+		{
+		case ResourceType::Buffer: return "Buffer";
+		case ResourceType::Texture: return "Texture";
+		case ResourceType::Program: return "Program";
+		case ResourceType::VertexArray: return "Vertex array";
+		case ResourceType::Count: break;
+		}
+		return "_unknown_type_";
+	}
+
+	GLsizeiptr ResourceUsage::getTotalBytes() const
+	{
+		GLsizeiptr total = 0;
+		for (const GLsizeiptr bytes : mBytes)
+			total += bytes;
+		return total;
+	}
+
+	GLuint create_buffer(const char * owner)
+	{
+		GLuint buffer = 0;
+		if (get_caps().direct_state_access)	ext::CreateBuffers(1, &buffer);
+		else								gl::GenBuffers(1, &buffer);
+		AddResource(ResourceType::Buffer, buffer, owner);
+		return buffer;
+	}
+	GLuint create_texture(GLenum target, const char * owner)
+	{
+		GLuint texture = 0;
+		if (get_caps().direct_state_access)	ext::CreateTextures(target, 1, &texture);
+		else								gl::GenTextures(1, &texture);
+		AddResource(ResourceType::Texture, texture, owner);
+		return texture;
+	}
+	GLuint create_vertex_array(const char * owner)
+	{
+		GLuint vertex_array = 0;
+		if (get_caps().direct_state_access)	ext::CreateVertexArrays(1, &vertex_array);
+		else								gl::GenVertexArrays(1, &vertex_array);
+		AddResource(ResourceType::VertexArray, vertex_array, owner);
+		return vertex_array;
+	}
+	GLuint create_program(const char * owner)
+	{
+		const GLuint program = gl::CreateProgram();
+		AddResource(ResourceType::Program, program, owner);
+		return program;
+	}
+
+	void delete_buffer(GLuint & buffer)
+	{
+		if (buffer == 0)
+			return;
+		RemoveResource(ResourceType::Buffer, buffer);
+		gl::DeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+	void delete_texture(GLuint & texture)
+	{
+		if (texture == 0)
+			return;
+		RemoveResource(ResourceType::Texture, texture);
+		gl::DeleteTextures(1, &texture);
+		texture = 0;
+	}
+	void delete_vertex_array(GLuint & vertex_array)
+	{
+		if (vertex_array == 0)
+			return;
+		RemoveResource(ResourceType::VertexArray, vertex_array);
+		gl::DeleteVertexArrays(1, &vertex_array);
+		vertex_array = 0;
+	}
+	void delete_program(GLuint & program)
+	{
+		if (program == 0)
+			return;
+		RemoveResource(ResourceType::Program, program);
+		gl::DeleteProgram(program);
+		program = 0;
+	}
+
+	void set_resource_size(ResourceType type, GLuint name, GLsizeiptr bytes)
+	{
+		Registry & registry = get_registry();
+		auto it = registry.mResources.find(MakeKey(type, name));
+		if (it == registry.mResources.end())
+			return;
+
+		const unsigned t = static_cast<unsigned>(type);
+		ResourceOwner & owner = registry.mvOwners[it->second.mOwner];
+		owner.mUsage.mBytes[t] += bytes - it->second.mBytes;
+		registry.mTotals.mBytes[t] += bytes - it->second.mBytes;
+		it->second.mBytes = bytes;
+		owner.mPeakBytes = std::max(owner.mPeakBytes, owner.mUsage.getTotalBytes());
+	}
+	GLsizeiptr get_texture_size(GLenum internal_format, GLsizei width, GLsizei height, GLsizei levels)
+	{
+		const GLsizeiptr bytes_per_pixel = BytesPerPixel(internal_format);
+		GLsizeiptr bytes = 0;
+		for (GLsizei level = 0; level < levels; ++level)
+		{
+			bytes += bytes_per_pixel * width * height;
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+		return bytes;
+	}
+
+	void set_resource_budget(const char * owner, GLsizeiptr bytes)
+	{
+		if (owner == nullptr)
+			get_registry().mBudget = bytes;
+		else
+			get_registry().mvOwners[FindOwner(owner)].mBudget = bytes;
+	}
+	void set_eviction_callback(const char * owner, EvictionCallback callback)
+	{
+		get_registry().mvEvictionCallbacks[FindOwner(owner)] = std::move(callback);
+	}
+
+	void update_resources()
+	{
+		Registry & registry = get_registry();
+		++registry.mFrame;
+
+		// IMPORTANT(Borja): The callbacks can create and delete objects (and owners), so the owners
+		// are accessed by index and the callbacks are copied before calling them.
+		for (unsigned i = 0; i < registry.mvOwners.size(); ++i)
+		{
+			const GLsizeiptr budget = registry.mvOwners[i].mBudget;
+			const GLsizeiptr bytes = registry.mvOwners[i].mUsage.getTotalBytes();
+			if (budget == 0 || bytes <= budget || !registry.mvEvictionCallbacks[i])
+				continue;
+
+			++registry.mvOwners[i].mEvictions;
+			const EvictionCallback callback = registry.mvEvictionCallbacks[i];
+			callback(bytes - budget);
+		}
+
+		// over the total budget, the biggest owners free memory first
+		if (registry.mBudget > 0 && registry.mTotals.getTotalBytes() > registry.mBudget)
+		{
+			std::vector<unsigned> order;
+			for (unsigned i = 0; i < registry.mvOwners.size(); ++i)
+			{
+				if (registry.mvEvictionCallbacks[i])
+					order.push_back(i);
+			}
+			std::sort(order.begin(), order.end(), [&registry](unsigned a, unsigned b)
+			{
+				return registry.mvOwners[a].mUsage.getTotalBytes() > registry.mvOwners[b].mUsage.getTotalBytes();
+			});
+
+			for (const unsigned i : order)
+			{
+				const GLsizeiptr bytes = registry.mTotals.getTotalBytes();
+				if (bytes <= registry.mBudget)
+					break;
+
+				++registry.mvOwners[i].mEvictions;
+				const EvictionCallback callback = registry.mvEvictionCallbacks[i];
+				callback(bytes - registry.mBudget);
+			}
+		}
+
+		// ring of the last frames
+		const float megabytes = static_cast<float>(registry.mTotals.getTotalBytes()) / (1024.f * 1024.f);
+		if (registry.mvHistory.size() < s_HistoryFrames)
+		{
+			registry.mvHistory.push_back(megabytes);
+		}
+		else
+		{
+			registry.mvHistory[registry.mHistoryOffset] = megabytes;
+			registry.mHistoryOffset = (registry.mHistoryOffset + 1) % static_cast<int>(s_HistoryFrames);
+		}
+	}
+
+	unsigned report_resource_leaks()
+	{
+		const Registry & registry = get_registry();
+		if (registry.mResources.empty())
+			return 0;
+
+		for (const auto & entry : registry.mResources)
+		{
+			const ResourceType type = static_cast<ResourceType>(entry.first >> 32);
+			const GLuint name = static_cast<GLuint>(entry.first & 0xffffffffu);
+			const Resource & resource = entry.second;
+			APP_LOG_WARNING(app::log::Category::GL, "GL leak: {} {} (owner {}, {} bytes, created in frame {})",
+							get_resource_type_name(type), name, registry.mvOwners[resource.mOwner].mName, resource.mBytes, resource.mFrame);
+		}
+
+		return static_cast<unsigned>(registry.mResources.size());
+	}
+
+	ResourceUsage get_resource_totals()
+	{
+		return get_registry().mTotals;
+	}
+	GLsizeiptr get_resource_budget()
+	{
+		return get_registry().mBudget;
+	}
+	const std::vector<ResourceOwner> & get_resource_owners()
+	{
+		return get_registry().mvOwners;
+	}
+	const std::vector<float> & get_resource_history(int & offset)
+	{
+		offset = get_registry().mHistoryOffset;
+		return get_registry().mvHistory;
+	}
+}
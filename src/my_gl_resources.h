@@ -0,0 +1,85 @@
+/*!
+\brief	Registry of the GL objects of the application, with memory accounting, budgets and leak reports.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"
+
+#include <functional>	// std::function
+#include <vector>		// std::vector
+
+namespace my_gl_core
+{
+	enum class ResourceType : unsigned
+	{
+		Buffer,
+		Texture,
+		Program,
+		VertexArray,
+		Count
+	};
+	const char * get_resource_type_name(ResourceType type);
+
+	/// \brief	Live objects and their estimated bytes, per type.
+	struct ResourceUsage
+	{
+		GLsizeiptr	mBytes[static_cast<unsigned>(ResourceType::Count)];
+		unsigned	mCount[static_cast<unsigned>(ResourceType::Count)];
+
+		GLsizeiptr getTotalBytes() const;
+	};
+
+	/// \brief	Everything created with the same owner name (i.e. "ImGuiSystem").
+	struct ResourceOwner
+	{
+		const char *	mName;
+		ResourceUsage	mUsage;
+		GLsizeiptr		mPeakBytes;
+		GLsizeiptr		mBudget;		// 0 if the owner has no budget
+		unsigned		mEvictions;		// times its eviction callback has been called
+	};
+
+	/// \brief	Called when the owner is over its budget (or the total budget is exceeded), it should
+	/// delete or shrink its objects (i.e. drop caches) until it frees at least bytes_over bytes.
+	typedef std::function<void(GLsizeiptr bytes_over)> EvictionCallback;
+
+	// Creation and deletion of the tracked objects, the owner names are copied.
+	// IMPORTANT(Borja): The objects need to be deleted with the functions of the registry,
+	// otherwise they are reported as leaks.
+	GLuint create_buffer(const char * owner);
+	GLuint create_texture(GLenum target, const char * owner);
+	GLuint create_vertex_array(const char * owner);
+	GLuint create_program(const char * owner);
+	/// \brief	Deletes the object and sets the name to 0, does nothing if it is already 0.
+	void delete_buffer(GLuint & buffer);
+	void delete_texture(GLuint & texture);
+	void delete_vertex_array(GLuint & vertex_array);
+	void delete_program(GLuint & program);
+
+	/// \brief	Updates the estimated bytes of an object, needs to be called every time its storage
+	/// is allocated (BufferData, BufferStorage, TexStorage2D, TexImage2D...).
+	void set_resource_size(ResourceType type, GLuint name, GLsizeiptr bytes);
+	/// \return	Estimated bytes of a 2D texture with the whole mip chain up to levels.
+	GLsizeiptr get_texture_size(GLenum internal_format, GLsizei width, GLsizei height, GLsizei levels = 1);
+
+	/// \brief	Sets the budget of an owner, or the budget of all the objects if owner is nullptr.
+	/// A budget of 0 disables it. The budgets are checked in my_gl_core::update_resources.
+	void set_resource_budget(const char * owner, GLsizeiptr bytes);
+	void set_eviction_callback(const char * owner, EvictionCallback callback);
+
+	/// \brief	Calls the eviction callbacks of the owners that are over budget and records the
+	/// history of the total bytes. Window calls it when swapping buffers.
+	void update_resources();
+
+	/// \brief	Logs every object that is still alive, Window calls it before
+	/// destroying the context.
+	/// \return	Number of objects leaked.
+	unsigned report_resource_leaks();
+
+	ResourceUsage get_resource_totals();
+	GLsizeiptr get_resource_budget();
+	const std::vector<ResourceOwner> & get_resource_owners();
+	/// \brief	Total megabytes of the last frames, oldest first starting at offset (same as ImGui::PlotLines).
+	const std::vector<float> & get_resource_history(int & offset);
+}
@@ -0,0 +1,239 @@
+/*!
+\brief	Ring buffer to stream per-frame dynamic data (vertices, indices, uniforms) to the GPU.
+*/
+
+#include "my_gl_stream_buffer.h"
+#include "my_gl_resources.h"	// my_gl_core::create_buffer, my_gl_core::delete_buffer
+#include "my_gl_trace.h"		// my_gl_core::trace_mapped_write
+
+#include <algorithm>	// std::max
+#include <chrono>		// std::chrono::high_resolution_clock
+#include <stdexcept>	// std::runtime_error
+
+namespace my_gl_core
+{
+	StreamBuffer::StreamBuffer(GLsizeiptr partition_size, unsigned frames_in_flight)
+		: mvFences(frames_in_flight ? frames_in_flight : 1, nullptr)
+	{
+		const Caps & caps = get_caps();
+		mbPersistent = caps.buffer_storage;
+		mbUseDSA = caps.direct_state_access;
+
+		CreateBuffer(partition_size);
+	}
+	StreamBuffer::~StreamBuffer()
+	{
+		for (GLsync & fence : mvFences)
+		{
+			if (fence)	gl::DeleteSync(fence);
+			fence = nullptr;
+		}
+
+		// the context is going away, no need to wait for the GPU
+		for (Retired & retired : mvRetired)
+		{
+			if (retired.mFence)	gl::DeleteSync(retired.mFence);
+			delete_buffer(retired.mBuffer);
+		}
+		mvRetired.clear();
+
+		if (mBuffer)
+		{
+			// deleting a mapped buffer unmaps it
+			delete_buffer(mBuffer);
+			mpMapped = nullptr;
+		}
+	}
+
+	void StreamBuffer::CreateBuffer(GLsizeiptr partition_size)
+	{
+		mStats.mPartitionSize = partition_size;
+		const GLsizeiptr total_size = partition_size * static_cast<GLsizeiptr>(mvFences.size());
+		mBuffer = create_buffer("StreamBuffer");
+		++mGeneration;
+
+		if (mbPersistent)
+		{
+			const GLbitfield flags = gl::MAP_WRITE_BIT | ext::MAP_PERSISTENT_BIT | ext::MAP_COHERENT_BIT;
+			if (mbUseDSA)
+			{
+				ext::NamedBufferStorage(mBuffer, total_size, nullptr, flags);
+				mpMapped = static_cast<char *>(ext::MapNamedBufferRange(mBuffer, 0, total_size, flags));
+			}
+			else
+			{
+				// use the copy target so that we don't modify any binding the renderers care about
+				gl::BindBuffer(gl::COPY_WRITE_BUFFER, mBuffer);
+				ext::BufferStorage(gl::COPY_WRITE_BUFFER, total_size, nullptr, flags);
+				mpMapped = static_cast<char *>(gl::MapBufferRange(gl::COPY_WRITE_BUFFER, 0, total_size, flags));
+			}
+
+			if (!mpMapped)
+				throw std::runtime_error{ "Stream buffer couldn't be persistently mapped." };
+		}
+		else if (mbUseDSA)
+		{
+			ext::NamedBufferData(mBuffer, total_size, nullptr, gl::STREAM_DRAW);
+		}
+		else
+		{
+			gl::BindBuffer(gl::COPY_WRITE_BUFFER, mBuffer);
+			gl::BufferData(gl::COPY_WRITE_BUFFER, total_size, nullptr, gl::STREAM_DRAW);
+		}
+		set_resource_size(ResourceType::Buffer, mBuffer, total_size);
+		CheckOGLError();
+	}
+
+	void StreamBuffer::WaitForPartition()
+	{
+		mbPartitionReady = true;
+
+		GLsync & fence = mvFences[mPartition];
+		if (!fence)
+			return;
+
+		GLenum result = gl::ClientWaitSync(fence, 0, 0);
+		if (result == gl::TIMEOUT_EXPIRED)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			const GLuint64 one_ms = 1000000;
+			do
+			{
+				result = gl::ClientWaitSync(fence, gl::SYNC_FLUSH_COMMANDS_BIT, one_ms);
+			} while (result == gl::TIMEOUT_EXPIRED);
+
+			const std::chrono::duration<double, std::milli> waited = std::chrono::high_resolution_clock::now() - start;
+			++mStats.mWaitStalls;
+			mStats.mWaitMs += waited.count();
+		}
+
+		gl::DeleteSync(fence);
+		fence = nullptr;
+	}
+
+	StreamBuffer::Range StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+	{
+		// IMPORTANT(Borja): The unsynchronized path can only have one range mapped at a time.
+		if (mbRangeMapped)
+			throw std::runtime_error{ "StreamBuffer::Commit needs to be called before allocating again." };
+
+		if (!mbPartitionReady)
+			WaitForPartition();
+
+		// align the absolute offset, partitions don't need to be a multiple of the alignment
+		if (alignment < 1)	alignment = 1;
+		const GLsizeiptr partition_start = mStats.mPartitionSize * mPartition;
+		GLsizeiptr offset = (partition_start + mHead + alignment - 1) / alignment * alignment - partition_start;
+
+		if (offset + size > mStats.mPartitionSize)
+		{
+			// the GPU may still be using the old buffer, delete it once this frame is done
+			mvRetired.push_back(Retired{ mBuffer, nullptr });
+			for (GLsync & fence : mvFences)
+			{
+				if (fence)	gl::DeleteSync(fence);
+				fence = nullptr;
+			}
+
+			mBuffer = 0;
+			mpMapped = nullptr;
+			mPartition = 0;
+			++mStats.mGrowCount;
+			CreateBuffer(std::max(mStats.mPartitionSize * 2, size + alignment));
+			offset = 0;
+		}
+
+		Range range;
+		range.mBuffer = mBuffer;
+		range.mGeneration = mGeneration;
+		range.mOffset = mStats.mPartitionSize * mPartition + offset;
+		range.mSize = size;
+
+		if (mbPersistent)
+		{
+			range.mpData = mpMapped + range.mOffset;
+		}
+		else
+		{
+			const GLbitfield access = gl::MAP_WRITE_BIT | gl::MAP_UNSYNCHRONIZED_BIT | gl::MAP_INVALIDATE_RANGE_BIT;
+			if (mbUseDSA)
+			{
+				range.mpData = ext::MapNamedBufferRange(mBuffer, range.mOffset, size, access);
+			}
+			else
+			{
+				gl::BindBuffer(gl::COPY_WRITE_BUFFER, mBuffer);
+				range.mpData = gl::MapBufferRange(gl::COPY_WRITE_BUFFER, range.mOffset, size, access);
+			}
+			mbRangeMapped = true;
+		}
+
+		mHead = offset + size;
+		mStats.mFrameBytes += size;
+		++mStats.mAllocations;
+		return range;
+	}
+
+	void StreamBuffer::Commit(const Range & range)
+	{
+		// the persistent mapping is coherent, nothing to do (but the tracer can't see the writes)
+		if (mbPersistent && is_tracing())
+			trace_mapped_write(range.mBuffer, range.mOffset, range.mSize, range.mpData);
+		if (mbPersistent || !mbRangeMapped)
+			return;
+
+		if (mbUseDSA)
+		{
+			ext::UnmapNamedBuffer(range.mBuffer);
+		}
+		else
+		{
+			gl::BindBuffer(gl::COPY_WRITE_BUFFER, range.mBuffer);
+			gl::UnmapBuffer(gl::COPY_WRITE_BUFFER);
+		}
+		mbRangeMapped = false;
+	}
+
+	void StreamBuffer::EndFrame()
+	{
+		// only fence partitions that have been used
+		if (mbPartitionReady)
+		{
+			mvFences[mPartition] = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+			mPartition = (mPartition + 1) % static_cast<unsigned>(mvFences.size());
+			mbPartitionReady = false;
+		}
+
+		ReleaseRetiredBuffers();
+
+		mStats.mHighWaterMark = std::max(mStats.mHighWaterMark, mStats.mFrameBytes);
+		mStats.mFrameBytes = 0;
+		mStats.mAllocations = 0;
+		mHead = 0;
+	}
+
+	void StreamBuffer::ReleaseRetiredBuffers()
+	{
+		for (auto it = mvRetired.begin(); it != mvRetired.end();)
+		{
+			if (!it->mFence)
+			{
+				// the last frame that could use it just finished submitting
+				it->mFence = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+				++it;
+				continue;
+			}
+
+			const GLenum result = gl::ClientWaitSync(it->mFence, 0, 0);
+			if (result == gl::ALREADY_SIGNALED || result == gl::CONDITION_SATISFIED)
+			{
+				gl::DeleteSync(it->mFence);
+				delete_buffer(it->mBuffer);
+				it = mvRetired.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+}
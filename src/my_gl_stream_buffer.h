@@ -0,0 +1,98 @@
+/*!
+\brief	Ring buffer to stream per-frame dynamic data (vertices, indices, uniforms) to the GPU.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"
+
+#include <vector>	// std::vector
+
+namespace my_gl_core
+{
+	/// \brief	Sub-allocates aligned ranges from one big GL buffer that is split in one
+	/// partition per frame in flight. Each partition is protected by a fence, so the CPU only
+	/// waits for the GPU when it laps it.
+	/// When ARB_buffer_storage is available the buffer is persistently mapped, otherwise every
+	/// range is mapped unsynchronized (the fences already guarantee the GPU is not reading it).
+	/// IMPORTANT(Borja): Needs a current OpenGL context during the whole lifetime of the object.
+	class StreamBuffer
+	{
+	public:
+		/// \brief	A range of the buffer the user can write into until StreamBuffer::Commit is called.
+		struct Range
+		{
+			void *		mpData{ nullptr };
+			GLuint		mBuffer{ 0 };
+			GLintptr	mOffset{ 0 };	// offset in bytes from the start of mBuffer
+			GLsizeiptr	mSize{ 0 };
+			unsigned	mGeneration{ 0 };	// of mBuffer, see StreamBuffer::getGeneration
+		};
+
+		struct Stats
+		{
+			GLsizeiptr	mFrameBytes{ 0 };		// bytes allocated in the current frame
+			GLsizeiptr	mHighWaterMark{ 0 };	// max bytes allocated in a single frame
+			GLsizeiptr	mPartitionSize{ 0 };	// bytes available per frame
+			unsigned	mAllocations{ 0 };		// allocations in the current frame
+			unsigned	mWaitStalls{ 0 };		// times the CPU had to wait for the GPU
+			double		mWaitMs{ 0.0 };			// total time spent waiting for the GPU
+			unsigned	mGrowCount{ 0 };		// times the buffer had to be reallocated
+		};
+
+		/// \param	partition_size	Initial number of bytes that can be allocated per frame.
+		StreamBuffer(GLsizeiptr partition_size, unsigned frames_in_flight = 3);
+		~StreamBuffer();
+		StreamBuffer(const StreamBuffer &) = delete;
+		StreamBuffer & operator=(const StreamBuffer &) = delete;
+
+		/// \brief	Allocates a range from the current frame partition,
+		/// grows the buffer if the partition is full.
+		/// \param	alignment	Doesn't need to be a power of two (i.e. sizeof(vertex) to use base vertex).
+		Range Allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+		/// \brief	Makes the data written to the range visible to the GPU,
+		/// needs to be called before issuing the draw calls that use it.
+		void Commit(const Range & range);
+		/// \brief	Fences the data of this frame and moves to the next partition.
+		/// Window calls it when swapping buffers.
+		void EndFrame();
+
+		/// \return	Current buffer, changes when the buffer grows.
+		GLuint getBuffer() const { return mBuffer; }
+		/// \return	Increased every time the buffer grows. The name of a retired buffer can be given
+		/// back by GL to a new one, so the users that keep the buffer attached (i.e. to a vertex array)
+		/// have to compare the name and the generation.
+		unsigned getGeneration() const { return mGeneration; }
+		bool isPersistent() const { return mbPersistent; }
+		const Stats & getStats() const { return mStats; }
+
+	private:
+		void CreateBuffer(GLsizeiptr partition_size);
+		/// \brief	Waits until the GPU is done with the current partition.
+		void WaitForPartition();
+		/// \brief	Deletes the old buffers the GPU is not using anymore.
+		void ReleaseRetiredBuffers();
+
+		/// \brief	Old buffer that can't be deleted until the frames that used it are done.
+		struct Retired
+		{
+			GLuint	mBuffer;
+			GLsync	mFence;
+		};
+
+		GLuint	mBuffer{ 0 };
+		unsigned	mGeneration{ 0 };
+		char *	mpMapped{ nullptr };	// only used by the persistent path
+		bool	mbPersistent{ false };
+		bool	mbUseDSA{ false };
+		bool	mbPartitionReady{ false };
+		bool	mbRangeMapped{ false };
+
+		unsigned	mPartition{ 0 };
+		GLsizeiptr	mHead{ 0 };		// offset inside the current partition
+
+		std::vector<GLsync>		mvFences;	// one per partition
+		std::vector<Retired>	mvRetired;
+		Stats mStats;
+	};
+}
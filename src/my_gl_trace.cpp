@@ -0,0 +1,1461 @@
+/*!
+\brief	GL command tracer: hooks the entry points to record every call into a file, and replays the file
+measuring every call.
+
+A trace is a header (the size of the window and the names of the entry points, so traces of other builds
+can be replayed) followed by records:
+	[u16 function][u32 size][arguments][memory read before the call][result][memory written by the call]
+Arguments are stored raw, pointers as 64 bits. The memory behind the pointers is stored as blobs of
+[u32 size][padding to 8][bytes], what each function reads is described by its Rule.
+*/
+
+#include "my_gl_trace.h"
+#include "Log.h"			// APP_LOG_INFO
+
+#include <fstream>			// std::ifstream, std::ofstream
+#include <string>			// std::string
+#include <tuple>			// std::tuple
+#include <utility>			// std::index_sequence
+#include <type_traits>		// std::enable_if_t, std::is_pointer
+#include <unordered_map>	// std::unordered_map
+#include <algorithm>		// std::sort, std::max
+#include <chrono>			// std::chrono::high_resolution_clock
+#include <stdexcept>		// std::runtime_error
+#include <cstring>			// std::memcpy, std::strlen
+#include <cstdint>			// std::uint64_t
+
+namespace my_gl_core
+{
+	namespace
+	{
+		enum Function : unsigned short
+		{
+#define MY_GL_TRACE_FUNCTION(space, name) FN_##name,
+#include "my_gl_trace_functions.h"
+#undef MY_GL_TRACE_FUNCTION
+			FUNCTION_COUNT,
+		};
+
+		const char * const s_FunctionNames[FUNCTION_COUNT] =
+		{
+#define MY_GL_TRACE_FUNCTION(space, name) #name,
+#include "my_gl_trace_functions.h"
+#undef MY_GL_TRACE_FUNCTION
+		};
+
+		// records that are not calls
+		constexpr unsigned short s_FrameMarker = 0xFFFF;
+		constexpr unsigned short s_MappedWrite = 0xFFFE;
+
+		constexpr char s_Magic[4] = { 'G', 'L', 'T', 'R' };
+		constexpr std::uint32_t s_Version = 1;
+		/// \brief	Offset of the frame count in the header, it is written when the trace ends.
+		constexpr std::streamoff s_FramesOffset = sizeof(s_Magic) + sizeof(std::uint32_t) + 2 * sizeof(std::int32_t);
+		/// \brief	Blob size that keeps the pointer as it was, i.e. an offset into a bound buffer.
+		constexpr std::uint32_t s_NoBlob = 0xFFFFFFFF;
+		/// \brief	Blobs are aligned in the file so the replay can hand them to GL where they are.
+		constexpr std::size_t s_BlobAlignment = 8;
+		/// \brief	Where the functions that write to client memory write when replaying, the readbacks
+		/// that don't fit grow it.
+		constexpr std::size_t s_ScratchSize = 64 * 1024 * 1024;
+
+		using Clock = std::chrono::high_resolution_clock;
+
+#pragma region // Trace
+		/// \brief	Range of a buffer the application has mapped, to record what it wrote when unmapping it.
+		struct Mapping
+		{
+			const void *	mpData;
+			GLsizeiptr		mLength;
+			GLbitfield		mAccess;
+		};
+
+		struct Trace
+		{
+			std::string mRequestedFile;
+			unsigned mRequestedFrames{ 0 };
+
+			std::ofstream mFile;
+			bool mbActive{ false };
+			unsigned mFramesLeft{ 0 };
+			unsigned mFrames{ 0 };
+			/// \brief	Records of the current frame, written to the file when the frame ends.
+			std::vector<unsigned char> mvRecords;
+			std::uint64_t mWritten{ 0 };
+			std::size_t mRecordStart{ 0 };
+
+			std::unordered_map<GLuint, Mapping> mMappings;
+			std::string mStrings;	// temporary for the string lists
+
+			void Put(const void * data, std::size_t size)
+			{
+				const unsigned char * bytes = static_cast<const unsigned char *>(data);
+				mvRecords.insert(mvRecords.end(), bytes, bytes + size);
+			}
+			template <typename T>
+			void Put(const T & value)
+			{
+				Put(&value, sizeof(T));
+			}
+			/// \brief	A null pointer is stored as an empty blob.
+			void PutBlob(const void * data, std::size_t size)
+			{
+				if (data == nullptr)
+					size = 0;
+				Put(static_cast<std::uint32_t>(size));
+				if (size == 0)
+					return;
+
+				// the position in the file is what has to be aligned
+				const std::size_t misalignment = static_cast<std::size_t>((mWritten + mvRecords.size()) % s_BlobAlignment);
+				if (misalignment != 0)
+					mvRecords.resize(mvRecords.size() + s_BlobAlignment - misalignment, 0);
+				Put(data, size);
+			}
+			void PutNoBlob()
+			{
+				Put(s_NoBlob);
+			}
+
+			void BeginRecord(unsigned short function)
+			{
+				Put(function);
+				mRecordStart = mvRecords.size();
+				Put(std::uint32_t{ 0 });
+			}
+			void EndRecord()
+			{
+				const std::uint32_t size = static_cast<std::uint32_t>(mvRecords.size() - mRecordStart - sizeof(std::uint32_t));
+				std::memcpy(mvRecords.data() + mRecordStart, &size, sizeof(size));
+			}
+
+			void Flush()
+			{
+				mFile.write(reinterpret_cast<const char *>(mvRecords.data()), mvRecords.size());
+				mWritten += mvRecords.size();
+				mvRecords.clear();
+			}
+		};
+
+		Trace & get_trace()
+		{
+			static Trace trace;
+			return trace;
+		}
+
+		template <typename T>
+		std::enable_if_t<!std::is_pointer<T>::value> encode(Trace & trace, T value)
+		{
+			trace.Put(value);
+		}
+		template <typename T>
+		std::enable_if_t<std::is_pointer<T>::value> encode(Trace & trace, T value)
+		{
+			trace.Put(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+		}
+
+		template <typename T>
+		std::enable_if_t<!std::is_pointer<T>::value, std::uint64_t> to_bits(T value)
+		{
+			return static_cast<std::uint64_t>(value);
+		}
+		template <typename T>
+		std::enable_if_t<std::is_pointer<T>::value, std::uint64_t> to_bits(T value)
+		{
+			return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+		}
+#pragma endregion
+
+#pragma region // Replayer
+		/// \brief	Reads a record, throws if the file is truncated.
+		class Reader
+		{
+		public:
+			/// \param	base	Start of the records in the file, the blobs are aligned relative to it.
+			Reader(const unsigned char * base, const unsigned char * begin, const unsigned char * end)
+				: mpBase(base)
+				, mpCurrent(begin)
+				, mpEnd(end)
+			{}
+
+			template <typename T>
+			T Get()
+			{
+				T value;
+				std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+				return value;
+			}
+			/// \param	raw	Pointer recorded in the arguments.
+			/// \return	Where the blob is in the file, the raw pointer if there wasn't one and nullptr if it was empty.
+			const void * GetBlob(const void * raw, std::uint32_t * size = nullptr)
+			{
+				const std::uint32_t blob_size = Get<std::uint32_t>();
+				if (size)
+					*size = blob_size == s_NoBlob ? 0 : blob_size;
+				if (blob_size == s_NoBlob)
+					return raw;
+				if (blob_size == 0)
+					return nullptr;
+
+				const std::size_t misalignment = static_cast<std::size_t>(mpCurrent - mpBase) % s_BlobAlignment;
+				if (misalignment != 0)
+					Skip(s_BlobAlignment - misalignment);
+				return Skip(blob_size);
+			}
+
+		private:
+			const unsigned char * Skip(std::size_t size)
+			{
+				if (static_cast<std::size_t>(mpEnd - mpCurrent) < size)
+					throw std::runtime_error{ "The GL trace is truncated." };
+				const unsigned char * data = mpCurrent;
+				mpCurrent += size;
+				return data;
+			}
+
+			const unsigned char * mpBase;
+			const unsigned char * mpCurrent;
+			const unsigned char * mpEnd;
+		};
+
+		/// \brief	Live mapping of a buffer that was mapped when traced.
+		struct LiveMapping
+		{
+			unsigned char *	mpData;
+			std::int64_t	mOffset;	// of the mapped range in the buffer
+		};
+
+		struct Replayer
+		{
+			bool mbFinishEveryCall{ false };
+			std::vector<unsigned char> mvScratch;
+			std::vector<const GLchar *> mvStrings;
+			/// \brief	Traced fences to the ones created when replaying.
+			std::unordered_map<std::uint64_t, GLsync> mSyncs;
+			std::unordered_map<GLuint, LiveMapping> mMappings;
+			unsigned mDivergences{ 0 };
+		};
+
+		/// \brief	Scalars are read as they were, pointers to client memory keep the traced value (it is
+		/// either an offset into a buffer or replaced by the Rule) and the ones GL writes to go to scratch.
+		/// Untyped pointers GL writes to keep the traced value too, their Readback rule knows if they are
+		/// an offset into the pixel pack buffer and how much scratch they need.
+		template <typename T, typename = void>
+		struct Decoder
+		{
+			static T Get(Replayer &, Reader & reader)
+			{
+				return reader.Get<T>();
+			}
+		};
+		template <typename T>
+		struct Decoder<T *, std::enable_if_t<std::is_const<T>::value>>
+		{
+			static T * Get(Replayer &, Reader & reader)
+			{
+				return reinterpret_cast<T *>(static_cast<std::uintptr_t>(reader.Get<std::uint64_t>()));
+			}
+		};
+		template <typename T>
+		struct Decoder<T *, std::enable_if_t<!std::is_const<T>::value>>
+		{
+			static T * Get(Replayer & replayer, Reader & reader)
+			{
+				if (reader.Get<std::uint64_t>() == 0)
+					return nullptr;
+				return static_cast<T *>(static_cast<void *>(replayer.mvScratch.data()));
+			}
+		};
+		template <>
+		struct Decoder<void *>
+		{
+			static void * Get(Replayer &, Reader & reader)
+			{
+				return reinterpret_cast<void *>(static_cast<std::uintptr_t>(reader.Get<std::uint64_t>()));
+			}
+		};
+		template <>
+		struct Decoder<GLsync>
+		{
+			static GLsync Get(Replayer & replayer, Reader & reader)
+			{
+				const auto it = replayer.mSyncs.find(reader.Get<std::uint64_t>());
+				return it != replayer.mSyncs.end() ? it->second : nullptr;
+			}
+		};
+
+		/// \brief	Pointers to client memory other than void (which is an offset into a bound buffer in the core
+		/// profile), the function can only be replayed if its Rule records that memory. Untyped pointers
+		/// GL writes to need a Readback rule.
+		template <typename T>
+		struct IsClientMemory : std::false_type {};
+		template <typename T>
+		struct IsClientMemory<const T *> : std::integral_constant<bool, !std::is_void<T>::value> {};
+		template <>
+		struct IsClientMemory<void *> : std::true_type {};
+
+		template <typename ... Args>
+		struct AnyClientMemory : std::false_type {};
+		template <typename T, typename ... Args>
+		struct AnyClientMemory<T, Args...> : std::integral_constant<bool, IsClientMemory<T>::value || AnyClientMemory<Args...>::value> {};
+#pragma endregion
+
+#pragma region // Rules
+		/// \brief	Describes the memory a function reads and writes besides its arguments. Before and After
+		/// record it when tracing, Replay and Check read it back in the same order when replaying.
+		struct NoRule
+		{
+			/// \brief	If the function takes client memory, if it is recorded.
+			static const bool HANDLED = false;
+
+			template <typename Tuple>
+			static void Before(Trace &, const Tuple &) {}
+			template <typename Tuple>
+			static void After(Trace &, const Tuple &, std::uint64_t /*result*/) {}
+			/// \brief	Replaces the traced pointers with the recorded memory.
+			template <typename Tuple>
+			static void Replay(Replayer &, Reader &, Tuple &) {}
+			/// \brief	Compares what the call wrote or returned with the trace.
+			template <typename Tuple>
+			static void Check(Replayer &, Reader &, const Tuple &, std::uint64_t /*traced*/, std::uint64_t /*live*/) {}
+		};
+
+		template <Function ID>
+		struct Rule : NoRule {};
+
+		/// \brief	Argument I of the function, or the fallback if I is -1.
+		template <int I>
+		struct Optional
+		{
+			template <typename Tuple, typename T>
+			static T Get(const Tuple & args, T)
+			{
+				return static_cast<T>(std::get<I>(args));
+			}
+			template <typename Tuple, typename T>
+			static void Set(Tuple & args, T value)
+			{
+				std::get<I>(args) = value;
+			}
+		};
+		template <>
+		struct Optional<-1>
+		{
+			template <typename Tuple, typename T>
+			static T Get(const Tuple &, T fallback)
+			{
+				return fallback;
+			}
+			template <typename Tuple, typename T>
+			static void Set(Tuple &, T) {}
+		};
+
+		template <int DATA, typename Tuple>
+		void replace_blob(Reader & reader, Tuple & args)
+		{
+			using Pointer = std::tuple_element_t<DATA, Tuple>;
+			std::get<DATA>(args) = static_cast<Pointer>(reader.GetBlob(std::get<DATA>(args)));
+		}
+#pragma endregion
+
+#pragma region // Hooks
+		/// \brief	Calls the function and keeps its result, if it has one.
+		template <typename R>
+		struct Result
+		{
+			template <typename FN, typename Tuple, std::size_t ... I>
+			Result(FN function, const Tuple & args, std::index_sequence<I...>)
+				: mValue(function(std::get<I>(args)...))
+			{}
+			R get() const { return mValue; }
+			std::uint64_t getBits() const { return to_bits(mValue); }
+			void Record(Trace & trace) const { trace.Put(getBits()); }
+			static std::uint64_t ReadTraced(Reader & reader) { return reader.Get<std::uint64_t>(); }
+
+			R mValue;
+		};
+		template <>
+		struct Result<void>
+		{
+			template <typename FN, typename Tuple, std::size_t ... I>
+			Result(FN function, const Tuple & args, std::index_sequence<I...>)
+			{
+				function(std::get<I>(args)...);
+			}
+			void get() const {}
+			std::uint64_t getBits() const { return 0; }
+			void Record(Trace &) const {}
+			static std::uint64_t ReadTraced(Reader &) { return 0; }
+		};
+
+		/// \brief	Replaces the entry point with one that records the call and forwards it.
+		template <Function ID, typename FN>
+		struct Hook;
+		template <Function ID, typename R, typename ... Args>
+		struct Hook<ID, R(CODEGEN_FUNCPTR *)(Args...)>
+		{
+			using FN = R(CODEGEN_FUNCPTR *)(Args...);
+			static FN sOriginal;
+
+			/// \brief	Entry points that weren't loaded stay null.
+			static void Swap(FN & slot, bool install)
+			{
+				if (install)
+				{
+					if (slot == nullptr)
+						return;
+					sOriginal = slot;
+					slot = &Call;
+				}
+				else if (sOriginal != nullptr)
+				{
+					slot = sOriginal;
+					sOriginal = nullptr;
+				}
+			}
+
+			static R CODEGEN_FUNCPTR Call(Args ... args)
+			{
+				Trace & trace = get_trace();
+				const std::tuple<Args...> tuple{ args... };
+
+				trace.BeginRecord(ID);
+				// IMPORTANT(Borja): The clauses of an array initializer are evaluated left to right, so the
+				// arguments are encoded in order (the arguments of a function call could be in any order).
+				const int expand[] = { 0, (encode(trace, args), 0)... };
+				(void)expand;
+				Rule<ID>::Before(trace, tuple);
+
+				const Result<R> result{ sOriginal, tuple, std::index_sequence_for<Args...>{} };
+				result.Record(trace);
+				Rule<ID>::After(trace, tuple, result.getBits());
+				trace.EndRecord();
+
+				return result.get();
+			}
+		};
+		template <Function ID, typename R, typename ... Args>
+		typename Hook<ID, R(CODEGEN_FUNCPTR *)(Args...)>::FN Hook<ID, R(CODEGEN_FUNCPTR *)(Args...)>::sOriginal = nullptr;
+
+		void swap_hooks(bool install)
+		{
+#define MY_GL_TRACE_FUNCTION(space, name) Hook<FN_##name, decltype(space::name)>::Swap(space::name, install);
+#include "my_gl_trace_functions.h"
+#undef MY_GL_TRACE_FUNCTION
+		}
+
+		/// \brief	The rules query the state with the original entry point so the queries aren't traced,
+		/// when replaying the hooks aren't installed and the entry points are the original ones.
+		GLint get_integer(GLenum pname)
+		{
+			const auto original = Hook<FN_GetIntegerv, decltype(gl::GetIntegerv)>::sOriginal;
+			GLint value = 0;
+			(original ? original : gl::GetIntegerv)(pname, &value);
+			return value;
+		}
+		GLint get_tex_level_integer(GLenum target, GLint level, GLenum pname)
+		{
+			const auto original = Hook<FN_GetTexLevelParameteriv, decltype(gl::GetTexLevelParameteriv)>::sOriginal;
+			GLint value = 0;
+			(original ? original : gl::GetTexLevelParameteriv)(target, level, pname, &value);
+			return value;
+		}
+		GLuint get_bound_buffer(GLenum target)
+		{
+			GLenum binding = 0;
+			switch (target)
+			{
+			case gl::ARRAY_BUFFER:				binding = gl::ARRAY_BUFFER_BINDING; break;
+			case gl::ELEMENT_ARRAY_BUFFER:		binding = gl::ELEMENT_ARRAY_BUFFER_BINDING; break;
+			case gl::COPY_READ_BUFFER:			binding = gl::COPY_READ_BUFFER_BINDING; break;
+			case gl::COPY_WRITE_BUFFER:			binding = gl::COPY_WRITE_BUFFER_BINDING; break;
+			case gl::PIXEL_PACK_BUFFER:			binding = gl::PIXEL_PACK_BUFFER_BINDING; break;
+			case gl::PIXEL_UNPACK_BUFFER:		binding = gl::PIXEL_UNPACK_BUFFER_BINDING; break;
+			case gl::UNIFORM_BUFFER:			binding = gl::UNIFORM_BUFFER_BINDING; break;
+			case gl::TEXTURE_BUFFER:			binding = gl::TEXTURE_BINDING_BUFFER; break;
+			case gl::TRANSFORM_FEEDBACK_BUFFER:	binding = gl::TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+			case gl::DRAW_INDIRECT_BUFFER:		binding = gl::DRAW_INDIRECT_BUFFER_BINDING; break;
+			case gl::ATOMIC_COUNTER_BUFFER:		binding = gl::ATOMIC_COUNTER_BUFFER_BINDING; break;
+			default:							return 0;
+			}
+			return static_cast<GLuint>(get_integer(binding));
+		}
+		GLsizeiptr get_buffer_size(GLenum target)
+		{
+			GLint size = 0;
+			Hook<FN_GetBufferParameteriv, decltype(gl::GetBufferParameteriv)>::sOriginal(target, gl::BUFFER_SIZE, &size);
+			return size;
+		}
+
+		/// \brief	Bytes GL reads from client memory for an image following the unpack state, or writes
+		/// following the pack state.
+		std::size_t get_image_size(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, bool pack = false)
+		{
+			if (width <= 0 || height <= 0 || depth <= 0)
+				return 0;
+
+			std::size_t pixel = 0;
+			switch (type)
+			{
+			case gl::UNSIGNED_BYTE_3_3_2:
+			case gl::UNSIGNED_BYTE_2_3_3_REV:
+				pixel = 1; break;
+			case gl::UNSIGNED_SHORT_5_6_5:
+			case gl::UNSIGNED_SHORT_5_6_5_REV:
+			case gl::UNSIGNED_SHORT_4_4_4_4:
+			case gl::UNSIGNED_SHORT_4_4_4_4_REV:
+			case gl::UNSIGNED_SHORT_5_5_5_1:
+			case gl::UNSIGNED_SHORT_1_5_5_5_REV:
+				pixel = 2; break;
+			case gl::UNSIGNED_INT_8_8_8_8:
+			case gl::UNSIGNED_INT_8_8_8_8_REV:
+			case gl::UNSIGNED_INT_10_10_10_2:
+			case gl::UNSIGNED_INT_2_10_10_10_REV:
+			case gl::UNSIGNED_INT_24_8:
+			case gl::UNSIGNED_INT_10F_11F_11F_REV:
+			case gl::UNSIGNED_INT_5_9_9_9_REV:
+				pixel = 4; break;
+			case gl::FLOAT_32_UNSIGNED_INT_24_8_REV:
+				pixel = 8; break;
+			default:
+			{
+				std::size_t components = 4;
+				switch (format)
+				{
+				case gl::RED: case gl::GREEN: case gl::BLUE: case gl::RED_INTEGER: case gl::GREEN_INTEGER: case gl::BLUE_INTEGER:
+				case gl::DEPTH_COMPONENT: case gl::STENCIL_INDEX:
+					components = 1; break;
+				case gl::RG: case gl::RG_INTEGER: case gl::DEPTH_STENCIL:
+					components = 2; break;
+				case gl::RGB: case gl::BGR: case gl::RGB_INTEGER: case gl::BGR_INTEGER:
+					components = 3; break;
+				}
+				std::size_t component = 4;
+				switch (type)
+				{
+				case gl::UNSIGNED_BYTE: case gl::BYTE:						component = 1; break;
+				case gl::UNSIGNED_SHORT: case gl::SHORT: case gl::HALF_FLOAT:	component = 2; break;
+				}
+				pixel = components * component;
+			}
+			}
+
+			const std::size_t alignment = static_cast<std::size_t>(std::max(get_integer(pack ? gl::PACK_ALIGNMENT : gl::UNPACK_ALIGNMENT), 1));
+			const GLint row_length = get_integer(pack ? gl::PACK_ROW_LENGTH : gl::UNPACK_ROW_LENGTH);
+			const GLint image_height = get_integer(pack ? gl::PACK_IMAGE_HEIGHT : gl::UNPACK_IMAGE_HEIGHT);
+			const std::size_t row = (static_cast<std::size_t>(row_length > 0 ? row_length : width) * pixel + alignment - 1) / alignment * alignment;
+			const std::size_t image = row * static_cast<std::size_t>(image_height > 0 ? image_height : height);
+			// the last row isn't padded
+			return image * (depth - 1) + row * (height - 1) + pixel * width;
+		}
+#pragma endregion
+
+#pragma region // Rule kinds
+		/// \brief	SIZE bytes at DATA, kept as an offset when UNPACK and a pixel unpack buffer is bound.
+		template <int SIZE, int DATA, bool UNPACK = false>
+		struct SizedBlob : NoRule
+		{
+			static const bool HANDLED = true;
+
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				if (UNPACK && get_integer(gl::PIXEL_UNPACK_BUFFER_BINDING) != 0)
+					trace.PutNoBlob();
+				else
+					trace.PutBlob(std::get<DATA>(args), static_cast<std::size_t>(std::get<SIZE>(args)));
+			}
+			template <typename Tuple>
+			static void Replay(Replayer &, Reader & reader, Tuple & args)
+			{
+				replace_blob<DATA>(reader, args);
+			}
+		};
+
+		/// \brief	Texture upload of WIDTH x HEIGHT x DEPTH pixels (-1 for the dimensions the function doesn't have).
+		template <int WIDTH, int HEIGHT, int DEPTH, int FORMAT, int TYPE, int DATA>
+		struct Image : NoRule
+		{
+			static const bool HANDLED = true;
+
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				if (std::get<DATA>(args) != nullptr && get_integer(gl::PIXEL_UNPACK_BUFFER_BINDING) != 0)
+				{
+					trace.PutNoBlob();
+					return;
+				}
+				const std::size_t size = get_image_size(std::get<WIDTH>(args),
+														Optional<HEIGHT>::Get(args, GLsizei{ 1 }),
+														Optional<DEPTH>::Get(args, GLsizei{ 1 }),
+														std::get<FORMAT>(args), std::get<TYPE>(args));
+				trace.PutBlob(std::get<DATA>(args), size);
+			}
+			template <typename Tuple>
+			static void Replay(Replayer &, Reader & reader, Tuple & args)
+			{
+				replace_blob<DATA>(reader, args);
+			}
+		};
+
+		/// \brief	COUNT elements of BYTES at DATA.
+		template <int COUNT, int DATA, std::size_t BYTES>
+		struct Array : NoRule
+		{
+			static const bool HANDLED = true;
+
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				trace.PutBlob(std::get<DATA>(args), static_cast<std::size_t>(std::max(static_cast<int>(std::get<COUNT>(args)), 0)) * BYTES);
+			}
+			template <typename Tuple>
+			static void Replay(Replayer &, Reader & reader, Tuple & args)
+			{
+				replace_blob<DATA>(reader, args);
+			}
+		};
+
+		/// \brief	Always BYTES at DATA.
+		template <int DATA, std::size_t BYTES>
+		struct Fixed : Array<-1, DATA, BYTES>
+		{
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				trace.PutBlob(std::get<DATA>(args), BYTES);
+			}
+		};
+
+		/// \brief	Parameters that are a vector of 4 for some values of KEY (the border color, the swizzle and
+		/// the clear color of ClearBuffer) and a single value for the rest.
+		template <int KEY, int DATA>
+		struct Params : Array<-1, DATA, 4>
+		{
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				const GLenum key = std::get<KEY>(args);
+				const bool vector = key == gl::TEXTURE_BORDER_COLOR || key == gl::TEXTURE_SWIZZLE_RGBA || key == gl::COLOR;
+				trace.PutBlob(std::get<DATA>(args), vector ? 16 : 4);
+			}
+		};
+
+		/// \brief	Null terminated string at DATA.
+		template <int DATA>
+		struct String : Array<-1, DATA, 1>
+		{
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				const GLchar * string = std::get<DATA>(args);
+				trace.PutBlob(string, string ? std::strlen(string) + 1 : 0);
+			}
+		};
+
+		/// \brief	COUNT strings at DATA, with their lengths at LENGTH (-1 if the function doesn't take them).
+		/// They are recorded one after another with their terminators, and replayed without lengths.
+		template <int COUNT, int DATA, int LENGTH>
+		struct StringList : NoRule
+		{
+			static const bool HANDLED = true;
+
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				const GLchar * const * strings = std::get<DATA>(args);
+				const GLint * lengths = Optional<LENGTH>::Get(args, static_cast<const GLint *>(nullptr));
+				trace.mStrings.clear();
+				for (GLsizei i = 0; strings && i < std::get<COUNT>(args); ++i)
+				{
+					if (lengths && lengths[i] >= 0)
+						trace.mStrings.append(strings[i], lengths[i]);
+					else
+						trace.mStrings.append(strings[i]);
+					trace.mStrings.push_back('\0');
+				}
+				trace.PutBlob(trace.mStrings.data(), trace.mStrings.size());
+			}
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader & reader, Tuple & args)
+			{
+				std::uint32_t size = 0;
+				const GLchar * strings = static_cast<const GLchar *>(reader.GetBlob(nullptr, &size));
+				replayer.mvStrings.clear();
+				for (std::uint32_t i = 0; i < size; i += static_cast<std::uint32_t>(std::strlen(strings + i)) + 1)
+					replayer.mvStrings.push_back(strings + i);
+
+				std::get<DATA>(args) = replayer.mvStrings.empty() ? nullptr : replayer.mvStrings.data();
+				Optional<LENGTH>::Set(args, static_cast<const GLint *>(nullptr));
+			}
+		};
+
+		/// \brief	Names generated by the function, they have to match when replaying because the names
+		/// aren't remapped.
+		template <int COUNT, int DATA>
+		struct Names : NoRule
+		{
+			template <typename Tuple>
+			static void After(Trace & trace, const Tuple & args, std::uint64_t)
+			{
+				trace.PutBlob(std::get<DATA>(args), static_cast<std::size_t>(std::max(static_cast<int>(std::get<COUNT>(args)), 0)) * sizeof(GLuint));
+			}
+			template <typename Tuple>
+			static void Check(Replayer & replayer, Reader & reader, const Tuple & args, std::uint64_t, std::uint64_t)
+			{
+				std::uint32_t size = 0;
+				const void * traced = reader.GetBlob(nullptr, &size);
+				if (traced && std::memcmp(traced, std::get<DATA>(args), size) != 0)
+					++replayer.mDivergences;
+			}
+		};
+
+		/// \brief	Name returned by the function.
+		struct ReturnedName : NoRule
+		{
+			template <typename Tuple>
+			static void Check(Replayer & replayer, Reader &, const Tuple &, std::uint64_t traced, std::uint64_t live)
+			{
+				if (traced != live)
+					++replayer.mDivergences;
+			}
+		};
+
+		template <typename A, typename B>
+		struct Both
+		{
+			static const bool HANDLED = A::HANDLED || B::HANDLED;
+
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				A::Before(trace, args);
+				B::Before(trace, args);
+			}
+			template <typename Tuple>
+			static void After(Trace & trace, const Tuple & args, std::uint64_t result)
+			{
+				A::After(trace, args, result);
+				B::After(trace, args, result);
+			}
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader & reader, Tuple & args)
+			{
+				A::Replay(replayer, reader, args);
+				B::Replay(replayer, reader, args);
+			}
+			template <typename Tuple>
+			static void Check(Replayer & replayer, Reader & reader, const Tuple & args, std::uint64_t traced, std::uint64_t live)
+			{
+				A::Check(replayer, reader, args, traced, live);
+				B::Check(replayer, reader, args, traced, live);
+			}
+		};
+
+		/// \brief	Untyped memory GL writes at DATA. When replaying it is written to scratch, unless PACK and a
+		/// pixel pack buffer is bound: then DATA is an offset into the buffer and it is kept.
+		template <bool PACK, int DATA>
+		struct Readback : NoRule
+		{
+			static const bool HANDLED = true;
+
+			/// \return	True if the traced pointer is used as it is (null or an offset).
+			template <typename Tuple>
+			static bool KeepPointer(const Tuple & args)
+			{
+				return std::get<DATA>(args) == nullptr || (PACK && get_integer(gl::PIXEL_PACK_BUFFER_BINDING) != 0);
+			}
+			template <typename Tuple>
+			static void Redirect(Replayer & replayer, Tuple & args, std::size_t size)
+			{
+				if (replayer.mvScratch.size() < size)
+					replayer.mvScratch.resize(size);
+				std::get<DATA>(args) = replayer.mvScratch.data();
+			}
+		};
+
+		/// \brief	SIZE bytes at DATA.
+		template <int SIZE, int DATA>
+		struct SizedReadback : Readback<false, DATA>
+		{
+			using Base = Readback<false, DATA>;
+
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader &, Tuple & args)
+			{
+				if (!Base::KeepPointer(args))
+					Base::Redirect(replayer, args, static_cast<std::size_t>(std::max(static_cast<std::int64_t>(std::get<SIZE>(args)), std::int64_t{ 0 })));
+			}
+		};
+
+		/// \brief	WIDTH x HEIGHT pixels of the read framebuffer.
+		template <int WIDTH, int HEIGHT, int FORMAT, int TYPE, int DATA>
+		struct PixelReadback : Readback<true, DATA>
+		{
+			using Base = Readback<true, DATA>;
+
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader &, Tuple & args)
+			{
+				if (!Base::KeepPointer(args))
+				{
+					Base::Redirect(replayer, args, get_image_size(std::get<WIDTH>(args), std::get<HEIGHT>(args), 1,
+																  std::get<FORMAT>(args), std::get<TYPE>(args), true));
+				}
+			}
+		};
+
+		/// \brief	A level of the texture bound to the target at argument 0, with the level at argument 1.
+		/// FORMAT and TYPE are -1 if it is compressed.
+		template <int FORMAT, int TYPE, int DATA>
+		struct TextureReadback : Readback<true, DATA>
+		{
+			using Base = Readback<true, DATA>;
+
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader &, Tuple & args)
+			{
+				if (Base::KeepPointer(args))
+					return;
+
+				const GLenum target = std::get<0>(args);
+				const GLint level = std::get<1>(args);
+				const GLenum format = Optional<FORMAT>::Get(args, GLenum{ 0 });
+				const std::size_t size = format == 0
+					? static_cast<std::size_t>(std::max(get_tex_level_integer(target, level, gl::TEXTURE_COMPRESSED_IMAGE_SIZE), 0))
+					: get_image_size(get_tex_level_integer(target, level, gl::TEXTURE_WIDTH),
+									 get_tex_level_integer(target, level, gl::TEXTURE_HEIGHT),
+									 get_tex_level_integer(target, level, gl::TEXTURE_DEPTH),
+									 format, Optional<TYPE>::Get(args, GLenum{ 0 }), true);
+				Base::Redirect(replayer, args, size);
+			}
+		};
+
+		/// \brief	Fences are pointers, the replay maps the traced ones to the ones it creates.
+		struct NewSync : NoRule
+		{
+			template <typename Tuple>
+			static void Check(Replayer & replayer, Reader &, const Tuple &, std::uint64_t traced, std::uint64_t live)
+			{
+				replayer.mSyncs[traced] = reinterpret_cast<GLsync>(static_cast<std::uintptr_t>(live));
+			}
+		};
+
+		/// \brief	Mapping of the buffer bound to the target (or the named buffer) at argument 0.
+		/// OFFSET and LENGTH are -1 for glMapBuffer, which maps everything and takes an access enum.
+		template <bool NAMED, int OFFSET, int LENGTH, int ACCESS>
+		struct MapRange : NoRule
+		{
+			template <typename Tuple>
+			static void After(Trace & trace, const Tuple & args, std::uint64_t result)
+			{
+				const GLuint target_or_buffer = std::get<0>(args);
+				const GLuint buffer = NAMED ? target_or_buffer : get_bound_buffer(target_or_buffer);
+				const GLintptr offset = Optional<OFFSET>::Get(args, GLintptr{ 0 });
+				const GLsizeiptr length = LENGTH >= 0 ? Optional<LENGTH>::Get(args, GLsizeiptr{ 0 }) : get_buffer_size(target_or_buffer);
+				const GLenum access_enum = std::get<ACCESS>(args);
+				const GLbitfield access = OFFSET >= 0 ? access_enum
+					: access_enum == gl::READ_ONLY ? gl::MAP_READ_BIT
+					: access_enum == gl::WRITE_ONLY ? gl::MAP_WRITE_BIT : gl::MAP_READ_BIT | gl::MAP_WRITE_BIT;
+
+				if (result != 0)
+					trace.mMappings[buffer] = Mapping{ reinterpret_cast<const void *>(static_cast<std::uintptr_t>(result)), length, access };
+				trace.Put(buffer);
+				trace.Put(static_cast<std::int64_t>(offset));
+			}
+			template <typename Tuple>
+			static void Check(Replayer & replayer, Reader & reader, const Tuple &, std::uint64_t, std::uint64_t live)
+			{
+				const GLuint buffer = reader.Get<GLuint>();
+				const std::int64_t offset = reader.Get<std::int64_t>();
+				if (live != 0)
+					replayer.mMappings[buffer] = LiveMapping{ reinterpret_cast<unsigned char *>(static_cast<std::uintptr_t>(live)), offset };
+			}
+		};
+
+		/// \brief	What the application wrote to the mapping, persistent mappings are recorded by
+		/// my_gl_core::trace_mapped_write instead.
+		template <bool NAMED>
+		struct Unmap : NoRule
+		{
+			template <typename Tuple>
+			static void Before(Trace & trace, const Tuple & args)
+			{
+				const GLuint target_or_buffer = std::get<0>(args);
+				const GLuint buffer = NAMED ? target_or_buffer : get_bound_buffer(target_or_buffer);
+				const auto it = trace.mMappings.find(buffer);
+				const bool written = it != trace.mMappings.end()
+					&& (it->second.mAccess & gl::MAP_WRITE_BIT) != 0
+					&& (it->second.mAccess & ext::MAP_PERSISTENT_BIT) == 0;
+
+				trace.Put(buffer);
+				trace.PutBlob(written ? it->second.mpData : nullptr, written ? static_cast<std::size_t>(it->second.mLength) : 0);
+				if (it != trace.mMappings.end())
+					trace.mMappings.erase(it);
+			}
+			template <typename Tuple>
+			static void Replay(Replayer & replayer, Reader & reader, Tuple &)
+			{
+				const GLuint buffer = reader.Get<GLuint>();
+				std::uint32_t size = 0;
+				const void * data = reader.GetBlob(nullptr, &size);
+				const auto it = replayer.mMappings.find(buffer);
+				if (it == replayer.mMappings.end())
+					return;
+				if (data)
+					std::memcpy(it->second.mpData, data, size);
+				replayer.mMappings.erase(it);
+			}
+		};
+#pragma endregion
+
+#pragma region // Rules of the functions
+#define MY_GL_TRACE_RULE(name, ...) template <> struct Rule<FN_##name> : __VA_ARGS__ {};
+		// buffers
+		MY_GL_TRACE_RULE(BufferData, SizedBlob<1, 2>)
+		MY_GL_TRACE_RULE(BufferSubData, SizedBlob<2, 3>)
+		MY_GL_TRACE_RULE(BufferStorage, SizedBlob<1, 2>)
+		MY_GL_TRACE_RULE(NamedBufferData, SizedBlob<1, 2>)
+		MY_GL_TRACE_RULE(NamedBufferSubData, SizedBlob<2, 3>)
+		MY_GL_TRACE_RULE(NamedBufferStorage, SizedBlob<1, 2>)
+		MY_GL_TRACE_RULE(MapBuffer, MapRange<false, -1, -1, 1>)
+		MY_GL_TRACE_RULE(MapBufferRange, MapRange<false, 1, 2, 3>)
+		MY_GL_TRACE_RULE(MapNamedBufferRange, MapRange<true, 1, 2, 3>)
+		MY_GL_TRACE_RULE(UnmapBuffer, Unmap<false>)
+		MY_GL_TRACE_RULE(UnmapNamedBuffer, Unmap<true>)
+
+		// textures
+		MY_GL_TRACE_RULE(TexImage1D, Image<3, -1, -1, 5, 6, 7>)
+		MY_GL_TRACE_RULE(TexImage2D, Image<3, 4, -1, 6, 7, 8>)
+		MY_GL_TRACE_RULE(TexImage3D, Image<3, 4, 5, 7, 8, 9>)
+		MY_GL_TRACE_RULE(TexSubImage1D, Image<3, -1, -1, 4, 5, 6>)
+		MY_GL_TRACE_RULE(TexSubImage2D, Image<4, 5, -1, 6, 7, 8>)
+		MY_GL_TRACE_RULE(TexSubImage3D, Image<5, 6, 7, 8, 9, 10>)
+		MY_GL_TRACE_RULE(TextureSubImage2D, Image<4, 5, -1, 6, 7, 8>)
+		MY_GL_TRACE_RULE(CompressedTexImage1D, SizedBlob<5, 6, true>)
+		MY_GL_TRACE_RULE(CompressedTexImage2D, SizedBlob<6, 7, true>)
+		MY_GL_TRACE_RULE(CompressedTexImage3D, SizedBlob<7, 8, true>)
+		MY_GL_TRACE_RULE(CompressedTexSubImage1D, SizedBlob<5, 6, true>)
+		MY_GL_TRACE_RULE(CompressedTexSubImage2D, SizedBlob<7, 8, true>)
+		MY_GL_TRACE_RULE(CompressedTexSubImage3D, SizedBlob<9, 10, true>)
+		MY_GL_TRACE_RULE(TexParameterfv, Params<1, 2>)
+		MY_GL_TRACE_RULE(TexParameteriv, Params<1, 2>)
+		MY_GL_TRACE_RULE(TexParameterIiv, Params<1, 2>)
+		MY_GL_TRACE_RULE(TexParameterIuiv, Params<1, 2>)
+		MY_GL_TRACE_RULE(SamplerParameterfv, Params<1, 2>)
+		MY_GL_TRACE_RULE(SamplerParameteriv, Params<1, 2>)
+		MY_GL_TRACE_RULE(SamplerParameterIiv, Params<1, 2>)
+		MY_GL_TRACE_RULE(SamplerParameterIuiv, Params<1, 2>)
+		MY_GL_TRACE_RULE(BindTextures, Array<1, 2, sizeof(GLuint)>)
+
+		// readbacks
+		MY_GL_TRACE_RULE(ReadPixels, PixelReadback<2, 3, 4, 5, 6>)
+		MY_GL_TRACE_RULE(GetTexImage, TextureReadback<2, 3, 4>)
+		MY_GL_TRACE_RULE(GetCompressedTexImage, TextureReadback<-1, -1, 2>)
+		MY_GL_TRACE_RULE(GetBufferSubData, SizedReadback<2, 3>)
+		MY_GL_TRACE_RULE(GetProgramBinary, SizedReadback<1, 4>)
+
+		// object names
+		MY_GL_TRACE_RULE(GenBuffers, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenTextures, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenVertexArrays, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenFramebuffers, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenRenderbuffers, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenQueries, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenSamplers, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenTransformFeedbacks, Names<0, 1>)
+		MY_GL_TRACE_RULE(GenProgramPipelines, Names<0, 1>)
+		MY_GL_TRACE_RULE(CreateBuffers, Names<0, 1>)
+		MY_GL_TRACE_RULE(CreateVertexArrays, Names<0, 1>)
+		MY_GL_TRACE_RULE(CreateTextures, Names<1, 2>)
+		MY_GL_TRACE_RULE(CreateShader, ReturnedName)
+		MY_GL_TRACE_RULE(CreateProgram, ReturnedName)
+		MY_GL_TRACE_RULE(DeleteBuffers, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteTextures, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteVertexArrays, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteFramebuffers, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteRenderbuffers, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteQueries, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteSamplers, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteTransformFeedbacks, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(DeleteProgramPipelines, Array<0, 1, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(FenceSync, NewSync)
+
+		// shaders and programs
+		MY_GL_TRACE_RULE(ShaderSource, StringList<1, 2, 3>)
+		MY_GL_TRACE_RULE(TransformFeedbackVaryings, StringList<1, 2, -1>)
+		MY_GL_TRACE_RULE(GetUniformIndices, StringList<1, 2, -1>)
+		MY_GL_TRACE_RULE(CreateShaderProgramv, Both<StringList<1, 2, -1>, ReturnedName>)
+		MY_GL_TRACE_RULE(ProgramBinary, SizedBlob<3, 2>)
+		MY_GL_TRACE_RULE(GetUniformLocation, String<1>)
+		MY_GL_TRACE_RULE(GetAttribLocation, String<1>)
+		MY_GL_TRACE_RULE(GetFragDataLocation, String<1>)
+		MY_GL_TRACE_RULE(GetFragDataIndex, String<1>)
+		MY_GL_TRACE_RULE(GetUniformBlockIndex, String<1>)
+		MY_GL_TRACE_RULE(GetSubroutineIndex, String<2>)
+		MY_GL_TRACE_RULE(GetSubroutineUniformLocation, String<2>)
+		MY_GL_TRACE_RULE(BindAttribLocation, String<2>)
+		MY_GL_TRACE_RULE(BindFragDataLocation, String<2>)
+		MY_GL_TRACE_RULE(BindFragDataLocationIndexed, String<3>)
+		MY_GL_TRACE_RULE(GetActiveUniformsiv, Array<1, 2, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(UniformSubroutinesuiv, Array<1, 2, sizeof(GLuint)>)
+
+		// uniforms
+		MY_GL_TRACE_RULE(Uniform1fv, Array<1, 2, 1 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(Uniform2fv, Array<1, 2, 2 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(Uniform3fv, Array<1, 2, 3 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(Uniform4fv, Array<1, 2, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(Uniform1iv, Array<1, 2, 1 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(Uniform2iv, Array<1, 2, 2 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(Uniform3iv, Array<1, 2, 3 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(Uniform4iv, Array<1, 2, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(Uniform1uiv, Array<1, 2, 1 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(Uniform2uiv, Array<1, 2, 2 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(Uniform3uiv, Array<1, 2, 3 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(Uniform4uiv, Array<1, 2, 4 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(Uniform1dv, Array<1, 2, 1 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(Uniform2dv, Array<1, 2, 2 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(Uniform3dv, Array<1, 2, 3 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(Uniform4dv, Array<1, 2, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix2fv, Array<1, 3, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix3fv, Array<1, 3, 9 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix4fv, Array<1, 3, 16 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix2x3fv, Array<1, 3, 6 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix3x2fv, Array<1, 3, 6 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix2x4fv, Array<1, 3, 8 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix4x2fv, Array<1, 3, 8 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix3x4fv, Array<1, 3, 12 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix4x3fv, Array<1, 3, 12 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(UniformMatrix2dv, Array<1, 3, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix3dv, Array<1, 3, 9 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix4dv, Array<1, 3, 16 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix2x3dv, Array<1, 3, 6 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix3x2dv, Array<1, 3, 6 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix2x4dv, Array<1, 3, 8 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix4x2dv, Array<1, 3, 8 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix3x4dv, Array<1, 3, 12 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(UniformMatrix4x3dv, Array<1, 3, 12 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniform1fv, Array<2, 3, 1 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniform2fv, Array<2, 3, 2 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniform3fv, Array<2, 3, 3 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniform4fv, Array<2, 3, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniform1iv, Array<2, 3, 1 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ProgramUniform2iv, Array<2, 3, 2 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ProgramUniform3iv, Array<2, 3, 3 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ProgramUniform4iv, Array<2, 3, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ProgramUniform1uiv, Array<2, 3, 1 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(ProgramUniform2uiv, Array<2, 3, 2 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(ProgramUniform3uiv, Array<2, 3, 3 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(ProgramUniform4uiv, Array<2, 3, 4 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(ProgramUniform1dv, Array<2, 3, 1 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniform2dv, Array<2, 3, 2 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniform3dv, Array<2, 3, 3 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniform4dv, Array<2, 3, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2fv, Array<2, 4, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3fv, Array<2, 4, 9 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4fv, Array<2, 4, 16 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2x3fv, Array<2, 4, 6 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3x2fv, Array<2, 4, 6 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2x4fv, Array<2, 4, 8 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4x2fv, Array<2, 4, 8 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3x4fv, Array<2, 4, 12 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4x3fv, Array<2, 4, 12 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2dv, Array<2, 4, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3dv, Array<2, 4, 9 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4dv, Array<2, 4, 16 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2x3dv, Array<2, 4, 6 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3x2dv, Array<2, 4, 6 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix2x4dv, Array<2, 4, 8 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4x2dv, Array<2, 4, 8 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix3x4dv, Array<2, 4, 12 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(ProgramUniformMatrix4x3dv, Array<2, 4, 12 * sizeof(GLdouble)>)
+
+		// vertex attributes
+		MY_GL_TRACE_RULE(VertexAttrib1fv, Fixed<1, 1 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(VertexAttrib2fv, Fixed<1, 2 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(VertexAttrib3fv, Fixed<1, 3 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(VertexAttrib4fv, Fixed<1, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(VertexAttrib1dv, Fixed<1, 1 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttrib2dv, Fixed<1, 2 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttrib3dv, Fixed<1, 3 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttrib4dv, Fixed<1, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttrib1sv, Fixed<1, 1 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttrib2sv, Fixed<1, 2 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttrib3sv, Fixed<1, 3 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttrib4sv, Fixed<1, 4 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Nbv, Fixed<1, 4 * sizeof(GLbyte)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Niv, Fixed<1, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Nsv, Fixed<1, 4 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Nubv, Fixed<1, 4 * sizeof(GLubyte)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Nuiv, Fixed<1, 4 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttrib4Nusv, Fixed<1, 4 * sizeof(GLushort)>)
+		MY_GL_TRACE_RULE(VertexAttrib4bv, Fixed<1, 4 * sizeof(GLbyte)>)
+		MY_GL_TRACE_RULE(VertexAttrib4iv, Fixed<1, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttrib4ubv, Fixed<1, 4 * sizeof(GLubyte)>)
+		MY_GL_TRACE_RULE(VertexAttrib4uiv, Fixed<1, 4 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttrib4usv, Fixed<1, 4 * sizeof(GLushort)>)
+		MY_GL_TRACE_RULE(VertexAttribI1iv, Fixed<1, 1 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttribI2iv, Fixed<1, 2 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttribI3iv, Fixed<1, 3 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttribI4iv, Fixed<1, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(VertexAttribI1uiv, Fixed<1, 1 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribI2uiv, Fixed<1, 2 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribI3uiv, Fixed<1, 3 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribI4uiv, Fixed<1, 4 * sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribI4bv, Fixed<1, 4 * sizeof(GLbyte)>)
+		MY_GL_TRACE_RULE(VertexAttribI4sv, Fixed<1, 4 * sizeof(GLshort)>)
+		MY_GL_TRACE_RULE(VertexAttribI4ubv, Fixed<1, 4 * sizeof(GLubyte)>)
+		MY_GL_TRACE_RULE(VertexAttribI4usv, Fixed<1, 4 * sizeof(GLushort)>)
+		MY_GL_TRACE_RULE(VertexAttribL1dv, Fixed<1, 1 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttribL2dv, Fixed<1, 2 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttribL3dv, Fixed<1, 3 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttribL4dv, Fixed<1, 4 * sizeof(GLdouble)>)
+		MY_GL_TRACE_RULE(VertexAttribP1uiv, Fixed<3, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribP2uiv, Fixed<3, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribP3uiv, Fixed<3, sizeof(GLuint)>)
+		MY_GL_TRACE_RULE(VertexAttribP4uiv, Fixed<3, sizeof(GLuint)>)
+
+		// framebuffer and viewport state
+		MY_GL_TRACE_RULE(DrawBuffers, Array<0, 1, sizeof(GLenum)>)
+		MY_GL_TRACE_RULE(ClearBufferfv, Params<0, 2>)
+		MY_GL_TRACE_RULE(ClearBufferiv, Params<0, 2>)
+		MY_GL_TRACE_RULE(ClearBufferuiv, Params<0, 2>)
+		MY_GL_TRACE_RULE(PointParameterfv, Fixed<1, sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(PointParameteriv, Fixed<1, sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ScissorArrayv, Array<1, 2, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ScissorIndexedv, Fixed<1, 4 * sizeof(GLint)>)
+		MY_GL_TRACE_RULE(ViewportArrayv, Array<1, 2, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(ViewportIndexedfv, Fixed<1, 4 * sizeof(GLfloat)>)
+		MY_GL_TRACE_RULE(DepthRangeArrayv, Array<1, 2, 2 * sizeof(GLdouble)>)
+#undef MY_GL_TRACE_RULE
+#pragma endregion
+
+#pragma region // Replay
+		/// \return	False if the call was skipped.
+		using ReplayFunction = bool(*)(Replayer & replayer, Reader & reader, const void * slot, double & ms);
+
+		template <Function ID, typename FN>
+		struct ReplayCall;
+		template <Function ID, typename R, typename ... Args>
+		struct ReplayCall<ID, R(CODEGEN_FUNCPTR *)(Args...)>
+		{
+			using FN = R(CODEGEN_FUNCPTR *)(Args...);
+			static const bool REPLAYABLE = Rule<ID>::HANDLED || !AnyClientMemory<Args...>::value;
+
+			/// \param	slot	The entry point, read when replaying because it is loaded with the context.
+			static bool Run(Replayer & replayer, Reader & reader, const void * slot, double & ms)
+			{
+				const FN function = *static_cast<const FN *>(slot);
+				if (!REPLAYABLE || function == nullptr)
+					return false;
+
+				std::tuple<Args...> args;
+				Decode(replayer, reader, args, std::index_sequence_for<Args...>{});
+				Rule<ID>::Replay(replayer, reader, args);
+
+				const auto start = Clock::now();
+				const Result<R> result{ function, args, std::index_sequence_for<Args...>{} };
+				if (replayer.mbFinishEveryCall)
+					gl::Finish();
+				ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+				const std::uint64_t traced = Result<R>::ReadTraced(reader);
+				Rule<ID>::Check(replayer, reader, args, traced, result.getBits());
+				return true;
+			}
+
+		private:
+			template <std::size_t ... I>
+			static void Decode(Replayer & replayer, Reader & reader, std::tuple<Args...> & args, std::index_sequence<I...>)
+			{
+				const int expand[] = { 0, (std::get<I>(args) = Decoder<Args>::Get(replayer, reader), 0)... };
+				(void)expand;
+			}
+		};
+
+		struct ReplayEntry
+		{
+			ReplayFunction	mpRun;
+			const void *	mpSlot;
+		};
+		const ReplayEntry s_Replays[FUNCTION_COUNT] =
+		{
+#define MY_GL_TRACE_FUNCTION(space, name) { &ReplayCall<FN_##name, decltype(space::name)>::Run, &space::name },
+#include "my_gl_trace_functions.h"
+#undef MY_GL_TRACE_FUNCTION
+		};
+
+		template <typename T>
+		bool read(std::istream & file, T & value)
+		{
+			return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+		}
+
+		/// \param	names	Names of the entry points the trace knows, in the order of its ids.
+		bool read_header(std::istream & file, TraceInfo & info, std::vector<std::string> & names)
+		{
+			char magic[sizeof(s_Magic)];
+			std::uint32_t version = 0;
+			std::uint32_t frames = 0;
+			std::uint32_t functions = 0;
+			if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, s_Magic, sizeof(magic)) != 0
+				|| !read(file, version) || version != s_Version
+				|| !read(file, info.mWidth) || !read(file, info.mHeight)
+				|| !read(file, frames) || !read(file, functions))
+				return false;
+			info.mFrames = frames;
+			info.mFunctions = functions;
+
+			names.resize(functions);
+			for (std::string & name : names)
+			{
+				std::uint16_t length = 0;
+				if (!read(file, length))
+					return false;
+				name.resize(length);
+				if (length > 0 && !file.read(&name[0], length))
+					return false;
+			}
+			// the records start aligned
+			const std::streamoff misalignment = static_cast<std::streamoff>(file.tellg()) % static_cast<std::streamoff>(s_BlobAlignment);
+			if (misalignment != 0)
+				file.seekg(static_cast<std::streamoff>(s_BlobAlignment) - misalignment, std::ios::cur);
+			return static_cast<bool>(file);
+		}
+#pragma endregion
+	}
+
+	void request_trace(const char * file, unsigned frames)
+	{
+		Trace & trace = get_trace();
+		trace.mRequestedFile = file;
+		trace.mRequestedFrames = frames;
+	}
+
+	void begin_requested_trace(int width, int height)
+	{
+		Trace & trace = get_trace();
+		if (trace.mbActive || trace.mRequestedFile.empty() || trace.mRequestedFrames == 0)
+			return;
+
+		trace.mFile.open(trace.mRequestedFile, std::ios::binary);
+		if (!trace.mFile)
+		{
+			APP_LOG_ERROR(app::log::Category::GL, "Couldn't open {} to write the GL trace", trace.mRequestedFile);
+			trace.mRequestedFile.clear();
+			return;
+		}
+
+		trace.Put(s_Magic, sizeof(s_Magic));
+		trace.Put(s_Version);
+		trace.Put(static_cast<std::int32_t>(width));
+		trace.Put(static_cast<std::int32_t>(height));
+		trace.Put(std::uint32_t{ 0 });
+		trace.Put(static_cast<std::uint32_t>(FUNCTION_COUNT));
+		for (const char * name : s_FunctionNames)
+		{
+			const std::uint16_t length = static_cast<std::uint16_t>(std::strlen(name));
+			trace.Put(length);
+			trace.Put(name, length);
+		}
+		trace.mvRecords.resize((trace.mvRecords.size() + s_BlobAlignment - 1) / s_BlobAlignment * s_BlobAlignment, 0);
+		trace.Flush();
+
+		trace.mFramesLeft = trace.mRequestedFrames;
+		trace.mFrames = 0;
+		trace.mbActive = true;
+		swap_hooks(true);
+
+		APP_LOG_INFO(app::log::Category::GL, "Tracing the first {} frames of GL calls into {}", trace.mRequestedFrames, trace.mRequestedFile);
+	}
+
+	void end_trace_frame()
+	{
+		Trace & trace = get_trace();
+		if (!trace.mbActive)
+			return;
+
+		trace.BeginRecord(s_FrameMarker);
+		trace.EndRecord();
+		trace.Flush();
+		++trace.mFrames;
+
+		if (--trace.mFramesLeft == 0)
+			stop_trace();
+	}
+
+	void stop_trace()
+	{
+		Trace & trace = get_trace();
+		if (!trace.mbActive)
+			return;
+
+		swap_hooks(false);
+		trace.mbActive = false;
+		trace.Flush();
+
+		const std::uint32_t frames = trace.mFrames;
+		trace.mFile.seekp(s_FramesOffset);
+		trace.mFile.write(reinterpret_cast<const char *>(&frames), sizeof(frames));
+		trace.mFile.close();
+		trace.mMappings.clear();
+
+		APP_LOG_INFO(app::log::Category::GL, "GL trace written to {}: {} frames, {} KB", trace.mRequestedFile, trace.mFrames,
+					 trace.mWritten / 1024);
+		// only the first context is traced
+		trace.mRequestedFile.clear();
+		trace.mWritten = 0;
+	}
+
+	bool is_tracing()
+	{
+		return get_trace().mbActive;
+	}
+
+	void trace_mapped_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void * data)
+	{
+		Trace & trace = get_trace();
+		if (!trace.mbActive)
+			return;
+
+		trace.BeginRecord(s_MappedWrite);
+		trace.Put(buffer);
+		trace.Put(static_cast<std::int64_t>(offset));
+		trace.PutBlob(data, static_cast<std::size_t>(size));
+		trace.EndRecord();
+	}
+
+	bool read_trace_info(const char * file, TraceInfo & info)
+	{
+		std::ifstream stream{ file, std::ios::binary };
+		std::vector<std::string> names;
+		return stream && read_header(stream, info, names);
+	}
+
+	bool replay_trace(const char * file, const ReplaySettings & settings, ReplayStats & stats)
+	{
+		using app::log::Category;
+
+		std::ifstream stream{ file, std::ios::binary };
+		TraceInfo info{};
+		std::vector<std::string> names;
+		if (!stream || !read_header(stream, info, names))
+		{
+			APP_LOG_ERROR(Category::GL, "{} isn't a GL trace", file);
+			return false;
+		}
+
+		// map the ids of the trace to the ones of this build
+		std::unordered_map<std::string, unsigned short> local_ids;
+		for (unsigned short i = 0; i < FUNCTION_COUNT; ++i)
+			local_ids.emplace(s_FunctionNames[i], i);
+		std::vector<unsigned short> functions(names.size(), static_cast<unsigned short>(FUNCTION_COUNT));
+		for (std::size_t i = 0; i < names.size(); ++i)
+		{
+			const auto it = local_ids.find(names[i]);
+			if (it != local_ids.end())
+				functions[i] = it->second;
+		}
+
+		const std::streampos start = stream.tellg();
+		stream.seekg(0, std::ios::end);
+		std::vector<unsigned char> records(static_cast<std::size_t>(stream.tellg() - start));
+		stream.seekg(start);
+		if (!records.empty() && !stream.read(reinterpret_cast<char *>(records.data()), records.size()))
+		{
+			APP_LOG_ERROR(Category::GL, "Couldn't read the GL trace {}", file);
+			return false;
+		}
+
+		Replayer replayer;
+		replayer.mbFinishEveryCall = settings.mbFinishEveryCall;
+		replayer.mvScratch.resize(s_ScratchSize);
+
+		std::ofstream csv;
+		if (settings.mCsvFile)
+		{
+			csv.open(settings.mCsvFile);
+			csv << "call,frame,function,ms\n";
+		}
+
+		stats = ReplayStats{};
+		std::vector<ReplayFunctionStats> function_stats(FUNCTION_COUNT);
+		for (unsigned i = 0; i < FUNCTION_COUNT; ++i)
+			function_stats[i] = ReplayFunctionStats{ s_FunctionNames[i], 0, 0.0, 0.0 };
+
+		try
+		{
+			const unsigned char * base = records.data();
+			const unsigned char * end = base + records.size();
+			const unsigned char * current = base;
+			auto frame_start = Clock::now();
+			while (current != end)
+			{
+				Reader header{ base, current, end };
+				const unsigned short id = header.Get<unsigned short>();
+				const std::uint32_t size = header.Get<std::uint32_t>();
+				current += sizeof(id) + sizeof(size);
+				if (static_cast<std::size_t>(end - current) < size)
+					throw std::runtime_error{ "The GL trace is truncated." };
+				Reader reader{ base, current, current + size };
+				current += size;
+
+				if (id == s_FrameMarker)
+				{
+					gl::Finish();
+					const auto now = Clock::now();
+					stats.mvFrameMs.push_back(std::chrono::duration<double, std::milli>(now - frame_start).count());
+					stats.mTotalMs += stats.mvFrameMs.back();
+					++stats.mFrames;
+					frame_start = now;
+				}
+				else if (id == s_MappedWrite)
+				{
+					const GLuint buffer = reader.Get<GLuint>();
+					const std::int64_t offset = reader.Get<std::int64_t>();
+					std::uint32_t bytes = 0;
+					const void * data = reader.GetBlob(nullptr, &bytes);
+					const auto it = replayer.mMappings.find(buffer);
+					if (it != replayer.mMappings.end() && data)
+						std::memcpy(it->second.mpData + (offset - it->second.mOffset), data, bytes);
+				}
+				else
+				{
+					const unsigned short function = id < functions.size() ? functions[id] : static_cast<unsigned short>(FUNCTION_COUNT);
+					double ms = 0.0;
+					if (function == FUNCTION_COUNT || !s_Replays[function].mpRun(replayer, reader, s_Replays[function].mpSlot, ms))
+					{
+						++stats.mSkipped;
+						continue;
+					}
+
+					ReplayFunctionStats & function_stat = function_stats[function];
+					++function_stat.mCalls;
+					function_stat.mTotalMs += ms;
+					function_stat.mMaxMs = std::max(function_stat.mMaxMs, ms);
+					if (csv)
+						csv << stats.mCalls << ',' << stats.mFrames << ',' << function_stat.mName << ',' << ms << '\n';
+					++stats.mCalls;
+				}
+			}
+		}
+		catch (const std::runtime_error & error)
+		{
+			APP_LOG_ERROR(Category::GL, "Replaying {}: {}", file, error.what());
+			return false;
+		}
+
+		for (const ReplayFunctionStats & function_stat : function_stats)
+		{
+			if (function_stat.mCalls > 0)
+				stats.mvFunctions.push_back(function_stat);
+		}
+		std::sort(stats.mvFunctions.begin(), stats.mvFunctions.end(), [](const ReplayFunctionStats & a, const ReplayFunctionStats & b)
+		{
+			return a.mTotalMs > b.mTotalMs;
+		});
+		stats.mDivergences = replayer.mDivergences;
+		return true;
+	}
+}
@@ -0,0 +1,73 @@
+/*!
+\brief	Records every GL call of the first frames into a file, and replays it with per-call timings.
+*/
+
+#pragma once
+
+#include "my_gl_core.h"
+
+#include <vector>	// std::vector
+
+namespace my_gl_core
+{
+	/// \brief	Traces the first frames of the next context into the file. The gl:: (and ext::) entry
+	/// points are swapped for hooks that record the call, its arguments and the memory it reads
+	/// (buffer and texture uploads, uniforms, shader sources, mapped ranges...).
+	/// IMPORTANT(Borja): The trace starts with the context so that it has every object the frames
+	/// use, a frame in the middle of a session can't be traced on its own.
+	void request_trace(const char * file, unsigned frames);
+	/// \brief	Starts the requested trace, if any. Window calls it right after my_gl_core::probe_caps.
+	void begin_requested_trace(int width, int height);
+	/// \brief	Window calls it when swapping buffers, after the requested frames the trace is written
+	/// and the entry points restored.
+	void end_trace_frame();
+	/// \brief	Writes what has been traced so far, i.e. when the window is closed early.
+	void stop_trace();
+	bool is_tracing();
+	/// \brief	Records the bytes written to a persistently mapped buffer, there is no GL call to hook.
+	/// my_gl_core::StreamBuffer calls it when committing its ranges.
+	void trace_mapped_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void * data);
+
+	struct TraceInfo
+	{
+		int			mWidth;		// of the window it was traced in
+		int			mHeight;
+		unsigned	mFrames;
+		unsigned	mFunctions;	// entry points it knows
+	};
+	bool read_trace_info(const char * file, TraceInfo & info);
+
+	struct ReplaySettings
+	{
+		/// \brief	Every call is followed by a gl::Finish so its time includes the GPU work.
+		bool			mbFinishEveryCall{ false };
+		/// \brief	Writes the time of every call, to bisect the frames (nullptr to skip it).
+		const char *	mCsvFile{ nullptr };
+	};
+
+	struct ReplayFunctionStats
+	{
+		const char *	mName;
+		unsigned		mCalls;
+		double			mTotalMs;
+		double			mMaxMs;
+	};
+
+	struct ReplayStats
+	{
+		unsigned	mFrames{ 0 };
+		unsigned	mCalls{ 0 };
+		unsigned	mSkipped{ 0 };		// calls whose memory the tracer doesn't know how to record
+		unsigned	mDivergences{ 0 };	// objects created with a different name than when traced
+		double		mTotalMs{ 0.0 };
+		/// \brief	Time of every frame up to a gl::Finish at its end.
+		std::vector<double> mvFrameMs;
+		/// \brief	Only the functions that were called, the most expensive first.
+		std::vector<ReplayFunctionStats> mvFunctions;
+	};
+
+	/// \brief	Replays the trace in the current context, which has to be a new one (see app::RunHeadless)
+	/// so that the objects get the same names they had when traced.
+	/// \return	False if the file can't be read.
+	bool replay_trace(const char * file, const ReplaySettings & settings, ReplayStats & stats);
+}
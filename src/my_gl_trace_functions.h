@@ -0,0 +1,520 @@
+/*!
+\brief	Entry points hooked by the GL tracer: all the ones of gl_core_4_2 and my_gl_core::ext.
+Included by my_gl_trace.cpp with MY_GL_TRACE_FUNCTION(space, name) defined. The traces store the names, so entries can be added anywhere.
+*/
+
+// gl_core_4_2
+MY_GL_TRACE_FUNCTION(gl, BlendFunc)
+MY_GL_TRACE_FUNCTION(gl, Clear)
+MY_GL_TRACE_FUNCTION(gl, ClearColor)
+MY_GL_TRACE_FUNCTION(gl, ClearDepth)
+MY_GL_TRACE_FUNCTION(gl, ClearStencil)
+MY_GL_TRACE_FUNCTION(gl, ColorMask)
+MY_GL_TRACE_FUNCTION(gl, CullFace)
+MY_GL_TRACE_FUNCTION(gl, DepthFunc)
+MY_GL_TRACE_FUNCTION(gl, DepthMask)
+MY_GL_TRACE_FUNCTION(gl, DepthRange)
+MY_GL_TRACE_FUNCTION(gl, Disable)
+MY_GL_TRACE_FUNCTION(gl, DrawBuffer)
+MY_GL_TRACE_FUNCTION(gl, Enable)
+MY_GL_TRACE_FUNCTION(gl, Finish)
+MY_GL_TRACE_FUNCTION(gl, Flush)
+MY_GL_TRACE_FUNCTION(gl, FrontFace)
+MY_GL_TRACE_FUNCTION(gl, GetBooleanv)
+MY_GL_TRACE_FUNCTION(gl, GetDoublev)
+MY_GL_TRACE_FUNCTION(gl, GetError)
+MY_GL_TRACE_FUNCTION(gl, GetFloatv)
+MY_GL_TRACE_FUNCTION(gl, GetIntegerv)
+MY_GL_TRACE_FUNCTION(gl, GetString)
+MY_GL_TRACE_FUNCTION(gl, GetTexImage)
+MY_GL_TRACE_FUNCTION(gl, GetTexLevelParameterfv)
+MY_GL_TRACE_FUNCTION(gl, GetTexLevelParameteriv)
+MY_GL_TRACE_FUNCTION(gl, GetTexParameterfv)
+MY_GL_TRACE_FUNCTION(gl, GetTexParameteriv)
+MY_GL_TRACE_FUNCTION(gl, Hint)
+MY_GL_TRACE_FUNCTION(gl, IsEnabled)
+MY_GL_TRACE_FUNCTION(gl, LineWidth)
+MY_GL_TRACE_FUNCTION(gl, LogicOp)
+MY_GL_TRACE_FUNCTION(gl, PixelStoref)
+MY_GL_TRACE_FUNCTION(gl, PixelStorei)
+MY_GL_TRACE_FUNCTION(gl, PointSize)
+MY_GL_TRACE_FUNCTION(gl, PolygonMode)
+MY_GL_TRACE_FUNCTION(gl, ReadBuffer)
+MY_GL_TRACE_FUNCTION(gl, ReadPixels)
+MY_GL_TRACE_FUNCTION(gl, Scissor)
+MY_GL_TRACE_FUNCTION(gl, StencilFunc)
+MY_GL_TRACE_FUNCTION(gl, StencilMask)
+MY_GL_TRACE_FUNCTION(gl, StencilOp)
+MY_GL_TRACE_FUNCTION(gl, TexImage1D)
+MY_GL_TRACE_FUNCTION(gl, TexImage2D)
+MY_GL_TRACE_FUNCTION(gl, TexParameterf)
+MY_GL_TRACE_FUNCTION(gl, TexParameterfv)
+MY_GL_TRACE_FUNCTION(gl, TexParameteri)
+MY_GL_TRACE_FUNCTION(gl, TexParameteriv)
+MY_GL_TRACE_FUNCTION(gl, Viewport)
+MY_GL_TRACE_FUNCTION(gl, BindTexture)
+MY_GL_TRACE_FUNCTION(gl, CopyTexImage1D)
+MY_GL_TRACE_FUNCTION(gl, CopyTexImage2D)
+MY_GL_TRACE_FUNCTION(gl, CopyTexSubImage1D)
+MY_GL_TRACE_FUNCTION(gl, CopyTexSubImage2D)
+MY_GL_TRACE_FUNCTION(gl, DeleteTextures)
+MY_GL_TRACE_FUNCTION(gl, DrawArrays)
+MY_GL_TRACE_FUNCTION(gl, DrawElements)
+MY_GL_TRACE_FUNCTION(gl, GenTextures)
+MY_GL_TRACE_FUNCTION(gl, IsTexture)
+MY_GL_TRACE_FUNCTION(gl, PolygonOffset)
+MY_GL_TRACE_FUNCTION(gl, TexSubImage1D)
+MY_GL_TRACE_FUNCTION(gl, TexSubImage2D)
+MY_GL_TRACE_FUNCTION(gl, CopyTexSubImage3D)
+MY_GL_TRACE_FUNCTION(gl, DrawRangeElements)
+MY_GL_TRACE_FUNCTION(gl, TexImage3D)
+MY_GL_TRACE_FUNCTION(gl, TexSubImage3D)
+MY_GL_TRACE_FUNCTION(gl, ActiveTexture)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexImage1D)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexImage2D)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexImage3D)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexSubImage1D)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexSubImage2D)
+MY_GL_TRACE_FUNCTION(gl, CompressedTexSubImage3D)
+MY_GL_TRACE_FUNCTION(gl, GetCompressedTexImage)
+MY_GL_TRACE_FUNCTION(gl, SampleCoverage)
+MY_GL_TRACE_FUNCTION(gl, BlendFuncSeparate)
+MY_GL_TRACE_FUNCTION(gl, MultiDrawArrays)
+MY_GL_TRACE_FUNCTION(gl, MultiDrawElements)
+MY_GL_TRACE_FUNCTION(gl, PointParameterf)
+MY_GL_TRACE_FUNCTION(gl, PointParameterfv)
+MY_GL_TRACE_FUNCTION(gl, PointParameteri)
+MY_GL_TRACE_FUNCTION(gl, PointParameteriv)
+MY_GL_TRACE_FUNCTION(gl, BeginQuery)
+MY_GL_TRACE_FUNCTION(gl, BindBuffer)
+MY_GL_TRACE_FUNCTION(gl, BufferData)
+MY_GL_TRACE_FUNCTION(gl, BufferSubData)
+MY_GL_TRACE_FUNCTION(gl, DeleteBuffers)
+MY_GL_TRACE_FUNCTION(gl, DeleteQueries)
+MY_GL_TRACE_FUNCTION(gl, EndQuery)
+MY_GL_TRACE_FUNCTION(gl, GenBuffers)
+MY_GL_TRACE_FUNCTION(gl, GenQueries)
+MY_GL_TRACE_FUNCTION(gl, GetBufferParameteriv)
+MY_GL_TRACE_FUNCTION(gl, GetBufferPointerv)
+MY_GL_TRACE_FUNCTION(gl, GetBufferSubData)
+MY_GL_TRACE_FUNCTION(gl, GetQueryObjectiv)
+MY_GL_TRACE_FUNCTION(gl, GetQueryObjectuiv)
+MY_GL_TRACE_FUNCTION(gl, GetQueryiv)
+MY_GL_TRACE_FUNCTION(gl, IsBuffer)
+MY_GL_TRACE_FUNCTION(gl, IsQuery)
+MY_GL_TRACE_FUNCTION(gl, MapBuffer)
+MY_GL_TRACE_FUNCTION(gl, UnmapBuffer)
+MY_GL_TRACE_FUNCTION(gl, AttachShader)
+MY_GL_TRACE_FUNCTION(gl, BindAttribLocation)
+MY_GL_TRACE_FUNCTION(gl, BlendEquationSeparate)
+MY_GL_TRACE_FUNCTION(gl, CompileShader)
+MY_GL_TRACE_FUNCTION(gl, CreateProgram)
+MY_GL_TRACE_FUNCTION(gl, CreateShader)
+MY_GL_TRACE_FUNCTION(gl, DeleteProgram)
+MY_GL_TRACE_FUNCTION(gl, DeleteShader)
+MY_GL_TRACE_FUNCTION(gl, DetachShader)
+MY_GL_TRACE_FUNCTION(gl, DisableVertexAttribArray)
+MY_GL_TRACE_FUNCTION(gl, DrawBuffers)
+MY_GL_TRACE_FUNCTION(gl, EnableVertexAttribArray)
+MY_GL_TRACE_FUNCTION(gl, GetActiveAttrib)
+MY_GL_TRACE_FUNCTION(gl, GetActiveUniform)
+MY_GL_TRACE_FUNCTION(gl, GetAttachedShaders)
+MY_GL_TRACE_FUNCTION(gl, GetAttribLocation)
+MY_GL_TRACE_FUNCTION(gl, GetProgramInfoLog)
+MY_GL_TRACE_FUNCTION(gl, GetProgramiv)
+MY_GL_TRACE_FUNCTION(gl, GetShaderInfoLog)
+MY_GL_TRACE_FUNCTION(gl, GetShaderSource)
+MY_GL_TRACE_FUNCTION(gl, GetShaderiv)
+MY_GL_TRACE_FUNCTION(gl, GetUniformLocation)
+MY_GL_TRACE_FUNCTION(gl, GetUniformfv)
+MY_GL_TRACE_FUNCTION(gl, GetUniformiv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribPointerv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribdv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribfv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribiv)
+MY_GL_TRACE_FUNCTION(gl, IsProgram)
+MY_GL_TRACE_FUNCTION(gl, IsShader)
+MY_GL_TRACE_FUNCTION(gl, LinkProgram)
+MY_GL_TRACE_FUNCTION(gl, ShaderSource)
+MY_GL_TRACE_FUNCTION(gl, StencilFuncSeparate)
+MY_GL_TRACE_FUNCTION(gl, StencilMaskSeparate)
+MY_GL_TRACE_FUNCTION(gl, StencilOpSeparate)
+MY_GL_TRACE_FUNCTION(gl, Uniform1f)
+MY_GL_TRACE_FUNCTION(gl, Uniform1fv)
+MY_GL_TRACE_FUNCTION(gl, Uniform1i)
+MY_GL_TRACE_FUNCTION(gl, Uniform1iv)
+MY_GL_TRACE_FUNCTION(gl, Uniform2f)
+MY_GL_TRACE_FUNCTION(gl, Uniform2fv)
+MY_GL_TRACE_FUNCTION(gl, Uniform2i)
+MY_GL_TRACE_FUNCTION(gl, Uniform2iv)
+MY_GL_TRACE_FUNCTION(gl, Uniform3f)
+MY_GL_TRACE_FUNCTION(gl, Uniform3fv)
+MY_GL_TRACE_FUNCTION(gl, Uniform3i)
+MY_GL_TRACE_FUNCTION(gl, Uniform3iv)
+MY_GL_TRACE_FUNCTION(gl, Uniform4f)
+MY_GL_TRACE_FUNCTION(gl, Uniform4fv)
+MY_GL_TRACE_FUNCTION(gl, Uniform4i)
+MY_GL_TRACE_FUNCTION(gl, Uniform4iv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4fv)
+MY_GL_TRACE_FUNCTION(gl, UseProgram)
+MY_GL_TRACE_FUNCTION(gl, ValidateProgram)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1f)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1fv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1s)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib1sv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2f)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2fv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2s)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib2sv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3f)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3fv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3s)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib3sv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nbv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Niv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nsv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nub)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nubv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nuiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4Nusv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4bv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4f)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4fv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4iv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4s)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4sv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4ubv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttrib4usv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribPointer)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2x3fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2x4fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3x2fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3x4fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4x2fv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4x3fv)
+MY_GL_TRACE_FUNCTION(gl, BeginConditionalRender)
+MY_GL_TRACE_FUNCTION(gl, BeginTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, BindBufferBase)
+MY_GL_TRACE_FUNCTION(gl, BindBufferRange)
+MY_GL_TRACE_FUNCTION(gl, BindFragDataLocation)
+MY_GL_TRACE_FUNCTION(gl, BindFramebuffer)
+MY_GL_TRACE_FUNCTION(gl, BindRenderbuffer)
+MY_GL_TRACE_FUNCTION(gl, BindVertexArray)
+MY_GL_TRACE_FUNCTION(gl, BlitFramebuffer)
+MY_GL_TRACE_FUNCTION(gl, CheckFramebufferStatus)
+MY_GL_TRACE_FUNCTION(gl, ClampColor)
+MY_GL_TRACE_FUNCTION(gl, ClearBufferfi)
+MY_GL_TRACE_FUNCTION(gl, ClearBufferfv)
+MY_GL_TRACE_FUNCTION(gl, ClearBufferiv)
+MY_GL_TRACE_FUNCTION(gl, ClearBufferuiv)
+MY_GL_TRACE_FUNCTION(gl, ColorMaski)
+MY_GL_TRACE_FUNCTION(gl, DeleteFramebuffers)
+MY_GL_TRACE_FUNCTION(gl, DeleteRenderbuffers)
+MY_GL_TRACE_FUNCTION(gl, DeleteVertexArrays)
+MY_GL_TRACE_FUNCTION(gl, Disablei)
+MY_GL_TRACE_FUNCTION(gl, Enablei)
+MY_GL_TRACE_FUNCTION(gl, EndConditionalRender)
+MY_GL_TRACE_FUNCTION(gl, EndTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, FlushMappedBufferRange)
+MY_GL_TRACE_FUNCTION(gl, FramebufferRenderbuffer)
+MY_GL_TRACE_FUNCTION(gl, FramebufferTexture1D)
+MY_GL_TRACE_FUNCTION(gl, FramebufferTexture2D)
+MY_GL_TRACE_FUNCTION(gl, FramebufferTexture3D)
+MY_GL_TRACE_FUNCTION(gl, FramebufferTextureLayer)
+MY_GL_TRACE_FUNCTION(gl, GenFramebuffers)
+MY_GL_TRACE_FUNCTION(gl, GenRenderbuffers)
+MY_GL_TRACE_FUNCTION(gl, GenVertexArrays)
+MY_GL_TRACE_FUNCTION(gl, GenerateMipmap)
+MY_GL_TRACE_FUNCTION(gl, GetBooleani_v)
+MY_GL_TRACE_FUNCTION(gl, GetFragDataLocation)
+MY_GL_TRACE_FUNCTION(gl, GetFramebufferAttachmentParameteriv)
+MY_GL_TRACE_FUNCTION(gl, GetIntegeri_v)
+MY_GL_TRACE_FUNCTION(gl, GetRenderbufferParameteriv)
+MY_GL_TRACE_FUNCTION(gl, GetStringi)
+MY_GL_TRACE_FUNCTION(gl, GetTexParameterIiv)
+MY_GL_TRACE_FUNCTION(gl, GetTexParameterIuiv)
+MY_GL_TRACE_FUNCTION(gl, GetTransformFeedbackVarying)
+MY_GL_TRACE_FUNCTION(gl, GetUniformuiv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribIiv)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribIuiv)
+MY_GL_TRACE_FUNCTION(gl, IsEnabledi)
+MY_GL_TRACE_FUNCTION(gl, IsFramebuffer)
+MY_GL_TRACE_FUNCTION(gl, IsRenderbuffer)
+MY_GL_TRACE_FUNCTION(gl, IsVertexArray)
+MY_GL_TRACE_FUNCTION(gl, MapBufferRange)
+MY_GL_TRACE_FUNCTION(gl, RenderbufferStorage)
+MY_GL_TRACE_FUNCTION(gl, RenderbufferStorageMultisample)
+MY_GL_TRACE_FUNCTION(gl, TexParameterIiv)
+MY_GL_TRACE_FUNCTION(gl, TexParameterIuiv)
+MY_GL_TRACE_FUNCTION(gl, TransformFeedbackVaryings)
+MY_GL_TRACE_FUNCTION(gl, Uniform1ui)
+MY_GL_TRACE_FUNCTION(gl, Uniform1uiv)
+MY_GL_TRACE_FUNCTION(gl, Uniform2ui)
+MY_GL_TRACE_FUNCTION(gl, Uniform2uiv)
+MY_GL_TRACE_FUNCTION(gl, Uniform3ui)
+MY_GL_TRACE_FUNCTION(gl, Uniform3uiv)
+MY_GL_TRACE_FUNCTION(gl, Uniform4ui)
+MY_GL_TRACE_FUNCTION(gl, Uniform4uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI1i)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI1iv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI1ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI1uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI2i)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI2iv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI2ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI2uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI3i)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI3iv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI3ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI3uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4bv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4i)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4iv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4sv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4ubv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribI4usv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribIPointer)
+MY_GL_TRACE_FUNCTION(gl, CopyBufferSubData)
+MY_GL_TRACE_FUNCTION(gl, DrawArraysInstanced)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsInstanced)
+MY_GL_TRACE_FUNCTION(gl, GetActiveUniformBlockName)
+MY_GL_TRACE_FUNCTION(gl, GetActiveUniformBlockiv)
+MY_GL_TRACE_FUNCTION(gl, GetActiveUniformName)
+MY_GL_TRACE_FUNCTION(gl, GetActiveUniformsiv)
+MY_GL_TRACE_FUNCTION(gl, GetUniformBlockIndex)
+MY_GL_TRACE_FUNCTION(gl, GetUniformIndices)
+MY_GL_TRACE_FUNCTION(gl, PrimitiveRestartIndex)
+MY_GL_TRACE_FUNCTION(gl, TexBuffer)
+MY_GL_TRACE_FUNCTION(gl, UniformBlockBinding)
+MY_GL_TRACE_FUNCTION(gl, ClientWaitSync)
+MY_GL_TRACE_FUNCTION(gl, DeleteSync)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsBaseVertex)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsInstancedBaseVertex)
+MY_GL_TRACE_FUNCTION(gl, DrawRangeElementsBaseVertex)
+MY_GL_TRACE_FUNCTION(gl, FenceSync)
+MY_GL_TRACE_FUNCTION(gl, FramebufferTexture)
+MY_GL_TRACE_FUNCTION(gl, GetBufferParameteri64v)
+MY_GL_TRACE_FUNCTION(gl, GetInteger64i_v)
+MY_GL_TRACE_FUNCTION(gl, GetInteger64v)
+MY_GL_TRACE_FUNCTION(gl, GetMultisamplefv)
+MY_GL_TRACE_FUNCTION(gl, GetSynciv)
+MY_GL_TRACE_FUNCTION(gl, IsSync)
+MY_GL_TRACE_FUNCTION(gl, MultiDrawElementsBaseVertex)
+MY_GL_TRACE_FUNCTION(gl, ProvokingVertex)
+MY_GL_TRACE_FUNCTION(gl, SampleMaski)
+MY_GL_TRACE_FUNCTION(gl, TexImage2DMultisample)
+MY_GL_TRACE_FUNCTION(gl, TexImage3DMultisample)
+MY_GL_TRACE_FUNCTION(gl, WaitSync)
+MY_GL_TRACE_FUNCTION(gl, BindFragDataLocationIndexed)
+MY_GL_TRACE_FUNCTION(gl, BindSampler)
+MY_GL_TRACE_FUNCTION(gl, DeleteSamplers)
+MY_GL_TRACE_FUNCTION(gl, GenSamplers)
+MY_GL_TRACE_FUNCTION(gl, GetFragDataIndex)
+MY_GL_TRACE_FUNCTION(gl, GetQueryObjecti64v)
+MY_GL_TRACE_FUNCTION(gl, GetQueryObjectui64v)
+MY_GL_TRACE_FUNCTION(gl, GetSamplerParameterIiv)
+MY_GL_TRACE_FUNCTION(gl, GetSamplerParameterIuiv)
+MY_GL_TRACE_FUNCTION(gl, GetSamplerParameterfv)
+MY_GL_TRACE_FUNCTION(gl, GetSamplerParameteriv)
+MY_GL_TRACE_FUNCTION(gl, IsSampler)
+MY_GL_TRACE_FUNCTION(gl, QueryCounter)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameterIiv)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameterIuiv)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameterf)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameterfv)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameteri)
+MY_GL_TRACE_FUNCTION(gl, SamplerParameteriv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribDivisor)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP1ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP1uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP2ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP2uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP3ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP3uiv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP4ui)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribP4uiv)
+MY_GL_TRACE_FUNCTION(gl, BeginQueryIndexed)
+MY_GL_TRACE_FUNCTION(gl, BindTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, BlendEquationSeparatei)
+MY_GL_TRACE_FUNCTION(gl, BlendEquationi)
+MY_GL_TRACE_FUNCTION(gl, BlendFuncSeparatei)
+MY_GL_TRACE_FUNCTION(gl, BlendFunci)
+MY_GL_TRACE_FUNCTION(gl, DeleteTransformFeedbacks)
+MY_GL_TRACE_FUNCTION(gl, DrawArraysIndirect)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsIndirect)
+MY_GL_TRACE_FUNCTION(gl, DrawTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, DrawTransformFeedbackStream)
+MY_GL_TRACE_FUNCTION(gl, EndQueryIndexed)
+MY_GL_TRACE_FUNCTION(gl, GenTransformFeedbacks)
+MY_GL_TRACE_FUNCTION(gl, GetActiveSubroutineName)
+MY_GL_TRACE_FUNCTION(gl, GetActiveSubroutineUniformName)
+MY_GL_TRACE_FUNCTION(gl, GetActiveSubroutineUniformiv)
+MY_GL_TRACE_FUNCTION(gl, GetProgramStageiv)
+MY_GL_TRACE_FUNCTION(gl, GetQueryIndexediv)
+MY_GL_TRACE_FUNCTION(gl, GetSubroutineIndex)
+MY_GL_TRACE_FUNCTION(gl, GetSubroutineUniformLocation)
+MY_GL_TRACE_FUNCTION(gl, GetUniformSubroutineuiv)
+MY_GL_TRACE_FUNCTION(gl, GetUniformdv)
+MY_GL_TRACE_FUNCTION(gl, IsTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, MinSampleShading)
+MY_GL_TRACE_FUNCTION(gl, PatchParameterfv)
+MY_GL_TRACE_FUNCTION(gl, PatchParameteri)
+MY_GL_TRACE_FUNCTION(gl, PauseTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, ResumeTransformFeedback)
+MY_GL_TRACE_FUNCTION(gl, Uniform1d)
+MY_GL_TRACE_FUNCTION(gl, Uniform1dv)
+MY_GL_TRACE_FUNCTION(gl, Uniform2d)
+MY_GL_TRACE_FUNCTION(gl, Uniform2dv)
+MY_GL_TRACE_FUNCTION(gl, Uniform3d)
+MY_GL_TRACE_FUNCTION(gl, Uniform3dv)
+MY_GL_TRACE_FUNCTION(gl, Uniform4d)
+MY_GL_TRACE_FUNCTION(gl, Uniform4dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2x3dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix2x4dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3x2dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix3x4dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4x2dv)
+MY_GL_TRACE_FUNCTION(gl, UniformMatrix4x3dv)
+MY_GL_TRACE_FUNCTION(gl, UniformSubroutinesuiv)
+MY_GL_TRACE_FUNCTION(gl, ActiveShaderProgram)
+MY_GL_TRACE_FUNCTION(gl, BindProgramPipeline)
+MY_GL_TRACE_FUNCTION(gl, ClearDepthf)
+MY_GL_TRACE_FUNCTION(gl, CreateShaderProgramv)
+MY_GL_TRACE_FUNCTION(gl, DeleteProgramPipelines)
+MY_GL_TRACE_FUNCTION(gl, DepthRangeArrayv)
+MY_GL_TRACE_FUNCTION(gl, DepthRangeIndexed)
+MY_GL_TRACE_FUNCTION(gl, DepthRangef)
+MY_GL_TRACE_FUNCTION(gl, GenProgramPipelines)
+MY_GL_TRACE_FUNCTION(gl, GetDoublei_v)
+MY_GL_TRACE_FUNCTION(gl, GetFloati_v)
+MY_GL_TRACE_FUNCTION(gl, GetProgramBinary)
+MY_GL_TRACE_FUNCTION(gl, GetProgramPipelineInfoLog)
+MY_GL_TRACE_FUNCTION(gl, GetProgramPipelineiv)
+MY_GL_TRACE_FUNCTION(gl, GetShaderPrecisionFormat)
+MY_GL_TRACE_FUNCTION(gl, GetVertexAttribLdv)
+MY_GL_TRACE_FUNCTION(gl, IsProgramPipeline)
+MY_GL_TRACE_FUNCTION(gl, ProgramBinary)
+MY_GL_TRACE_FUNCTION(gl, ProgramParameteri)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1d)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1f)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1i)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1iv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1ui)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform1uiv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2d)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2f)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2i)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2iv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2ui)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform2uiv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3d)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3f)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3i)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3iv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3ui)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform3uiv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4d)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4f)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4i)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4iv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4ui)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniform4uiv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2x3dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2x3fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2x4dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix2x4fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3x2dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3x2fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3x4dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix3x4fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4x2dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4x2fv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4x3dv)
+MY_GL_TRACE_FUNCTION(gl, ProgramUniformMatrix4x3fv)
+MY_GL_TRACE_FUNCTION(gl, ReleaseShaderCompiler)
+MY_GL_TRACE_FUNCTION(gl, ScissorArrayv)
+MY_GL_TRACE_FUNCTION(gl, ScissorIndexed)
+MY_GL_TRACE_FUNCTION(gl, ScissorIndexedv)
+MY_GL_TRACE_FUNCTION(gl, ShaderBinary)
+MY_GL_TRACE_FUNCTION(gl, UseProgramStages)
+MY_GL_TRACE_FUNCTION(gl, ValidateProgramPipeline)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL1d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL1dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL2d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL2dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL3d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL3dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL4d)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribL4dv)
+MY_GL_TRACE_FUNCTION(gl, VertexAttribLPointer)
+MY_GL_TRACE_FUNCTION(gl, ViewportArrayv)
+MY_GL_TRACE_FUNCTION(gl, ViewportIndexedf)
+MY_GL_TRACE_FUNCTION(gl, ViewportIndexedfv)
+MY_GL_TRACE_FUNCTION(gl, BindImageTexture)
+MY_GL_TRACE_FUNCTION(gl, DrawArraysInstancedBaseInstance)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsInstancedBaseInstance)
+MY_GL_TRACE_FUNCTION(gl, DrawElementsInstancedBaseVertexBaseInstance)
+MY_GL_TRACE_FUNCTION(gl, DrawTransformFeedbackInstanced)
+MY_GL_TRACE_FUNCTION(gl, DrawTransformFeedbackStreamInstanced)
+MY_GL_TRACE_FUNCTION(gl, GetActiveAtomicCounterBufferiv)
+MY_GL_TRACE_FUNCTION(gl, GetInternalformativ)
+MY_GL_TRACE_FUNCTION(gl, MemoryBarrier)
+MY_GL_TRACE_FUNCTION(gl, TexStorage1D)
+MY_GL_TRACE_FUNCTION(gl, TexStorage2D)
+MY_GL_TRACE_FUNCTION(gl, TexStorage3D)
+
+// my_gl_core::ext
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, BufferStorage)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, BindBuffersRange)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, BindTextures)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, BindVertexBuffers)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, CreateBuffers)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, NamedBufferData)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, NamedBufferSubData)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, NamedBufferStorage)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, MapNamedBufferRange)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, UnmapNamedBuffer)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, FlushMappedNamedBufferRange)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, CreateVertexArrays)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, EnableVertexArrayAttrib)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, VertexArrayAttribFormat)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, VertexArrayAttribBinding)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, VertexArrayBindingDivisor)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, VertexArrayVertexBuffer)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, VertexArrayElementBuffer)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, CreateTextures)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, TextureStorage2D)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, TextureSubImage2D)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, TextureParameteri)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, BindTextureUnit)
+MY_GL_TRACE_FUNCTION(my_gl_core::ext, MaxShaderCompilerThreads)